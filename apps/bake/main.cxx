@@ -0,0 +1,57 @@
+#include <algorithm>
+#include <fstream>
+#include <filesystem>
+#include <iterator>
+
+#include <argparse/argparse.hpp>
+#include <spdlog/spdlog.h>
+#include <fmt/format.h>
+
+#include "../../libs/texture/texture.h"
+#include "../../libs/texture/baked_animation.h"
+
+// Renders a Lottie animation at a fixed size into a baked animation, so the application can show it without rlottie.
+int main(int argc, char **argv) {
+    argparse::ArgumentParser program("bake");
+    program.add_argument("input").help("Lottie JSON file");
+    program.add_argument("output").help("baked animation file to write");
+    program.add_argument("--width").help("frame width in pixels").scan<'i', int>();
+    program.add_argument("--height").help("frame height in pixels").scan<'i', int>();
+    try {
+        program.parse_args(argc, argv);
+    } catch (const std::runtime_error &err) {
+        spdlog::error("{}", err.what());
+        return 1;
+    }
+    const std::filesystem::path input = program.get<std::string>("input");
+    const std::filesystem::path output = program.get<std::string>("output");
+    const glm::ivec2 size = { program.get<int>("--width"), program.get<int>("--height") };
+
+    std::ifstream input_file(input, std::ios::binary);
+    if (!input_file) {
+        spdlog::error("Unable to open: {}", input.string());
+        return 1;
+    }
+    std::vector<std::byte> data;
+    std::transform(std::istreambuf_iterator<char>(input_file), std::istreambuf_iterator<char>(), std::back_inserter(data), [](const char &c) { return static_cast<std::byte>(c); });
+
+    const auto sequence = sc::texture::load_lottie_from_memory(input.filename().string(), data, size);
+    if (!sequence.has_value()) {
+        spdlog::error("{}: {}", input.string(), sequence.error());
+        return 1;
+    }
+    const auto baked = sc::texture::bake_animation(*sequence);
+    if (!baked.has_value()) {
+        spdlog::error("{}: {}", input.string(), baked.error());
+        return 1;
+    }
+    if (output.has_parent_path()) std::filesystem::create_directories(output.parent_path());
+    std::ofstream output_file(output, std::ios::binary | std::ios::trunc);
+    output_file.write(reinterpret_cast<const char *>(baked->data()), baked->size());
+    if (!output_file) {
+        spdlog::error("Unable to write: {}", output.string());
+        return 1;
+    }
+    spdlog::info("Baked {} ({} frames at {}x{}): {} KiB, {} KiB raw", input.filename().string(), sequence->num_frames, size.x, size.y, baked->size() / 1024, sequence->pixels.size() / 1024);
+    return 0;
+}
@@ -1,6 +1,9 @@
 #include "animation_instance.h"
 // This includes the animation_instance.h header file, which contains the definition of the animation_instance structure.
 
+#include "../../libs/boot/wakeup.h"
+// This includes the main loop wakeup header, so a playing animation keeps the loop updating.
+
 bool sc::animation_instance::update() {
     // This function updates the state of an animation_instance. It returns a boolean indicating whether the animation frame has changed.
 
@@ -38,7 +41,7 @@ bool sc::animation_instance::update() {
         time += delta;
         // ...and add the delta to the animation time.
 
-        if (const auto res = texture::frame_sequence::plot_frame_index(frame_rate, frames.size(), time, loop); res && frame_i != *res) {
+        if (const auto res = texture::frame_sequence::plot_frame_index(frame_rate, num_frames, time, loop); res && frame_i != *res) {
             // If the result of the frame_sequence's plot_frame_index function is a valid frame index that is different from the current frame index...
 
             frame_i = *res;
@@ -47,10 +50,31 @@ bool sc::animation_instance::update() {
             changed = true;
             // ...and set the changed flag to true.
         }
-        if (!loop && frame_i == frames.size() - 1) playing = false;
+        if (!loop && frame_i == num_frames - 1) playing = false;
         // If the animation is not set to loop and the current frame is the last frame, stop the animation.
+
+        if (playing && frame_rate > 0) sc::boot::schedule(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / frame_rate)));
+        // While playing, ask the main loop to come back in time for the next frame.
     }
     
+    if (player) {
+        if (now - last_shown > std::chrono::seconds(1)) {
+            // If the animation hasn't been on screen for a second, stop it and drop every frame and texture.
+            playing = false;
+            player->release();
+        } else if (was_playing && !playing) player->trim();
+        // If the animation just stopped, drop everything but the frame that stays on screen.
+    }
+    was_playing = playing;
+
     return changed;
     // Return the changed flag, indicating whether the animation frame has changed during this update.
 }
+
+std::shared_ptr<sc::texture::gpu_handle> sc::animation_instance::texture() {
+    // This function returns the texture for the current frame and marks the animation as being on screen.
+
+    last_shown = std::chrono::high_resolution_clock::now();
+    if (!player) return nullptr;
+    return player->texture(frame_i);
+}
@@ -13,6 +13,9 @@
 #include "../../libs/texture/texture.h"
 // This includes the texture.h header file from the texture library, likely providing functionality for handling textures in the application.
 
+#include "../../libs/texture/lottie_player.h"
+// This includes the lottie_player.h header file, which renders animation frames on demand.
+
 namespace sc {
 // The sc namespace is used to organize the code and avoid name collisions.
 
@@ -35,10 +38,26 @@ namespace sc {
         // This represents the frame rate of the animation, in frames per second.
 
         size_t frame_i = 0;
-        // This represents the index of the current frame in the frames vector.
+        // This represents the index of the current frame of the animation.
+
+        size_t num_frames = 0;
+        // This is the number of frames in the animation.
+
+        glm::ivec2 size = { 0, 0 };
+        // This is the size every frame is rendered at.
+
+        std::shared_ptr<sc::texture::lottie_player> player;
+        // This renders frames on demand; it holds only a few frames and textures at a time, and none while the animation isn't shown.
+
+        bool was_playing = false;
+        // This remembers whether the animation was playing during the previous update, to notice when it stops.
+
+        std::chrono::high_resolution_clock::time_point last_shown = std::chrono::high_resolution_clock::now();
+        // This is the time point texture() was last called, i.e. the animation was last on screen.
+        // It starts at creation, so a new instance gets a second to be shown before update() releases its player's frames.
 
-        std::vector<std::shared_ptr<sc::texture::gpu_handle>> frames;
-        // This is a vector of shared pointers to gpu_handle objects in the sc::texture namespace. Each gpu_handle likely represents a frame of the animation, and is stored on the GPU.
+        std::shared_ptr<sc::texture::gpu_handle> texture();
+        // This returns the texture for the current frame, or nothing while the first frame is still being rendered.
 
         std::chrono::high_resolution_clock::time_point last_update = std::chrono::high_resolution_clock::now();
         // This is the time point of the last update to the animation. It is initialized to the current time when the animation_instance is created.
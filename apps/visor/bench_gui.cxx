@@ -0,0 +1,100 @@
+// Measures what it costs to build the visor's UI, without a window or a GPU.
+// An ImGui context without a renderer backend is fed by simulated devices, legacy axes and telemetry, and every panel
+// is built for thousands of frames through gui::emit, reporting CPU time, allocations and draw-list sizes per frame.
+
+#include "bench_gui_harness.h" // Include the headless UI harness
+
+#include <fmt/format.h> // Include the fmt library's header
+
+#include <algorithm> // Include the algorithm header
+#include <atomic> // Include the atomic header
+#include <cstdlib> // Include the cstdlib header
+#include <map> // Include the map header
+#include <new> // Include the new header
+
+static std::atomic<uint64_t> num_allocations = 0; // Every heap allocation, through operator new or ImGui's allocator
+
+void *operator new(size_t size) {
+    num_allocations++;
+    if (auto ptr = std::malloc(size ? size : 1); ptr) return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+static void *imgui_alloc(size_t size, void *) {
+    num_allocations++;
+    return std::malloc(size);
+}
+
+static void imgui_free(void *ptr, void *) {
+    std::free(ptr);
+}
+
+namespace {
+
+    struct draw_list_stats {
+
+        int vertices = 0, indices = 0, commands = 0;
+    };
+}
+
+int main(int argc, char **argv) {
+    const auto num_frames = argc > 1 ? std::stoi(argv[1]) : 5000;
+
+    ImGui::SetAllocatorFunctions(imgui_alloc, imgui_free);
+    sc::visor::bench::start();
+
+    sc::visor::bench::simulation sim;
+    sc::visor::gui::attach(sim.context);
+
+    spdlog::info("{} frames per panel at {}x{}", num_frames, sc::visor::bench::framebuffer_size.x, sc::visor::bench::framebuffer_size.y);
+    for (const auto &panel : sc::visor::bench::scenarios(sim)) {
+        if (!sc::visor::bench::open(panel, sim)) {
+            spdlog::warn("{}: tab not found, skipped.", panel.name);
+            continue;
+        }
+
+        std::vector<double> frame_us;
+        frame_us.reserve(num_frames);
+        const auto allocations_before = num_allocations.load();
+        for (int frame_i = 0; frame_i < num_frames; frame_i++) {
+            const auto start = std::chrono::steady_clock::now();
+            sc::visor::bench::emit_frame(sim);
+            frame_us.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+        }
+        const auto allocations = num_allocations.load() - allocations_before;
+
+        // Sizes come from the last frame; with animated inputs they hardly vary between frames
+        std::map<std::string, draw_list_stats> draw_lists; // By owner window; child windows have their own
+        const auto draw_data = ImGui::GetDrawData();
+        for (int i = 0; i < draw_data->CmdListsCount; i++) {
+            const auto list = draw_data->CmdLists[i];
+            auto &stats = draw_lists[list->_OwnerName ? list->_OwnerName : "?"];
+            stats.vertices += list->VtxBuffer.Size;
+            stats.indices += list->IdxBuffer.Size;
+            stats.commands += list->CmdBuffer.Size;
+        }
+
+        std::sort(frame_us.begin(), frame_us.end());
+        double total_us = 0;
+        for (const auto &us : frame_us) total_us += us;
+        spdlog::info("{}:", panel.name);
+        spdlog::info("  CPU: {:.1f} us per frame (median {:.1f}, p99 {:.1f})", total_us / num_frames, frame_us[frame_us.size() / 2], frame_us[(frame_us.size() * 99) / 100]);
+        spdlog::info("  Allocations: {:.1f} per frame", static_cast<double>(allocations) / num_frames);
+        spdlog::info("  Frame arena: {} bytes used", ImFrameArena::Get().Used());
+        spdlog::info("  Draw lists: {}, {} vertices, {} indices", draw_data->CmdListsCount, draw_data->TotalVtxCount, draw_data->TotalIdxCount);
+        for (const auto &[owner, stats] : draw_lists) {
+            spdlog::info("    {}: {} vertices, {} indices, {} commands", owner, stats.vertices, stats.indices, stats.commands);
+        }
+    }
+
+    sc::visor::bench::stop();
+    return 0;
+}
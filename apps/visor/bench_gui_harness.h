@@ -0,0 +1,180 @@
+#pragma once
+
+// Runs the visor's UI without a window or a GPU, for the headless benchmarks.
+// An ImGui context without a renderer backend is fed by simulated devices, legacy axes and telemetry, and panels are
+// selected by their tab labels, so a benchmark can build any of them through gui::emit.
+
+#include "gui.h" // Include the GUI header
+#include "device_context.h" // Include the device context header
+#include "legacy.h" // Include the legacy header
+
+#include "../../libs/iracing/iracing.h" // Include the iRacing header
+#include "../../libs/imgui/imgui_utils.hpp" // Include the ImGui utilities, for the frame arena
+#include "../../libs/recorder/recorder.h" // Include the recorder header, for the clock the axis histories use
+
+#include <imgui.h> // Include the ImGui library
+#include <imgui_internal.h> // Include ImGui's internals, to select tabs without clicking them
+#include <spdlog/spdlog.h> // Include the spdlog library's header
+
+#include <chrono> // Include the chrono header
+#include <cmath> // Include the cmath header
+#include <filesystem> // Include the filesystem header
+#include <memory> // Include the memory header
+#include <string> // Include the string header
+#include <thread> // Include the thread header
+#include <vector> // Include the vector header
+
+namespace sc::visor::bench {
+
+    // Drives the inputs the panels show, so every frame draws something different, like it does with pedals in use.
+    struct simulation {
+
+        std::shared_ptr<device_context> context = std::make_shared<device_context>();
+        int64_t tick = 0;
+
+        simulation() {
+            context->name = "Simulated MK4";
+            context->serial = "BENCH0001";
+            context->axes.resize(3);
+            context->axes_ex.resize(3);
+            for (int i = 0; i < 3; i++) {
+                context->axes[i].enabled = true;
+                context->axes[i].curve_i = 0;
+                context->axes_ex[i].model_edit_i = 0; // Show the curve editor, the heaviest part of the axis panel
+                legacy::axes[i].present = true;
+                legacy::axes[i].label = i == 0 ? "Throttle" : (i == 1 ? "Brake" : "Clutch");
+                legacy::axes[i].curve_i = 0;
+                legacy::axes[i].model_edit_i = 0;
+            }
+            context->initial_communication_complete = true;
+
+            // A full minute of history at 1 kHz, as the legacy pipeline records it, so the plots downsample their worst case
+            const auto now_us = recorder::now_us();
+            for (int64_t i = 60000; i > 0; i--) {
+                const auto value = static_cast<float>(.5 + .5 * std::sin(i / 1000.0));
+                for (auto &trace : context->traces) trace.push(now_us - (i * 1000), value, value * value);
+                for (auto &trace : legacy::traces) trace.push(now_us - (i * 1000), value, value * value);
+            }
+        }
+
+        void step() {
+            tick++;
+            const auto t = tick / 60.0;
+            {
+                std::lock_guard guard(context->mutex);
+                for (int i = 0; i < 3; i++) {
+                    const auto value = static_cast<float>(.5 + .5 * std::sin(t + i));
+                    auto &axis = context->axes[i];
+                    axis.input = static_cast<uint16_t>(value * axis.max);
+                    axis.input_fraction = value;
+                    axis.output_fraction = value * value;
+                    axis.output = static_cast<uint16_t>(axis.output_fraction * axis.max);
+                }
+            }
+            for (int i = 0; i < 3; i++) {
+                auto &axis = legacy::axes[i];
+                axis.input_raw = static_cast<float>(.5 + .5 * std::cos(t + i));
+                axis.input_steps = static_cast<int>(axis.input_raw * axis.output_steps_max);
+                axis.output = axis.input_raw * axis.input_raw;
+                axis.output_short = static_cast<int>(axis.output * 32767);
+            }
+            const auto now_us = recorder::now_us();
+            for (int i = 0; i < 3; i++) {
+                context->traces[i].push(now_us, context->axes[i].input_fraction, context->axes[i].output_fraction);
+                legacy::traces[i].push(now_us, legacy::axes[i].input_raw, legacy::axes[i].output);
+            }
+            iracing::frame current;
+            current.tick = tick;
+            current.lap_percent = static_cast<float>(std::fmod(t / 90.0, 1.0));
+            current.speed = static_cast<float>(80 + 40 * std::sin(t / 4));
+            current.rpm = static_cast<float>(6000 + 1500 * std::sin(t));
+            current.gear = 1 + static_cast<int32_t>(tick / 300) % 6;
+            current.throttle = context->axes[0].input_fraction;
+            current.brake = context->axes[1].input_fraction;
+            iracing::replay(current);
+        }
+    };
+
+    struct scenario {
+
+        std::string name;
+        std::vector<std::string> tabs; // Tab labels to select, outermost first; matched by substring
+    };
+
+    inline const glm::ivec2 framebuffer_size = { 1280, 800 };
+
+    // Every panel worth measuring
+    inline std::vector<scenario> scenarios(const simulation &sim) {
+        return {
+            { "Account", { "Account" } },
+            { "Hardware", { "Hardware", sim.context->name } },
+            { "Virtual Pedals", { "Virtual Pedals" } },
+            { "iRacing Telemetry", { "iRacing", "Telemetry" } },
+            { "iRacing Coaching", { "iRacing", "Coaching" } },
+            { "iRacing Recorder", { "iRacing", "Recorder" } },
+            { "iRacing Profiles", { "iRacing", "Profiles" } }
+        };
+    }
+
+    // Builds one frame of the UI; without "animate" the simulated inputs hold still, as with nobody at the pedals
+    inline void emit_frame(simulation &sim, const bool &animate = true) {
+        if (animate) sim.step();
+        ImGui::GetIO().DeltaTime = 1.f / 60.f;
+        ImFrameArena::Get().Reset(); // As the boot header does before every frame
+        ImGui::NewFrame();
+        gui::emit(framebuffer_size);
+        ImGui::Render();
+    }
+
+    // Selects the first tab whose label contains the given text, in whichever tab bar it is.
+    inline bool select_tab(const std::string &label) {
+        for (auto &tab_bar : GImGui->TabBars.Buf) {
+            for (auto &tab : tab_bar.Tabs) {
+                if (std::string(ImGui::TabBarGetTabName(&tab_bar, &tab)).find(label) == std::string::npos) continue;
+                tab_bar.NextSelectedTabId = tab.ID;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Brings a panel to the front; false if one of its tabs wasn't found
+    inline bool open(const scenario &panel, simulation &sim) {
+        // Tab bars only exist once they were built, so select one level per frame, then let the layout settle.
+        bool selected = true;
+        for (const auto &tab : panel.tabs) {
+            emit_frame(sim);
+            selected = selected && select_tab(tab);
+        }
+        for (int i = 0; i < 10; i++) emit_frame(sim);
+        return selected;
+    }
+
+    // Creates the ImGui context and starts the UI, as the boot header would
+    inline void start() {
+        // Settings, profile rules and the startup trace are written to the working directory; keep them away from a real install.
+        const auto work_directory = std::filesystem::temp_directory_path() / "visor-bench-gui";
+        std::filesystem::create_directories(work_directory);
+        std::filesystem::current_path(work_directory);
+
+        ImGui::CreateContext();
+        auto &io = ImGui::GetIO();
+        io.DisplaySize = { static_cast<float>(framebuffer_size.x), static_cast<float>(framebuffer_size.y) };
+        io.IniFilename = nullptr;
+        unsigned char *pixels;
+        int width, height;
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height); // The default font, built on the CPU; icons show as missing glyphs
+
+        gui::initialize();
+        spdlog::set_level(spdlog::level::off); // The stand-ins have no animation resources, which show() reports as errors
+        gui::show();
+        spdlog::set_level(spdlog::level::info);
+        while (!gui::ready()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    inline void stop() {
+        gui::hide();
+        gui::shutdown();
+        ImGui::DestroyContext();
+    }
+}
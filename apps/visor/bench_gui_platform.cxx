@@ -0,0 +1,87 @@
+// Stand-ins for the Windows-only modules the GUI talks to, so bench_gui builds and runs headless on any platform.
+// Each one behaves like the real module on a machine without the hardware or the sim: no resources, no HID devices,
+// a telemetry bus the benchmark publishes to, and a legacy pipeline whose axes the benchmark writes directly.
+
+#include "legacy.h" // Include the legacy header
+#include "../../libs/resource/resource.h" // Include the resource header
+#include "../../libs/iracing/iracing.h" // Include the iRacing header
+#include "../../libs/hidapi/hidapi.h" // Include the hidapi header
+
+#include <cmath> // Include the cmath header
+#include <string> // Include the string header
+#include <vector> // Include the vector header
+#include <fmt/format.h> // Include the fmt library's header
+
+// Resources are compiled into the executable on Windows; without them the GUI skips the animations.
+std::optional<std::pair<void *, size_t>> sc::resource::get_resource(const std::string_view &type, const std::string_view &name) {
+    return std::nullopt;
+}
+
+// No HID devices are ever found, so the device scan comes back empty and the simulated contexts are the only ones shown.
+int HID_API_EXPORT HID_API_CALL hid_init(void) { return 0; }
+struct hid_device_info HID_API_EXPORT * HID_API_CALL hid_enumerate(unsigned short vendor_id, unsigned short product_id) { return nullptr; }
+void HID_API_EXPORT HID_API_CALL hid_free_enumeration(struct hid_device_info *devs) { }
+HID_API_EXPORT hid_device * HID_API_CALL hid_open(unsigned short vendor_id, unsigned short product_id, const wchar_t *serial_number) { return nullptr; }
+HID_API_EXPORT hid_device * HID_API_CALL hid_open_path(const char *path) { return nullptr; }
+int HID_API_EXPORT HID_API_CALL hid_write(hid_device *dev, const unsigned char *data, size_t length) { return -1; }
+int HID_API_EXPORT HID_API_CALL hid_read_timeout(hid_device *dev, unsigned char *data, size_t length, int milliseconds) { return -1; }
+void HID_API_EXPORT HID_API_CALL hid_close(hid_device *dev) { }
+
+namespace sc::iracing {
+
+    static telemetry_bus bus; // Fed by the benchmark through replay()
+    static const status live = status::live; // The simulated sim is always live
+}
+
+void sc::iracing::startup() { }
+void sc::iracing::shutdown() { }
+
+const sc::iracing::status &sc::iracing::get_status() {
+    return live;
+}
+
+std::shared_ptr<const sc::iracing::session_info> sc::iracing::session() {
+    return nullptr; // No session info; the profile rules never match
+}
+
+std::shared_ptr<const sc::iracing::variable_snapshot> sc::iracing::variables() {
+    // About as many variables as a live iRacing session exposes, so the variable list costs what it does in the sim
+    static const auto snapshot = [] {
+        std::vector<variable_info> list;
+        for (int i = 0; i < 280; i++) list.push_back({ fmt::format("Variable{:03}", i), fmt::format("Simulated channel #{}", i), i % 3 ? "m/s" : "%", static_cast<variable_type>(i % 6), i * 8, i % 10 ? 1 : 64 });
+        return variable_snapshot::create(std::move(list));
+    }();
+    return snapshot;
+}
+
+void sc::iracing::read_values(const variable_snapshot &snapshot, const std::vector<size_t> &indices, std::vector<double> &values) {
+    // Values that change every tick, decoded like the real ones would be
+    values.resize(indices.size());
+    const auto tick = bus.latest().value_or(frame { }).tick;
+    for (size_t i = 0; i < indices.size(); i++) values[i] = std::sin((tick + static_cast<int64_t>(indices[i])) / 60.0);
+}
+
+const sc::iracing::telemetry_bus &sc::iracing::telemetry() {
+    return bus;
+}
+
+std::optional<sc::iracing::frame> sc::iracing::latest() {
+    return bus.latest();
+}
+
+void sc::iracing::replay(const frame &value) {
+    bus.publish(value);
+}
+
+std::array<sc::visor::legacy::axis_info, 4> sc::visor::legacy::axes; // Written by the benchmark every frame
+std::array<sc::visor::legacy::model, 5> sc::visor::legacy::models;
+std::array<sc::visor::pedal_trace, 4> sc::visor::legacy::traces; // Also written by the benchmark
+
+std::optional<std::string> sc::visor::legacy::enable() { return std::nullopt; }
+void sc::visor::legacy::disable() { }
+std::optional<std::string> sc::visor::legacy::process() { return std::nullopt; }
+bool sc::visor::legacy::present() { return true; }
+void sc::visor::legacy::replay(const std::optional<std::array<float, 4>> &inputs) { }
+void sc::visor::legacy::apply_settings(std::shared_ptr<const profiles::pedal_settings> settings) { }
+std::optional<std::string> sc::visor::legacy::load_settings() { return std::nullopt; }
+std::optional<std::string> sc::visor::legacy::save_settings() { return std::nullopt; }
@@ -0,0 +1,112 @@
+// Measures ImDrawCompare, which decides whether a frame needs drawing, against the full memcmp it replaced.
+// Every panel of the visor is built headless through gui::emit, once with the simulated pedals at rest and once in use.
+
+#include "bench_gui_harness.h" // Include the headless UI harness
+
+#include <chrono> // Include the chrono header
+#include <cstring> // Include the cstring header
+#include <type_traits> // Include the type_traits header
+
+// The implementation ImDrawCompare replaced: a full memcmp against the previous frame, then a full copy on change.
+struct ImDrawCompareMemcmp {
+
+    std::vector<std::vector<ImDrawVert>> prev_vertices;
+    std::vector<std::vector<ImDrawIdx>> prev_indices;
+
+    bool Check(ImDrawData *const data) {
+        const auto draw_list_num = data->CmdListsCount;
+        const bool prev_vertices_match = [&]() {
+            if (prev_vertices.size() < draw_list_num) return false;
+            for (int i = 0; i < prev_vertices.size() && i < data->CmdListsCount; i++) {
+                if (prev_vertices[i].size() < data->CmdLists[i]->VtxBuffer.size()) return false;
+                if (memcmp(prev_vertices[i].data(), data->CmdLists[i]->VtxBuffer.Data, sizeof(ImDrawVert) * data->CmdLists[i]->VtxBuffer.size()) != 0) return false;
+            }
+            return true;
+        }();
+        const bool prev_indices_match = [&]() {
+            if (prev_indices.size() < draw_list_num) return false;
+            for (int i = 0; i < prev_indices.size() && i < data->CmdListsCount; i++) {
+                if (prev_indices[i].size() < data->CmdLists[i]->IdxBuffer.size()) return false;
+                if (memcmp(prev_indices[i].data(), data->CmdLists[i]->IdxBuffer.Data, sizeof(ImDrawIdx) * data->CmdLists[i]->IdxBuffer.size()) != 0)  return false;
+            }
+            return true;
+        }();
+        if (prev_vertices_match && prev_indices_match) return true;
+        if (prev_vertices.size() < draw_list_num) prev_vertices.resize(draw_list_num);
+        if (prev_indices.size() < draw_list_num) prev_indices.resize(draw_list_num);
+        for (int i = 0; i < draw_list_num; i++) {
+            const auto this_draw_list = data->CmdLists[i];
+            const auto this_draw_list_vertex_num = this_draw_list->VtxBuffer.size();
+            const auto this_draw_list_index_num = this_draw_list->IdxBuffer.size();
+            if (prev_vertices[i].size() < this_draw_list_vertex_num) prev_vertices[i].resize(this_draw_list_vertex_num);
+            memcpy(prev_vertices[i].data(), this_draw_list->VtxBuffer.Data, sizeof(ImDrawVert) * this_draw_list->VtxBuffer.size());
+            if (prev_indices[i].size() < this_draw_list_index_num) prev_indices[i].resize(this_draw_list_index_num);
+            memcpy(prev_indices[i].data(), this_draw_list->IdxBuffer.Data, sizeof(ImDrawIdx) * this_draw_list->IdxBuffer.size());
+        }
+        return false;
+    }
+
+    // Geometry kept between frames
+    size_t Bytes() const {
+        size_t res = 0;
+        for (const auto &vertices : prev_vertices) res += vertices.size() * sizeof(ImDrawVert);
+        for (const auto &indices : prev_indices) res += indices.size() * sizeof(ImDrawIdx);
+        return res;
+    }
+};
+
+// Fingerprints and command hashes kept between frames
+static size_t bytes_of(const ImDrawCompare &compare) {
+    size_t res = compare.prints.size() * sizeof(ImDrawListFingerprint);
+    for (const auto &commands : compare.commands) res += commands.size() * sizeof(ImDrawCompare::Command);
+    return res;
+}
+
+template<typename T> static double measure(T &compare, sc::visor::bench::simulation &sim, const bool &animate, const int &num_frames, int &num_changed, double *const damaged = nullptr) {
+    double total_us = 0;
+    num_changed = 0;
+    if (damaged) *damaged = 0;
+    for (int frame_i = 0; frame_i < num_frames; frame_i++) {
+        sc::visor::bench::emit_frame(sim, animate);
+        const auto start = std::chrono::high_resolution_clock::now();
+        if (!compare.Check(ImGui::GetDrawData())) num_changed++;
+        total_us += std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+        if constexpr (std::is_same_v<T, ImDrawCompare>) {  // Share of the display that would be drawn again
+            const auto display_size = ImGui::GetDrawData()->DisplaySize;
+            if (damaged && frame_i) *damaged += compare.damage.full ? 1 : compare.damage.Area() / (display_size.x * display_size.y);
+        }
+    }
+    return total_us / num_frames;
+}
+
+int main(int argc, char **argv) {
+    const auto num_frames = argc > 1 ? std::stoi(argv[1]) : 2000;
+
+    sc::visor::bench::start();
+    sc::visor::bench::simulation sim;
+    sc::visor::gui::attach(sim.context);
+
+    spdlog::info("{} frames per panel at {}x{}", num_frames, sc::visor::bench::framebuffer_size.x, sc::visor::bench::framebuffer_size.y);
+    for (const auto &panel : sc::visor::bench::scenarios(sim)) {
+        if (!sc::visor::bench::open(panel, sim)) {
+            spdlog::warn("{}: tab not found, skipped.", panel.name);
+            continue;
+        }
+        for (const auto animate : { false, true }) {
+            ImDrawCompareMemcmp memcmp_compare;
+            ImDrawCompare hash_compare;
+            int memcmp_changed, hash_changed;
+            double damaged;
+            const auto memcmp_us = measure(memcmp_compare, sim, animate, num_frames, memcmp_changed);
+            const auto hash_us = measure(hash_compare, sim, animate, num_frames, hash_changed, &damaged);
+            const auto draw_data = ImGui::GetDrawData();
+            spdlog::info("{}, {}: {} draw lists, {} vertices, {} indices", panel.name, animate ? "pedals in use" : "pedals at rest", draw_data->CmdListsCount, draw_data->TotalVtxCount, draw_data->TotalIdxCount);
+            spdlog::info("  memcmp+copy: {:.2f} us per frame, {} of {} frames changed, {} bytes kept", memcmp_us, memcmp_changed, num_frames, memcmp_compare.Bytes());
+            spdlog::info("  fingerprint: {:.2f} us per frame, {} of {} frames changed, {} bytes kept", hash_us, hash_changed, num_frames, bytes_of(hash_compare));
+            spdlog::info("  damage: {:.1f}% of the display per frame", (damaged * 100) / (num_frames - 1));
+        }
+    }
+
+    sc::visor::bench::stop();
+    return 0;
+}
@@ -0,0 +1,130 @@
+#include "profile_store.h" // Include the "profile_store.h" header file
+
+#include <chrono> // Include the chrono header
+#include <random> // Include the random header
+
+#include <fmt/format.h> // Include the fmt library's header
+#include <nlohmann/json.hpp> // Include the nlohmann/json library's header
+#include <spdlog/spdlog.h> // Include the spdlog library's header
+
+using namespace sc::visor; // Use the visor namespace
+
+// The rules as profiles.json kept them, to compare against
+static nlohmann::json to_json(const std::vector<profiles::rule> &rules) {
+    nlohmann::json rules_doc = nlohmann::json::array();
+    for (const auto &entry : rules) {
+        nlohmann::json rule_doc = { { "id", entry.id }, { "name", entry.name } };
+        if (entry.car) rule_doc["car"] = *entry.car;
+        if (entry.track) rule_doc["track"] = *entry.track;
+        for (const auto &[key, settings] : { std::pair { "virtual", &entry.legacy }, std::pair { "mk4", &entry.mk4 } }) {
+            if (!*settings) continue;
+            auto &settings_doc = rule_doc[key];
+            for (const auto &axis : (*settings)->axes) settings_doc["axes"].push_back({ { "min", *axis.min }, { "max", *axis.max }, { "deadzone", *axis.deadzone }, { "limit", *axis.limit }, { "curve", *axis.curve_i } });
+            for (const auto &model : (*settings)->models) {
+                nlohmann::json model_doc = nlohmann::json::object();
+                for (const auto &point : *model) model_doc["points"].push_back({ { "x", point.x }, { "y", point.y } });
+                settings_doc["models"].push_back(model_doc);
+            }
+        }
+        rules_doc.push_back(rule_doc);
+    }
+    return { { "rules", rules_doc } };
+}
+
+// profiles::match, without the allocations of pystring::lower
+static const profiles::rule *reference_match(const std::vector<profiles::rule> &rules, const std::string &car, const std::string &track) {
+    const auto equal_ci = [](const std::string &a, const std::string &b) {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](const char &x, const char &y) { return std::tolower(x) == std::tolower(y); });
+    };
+    const auto specificity = [](const profiles::rule &entry) { return (entry.car ? 2 : 0) + (entry.track ? 1 : 0); }; // rule::specificity lives with the rest of profiles.cxx
+    const profiles::rule *best = nullptr;
+    for (const auto &entry : rules) {
+        if (entry.car && !equal_ci(*entry.car, car)) continue;
+        if (entry.track && !equal_ci(*entry.track, track)) continue;
+        if (!best || specificity(entry) > specificity(*best)) best = &entry;
+    }
+    return best;
+}
+
+template<typename F> static double time_us(const int &n, F &&f) {
+    const auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < n; i++) f(i);
+    return std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count() / n;
+}
+
+int main() {
+    // Rules per car, per track and per car and track, as a driver with a few hundred profiles has them
+    std::mt19937 rng(7);
+    std::vector<std::string> cars, tracks;
+    for (int i = 0; i < 40; i++) cars.push_back(fmt::format("car{:02}gt3", i));
+    for (int i = 0; i < 30; i++) tracks.push_back(fmt::format("track {:02}", i));
+    std::vector<profiles::rule> rules;
+    for (int i = 0; i < 500; i++) {
+        profiles::rule entry;
+        entry.id = fmt::format("{:032x}", i * 2654435761u);
+        const auto kind = i % 5;
+        if (kind != 4) entry.car = cars[rng() % cars.size()];
+        if (kind == 0 || kind == 3) entry.track = tracks[rng() % tracks.size()];
+        entry.name = fmt::format("{} @ {} #{}", entry.car.value_or("Any"), entry.track.value_or("Any"), i);
+        profiles::pedal_settings settings;
+        for (auto &axis : settings.axes) {
+            axis.min = static_cast<int>(rng() % 20);
+            axis.max = 80 + static_cast<int>(rng() % 20);
+            axis.deadzone = static_cast<int>(rng() % 5);
+            axis.limit = 100;
+            axis.curve_i = static_cast<int>(rng() % 5);
+        }
+        for (auto &model : settings.models) {
+            std::array<glm::ivec2, 6> points;
+            for (int j = 0; j < 6; j++) points[j] = { j * 20, static_cast<int>(rng() % 100) };
+            model = points;
+        }
+        entry.legacy = settings;
+        if (i % 2) entry.mk4 = settings;
+        rules.push_back(std::move(entry));
+    }
+
+    const auto path = std::filesystem::temp_directory_path() / "visor-bench-profiles.bin";
+    const auto built = profiles::store::build(rules);
+    if (const auto err = sc::file::save(path, std::vector<std::byte>(built->data(), built->data() + built->data_size())); err) {
+        spdlog::error("Unable to save the store: {}", *err);
+        return 1;
+    }
+    const auto json_text = to_json(rules).dump(4);
+
+    // Startup: map and check the store, against parsing the same rules as JSON
+    const auto open_us = time_us(50, [&](int) { if (!profiles::store::open(path)) std::abort(); });
+    const auto parse_us = time_us(50, [&](int) { if (nlohmann::json::parse(json_text).is_discarded()) std::abort(); });
+    const auto opened = *profiles::store::open(path);
+
+    // Switching: find the rule for a session and copy out its settings
+    int num_mismatches = 0;
+    std::vector<std::pair<std::string, std::string>> sessions;
+    for (int i = 0; i < 1000; i++) sessions.emplace_back(cars[rng() % cars.size()], tracks[rng() % tracks.size()]);
+    for (const auto &[car, track] : sessions) {
+        const auto *expected = reference_match(rules, car, track);
+        const auto *found = opened->match(car, track);
+        if ((expected == nullptr) != (found == nullptr) || (found && profiles::store::field(found->id) != expected->id)) num_mismatches++;
+    }
+    const auto switch_us = time_us(static_cast<int>(sessions.size()), [&](const int &i) {
+        const auto *found = opened->match(sessions[i].first, sessions[i].second);
+        if (found && (found->flags & profiles::format::has_legacy)) {
+            const auto settings = profiles::store::to_settings(found->legacy);
+            if (!settings.axes[0].min) std::abort();
+        }
+    });
+    const auto linear_us = time_us(static_cast<int>(sessions.size()), [&](const int &i) {
+        if (const auto *found = reference_match(rules, sessions[i].first, sessions[i].second); found && !found->legacy) std::abort();
+    });
+    const auto id_us = time_us(static_cast<int>(rules.size()), [&](const int &i) { if (!opened->find_id(rules[i].id)) std::abort(); });
+    const auto name_us = time_us(static_cast<int>(rules.size()), [&](const int &i) { if (!opened->find_name(rules[i].name)) std::abort(); });
+
+    spdlog::info("{} rules, {} KiB store, {} KiB JSON", rules.size(), built->data_size() / 1024, json_text.size() / 1024);
+    spdlog::info("  open store: {:.1f} us, parse JSON: {:.1f} us", open_us, parse_us);
+    spdlog::info("  match + settings: {:.2f} us, linear match over rules: {:.2f} us", switch_us, linear_us);
+    spdlog::info("  find by id: {:.2f} us, find by name: {:.2f} us", id_us, name_us);
+    spdlog::info("  {} of {} sessions matched differently than profiles::match would", num_mismatches, sessions.size());
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    return num_mismatches ? 1 : 0;
+}
@@ -2,6 +2,11 @@
 #include "bezier.h"
 #include "im_glm_vec.hpp"
 
+#include "../../libs/imgui/imgui_utils.hpp"
+#include "../../libs/imgui/imgui_curve.h"
+
+#include <array>
+#include <algorithm>
 #include <glm/common.hpp>
 #include <fmt/format.h>
 
@@ -19,21 +24,36 @@ namespace sc::bezier::ui {
 }
 
 // Function to calculate bezier curve points given a set of input points, a power value, and an optional callback function
-glm::dvec2 sc::bezier::calculate(std::vector<glm::dvec2> inputs, double power, std::optional<std::function<void(const std::vector<glm::dvec2> &level)>> callback) {
+glm::dvec2 sc::bezier::calculate(const std::vector<glm::dvec2> &inputs, double power, std::optional<std::function<void(const std::vector<glm::dvec2> &level)>> callback) {
+    // Without a callback, curves of up to max_stack_points are reduced in place on the stack, so evaluating a curve doesn't allocate
+    constexpr size_t max_stack_points = 16;
+    if (!callback && inputs.size() <= max_stack_points) {
+        std::array<glm::dvec2, max_stack_points> level { };
+        std::copy(inputs.begin(), inputs.end(), level.begin());
+        // Interpolate between each pair of points until only one is left
+        for (auto num_points = inputs.size(); num_points > 1; num_points--) {
+            for (size_t i = 0; i + 1 < num_points; i++) level[i] = glm::mix(level[i], level[i + 1], power);
+        }
+        return level[0];
+    }
+    auto level = inputs;
     for (;;) {
         // Interpolate between each pair of points
-        for (int i = 0; i < inputs.size() - 1; i++) inputs[i] = glm::mix(inputs[i], inputs[i + 1], power);
-        // Reduce the size of inputs by one
-        inputs.resize(inputs.size() - 1);
+        for (int i = 0; i < level.size() - 1; i++) level[i] = glm::mix(level[i], level[i + 1], power);
+        // Reduce the size of the level by one
+        level.resize(level.size() - 1);
         // If there's only one point left, return it
-        if (inputs.size() == 1) return inputs.front();
-        // If there's a callback function, call it with the current set of inputs
-        if (callback) (*callback)(inputs);
+        if (level.size() == 1) return level.front();
+        // If there's a callback function, call it with the current set of points
+        if (callback) (*callback)(level);
     }
 }
 
 // Function to plot a cubic bezier curve
-void sc::bezier::ui::plot_cubic(std::vector<glm::dvec2> inputs, const glm::ivec2 &size, std::optional<double> fraction, std::optional<double> limit_min, std::optional<double> limit_max, std::optional<double> fraction_h) {
+void sc::bezier::ui::plot_cubic(const std::vector<glm::dvec2> &points, const glm::ivec2 &size, std::optional<double> fraction, std::optional<double> limit_min, std::optional<double> limit_max, std::optional<double> fraction_h) {
+    // Scratch buffers reused between frames, so plotting doesn't allocate; only called from the UI thread
+    static std::vector<glm::dvec2> inputs, screen_p;
+    inputs.assign(points.begin(), points.end());
     // If there's a minimum limit, adjust the y-coordinates of the inputs accordingly
     if (limit_min) for (auto &p : inputs) p.y += *limit_min * (1.0 - p.y);
     // Get the draw list from ImGui
@@ -60,27 +80,38 @@ void sc::bezier::ui::plot_cubic(std::vector<glm::dvec2> inputs, const glm::ivec2
     bez_area_size.y -= 24;
 
     // Convert input coordinates to screen coordinates
-    auto screen_p = inputs;
+    screen_p.assign(inputs.begin(), inputs.end());
     for (auto &sp : screen_p) sp = coords_to_screen(sp, IM_GLMD2(bez_area_min), bez_area_size);
 
     // Draw lines between each pair of input points
     for (int i = 1; i < inputs.size(); i++) draw_list->AddLine(GLMD_IM2(screen_p[i - 1]), GLMD_IM2(screen_p[i]), IM_COL32(128, 255, 128, 32), 2.f);
 
-    // Set the number of curve segments
-    const int num_curve_segments = 30;
-    // Calculate the first plot point
-    auto last_plot = GLMD_IM2(coords_to_screen(inputs[0], IM_GLMD2(bez_area_min), bez_area_size));
-
-    // Draw the bezier curve
-    for (int i = 1; i < num_curve_segments; i++) {
-        const double power = (1.0 / static_cast<double>(num_curve_segments)) * static_cast<double>(i);
-        const auto here = GLMD_IM2(coords_to_screen(calculate(inputs, power), IM_GLMD2(bez_area_min), bez_area_size));
-        draw_list->AddCircleFilled(last_plot, 1.f, IM_COL32(255, 165, 0, 255));
-        draw_list->AddLine(last_plot, here, IM_COL32(255, 165, 0, 255), 2.f);
-        last_plot = here;
+    // Let the GPU draw the curve, and shade the output the limits cut off; the control points are only converted to polynomial coefficients
+    std::array<ImVec2, ImCurve::MaxCoefficients> curve_points;
+    ImCurve curve;
+    if (!ImCurve::Failed() && inputs.size() <= curve_points.size()) {
+        for (size_t i = 0; i < inputs.size(); i++) curve_points[i] = { static_cast<float>(inputs[i].x), static_cast<float>(inputs[i].y) };
+        curve.SetBezier(curve_points.data(), static_cast<int>(inputs.size()));
+        curve.Min = bez_area_min;
+        curve.Max = { bez_area_min.x + bez_area_size.x, bez_area_min.y + bez_area_size.y };
+        curve.Color = IM_COL32(255, 165, 0, 255);
+        curve.ShadeColor = IM_COL32(150, 42, 42, 64);
+        curve.ShadeBelow = static_cast<float>(limit_min.value_or(0.0));
+        curve.ShadeAbove = static_cast<float>(limit_max.value_or(1.0));
+        ImCurve::Add(draw_list, curve);
+    } else {
+        // Without the shader, approximate the curve with line segments
+        const int num_curve_segments = 30;
+        auto last_plot = GLMD_IM2(coords_to_screen(inputs[0], IM_GLMD2(bez_area_min), bez_area_size));
+        for (int i = 1; i < num_curve_segments; i++) {
+            const double power = (1.0 / static_cast<double>(num_curve_segments)) * static_cast<double>(i);
+            const auto here = GLMD_IM2(coords_to_screen(calculate(inputs, power), IM_GLMD2(bez_area_min), bez_area_size));
+            draw_list->AddCircleFilled(last_plot, 1.f, IM_COL32(255, 165, 0, 255));
+            draw_list->AddLine(last_plot, here, IM_COL32(255, 165, 0, 255), 2.f);
+            last_plot = here;
+        }
+        draw_list->AddLine(last_plot, GLMD_IM2(coords_to_screen(inputs.back(), IM_GLMD2(bez_area_min), bez_area_size)), IM_COL32(255, 165, 0, 255), 2.f);
     }
-    // Draw the last line segment
-    draw_list->AddLine(last_plot, GLMD_IM2(coords_to_screen(inputs.back(), IM_GLMD2(bez_area_min), bez_area_size)), IM_COL32(255, 165, 0, 255), 2.f);
 
     // If there's a vertical fraction, draw a line at that fraction of the height
     if (fraction.has_value()) {
@@ -104,7 +135,7 @@ void sc::bezier::ui::plot_cubic(std::vector<glm::dvec2> inputs, const glm::ivec2
         ImGui::SetCursorScreenPos(GLMD_IM2(screen_p[i] - 3.0));
         if (!hovering_point_i && ImGui::IsMouseHoveringRect(GLMD_IM2(screen_p[i] - 3.0), GLMD_IM2(screen_p[i] + 3.0))) {
             ImGui::BeginTooltip();
-            ImGui::Text(fmt::format("#{}: x{}, y{}", i + 1, inputs[i].x, inputs[i].y).data());
+            ImGui::Text(ImFormat("#{}: x{}, y{}", i + 1, inputs[i].x, inputs[i].y));
             ImGui::EndTooltip();
             draw_list->AddRect(GLMD_IM2(screen_p[i] - 6.0), GLMD_IM2(screen_p[i] + 7.0), color, ImGui::GetStyle().FrameRounding, 0, 2);
             hovering_point_i = i;
@@ -116,7 +147,7 @@ void sc::bezier::ui::plot_cubic(std::vector<glm::dvec2> inputs, const glm::ivec2
         const auto top_left = GLMD_IM2(coords_to_screen({ 0, *limit_max }, IM_GLMD2(bez_area_min), bez_area_size));
         const auto top_right = GLMD_IM2(coords_to_screen({ 0.2, *limit_max }, IM_GLMD2(bez_area_min), bez_area_size));
         draw_list->AddLine(top_left, top_right, IM_COL32(255, 255, 255, 200), 2.f);
-        draw_list->AddText({ top_left.x, top_left.y + 2 }, IM_COL32(255, 255, 255, 128), fmt::format("{}%", static_cast<int>(glm::round(*limit_max * 100.0))).data());
+        draw_list->AddText({ top_left.x, top_left.y + 2 }, IM_COL32(255, 255, 255, 128), ImFormat("{}%", static_cast<int>(glm::round(*limit_max * 100.0))));
     }
 
     // If there's a minimum limit, draw a line at that limit and display a label showing the limit as a percentage
@@ -124,9 +155,9 @@ void sc::bezier::ui::plot_cubic(std::vector<glm::dvec2> inputs, const glm::ivec2
         const auto bottom_right = GLMD_IM2(coords_to_screen({ 1, *limit_min }, IM_GLMD2(bez_area_min), bez_area_size));
         const auto bottom_left = GLMD_IM2(coords_to_screen({ 0, *limit_min }, IM_GLMD2(bez_area_min), bez_area_size));
         draw_list->AddLine(bottom_left, bottom_right, IM_COL32(255, 255, 255, 200), 2.f);
-        const auto text = fmt::format("{}%", static_cast<int>(glm::round(*limit_min * 100.0)));
-        const auto text_dim = ImGui::CalcTextSize(text.data());
-        draw_list->AddText({ bottom_right.x - text_dim.x, bottom_right.y - text_dim.y - 2 }, IM_COL32(255, 255, 255, 128), text.data());
+        const auto text = ImFormat("{}%", static_cast<int>(glm::round(*limit_min * 100.0)));
+        const auto text_dim = ImGui::CalcTextSize(text);
+        draw_list->AddText({ bottom_right.x - text_dim.x, bottom_right.y - text_dim.y - 2 }, IM_COL32(255, 255, 255, 128), text);
     }
 
     // Reset the bezier area dimensions to remove padding
@@ -13,6 +13,12 @@
 #include <spdlog/fmt/bin_to_hex.h>
 // This includes the spdlog/fmt/bin_to_hex.h header file, which provides spdlog's binary to hexadecimal formatting functions.
 
+#include <cstring>
+// This includes the cstring header file, which provides strnlen.
+
+#include "../../libs/recorder/recorder.h"
+// This includes the recorder.h header file, which provides the background session recorder.
+
 std::optional<std::string> sc::visor::device_context::update(std::shared_ptr<device_context> context) {
     // This function updates the state of a device_context. It returns an optional string error message.
 
@@ -22,6 +28,9 @@ std::optional<std::string> sc::visor::device_context::update(std::shared_ptr<dev
     std::lock_guard guard(context->mutex);
     // Lock the device_context's mutex to prevent other threads from modifying it during this update.
 
+    if (context->switching_profile) return std::nullopt;
+    // If a profile switch is talking to the device, skip this update; checked under the mutex, so a switch that starts later waits for this update to finish.
+
     {
         const auto now = std::chrono::high_resolution_clock::now();
         // Get the current time.
@@ -69,8 +78,7 @@ std::optional<std::string> sc::visor::device_context::update(std::shared_ptr<dev
 
             context->axes_ex[axis_i].range_min = res->min;
             context->axes_ex[axis_i].range_max = res->max;
-            context->axes_ex```c++
-[axis_i].deadzone = res->deadzone;
+            context->axes_ex[axis_i].deadzone = res->deadzone;
             context->axes_ex[axis_i].limit = res->limit;
             context->axes_ex[axis_i].model_edit_i = res->curve_i;
             // ...update the axis_ex's extended attributes.
@@ -80,6 +88,28 @@ std::optional<std::string> sc::visor::device_context::update(std::shared_ptr<dev
         // Update the axis's state.
     }
 
+    {
+        // Extend the axis histories the UI plots.
+
+        const auto now_us = recorder::now_us();
+        for (int axis_i = 0; axis_i < glm::min(context->axes.size(), context->traces.size()); axis_i++) {
+            context->traces[axis_i].push(now_us, context->axes[axis_i].input_fraction, context->axes[axis_i].output_fraction);
+        }
+    }
+
+    if (recorder::recording()) {
+        // If a recording is in progress, queue the device's input and output fractions without waiting on the writer.
+
+        recorder::sample value;
+        value.timestamp_us = recorder::now_us();
+        value.source = recorder::source::pedals_mk4;
+        for (int axis_i = 0; axis_i < glm::min(context->axes.size(), value.input.size()); axis_i++) {
+            value.input[axis_i] = context->axes[axis_i].input_fraction;
+            value.output[axis_i] = context->axes[axis_i].output_fraction;
+        }
+        recorder::push(value);
+    }
+
     if (!context->initial_communication_complete) {
         // If the device_context has not yet completed its initial communication...
 
@@ -92,7 +122,7 @@ std::optional<std::string> sc::visor::device_context::update(std::shared_ptr<dev
             if (!label_res.has_value()) return label_res.error();
             // ...and if the label is not available, return the error message.
 
-            if (strnlen_s(label_res->data(), 50) > 0) {
+            if (strnlen(label_res->data(), 50) > 0) {
                 // If the label is not empty...
 
                 context->models[model_i].label = label_res->data();
@@ -5,6 +5,9 @@
 #include "../../libs/firmware/mk4.h"
 // This includes the mk4.h header file, which probably contains the definition of the firmware::mk4::device_handle structure.
 
+#include "pedal_trace.h"
+// This includes the pedal_trace.h header file, which provides the ring buffer behind the axis history plots.
+
 #include <array>
 // This includes the array header file, which provides the std::array template class that encapsulates fixed-size arrays.
 
@@ -90,6 +93,10 @@ namespace sc::visor {
         std::vector<axis_info_ex> axes_ex;
         // This is a vector of extended axis information for the device, as defined in axis_info_ex structure.
 
+        std::array<pedal_trace, 3> traces;
+        // This is the input and output history of the throttle, brake and clutch axes, written by update() and plotted by the UI.
+        // It is a fixed array rather than a vector sized like "axes", so the UI can read it without taking the mutex.
+
         std::future<std::optional<std::string>> update_future;
         // This is a future that holds the result of an asynchronous operation that returns an optional string. 
         // This could be used to track the progress of an update operation on the device context.
@@ -97,6 +104,10 @@ namespace sc::visor {
         std::atomic_bool initial_communication_complete = false;
         // This is an atomic boolean that indicates whether the initial communication with the device has been completed.
 
+        std::atomic_bool switching_profile = false;
+        // This is set while a profile switch is writing to the device without holding the mutex.
+        // update() and the device's controls leave the device alone until it is cleared.
+
         static std::optional<std::string> update(std::shared_ptr<device_context> context);
         // This is a declaration of a static function named 'update' that takes a shared pointer to a device context and returns an optional string.
         // The optional string return value suggests that the function may return a string (possibly an error message or status information) or no value.
@@ -0,0 +1,150 @@
+// Include the gui-coaching.h header file, which contains the declarations of the methods being defined here.
+#include "gui-coaching.h"
+
+#include <imgui.h>
+#include <spdlog/spdlog.h>
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <array>
+
+#include "../../libs/font/imgui.h"
+#include "../../libs/imgui/imgui_utils.hpp"
+#include "../../libs/file/file.h"
+#include "../../libs/iracing/iracing.h"
+#include "../../libs/iracing/analytics.h"
+
+#include "device_context.h"
+#include "legacy.h"
+
+namespace sc::visor::gui::coaching {
+
+    static sc::iracing::trace_analytics analytics;
+    // The analytics keep a fixed number of laps; nothing here grows with session length.
+
+    static std::optional<sc::iracing::telemetry_bus::cursor> cursor;
+    // Our own read position on the telemetry bus.
+
+    static std::optional<std::string> segments_track;
+    // The track the segment table was chosen for; session-info updates for the same track keep the laps.
+
+    static std::array<const pedal_trace *, 2> pedal_traces = { nullptr, nullptr };
+    static std::array<uint64_t, 2> pedal_cursors = { 0, 0 };
+    // The throttle and brake output histories the analytics read, and our read positions in them.
+
+    static constexpr int64_t max_pedal_age_us = 100000;
+    // A pedal sample older than this before a frame doesn't describe it, e.g. once the pedals stopped reporting.
+
+    static int selected_lap_age = 1;
+    // Which lap is shown: 0 is the lap in progress, 1 the previous one, and so on.
+
+    static void load_segments(const sc::iracing::session_info &info) {
+        // This loads the corner table of the current track from "corners.json", falling back to equal segments.
+
+        std::vector<sc::iracing::segment> table;
+        if (const auto load_res = file::load("corners.json"); load_res.has_value()) {
+            const auto doc = nlohmann::json::parse(*load_res, nullptr, false);
+            if (const auto track = doc.is_object() ? doc.find(info.track_name) : doc.end(); !doc.is_discarded() && doc.is_object() && track != doc.end() && track->is_array()) {
+                for (const auto &corner : *track) {
+                    sc::iracing::segment entry;
+                    entry.start = corner.value("start", 0.f);
+                    entry.end = corner.value("end", 0.f);
+                    corner.value("name", std::string()).copy(entry.name.data(), entry.name.size() - 1);
+                    if (entry.end > entry.start) table.push_back(entry);
+                }
+            }
+        }
+        if (table.size()) analytics.set_segments(table);
+        else analytics.set_uniform_segments(12);
+        spdlog::debug("Coaching uses {} segments for {}.", analytics.num_segments, info.track_name);
+    }
+}
+
+void sc::visor::gui::coaching::update(const std::vector<std::shared_ptr<device_context>> &contexts) {
+    std::array<const pedal_trace *, 2> traces = { nullptr, nullptr };
+    if (const auto mk4 = std::find_if(contexts.begin(), contexts.end(), [](const std::shared_ptr<device_context> &context) { return context->handle && context->initial_communication_complete; }); mk4 != contexts.end()) {
+        traces = { &(*mk4)->traces[0], &(*mk4)->traces[1] };
+    } else if (legacy::axis_i_throttle && legacy::axis_i_brake) {
+        traces = { &legacy::traces[*legacy::axis_i_throttle], &legacy::traces[*legacy::axis_i_brake] };
+    }
+    if (traces != pedal_traces) {
+        pedal_traces = traces;
+        pedal_cursors = { 0, 0 };
+    }
+    // The traces are written by the device threads and read here without locks; see pedal_trace.
+
+    if (const auto info = sc::iracing::session(); info && segments_track != info->track_name) {
+        load_segments(*info);
+        segments_track = info->track_name;
+    }
+
+    if (!cursor) cursor = sc::iracing::telemetry().subscribe();
+    while (const auto current = sc::iracing::telemetry().read(*cursor)) {
+        std::array<float, 2> pedals = { current->throttle, current->brake };
+        for (size_t i = 0; i < pedals.size(); i++) {
+            if (!pedal_traces[i]) continue;
+            if (const auto output = pedal_traces[i]->output_at(current->timestamp_us, max_pedal_age_us, pedal_cursors[i]); output) pedals[i] = *output;
+        }
+        analytics.push(*current, pedals[0], pedals[1]);
+    }
+    // Only frames published since the last call are processed; each one, and each pedal lookup, costs the same regardless of history.
+}
+
+void sc::visor::gui::coaching::emit_content() {
+    const auto target = analytics.lap(selected_lap_age);
+    const auto lap_label = [](const sc::iracing::trace_analytics::lap_metrics *lap, int age) -> const char * {
+        if (!lap) return "No lap";
+        if (!age) return ImFormat("Lap {} (in progress)", lap->number + 1);
+        return ImFormat("Lap {} ({:.2f}s{})", lap->number + 1, lap->lap_time, lap->complete ? "" : ", incomplete");
+    };
+
+    if (ImGui::BeginCombo("##CoachingLap", lap_label(target, selected_lap_age))) {
+        for (int age = 0; age < static_cast<int>(sc::iracing::trace_analytics::max_laps); age++) {
+            const auto lap = analytics.lap(age);
+            if (!lap) break;
+            if (ImGui::Selectable(lap_label(lap, age), age == selected_lap_age)) selected_lap_age = age;
+        }
+        ImGui::EndCombo();
+    }
+
+    if (!target) {
+        ImGui::TextDisabled("Drive a lap to see braking metrics.");
+        return;
+    }
+
+    if (ImGui::BeginTable("CoachingCorners", 8, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY)) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Corner");
+        ImGui::TableSetupColumn("Peak Brake");
+        ImGui::TableSetupColumn("Time to Peak");
+        ImGui::TableSetupColumn("Release");
+        ImGui::TableSetupColumn("Overlap");
+        ImGui::TableSetupColumn("Coasting");
+        ImGui::TableSetupColumn("Entry");
+        ImGui::TableSetupColumn("Minimum");
+        ImGui::TableHeadersRow();
+        for (size_t i = 0; i < analytics.num_segments; i++) {
+            const auto &corner = target->corners[i];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(analytics.segments[i].name.data());
+            if (!corner.visited) continue;
+            ImGui::TableNextColumn();
+            if (corner.braked) ImGui::TextUnformatted(ImFormat("{:.0f}%", corner.peak_brake * 100.f));
+            else ImGui::TextDisabled("--");
+            ImGui::TableNextColumn();
+            if (corner.braked) ImGui::TextUnformatted(ImFormat("{:.2f}s", corner.time_to_peak));
+            ImGui::TableNextColumn();
+            if (corner.braked && corner.release_slope > 0) ImGui::TextUnformatted(ImFormat("{:.0f}%/s", corner.release_slope * 100.f));
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(ImFormat("{:.2f}s", corner.overlap));
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(ImFormat("{:.2f}s", corner.coasting));
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(ImFormat("{:.0f}", corner.entry_speed));
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(ImFormat("{:.0f}", corner.min_speed));
+        }
+        ImGui::EndTable();
+    }
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+namespace sc::visor {
+
+    struct device_context;
+}
+
+namespace sc::visor::gui::coaching {
+
+    // Feed new telemetry frames into the corner analytics, with the pedal output of the first connected MK4 or else the
+    // virtual pedals, and the sim's own pedals where there is neither
+    void update(const std::vector<std::shared_ptr<device_context>> &contexts);
+
+    // Render the per-corner braking metrics
+    void emit_content();
+
+}  // namespace sc::visor::gui::coaching
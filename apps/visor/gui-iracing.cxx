@@ -13,26 +13,270 @@
 // Include a custom imgui.h header file, which likely contains some customizations or additions for using fonts with ImGui.
 #include "../../libs/font/imgui.h"
 
+// Include the imgui_utils.hpp header file, which provides the per-frame label formatting helpers.
+#include "../../libs/imgui/imgui_utils.hpp"
+
 // Include the iracing.h header file, which likely contains declarations for interacting with the iRacing API.
 #include "../../libs/iracing/iracing.h"
 
+// Include the recorder.h header file, which contains the session recorder and replay player.
+#include "../../libs/recorder/recorder.h"
+
+// Include the wakeup.h header file, so the end of a replay is handled without waiting for input.
+#include "../../libs/boot/wakeup.h"
+
+// Include the legacy.h header file, so replays can drive the legacy pedal pipeline.
+#include "legacy.h"
+
+// Include the profiles.h header file, which contains the car/track profile rules.
+#include "profiles.h"
+
+// Include the gui-coaching.h header file, which renders the per-corner braking metrics.
+#include "gui-coaching.h"
+
+#include <filesystem>
+#include <ctime>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace sc::visor::gui::iracing {
+
+    static const std::filesystem::path recordings_directory = "recordings";
+    // Recordings are written next to the settings files.
+
+    static bool replaying = false, resume_telemetry = false;
+    // Whether a replay was started from this tab, and whether the live telemetry worker has to be restarted afterwards.
+
+    static std::optional<std::string> recorder_error;
+    // The last error reported by the recorder or the player.
+
+    static std::optional<std::filesystem::path> latest_recording() {
+        // This finds the most recently written recording, if any.
+
+        std::optional<std::filesystem::path> latest;
+        std::error_code ec;
+        for (const auto &entry : std::filesystem::directory_iterator(recordings_directory, ec)) {
+            if (entry.path().extension() != ".screc") continue;
+            if (!latest || std::filesystem::last_write_time(entry.path(), ec) > std::filesystem::last_write_time(*latest, ec)) latest = entry.path();
+        }
+        return latest;
+    }
+
+    static void start_recording() {
+        std::error_code ec;
+        std::filesystem::create_directories(recordings_directory, ec);
+        const auto now = std::time(nullptr);
+        char name[32];
+        std::strftime(name, sizeof(name), "%Y%m%d-%H%M%S.screc", std::localtime(&now));
+        recorder_error = sc::recorder::start(recordings_directory / name, &sc::iracing::telemetry());
+    }
+
+    static void start_replay(const std::filesystem::path &path) {
+        resume_telemetry = sc::iracing::get_status() != sc::iracing::status::stopped;
+        sc::iracing::shutdown();
+        // The player becomes the only producer of telemetry frames while it runs.
+
+        recorder_error = sc::recorder::player::start(path, [](const sc::recorder::sample &value) {
+            if (value.source & sc::recorder::source::telemetry) {
+                sc::iracing::frame current;
+                current.tick = value.tick;
+                current.timestamp_us = sc::recorder::now_us();
+                current.gear = static_cast<int32_t>(value.gear);
+                current.lap_percent = value.lap_percent;
+                current.speed = value.speed;
+                current.rpm = value.rpm;
+                current.throttle = value.throttle;
+                current.brake = value.brake;
+                current.clutch = value.clutch;
+                sc::iracing::replay(current);
+            }
+            if (value.source & sc::recorder::source::pedals_legacy) legacy::replay(value.input);
+            // MK4 rows are shown in the recording but can't be pushed back into the device.
+        }, 1.f, 0, []() {
+            legacy::replay(std::nullopt);
+            sc::boot::wakeup();
+            // The hardware takes over the pedals right away; update() restarts the live telemetry on the main thread.
+        });
+        replaying = !recorder_error;
+        if (!replaying && resume_telemetry) sc::iracing::startup();
+    }
+
+    static void finish_replay() {
+        sc::recorder::player::stop();
+        legacy::replay(std::nullopt);
+        if (resume_telemetry) sc::iracing::startup();
+        replaying = resume_telemetry = false;
+    }
+
+    static void emit_recorder() {
+        if (sc::recorder::recording()) {
+            if (ImGui::Button(IM_LABEL("{} Stop Recording", ICON_FA_STOP))) sc::recorder::stop();
+            ImGui::SameLine();
+            ImGui::TextDisabled(ImFormat("Dropped: {}", sc::recorder::dropped()));
+        } else if (replaying) {
+            if (ImGui::Button(IM_LABEL("{} Stop Replay", ICON_FA_STOP))) finish_replay();
+        } else {
+            if (ImGui::Button(IM_LABEL("{} Record", ICON_FA_CIRCLE))) start_recording();
+            if (const auto latest = latest_recording(); latest) {
+                ImGui::SameLine();
+                if (ImGui::Button(ImFormat("{} Replay {}", ICON_FA_PLAY, latest->filename().string()))) start_replay(*latest);
+            }
+        }
+
+        if (recorder_error) ImGui::TextColored({ 1.f, 0.f, 0.f, 1.f }, "%s", recorder_error->data());
+    }
+
+    static std::optional<std::string> profiles_error;
+    // The last error reported while loading or saving profile rules.
+
+    static void emit_profiles() {
+        if (const auto info = sc::iracing::session(); info) {
+            const auto player = info->player();
+            ImGui::TextUnformatted(ImFormat("Car: {}", player ? player->car_screen_name : "Unknown"));
+            ImGui::TextUnformatted(ImFormat("Track: {}", info->track_display_name));
+        } else ImGui::TextDisabled("No iRacing session.");
+
+        ImGui::TextUnformatted(ImFormat("Active profile: {}", profiles::active().value_or("None")));
+
+        // Rules are synced with the account in the background; this only reads the last known state.
+        if (const auto sync = profiles::sync_status(); !sync.signed_in) ImGui::TextDisabled("Cloud sync: sign in to sync rules between rigs.");
+        else if (sync.error) ImGui::TextDisabled("%s", ImFormat("Cloud sync: {} ({} rule(s) waiting)", *sync.error, sync.pending));
+        else if (sync.pending) ImGui::TextDisabled(ImFormat("Cloud sync: {} rule(s) waiting", sync.pending));
+        else ImGui::TextDisabled("Cloud sync: up to date");
+
+        if (ImGui::Button(IM_LABEL("{} Save Virtual Pedals for this Car & Track", ICON_FA_SAVE))) profiles_error = profiles::capture_legacy();
+        ImGui::SameLine();
+        if (ImGui::Button(IM_LABEL("{} Reload Rules", ICON_FA_SYNC))) profiles_error = profiles::load();
+        ImGui::SameLine();
+        if (ImGui::Button(IM_LABEL("{} Import profiles.json", ICON_FA_FILE_IMPORT))) profiles_error = profiles::import_json("profiles.json");
+        ImGui::SameLine();
+        if (ImGui::Button(IM_LABEL("{} Export profiles.json", ICON_FA_FILE_EXPORT))) profiles_error = profiles::export_json("profiles.json");
+
+        if (profiles_error) ImGui::TextColored({ 1.f, 0.f, 0.f, 1.f }, "%s", profiles_error->data());
+
+        if (ImGui::BeginChild("ProfileRules", { 0, 0 }, true)) {
+            // This lists every rule; the most specific matching rule wins.
+
+            for (const auto &rule : profiles::rules()) {
+                ImGui::TextUnformatted(rule.name.data());
+                ImGui::SameLine();
+                ImGui::TextDisabled("%s", ImFormat("car: {}, track: {}{}{}", rule.car.value_or("any"), rule.track.value_or("any"), rule.legacy ? ", virtual" : "", rule.mk4 ? ", MK4" : ""));
+            }
+
+            ImGui::EndChild();
+        }
+    }
+}
+
+static void emit_variables() {
+    // This displays the telemetry variables of the current snapshot, filtered by the search box.
+    // Only the rows that are visible are emitted, and only their values are read from the latest tick.
+
+    static std::array<char, 64> query_buffer = { 0 };
+    static std::string query;
+    static std::vector<size_t> matches;
+    static uint64_t matches_version = 0;
+    static std::vector<size_t> visible;
+    static std::vector<double> values;
+    // These persist between frames: the search result is only recomputed when the query or the snapshot changes.
+
+    const auto snapshot = sc::iracing::variables();
+    // This takes the current variable list; it stays the same object until iRacing's variable headers change.
+
+    ImGui::SetNextItemWidth(-1);
+    ImGui::InputTextWithHint("##TelemetryVariableSearch", IM_LABEL("{} Search variables", ICON_FA_SEARCH), query_buffer.data(), query_buffer.size());
+    // This displays the search box, which matches names, descriptions and units.
+
+    if (!snapshot) {
+        ImGui::TextDisabled("No variables yet; they are listed once iRacing is connected.");
+        return;
+    }
+
+    std::string current = query_buffer.data();
+    std::transform(current.begin(), current.end(), current.begin(), [](const char &c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+    // This lower-cases the query like the prebuilt search keys.
+
+    if (snapshot->version != matches_version || current != query) {
+        const auto refine = snapshot->version == matches_version && current.find(query) != std::string::npos;
+        // A query that contains the previous one can only match a subset of its matches, so typing only rescans those.
+
+        snapshot->search(current, matches, refine);
+        query = std::move(current);
+        matches_version = snapshot->version;
+    }
+
+    ImGui::TextDisabled(ImFormat("{} of {} variables", matches.size(), snapshot->variables.size()));
+
+    if (ImGui::BeginTable("TelemetryVariables", 4, ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_Resizable)) {
+        // This starts a scrolling table that fills the remaining space.
+
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Name");
+        ImGui::TableSetupColumn("Value");
+        ImGui::TableSetupColumn("Unit");
+        ImGui::TableSetupColumn("Type");
+        ImGui::TableHeadersRow();
+
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(matches.size()));
+        while (clipper.Step()) {
+            // The clipper hands out the range of rows that is visible.
+
+            visible.assign(matches.begin() + clipper.DisplayStart, matches.begin() + clipper.DisplayEnd);
+            sc::iracing::read_values(*snapshot, visible, values);
+            // This reads the live values of the visible rows only.
+
+            for (size_t row_i = 0; row_i < visible.size(); row_i++) {
+                const auto &variable = snapshot->variables[visible[row_i]];
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(variable.name.data(), variable.name.data() + variable.name.size());
+                if (!variable.description.empty() && ImGui::IsItemHovered()) ImGui::SetTooltip("%s", variable.description.data());
+                ImGui::TableNextColumn();
+                if (std::isnan(values[row_i])) ImGui::TextDisabled("--");
+                else if (variable.type == sc::iracing::variable_type::float32 || variable.type == sc::iracing::variable_type::float64) ImGui::Text(ImFormat("{:.3f}", values[row_i]));
+                else if (variable.type == sc::iracing::variable_type::bit_field) ImGui::Text(ImFormat("0x{:08X}", static_cast<uint32_t>(values[row_i])));
+                else ImGui::Text(ImFormat("{}", static_cast<int64_t>(values[row_i])));
+                ImGui::TableNextColumn();
+                ImGui::TextDisabled("%s", variable.unit.data());
+                ImGui::TableNextColumn();
+                if (variable.count > 1) ImGui::TextDisabled(ImFormat("{}[{}]", magic_enum::enum_name(variable.type), variable.count));
+                else ImGui::TextDisabled(ImFormat("{}", magic_enum::enum_name(variable.type)));
+            }
+        }
+
+        ImGui::EndTable();
+    }
+}
+
 void sc::visor::gui::iracing::startup() {
     sc::iracing::startup();
     // Additional GUI-specific startup tasks could go here
 }
 
 void sc::visor::gui::iracing::shutdown() {
+    sc::recorder::stop();
+    if (replaying) finish_replay();
     sc::iracing::shutdown();
     // Additional GUI-specific shutdown tasks could go here
 }
 
+void sc::visor::gui::iracing::update() {
+    if (replaying && !sc::recorder::player::playing()) finish_replay();
+    // Once the player runs out of samples, the hardware and the live telemetry take over again, whichever tab is shown.
+}
+
 void sc::visor::gui::iracing::emit_content() {
     // This method named 'emit_content' is likely used to draw or update the ImGui interface.
 
     if (ImGui::BeginTabBar("iRacingTabBar")) {
         // This starts a new tab bar with the identifier "iRacingTabBar".
 
-        if (ImGui::BeginTabItem(fmt::format("{} Telemetry", ICON_FA_SIGNAL_STREAM).data())) {
+        if (ImGui::BeginTabItem(IM_LABEL("{} Telemetry", ICON_FA_SIGNAL_STREAM))) {
             // This starts a new tab item with the title "Telemetry". The icon is set using a font awesome icon.
 
             switch (sc::iracing::get_status()) {
@@ -40,63 +284,75 @@ void sc::visor::gui::iracing::emit_content() {
 
                 case sc::iracing::status::connected:
                     // If the status is 'connected', then it shows a green "Connected" text.
-                    ImGui::TextColored({ 0.f, 1.f, 0.f, 1.f }, fmt::format("{} Connected", ICON_FA_CHECK).data());
+                    ImGui::TextColored({ 0.f, 1.f, 0.f, 1.f }, IM_LABEL("{} Connected", ICON_FA_CHECK));
                     break;
 
                 case sc::iracing::status::live:
                     // If the status is 'live', then it shows a green "Live" text.
-                    ImGui::TextColored({ 0.f, 1.f, 0.f, 1.f }, fmt::format("{} Live", ICON_FA_CHECK_DOUBLE).data());
+                    ImGui::TextColored({ 0.f, 1.f, 0.f, 1.f }, IM_LABEL("{} Live", ICON_FA_CHECK_DOUBLE));
                     break;
 
                 case sc::iracing::status::searching:
                     // If the status is 'searching', then it shows a gray "Searching" text.
-                    ImGui::TextDisabled(fmt::format("{} Searching", ICON_FA_SEARCH).data());
+                    ImGui::TextDisabled(IM_LABEL("{} Searching", ICON_FA_SEARCH));
                     break;
 
                 case sc::iracing::status::stopped:
                     // If the status is 'stopped', then it shows a gray "Paused" text.
-                    ImGui::TextDisabled(fmt::format("{} Paused", ICON_FA_PAUSE).data());
+                    ImGui::TextDisabled(IM_LABEL("{} Paused", ICON_FA_PAUSE));
                     break;
             }
 
-            ImGui::ProgressBar(sc::iracing::lap_percent());
+            const auto current = sc::iracing::latest().value_or(sc::iracing::frame { });
+            // This takes a single frame so every value below comes from the same iRacing tick.
+
+            ImGui::ProgressBar(current.lap_percent);
             // This displays a progress bar with the current lap percentage.
 
-            ImGui::Text(fmt::format("Lap: {}%", sc::iracing::lap_percent()).data());
+            ImGui::Text(ImFormat("Lap: {}%", current.lap_percent));
             // This displays the current lap percentage as text.
 
-            ImGui::Text(fmt::format("RPM: {}", sc::iracing::rpm()).data());
+            ImGui::Text(ImFormat("RPM: {}", current.rpm));
             // This displays the current RPM (Revolutions per Minute) as text.
 
-            ImGui::Text(fmt::format("Speed: {}", sc::iracing::speed()).data());
+            ImGui::Text(ImFormat("Speed: {}", current.speed));
             // This displays the current speed as text.
 
-            ImGui::Text(fmt::format("Gear: {}", sc::iracing::gear()).data());
+            ImGui::Text(ImFormat("Gear: {}", current.gear));
             // This displays the current gear as text.
 
-            if (ImGui::BeginChild("TelemetryVariables", { 0, 0 }, true)) {
-                // This starts a new child window with the identifier "TelemetryVariables".
-                // The window's size is {0, 0} which means it uses the available space.
+            ImGui::TextDisabled(ImFormat("Tick: {}", current.tick));
+            // This displays the iRacing tick the values above were read from.
 
-                for (auto &var : sc::iracing::variables()) {
-                    // This loops through all the variables provided by the iRacing API.
+            emit_variables();
+            // This displays the searchable list of every telemetry variable.
 
-                    ImGui::Text(var.first.data());
-                    // This displays the name of the variable as text.
+            ImGui::EndTabItem();
+            // This ends the tab item.
+        }
 
-                    ImGui::SameLine();
-                    // This makes the next ImGui command appear on the same line as the previous one.
+        if (ImGui::BeginTabItem(IM_LABEL("{} Coaching", ICON_FA_CHALKBOARD_TEACHER))) {
+            // This starts a tab item with the braking metrics of every corner.
 
-                    ImGui::TextDisabled(fmt::format("Type: {}", var.second).data());
-                    // This displays the type of the variable as disabled (gray) text.
-                }
+            coaching::emit_content();
 
-                ImGui::EndChild();
-                // This ends the child window.
-            }
+            ImGui::EndTabItem();
+        }
+
+        if (ImGui::BeginTabItem(IM_LABEL("{} Recorder", ICON_FA_CIRCLE))) {
+            // This starts a tab item for recording sessions and replaying them.
+
+            emit_recorder();
+
+            ImGui::EndTabItem();
+        }
+
+        if (ImGui::BeginTabItem(IM_LABEL("{} Profiles", ICON_FA_RANDOM))) {
+            // This starts a tab item for the car/track profile rules.
+
+            emit_profiles();
 
             ImGui::EndTabItem();
-            // This ends the tab item.
         }
 
         ImGui::EndTabBar();
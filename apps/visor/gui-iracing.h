@@ -8,6 +8,9 @@ namespace sc::visor::gui::iracing {
     // Shut down the iRacing GUI module
     void shutdown();
 
+    // Run the iRacing services that don't need the UI, such as finishing a replay
+    void update();
+
     // Render or update the iRacing GUI content
     void emit_content();
 
@@ -3,7 +3,9 @@
 #include "animation_instance.h"  // Include animation instance header file
 #include "device_context.h"  // Include device context header file
 #include "legacy.h"  // Include legacy header file
-#include "gui-iRacing.h"  // Include the iRacing GUI header file
+#include "gui-iracing.h"  // Include the iRacing GUI header file
+#include "profiles.h"  // Include the profile rules header file
+#include "gui-coaching.h"  // Include the coaching GUI header file
 
 #include <string_view>  // Include header for string views
 #include <array>  // Include header for arrays
@@ -14,7 +16,9 @@
 #include <future>  // Include header for futures and promises
 #include <mutex>  // Include header for mutexes
 #include <memory>  // Include header for memory management
+#include <cstdlib>  // Include header for std::system
 #include <imgui.h>  // Include ImGui library
+#include <implot.h>  // Include ImPlot library
 #include <fmt/format.h>  // Include header for string formatting
 #include <glm/common.hpp>  // Include header for common GLM functions
 #include <glm/vec2.hpp>  // Include header for 2D vectors in GLM
@@ -27,16 +31,23 @@
 #include "../../libs/font/font_awesome_5.h"  // Include custom FontAwesome 5 font library
 #include "../../libs/font/font_awesome_5_brands.h"  // Include custom FontAwesome 5 Brands font library
 #include "../../libs/imgui/imgui_utils.hpp"  // Include custom ImGui utilities
+#include "../../libs/imgui/imgui_curve.h"  // Include the GPU curve renderer
 #include "../../libs/defer.hpp"  // Include custom defer library
 #include "../../libs/resource/resource.h"  // Include custom resource management library
 #include "../../libs/iracing/iracing.h"  // Include custom iRacing integration library
 #include "../../libs/api/api.h"  // Include custom API library
+#include "../../libs/boot/wakeup.h"  // Include main loop wakeup header
+#include "../../libs/boot/startup.h"  // Include startup task graph header
+#include "../../libs/recorder/recorder.h"  // Include recorder header, for its clock
+#include "../../libs/firmware/avr109.h"  // Include the AVR109 flasher header
 
 #include "bezier.h"  // Include custom Bezier library
 #include "im_glm_vec.hpp"  // Include custom GLM vector utilities
 
+#ifdef _WIN32
 #include <windows.h>  // Include Windows API header
 #include <shellapi.h>  // Include Shell API header
+#endif
 
 #undef min  // Undefine min macro
 #undef max  // Undefine max macro
@@ -113,10 +124,19 @@ void sc::visor::gui::popup::launch() {
     static std::future<tl::expected<std::vector<std::shared_ptr<sc::firmware::mk4::device_handle>>, std::string>> devices_future;  // Future for asynchronous device scanning
     static std::vector<std::shared_ptr<firmware::mk4::device_handle>> devices;  // Vector to store device handles
     static std::vector<std::shared_ptr<device_context>> device_contexts;  // Vector to store device contexts
+    static std::unique_ptr<firmware::avr109::flash_job> firmware_job;  // Firmware update in progress, if any
+    static std::optional<std::pair<std::string, std::string>> firmware_status;  // How the last firmware update went, and the details, until the next one
 
     static bool legacy_is_default = true;  // Flag indicating if legacy support is enabled by default
     static bool enable_legacy_support = false;  // Flag indicating if legacy support is enabled
 
+    // Variables related to startup
+    static sc::boot::task_graph startup_tasks;  // Settings, profiles and hardware support, initialized concurrently
+    static bool startup_applied = false;  // Flag indicating if the startup results were taken over by the main thread
+    static bool first_frame_marked = false;  // Flag indicating if the first frame was recorded in the startup trace
+    static std::optional<std::string> legacy_startup_error;  // Error from enabling legacy support during startup
+    static const char *startup_trace_file = "startup-trace.json";  // Chrome trace of the startup tasks, rewritten on every start
+
     // Variables related to account management
     static bool should_verify_session_token = false;  // Flag indicating if session token should be verified
     static std::optional<std::string> account_session_token;  // Optional session token
@@ -149,14 +169,15 @@ void sc::visor::gui::popup::launch() {
         return std::nullopt;  // Return no error
     }
 
-    // Save configuration to a file
-    static std::optional<std::string> cfg_save() {
-        auto doc_content = cfg.dump(4);  // Convert JSON to string with indentation of 4 spaces
-        std::vector<std::byte> doc_data;  // Vector to store byte data
-        doc_data.resize(doc_content.size());  // Resize vector to match string size
-        memcpy(doc_data.data(), doc_content.data(), glm::min(doc_data.size(), doc_content.size()));  // Copy string data to byte vector
-        if (const auto err = file::save("settings.json", doc_data); err) return *err;  // Save byte vector to file "settings.json"
-        return std::nullopt;  // Return no error
+    // Save configuration to a file in the background; errors are reported by the writer
+    static void cfg_save() {
+        file::writer::shared().save("settings.json", [doc = cfg]() {  // Hand the writer a snapshot; the UI keeps changing "cfg"
+            auto doc_content = doc.dump(4);  // Convert JSON to string with indentation of 4 spaces
+            std::vector<std::byte> doc_data;  // Vector to store byte data
+            doc_data.resize(doc_content.size());  // Resize vector to match string size
+            memcpy(doc_data.data(), doc_content.data(), glm::min(doc_data.size(), doc_content.size()));  // Copy string data to byte vector
+            return doc_data;  // Written to "settings.json" through a temporary file
+        });
     }
 
     // Prepare styling colors for ImGui
@@ -193,22 +214,42 @@ void sc::visor::gui::popup::launch() {
         return std::nullopt;  // Return no error
     }
 
-    // Prepare animation by loading and processing a resource
+    // Load the animation baked at build time, if it was baked at the size it is shown at
+    static std::optional<sc::texture::baked_animation> load_baked_animation(const std::string_view &resource_name, const glm::ivec2 &size) {
+        const auto content = sc::resource::get_resource("DATA", fmt::format("{}_BAKED", resource_name));  // Get baked resource content
+        if (!content) return std::nullopt;
+        std::vector<std::byte> buffer(content->second);  // Create buffer for content
+        memcpy(buffer.data(), content->first, buffer.size());  // Copy content to buffer
+        auto baked = sc::texture::baked_animation::parse(std::move(buffer));  // Read the frame index
+        if (!baked.has_value()) {
+            spdlog::warn("{}: {}", resource_name, baked.error());
+            return std::nullopt;
+        }
+        if (baked->size != size) {
+            spdlog::warn("{} was baked at {}x{}, but is shown at {}x{}.", resource_name, baked->size.x, baked->size.y, size.x, size.y);
+            return std::nullopt;
+        }
+        return std::move(*baked);
+    }
+
+    // Prepare animation by loading a resource; frames are decoded (or rendered, without a baked copy) on demand while it plays
     void prepare_animation(const std::string_view &resource_name, animation_instance &instance, const glm::ivec2 &size) {
-        if (const auto content = sc::resource::get_resource("DATA", resource_name); content) {  // Get resource content
+        auto player = [&]() -> tl::expected<std::shared_ptr<sc::texture::lottie_player>, std::string> {
+            if (auto baked = load_baked_animation(resource_name, size); baked) return sc::texture::lottie_player::create(pystring::lower(fmt::format("<baked:{}:{}x{}>", resource_name, size.x, size.y)), std::move(*baked));
+            const auto content = sc::resource::get_resource("DATA", resource_name);  // Get resource content
+            if (!content) return tl::make_unexpected(fmt::format("Missing resource: {}", resource_name));
             std::vector<std::byte> buffer(content->second);  // Create buffer for content
             memcpy(buffer.data(), content->first, buffer.size());  // Copy content to buffer
-            if (const auto sequence = sc::texture::load_lottie_from_memory(resource_name, buffer, size); sequence.has_value()) {  // Load and process Lottie sequence from buffer
-                instance.frame_rate = sequence->frame_rate;  // Set animation frame rate
-                int frame_i = 0;  // Initialize frame index
-                for (const auto &frame : sequence->frames) {  // Iterate through frames
-                    const auto description = pystring::lower(fmt::format("<rsc:{}:{}x{}#{}>", resource_name, sequence->frames.front().size.x, sequence->frames.front().size.y, frame_i++));  // Generate frame description
-                    if (const auto texture = sc::texture::upload_to_gpu(frame, sequence->frames.front().size, description); texture.has_value()) {  // Upload frame texture to GPU
-                        instance.frames.push_back(*texture);  // Add texture to animation instance
-                    } else spdlog::error(texture.error());  // Log error if texture upload fails
-                }
-            }
-        }
+            return sc::texture::lottie_player::create(pystring::lower(fmt::format("<rsc:{}:{}x{}>", resource_name, size.x, size.y)), buffer, size);  // Parse the Lottie animation
+        }();
+        if (player.has_value()) {
+            instance.frame_rate = (*player)->frame_rate;  // Set animation frame rate
+            instance.num_frames = (*player)->num_frames;  // Set animation frame count
+            instance.size = size;  // Set animation frame size
+            instance.frame_i = 0;  // Start from the first frame
+            instance.player = std::move(*player);
+            instance.last_shown = std::chrono::high_resolution_clock::now();  // Give the new player its second to be shown before update() releases it
+        } else spdlog::error("{}", player.error());  // Log error if the animation can't be parsed
     }
 }
 void load_animations() {
@@ -235,9 +276,10 @@ static void poll_devices() {
         if (!devices_last_scan) devices_last_scan = std::chrono::high_resolution_clock::now();  // Check if it's the first scan
         if (std::chrono::duration_cast<std::chrono::seconds>(std::chrono::high_resolution_clock::now() - *devices_last_scan).count() >= 1) {
             devices_future = async(std::launch::async, []() {
+                DEFER(sc::boot::wakeup());  // Wake the main loop to collect the result
                 return sc::firmware::mk4::discover(devices);  // Discover devices asynchronously
             });
-        }
+        } else sc::boot::schedule(std::chrono::seconds(1));  // Come back for the next scan
     }
     for (auto& device : devices) {
         const auto contexts_i = std::find_if(device_contexts.begin(), device_contexts.end(), [&device](const std::shared_ptr<device_context>& context) {
@@ -273,30 +315,89 @@ static void poll_devices() {
             } else continue;
         }
         context->update_future = async(std::launch::async, [context]() {
+            DEFER(sc::boot::wakeup());  // Wake the main loop to show the new axis values
             return device_context::update(context);  // Update the device context asynchronously
         });
     }
 }
 
+// Emit the firmware update button, or the progress of the update under way
+static void emit_firmware_update() {
+    if (firmware_job && firmware_job->finished()) {
+        const auto err = firmware_job->error();  // The job logged it already
+        firmware_status = err ? std::pair<std::string, std::string> { "Update failed.", *err } : std::pair<std::string, std::string> { "Updated.", "The new firmware is running." };
+        firmware_job.reset();  // Doesn't wait; the job's thread is done
+    }
+    if (firmware_job) {
+        const auto stage = firmware_job->current_stage();
+        ImGui::TextDisabled(stage == firmware::avr109::stage::waiting_for_bootloader ? "Press the reset button..." : firmware::avr109::describe(stage));  // Waiting needs the user
+        ImGui::ProgressBar(firmware_job->fraction(), { ImGui::GetContentRegionAvail().x, 0 });  // Progress of the stage; the UI never waits on the flash
+        return;
+    }
+    std::filesystem::path hex_path = "firmware.hex";  // Next to the executable, as profiles.json, unless settings.json says otherwise
+    if (const auto path_doc = cfg.find("firmware_path"); path_doc != cfg.end() && path_doc->is_string()) hex_path = path_doc->get<std::string>();
+    if (ImGui::Button(IM_LABEL("{} Update Firmware", ICON_FA_MICROCHIP), { ImGui::GetContentRegionAvail().x, 0 })) {
+        if (std::error_code ec; !std::filesystem::is_regular_file(hex_path, ec)) {  // Before the user is asked to press reset
+            firmware_status = { "Update failed.", fmt::format("There is no firmware at {}; set \"firmware_path\" in settings.json.", hex_path.string()) };
+        } else {
+            firmware::avr109::flash_options options;
+            options.hex_path = hex_path;
+            options.on_progress = sc::boot::wakeup;  // Redraw the progress bar as it moves
+            firmware_job = std::make_unique<firmware::avr109::flash_job>(std::move(options));  // Only a Caterina bootloader's port is flashed
+            firmware_status.reset();
+        }
+    }
+    if (ImGui::IsItemHovered()) ImGui::SetTooltip("%s", hex_path.string().c_str());
+    if (firmware_status) {
+        ImGui::TextDisabled("%s", firmware_status->first.c_str());  // The details don't fit the box
+        if (ImGui::IsItemHovered()) ImGui::SetTooltip("%s", firmware_status->second.c_str());
+    }
+}
+
+// Emit the scrolling input/output history of an axis, downsampled to one point per pixel
+static void emit_axis_trace(const char *id, const pedal_trace &trace) {
+    constexpr double seconds = 60;  // Width of the window, ending now
+    static pedal_trace::series input, output;  // Reused every frame; only the UI thread plots
+    if (ImGui::BeginChild(id, { 0, 164 }, true, ImGuiWindowFlags_MenuBar)) {
+        if (ImGui::BeginMenuBar()) {
+            ImGui::Text(IM_LABEL("{} History", ICON_FA_CHART_LINE));  // Display the history label
+            ImGui::EndMenuBar();
+        }
+        const auto size = ImGui::GetContentRegionAvail();
+        trace.downsample(recorder::now_us(), seconds, static_cast<size_t>(glm::max(size.x, 3.f)), input, output);  // The plot area is a bit narrower than the child, so this is at most a point per pixel
+        ImPlot::SetNextPlotLimits(-seconds, 0, 0, 1, ImGuiCond_Always);  // Scroll with time; fractions are 0 to 1
+        if (ImPlot::BeginPlot(ImFormat("##{}Plot", id), nullptr, nullptr, size, ImPlotFlags_NoMenus | ImPlotFlags_NoBoxSelect | ImPlotFlags_NoMousePos, ImPlotAxisFlags_None, ImPlotAxisFlags_NoTickLabels)) {
+            ImPlot::PushStyleColor(ImPlotCol_Line, { 150.f / 255.f, 150.f / 255.f, 150.f / 255.f, 1.f });  // Input in grey, like the raw input bar
+            ImPlot::PlotLine("Input", input.time.data(), input.value.data(), static_cast<int>(input.time.size()));
+            ImPlot::PopStyleColor();
+            ImPlot::PushStyleColor(ImPlotCol_Line, { 72.f / 255.f, 150.f / 255.f, 42.f / 255.f, 1.f });  // Output in green, like the output bar
+            ImPlot::PlotLine("Output", output.time.data(), output.value.data(), static_cast<int>(output.time.size()));
+            ImPlot::PopStyleColor();
+            ImPlot::EndPlot();
+        }
+    }
+    ImGui::EndChild();
+}
+
 // Emit axis profile slice GUI
 static void emit_axis_profile_slice(const std::shared_ptr<device_context>& context, int axis_i) {
     const auto label_default = axis_i == 0 ? "Throttle" : (axis_i == 1 ? "Brake" : "Clutch");  // Determine the label based on the axis index
-    if (ImGui::BeginChild(fmt::format("##{}Window", label_default).data(), { 0, 0 }, true, ImGuiWindowFlags_MenuBar)) {
+    if (ImGui::BeginChild(ImFormat("##{}Window", label_default), { 0, 0 }, true, ImGuiWindowFlags_MenuBar)) {
         if (ImGui::BeginMenuBar()) {
-            ImGui::Text(fmt::format("{} {} Configurations", ICON_FA_COGS, label_default).data());  // Display the axis configuration label
+            ImGui::Text(ImFormat("{} {} Configurations", ICON_FA_COGS, label_default));  // Display the axis configuration label
             ImGui::EndMenuBar();
         }
-        if (ImGui::Button(context->axes[axis_i].enabled ? fmt::format("{} Disable", ICON_FA_STOP).data() : fmt::format("{} Enable", ICON_FA_PLAY).data(), { ImGui::GetContentRegionAvail().x, 0 })) context->handle->set_axis_enabled(axis_i, !context->axes[axis_i].enabled);  // Toggle axis enable/disable
+        if (ImGui::Button(context->axes[axis_i].enabled ? IM_LABEL("{} Disable", ICON_FA_STOP) : IM_LABEL("{} Enable", ICON_FA_PLAY), { ImGui::GetContentRegionAvail().x, 0 })) context->handle->set_axis_enabled(axis_i, !context->axes[axis_i].enabled);  // Toggle axis enable/disable
         if (ImGui::BeginChild("##{}InputRangeWindow", { 0, 164 }, true, ImGuiWindowFlags_MenuBar)) {
             bool update_axis_range = false;
             if (ImGui::BeginMenuBar()) {
-                ImGui::Text(fmt::format("{} Range", ICON_FA_RULER).data());  // Display the axis range label
+                ImGui::Text(IM_LABEL("{} Range", ICON_FA_RULER));  // Display the axis range label
                 ImGui::EndMenuBar();
             }
-            ImGui::ProgressBar(context->axes[axis_i].input_fraction, { ImGui::GetContentRegionAvail().x, 0 }, fmt::format("{}", context->axes[axis_i].input).data());  // Display the input progress bar
+            ImGui::ProgressBar(context->axes[axis_i].input_fraction, { ImGui::GetContentRegionAvail().x, 0 }, ImFormat("{}", context->axes[axis_i].input));  // Display the input progress bar
             ImGui::SameLine();
             ImGui::Text("Raw Input");
-            if (ImGui::Button(fmt::format(" {} Set Min ", ICON_FA_ARROW_TO_LEFT).data(), { 100, 0 })) {
+            if (ImGui::Button(IM_LABEL(" {} Set Min ", ICON_FA_ARROW_TO_LEFT), { 100, 0 })) {
                 context->axes_ex[axis_i].range_min = context->axes[axis_i].input;  // Set the minimum range to the current raw input value
                 update_axis_range = true;
             }
@@ -312,7 +413,7 @@ static void emit_axis_profile_slice(const std::shared_ptr<device_context>& conte
             if (ImGui::InputInt("Max", &context->axes_ex[axis_i].range_max)) update_axis_range = true;  // Input field for maximum range
             ImGui::PopItemWidth();
             ImGui::SameLine();
-            if (ImGui::Button(fmt::format(" {} Set Max ", ICON_FA_ARROW_TO_RIGHT).data(), { 100, 0 })) {
+            if (ImGui::Button(IM_LABEL(" {} Set Max ", ICON_FA_ARROW_TO_RIGHT), { 100, 0 })) {
                 context->axes_ex[axis_i].range_max = context->axes[axis_i].input;  // Set the maximum range to the current raw input value
                 update_axis_range = true;
             }
@@ -326,7 +427,7 @@ if (ImGui::SliderInt("Output Limit##DZH", &context->axes_ex[axis_i].limit, 50, 1
 if (!context->axes[axis_i].enabled) ImGui::PushStyleColor(ImGuiCol_FrameBg, { 72.f / 255.f, 42.f / 255.f, 42.f / 255.f, 1.f });  // Modify frame background color for disabled axis
 const auto old_y = ImGui::GetCursorPos().y;
 ImGui::SetCursorPos({ ImGui::GetCursorPos().x, ImGui::GetCursorPos().y + 2 });
-ImGui::Text(fmt::format("{}", ICON_FA_SIGNAL_SLASH).data());  // Display signal slash icon
+ImGui::Text(IM_LABEL("{}", ICON_FA_SIGNAL_SLASH));  // Display signal slash icon
 ImGui::SameLine();
 ImGui::SetCursorPos({ ImGui::GetCursorPos().x, old_y });
 const int deadzone_padding = (context->axes_ex[axis_i].deadzone / 100.f) * static_cast<float>(context->axes[axis_i].max - context->axes[axis_i].min);  // Calculate deadzone padding
@@ -336,7 +437,7 @@ if (context->axes_ex[axis_i].deadzone > 0) ImGui::ProgressBar(within_deadzone_fr
 else ImGui::ProgressBar(0.f, { 80, 0 }, "--");  // Display placeholder progress bar
 ImGui::PopStyleColor();
 ImGui::SameLine();
-ImGui::Text(fmt::format("{}", ICON_FA_SIGNAL).data());  // Display signal icon
+ImGui::Text(IM_LABEL("{}", ICON_FA_SIGNAL));  // Display signal icon
 ImGui::SameLine();
 ImGui::PushStyleColor(ImGuiCol_PlotHistogram, { 72.f / 255.f, 150.f / 255.f, 42.f / 255.f, 1.f });  // Modify plot histogram color
 ImGui::ProgressBar(context->axes[axis_i].output_fraction, { ImGui::GetContentRegionAvail().x, 0 });  // Display progress bar for output fraction
@@ -355,17 +456,18 @@ if (update_axis_range) {
     else spdlog::info("Updated axis #{} range: {}, {}, {}", axis_i, context->axes_ex[axis_i].range_min, context->axes_ex[axis_i].range_max, context->axes_ex[axis_i].limit);  // Log successful range update
 }
 ImGui::EndChild();
-if (ImGui::BeginChild(fmt::format("##{}CurveWindow", label_default).data(), { 0, 294 }, true, ImGuiWindowFlags_MenuBar)) {
+if (axis_i < context->traces.size()) emit_axis_trace(ImFormat("##{}TraceWindow", label_default), context->traces[axis_i]);  // Display the axis history
+if (ImGui::BeginChild(ImFormat("##{}CurveWindow", label_default), { 0, 294 }, true, ImGuiWindowFlags_MenuBar)) {
     if (ImGui::BeginMenuBar()) {
-        ImGui::Text(fmt::format("{} Curve", ICON_FA_BEZIER_CURVE).data());  // Display curve label in the menu bar
+        ImGui::Text(IM_LABEL("{} Curve", ICON_FA_BEZIER_CURVE));  // Display curve label in the menu bar
         ImGui::EndMenuBar();
     }
-    const std::string selected_model_label = context->axes_ex[axis_i].model_edit_i >= 0 ? (context->models[context->axes_ex[axis_i].model_edit_i].label ? fmt::format("{} (#{})", *context->models[context->axes_ex[axis_i].model_edit_i].label, context->axes_ex[axis_i].model_edit_i) : fmt::format("Model #{}", context->axes_ex[axis_i].model_edit_i)) : "None selected.";  // Generate label for the selected curve model
-    if (ImGui::BeginCombo(fmt::format("##{}CurveOptions", label_default).data(), selected_model_label.data())) {
+    const char *selected_model_label = context->axes_ex[axis_i].model_edit_i >= 0 ? (context->models[context->axes_ex[axis_i].model_edit_i].label ? ImFormat("{} (#{})", *context->models[context->axes_ex[axis_i].model_edit_i].label, context->axes_ex[axis_i].model_edit_i) : ImFormat("Model #{}", context->axes_ex[axis_i].model_edit_i)) : "None selected.";  // Generate label for the selected curve model
+    if (ImGui::BeginCombo(ImFormat("##{}CurveOptions", label_default), selected_model_label)) {
         for (int model_i = 0; model_i < context->models.size(); model_i++) {
-            std::string this_label = context->models[model_i].label ? fmt::format("{} (#{})", *context->models[model_i].label, model_i) : fmt::format("Model #{}", model_i);  // Generate label for each curve model
-            if (model_i == context->axes[axis_i].curve_i) this_label += " *";  // Append "*" to label if it is the current curve model
-            if (ImGui::Selectable(this_label.data())) context->axes_ex[axis_i].model_edit_i = model_i;  // Handle selection of curve model
+            const auto current_mark = model_i == context->axes[axis_i].curve_i ? " *" : "";  // Append "*" to label if it is the current curve model
+            const auto this_label = context->models[model_i].label ? ImFormat("{} (#{}){}", *context->models[model_i].label, model_i, current_mark) : ImFormat("Model #{}{}", model_i, current_mark);  // Generate label for each curve model
+            if (ImGui::Selectable(this_label)) context->axes_ex[axis_i].model_edit_i = model_i;  // Handle selection of curve model
         }
         ImGui::EndCombo();
     }
@@ -380,7 +482,8 @@ if (ImGui::BeginChild(fmt::format("##{}CurveWindow", label_default).data(), { 0,
             else context->models[context->axes_ex[axis_i].model_edit_i].label = context->models[context->axes_ex[axis_i].model_edit_i].label_buffer.data();  // Update label value
         }
         {
-            std::vector<glm::dvec2> model;
+            static std::vector<glm::dvec2> model;  // Reused between frames, so the plot doesn't allocate
+            model.clear();
             for (auto &percent : context->models[context->axes_ex[axis_i].model_edit_i].points) model.push_back({
                 static_cast<double>(percent.x) / 100.0,
                 static_cast<double>(percent.y) / 100.0
@@ -392,7 +495,7 @@ if (ImGui::BeginChild(fmt::format("##{}CurveWindow", label_default).data(), { 0,
             else bezier::ui::plot_cubic(model, { 200, 200 }, std::nullopt, std::nullopt, context->axes_ex[axis_i].limit / 100.f, cif);  // Display cubic curve plot without output fraction
         }
         ImGui::SameLine();
-        if (ImGui::BeginChild(fmt::format("##{}CurveWindowRightPanel", label_default).data(), { ImGui::GetContentRegionAvail().x, ImGui::GetContentRegionAvail().y }, false)) {
+        if (ImGui::BeginChild(ImFormat("##{}CurveWindowRightPanel", label_default), { ImGui::GetContentRegionAvail().x, ImGui::GetContentRegionAvail().y }, false)) {
             bool update_model = false;
             ImGui::PushItemWidth(80);
             for (int i = 0; i < context->models[context->axes_ex[axis_i].model_edit_i].points.size(); i++) {
@@ -405,18 +508,18 @@ if (ImGui::BeginChild(fmt::format("##{}CurveWindow", label_default).data(), { 0,
                     default: break;
                 }
                 ImGui::SameLine();
-                if (ImGui::Button(fmt::format("{}##YM{}", ICON_FA_MINUS, i + 1).data()) && context->models[context->axes_ex[axis_i].model_edit_i].points[i].y > 0) {  // Button to decrease the y-value of the point
+                if (ImGui::Button(ImFormat("{}##YM{}", ICON_FA_MINUS, i + 1)) && context->models[context->axes_ex[axis_i].model_edit_i].points[i].y > 0) {  // Button to decrease the y-value of the point
                     context->models[context->axes_ex[axis_i].model_edit_i].points[i].y--;
                     update_model = true;
                 }
                 ImGui::SameLine();
-                if (ImGui::Button(fmt::format("{}##YP{}", ICON_FA_PLUS, i + 1).data()) && context->models[context->axes_ex[axis_i].model_edit_i].points[i].y < 100) {  // Button to increase the y-value of the point
+                if (ImGui::Button(ImFormat("{}##YP{}", ICON_FA_PLUS, i + 1)) && context->models[context->axes_ex[axis_i].model_edit_i].points[i].y < 100) {  // Button to increase the y-value of the point
                     context->models[context->axes_ex[axis_i].model_edit_i].points[i].y++;
                     update_model = true;
                 }
                 ImGui::SameLine();
                 ImGui::SameLine();
-                if (ImGui::SliderInt(fmt::format("Y##{}", i + 1).data(), &context->models[context->axes_ex[axis_i].model_edit_i].points[i].y, 0, 100)) update_model = true;  // Slider for adjusting the y-value of the point
+                if (ImGui::SliderInt(ImFormat("Y##{}", i + 1), &context->models[context->axes_ex[axis_i].model_edit_i].points[i].y, 0, 100)) update_model = true;  // Slider for adjusting the y-value of the point
             }
 ImGui::PopItemWidth(); // Pop the item width setting
 
@@ -444,7 +547,7 @@ animation_under_construction.play = false; // Set the play flag of the "animatio
 animation_under_construction.playing = false; // Set the playing flag of the "animation_under_construction" to false
 
 if (ImGui::BeginTabBar("##AppModeBar")) { // Begin a tab bar with the identifier "##AppModeBar"
-    if (ImGui::BeginTabItem(fmt::format("{} Account", ICON_FA_USER).data())) { // Begin a tab item with the label " Account" and icon
+    if (ImGui::BeginTabItem(IM_LABEL("{} Account", ICON_FA_USER))) { // Begin a tab item with the label " Account" and icon
         static bool logged_in = false; // Declare a static boolean variable "logged_in" and set it to false
         const auto logged_in_rn = !account_session_token || account_creation_response || account_login_response || account_confirmation_response || account_pw_reset_response || account_pw_reset_confirm_response; // Check if the user is logged in
         if (logged_in_rn != logged_in) { // If the login state has changed
@@ -464,12 +567,12 @@ if (ImGui::BeginTabBar("##AppModeBar")) { // Begin a tab bar with the identifier
                             animation_scan.play = true; // Set the play flag of the "animation_scan" to true
                             ImPenUtility pen; // Create an ImPenUtility object named "pen"
                             pen.CalculateWindowBounds(); // Calculate the window bounds using the "pen" object
-                            const auto image_pos = pen.GetCenteredPosition(GLMD_IM2(animation_scan.frames[animation_scan.frame_i]->size)); // Calculate the centered position of the image using the "pen" object
+                            const auto image_pos = pen.GetCenteredPosition(GLMD_IM2(animation_scan.size)); // Calculate the centered position of the image using the "pen" object
                             ImGui::SetCursorScreenPos(image_pos); // Set the cursor screen position using the image position
-                            if (animation_scan.frames.size()) { // If there are animation frames
+                            if (const auto texture = animation_scan.texture(); texture) { // If the current animation frame is ready
                                 ImGui::Image( // Display an image
-                                    reinterpret_cast<ImTextureID>(animation_scan.frames[animation_scan.frame_i]->handle), // Image texture ID
-                                    GLMD_IM2(animation_scan.frames[animation_scan.frame_i]->size), // Image size
+                                    reinterpret_cast<ImTextureID>(texture->handle), // Image texture ID
+                                    GLMD_IM2(animation_scan.size), // Image size
                                     { 0, 0 }, // UV min
                                     { 1, 1 }, // UV max
                                     { 1, 1, 1, animation_scan.playing ? 1 : 0.8f } // Tint color
@@ -535,7 +638,7 @@ if (ImGui::BeginTabBar("##AppModeBar")) { // Begin a tab bar with the identifier
         animation_under_construction.playing = false; // Set the playing flag of the "animation_under_construction" to false
 
         if (ImGui::BeginTabBar("##AppModeBar")) { // Begin a tab bar with the identifier "##AppModeBar"
-            if (ImGui::BeginTabItem(fmt::format("{} Account", ICON_FA_USER).data())) { // Begin a tab item with the label " Account" and icon
+            if (ImGui::BeginTabItem(IM_LABEL("{} Account", ICON_FA_USER))) { // Begin a tab item with the label " Account" and icon
                 static bool logged_in = false; // Declare a static boolean variable "logged_in" and set it to false
                 const auto logged_in_rn = !account_session_token || account_creation_response || account_login_response || account_confirmation_response || account_pw_reset_response || account_pw_reset_confirm_response; // Check if the user is logged in
                 if (logged_in_rn != logged_in) { // If the login state has changed
@@ -555,12 +658,12 @@ if (ImGui::BeginTabBar("##AppModeBar")) { // Begin a tab bar with the identifier
                                     animation_scan.play = true; // Set the play flag of the "animation_scan" to true
                                     ImPenUtility pen; // Create an ImPenUtility object named "pen"
                                     pen.CalculateWindowBounds(); // Calculate the window bounds using the "pen" object
-                                    const auto image_pos = pen.GetCenteredPosition(GLMD_IM2(animation_scan.frames[animation_scan.frame_i]->size)); // Calculate the centered position of the image using the "pen" object
+                                    const auto image_pos = pen.GetCenteredPosition(GLMD_IM2(animation_scan.size)); // Calculate the centered position of the image using the "pen" object
                                     ImGui::SetCursorScreenPos(image_pos); // Set the cursor screen position using the image position
-                                    if (animation_scan.frames.size()) { // If there are animation frames
+                                    if (const auto texture = animation_scan.texture(); texture) { // If the current animation frame is ready
                                         ImGui::Image( // Display an image
-                                            reinterpret_cast<ImTextureID>(animation_scan.frames[animation_scan.frame_i]->handle), // Image texture ID
-                                            GLMD_IM2(animation_scan.frames[animation_scan.frame_i]->size), // Image size
+                                            reinterpret_cast<ImTextureID>(texture->handle), // Image texture ID
+                                            GLMD_IM2(animation_scan.size), // Image size
                                             { 0, 0 }, // UV min
                                             { 1, 1 }, // UV max
                                             { 1, 1, 1, animation_scan.playing ? 1 : 0.8f } // Tint color
@@ -618,12 +721,12 @@ if (ImGui::BeginTabItem("Create Account")) { // Begin a tab item with the label
         animation_scan.play = true; // Set the play flag of the "animation_scan" to true
         ImPenUtility pen; // Create an ImPenUtility object named "pen"
         pen.CalculateWindowBounds(); // Calculate the window bounds using the "pen" object
-        const auto image_pos = pen.GetCenteredPosition(GLMD_IM2(animation_scan.frames[animation_scan.frame_i]->size)); // Calculate the centered position of the image using the "pen" object
+        const auto image_pos = pen.GetCenteredPosition(GLMD_IM2(animation_scan.size)); // Calculate the centered position of the image using the "pen" object
         ImGui::SetCursorScreenPos(image_pos); // Set the cursor screen position using the image position
-        if (animation_scan.frames.size()) { // If there are animation frames
+        if (const auto texture = animation_scan.texture(); texture) { // If the current animation frame is ready
             ImGui::Image( // Display an image
-                reinterpret_cast<ImTextureID>(animation_scan.frames[animation_scan.frame_i]->handle), // Image texture ID
-                GLMD_IM2(animation_scan.frames[animation_scan.frame_i]->size), // Image size
+                reinterpret_cast<ImTextureID>(texture->handle), // Image texture ID
+                GLMD_IM2(animation_scan.size), // Image size
                 { 0, 0 }, // UV min
                 { 1, 1 }, // UV max
                 { 1, 1, 1, animation_scan.playing ? 1 : 0.8f } // Tint color
@@ -739,12 +842,12 @@ if (ImGui::BeginTabItem("Reset Password")) { // Begin the "Reset Password" tab
         animation_scan.play = true; // Set the animation scan to play
         ImPenUtility pen;
         pen.CalculateWindowBounds();
-        const auto image_pos = pen.GetCenteredPosition(GLMD_IM2(animation_scan.frames[animation_scan.frame_i]->size));
+        const auto image_pos = pen.GetCenteredPosition(GLMD_IM2(animation_scan.size));
         ImGui::SetCursorScreenPos(image_pos);
-        if (animation_scan.frames.size()) {
+        if (const auto texture = animation_scan.texture(); texture) {
             ImGui::Image(
-                reinterpret_cast<ImTextureID>(animation_scan.frames[animation_scan.frame_i]->handle),
-                GLMD_IM2(animation_scan.frames[animation_scan.frame_i]->size),
+                reinterpret_cast<ImTextureID>(texture->handle),
+                GLMD_IM2(animation_scan.size),
                 { 0, 0 },
                 { 1, 1 },
                 { 1, 1, 1, animation_scan.playing ? 1 : 0.8f }
@@ -832,9 +935,9 @@ ImGui::EndTabBar(); // End the tab bar
 ImGui::EndChild(); // End of the child window
 
 else {
-  ImGui::TextColored({ .2f, 1, .2f, 1 }, fmt::format("{} Logged In", ICON_FA_CHECK_DOUBLE).data()); // Display the "Logged In" text in colored format
+  ImGui::TextColored({ .2f, 1, .2f, 1 }, IM_LABEL("{} Logged In", ICON_FA_CHECK_DOUBLE)); // Display the "Logged In" text in colored format
   ImGui::SameLine(); // Move the cursor to the same line
-  ImGui::TextDisabled(fmt::format("({}, Token: {})", *account_person_name, *account_session_token).data()); // Display the person's name and session token in disabled format
+  ImGui::TextDisabled(ImFormat("({}, Token: {})", *account_person_name, *account_session_token)); // Display the person's name and session token in disabled format
 
   // Start of new code
   /*
@@ -852,20 +955,20 @@ else {
   animation_under_construction.loop = true; // Set the loop flag of the animation_under_construction to true
   ImPenUtility pen; // Create an ImPenUtility object
   pen.CalculateWindowBounds(); // Calculate the window bounds
-  const auto image_pos = pen.GetCenteredPosition(GLMD_IM2(animation_under_construction.frames[animation_under_construction.frame_i]->size)); // Calculate the centered position of the image
+  const auto image_pos = pen.GetCenteredPosition(GLMD_IM2(animation_under_construction.size)); // Calculate the centered position of the image
   ImGui::SetCursorScreenPos(image_pos); // Set the cursor position to the image position
 
-  if (animation_under_construction.frames.size()) { // Check if there are frames in animation_under_construction
+  if (const auto texture = animation_under_construction.texture(); texture) { // Check if the current frame of animation_under_construction is ready
     ImGui::Image(
-      reinterpret_cast<ImTextureID>(animation_under_construction.frames[animation_under_construction.frame_i]->handle), // Display the current frame of the animation_under_construction
-      GLMD_IM2(animation_under_construction.frames[animation_under_construction.frame_i]->size)
+      reinterpret_cast<ImTextureID>(texture->handle), // Display the current frame of the animation_under_construction
+      GLMD_IM2(animation_under_construction.size)
     );
   }
 }
 
 ImGui::EndTabItem(); // End the current tab item
 
-if (ImGui::BeginTabItem(fmt::format("{} Hardware", ICON_FA_TOOLS).data())) { // Begin a new tab item with the label "Hardware" and the "Tools" icon
+if (ImGui::BeginTabItem(IM_LABEL("{} Hardware", ICON_FA_TOOLS))) { // Begin a new tab item with the label "Hardware" and the "Tools" icon
   enum class selection_type {
     axis,
     button,
@@ -879,34 +982,38 @@ if (ImGui::BeginTabItem(fmt::format("{} Hardware", ICON_FA_TOOLS).data())) { //
       for (const auto &context : device_contexts) { // Iterate over each context in the device_contexts vector
         std::lock_guard guard(context->mutex); // Create a lock guard for the context's mutex
 
-        if (ImGui::BeginTabItem(fmt::format("{} {}##{}", ICON_FA_MICROCHIP, context->name, context->serial).data())) { // Begin a new tab item with the label containing the icon, context name, and serial number
+        if (ImGui::BeginTabItem(ImFormat("{} {}##{}", ICON_FA_MICROCHIP, context->name, context->serial))) { // Begin a new tab item with the label containing the icon, context name, and serial number
+          ImGui::BeginDisabled(context->switching_profile); // Keep the controls off the device while a profile switch writes to it
           if (context->handle) { // Check if the context has a handle
-            ImGui::TextColored({ .2f, 1, .2f, 1 }, fmt::format("{} Connected", ICON_FA_CHECK_DOUBLE).data()); // Display the "Connected" text in colored format
+            ImGui::TextColored({ .2f, 1, .2f, 1 }, IM_LABEL("{} Connected", ICON_FA_CHECK_DOUBLE)); // Display the "Connected" text in colored format
             ImGui::SameLine(); // Move the cursor to the same line
-            ImGui::TextDisabled(fmt::format("v{}.{}.{}", context->version_major, context->version_minor, context->version_revision).data()); // Display the version information in disabled format
+            ImGui::TextDisabled(ImFormat("v{}.{}.{}", context->version_major, context->version_minor, context->version_revision)); // Display the version information in disabled format
           } else {
-            ImGui::TextColored({ 1, 1, .2f, 1 }, fmt::format("{} Disconnected", ICON_FA_SPINNER).data()); // Display the "Disconnected" text in colored format
+            ImGui::TextColored({ 1, 1, .2f, 1 }, IM_LABEL("{} Disconnected", ICON_FA_SPINNER)); // Display the "Disconnected" text in colored format
           }
 
           if (context->initial_communication_complete) { // Check if the initial communication with the context is complete
             const auto top_y = ImGui::GetCursorScreenPos().y; // Get the top y-coordinate of the current position
             animation_comm.playing = false; // Set the playing flag of the animation_comm to false
 
-            if (ImGui::BeginChild("##DeviceInteractionBox", { 200, 86 }, true, ImGuiWindowFlags_MenuBar)) { // Begin a child window with the ID "##DeviceInteractionBox" and a size of {200, 86} pixels, along with a menubar
+            const auto firmware_rows = firmware_job || firmware_status ? 2 : 1; // The update button, or the stage and its progress bar
+            if (ImGui::BeginChild("##DeviceInteractionBox", { 200, 86 + firmware_rows * ImGui::GetFrameHeightWithSpacing() }, true, ImGuiWindowFlags_MenuBar)) { // Begin a child window with the ID "##DeviceInteractionBox", tall enough for the firmware update rows, along with a menubar
               if (ImGui::BeginMenuBar()) { // Begin the menubar
-                ImGui::Text(fmt::format("{} Controls", ICON_FA_SATELLITE_DISH).data()); // Display the "Controls" text in the menubar
+                ImGui::Text(IM_LABEL("{} Controls", ICON_FA_SATELLITE_DISH)); // Display the "Controls" text in the menubar
                 ImGui::EndMenuBar(); // End the menubar
               }
 
-              if (ImGui::Button(fmt::format("{} Save to Chip", ICON_FA_FILE_IMPORT).data(), { ImGui::GetContentRegionAvail().x, 0 })) { // Create a button with the label "Save to Chip" and the "File Import" icon
+              if (ImGui::Button(IM_LABEL("{} Save to Chip", ICON_FA_FILE_IMPORT), { ImGui::GetContentRegionAvail().x, 0 })) { // Create a button with the label "Save to Chip" and the "File Import" icon
                 const auto err = context->handle->commit(); // Commit the changes to the context's handle
                 if (err) spdlog::error(*err); // Display an error message if there is an error
                 else spdlog::info("Settings saved."); // Display a success message if the settings are saved
               }
 
-              if (ImGui::Button(fmt::format("{} Clear Chip", ICON_FA_ERASER).data(), { ImGui::GetContentRegionAvail().x, 0 })) { // Create a button with the label "Clear Chip" and the "Eraser" icon
+              if (ImGui::Button(IM_LABEL("{} Clear Chip", ICON_FA_ERASER), { ImGui::GetContentRegionAvail().x, 0 })) { // Create a button with the label "Clear Chip" and the "Eraser" icon
                 // Perform some action when the button is clicked
               }
+
+              emit_firmware_update(); // Emit the firmware update button or its progress
             }
 
             ImGui::EndChild(); // End the child window
@@ -915,7 +1022,7 @@ if (ImGui::BeginTabItem(fmt::format("{} Hardware", ICON_FA_TOOLS).data())) { //
 
             if (ImGui::BeginChild("##DeviceHardwareList", { 200, 0 }, true, ImGuiWindowFlags_MenuBar)) { // Begin a child window with the ID "##DeviceHardwareList" and a dynamic height, along with a menubar
               if (ImGui::BeginMenuBar()) { // Begin the menubar
-                ImGui::Text(fmt::format("{} Inputs", ICON_FA_SITEMAP).data()); // Display the "Inputs" text in the menubar
+                ImGui::Text(IM_LABEL("{} Inputs", ICON_FA_SITEMAP)); // Display the "Inputs" text in the menubar
                 ImGui::EndMenuBar(); // End the menubar
               }
 
@@ -954,25 +1061,26 @@ if (ImGui::BeginTabItem(fmt::format("{} Hardware", ICON_FA_TOOLS).data())) { //
             animation_comm.playing = true; // Set the playing flag of the animation_comm to true
             ImPenUtility pen; // Create an ImPenUtility object
             pen.CalculateWindowBounds(); // Calculate the window bounds
-            const auto image_pos = pen.GetCenteredPosition(GLMD_IM2(animation_comm.frames[animation_comm.frame_i]->size)); // Calculate the centered position of the image
+            const auto image_pos = pen.GetCenteredPosition(GLMD_IM2(animation_comm.size)); // Calculate the centered position of the image
             ImGui::SetCursorScreenPos(image_pos); // Set the cursor position to the image position
 
-            if (animation_comm.frames.size()) { // Check if there are frames in animation_comm
+            if (const auto texture = animation_comm.texture(); texture) { // Check if the current frame of animation_comm is ready
               ImGui::Image(
-                  reinterpret_cast<ImTextureID>(animation_comm.frames[animation_comm.frame_i]->handle), // Display the current frame of the animation_comm
-                  GLMD_IM2(animation_comm.frames[animation_comm.frame_i]->size)
+                  reinterpret_cast<ImTextureID>(texture->handle), // Display the current frame of the animation_comm
+                  GLMD_IM2(animation_comm.size)
               );
             }
           }
 
+          ImGui::EndDisabled(); // End the disabled block of a profile switch
           ImGui::EndTabItem(); // End the current tab item
         }
 	}
-  if (enable_legacy_support && ImGui::BeginTabItem(fmt::format("{} Virtual Pedals", ICON_FA_GHOST).data())) { // Check if legacy support is enabled and begin a new tab with the label "Virtual Pedals" and the "Ghost" icon
+  if (enable_legacy_support && ImGui::BeginTabItem(IM_LABEL("{} Virtual Pedals", ICON_FA_GHOST))) { // Check if legacy support is enabled and begin a new tab with the label "Virtual Pedals" and the "Ghost" icon
     if (legacy::present()) { // Check if legacy is present
-      ImGui::TextColored({ .2f, 1, .2f, 1 }, fmt::format("{} Online", ICON_FA_CHECK_DOUBLE).data()); // Display the "Online" text in colored format
+      ImGui::TextColored({ .2f, 1, .2f, 1 }, IM_LABEL("{} Online", ICON_FA_CHECK_DOUBLE)); // Display the "Online" text in colored format
     } else {
-      ImGui::TextColored({ .2f, 1, .2f, 1 }, fmt::format("{} Ready", ICON_FA_CHECK).data()); // Display the "Ready" text in colored format
+      ImGui::TextColored({ .2f, 1, .2f, 1 }, IM_LABEL("{} Ready", ICON_FA_CHECK)); // Display the "Ready" text in colored format
       ImGui::SameLine();
       ImGui::TextDisabled("No hardware detected."); // Display the "No hardware detected." text in disabled format
     }
@@ -981,19 +1089,19 @@ if (ImGui::BeginTabItem(fmt::format("{} Hardware", ICON_FA_TOOLS).data())) { //
 
     if (ImGui::BeginChild("##DeviceInteractionBox", { 200, 86 }, true, ImGuiWindowFlags_MenuBar)) { // Begin a child window with the ID "##DeviceInteractionBox" and a size of {200, 86} pixels, along with a menubar
       if (ImGui::BeginMenuBar()) { // Begin the menubar
-        ImGui::Text(fmt::format("{} Controls", ICON_FA_SATELLITE_DISH).data()); // Display the "Controls" text in the menubar
+        ImGui::Text(IM_LABEL("{} Controls", ICON_FA_SATELLITE_DISH)); // Display the "Controls" text in the menubar
         ImGui::EndMenuBar(); // End the menubar
       }
 
-      if (ImGui::Button(fmt::format("{} Save Settings", ICON_FA_FILE_IMPORT).data(), { ImGui::GetContentRegionAvail().x, 0 })) { // Create a button with the label "Save Settings" and the "File Import" icon
+      if (ImGui::Button(IM_LABEL("{} Save Settings", ICON_FA_FILE_IMPORT), { ImGui::GetContentRegionAvail().x, 0 })) { // Create a button with the label "Save Settings" and the "File Import" icon
         if (const auto err = legacy::save_settings(); err) { // Save the settings and check if there is an error
           spdlog::error("Unable to save settings: {}", *err); // Display an error message if there is an error
         } else {
-          spdlog::info("Settings saved."); // Display a success message if the settings are saved
+          spdlog::info("Settings queued for saving."); // Written in the background; a failure is reported by gui::update
         }
       }
 
-      if (ImGui::Button(fmt::format("{} Clear Settings", ICON_FA_ERASER).data(), { ImGui::GetContentRegionAvail().x, 0 })) {
+      if (ImGui::Button(IM_LABEL("{} Clear Settings", ICON_FA_ERASER), { ImGui::GetContentRegionAvail().x, 0 })) {
         // Perform some action when the button is clicked
       }
     }
@@ -1004,7 +1112,7 @@ if (ImGui::BeginTabItem(fmt::format("{} Hardware", ICON_FA_TOOLS).data())) { //
 
     if (ImGui::BeginChild("##DeviceHardwareList", { 200, 0 }, true, ImGuiWindowFlags_MenuBar)) { // Begin a child window with the ID "##DeviceHardwareList" and a dynamic height, along with a menubar
       if (ImGui::BeginMenuBar()) { // Begin the menubar
-        ImGui::Text(fmt::format("{} Inputs", ICON_FA_SITEMAP).data()); // Display the "Inputs" text in the menubar
+        ImGui::Text(IM_LABEL("{} Inputs", ICON_FA_SITEMAP)); // Display the "Inputs" text in the menubar
         ImGui::EndMenuBar(); // End the menubar
       }
 
@@ -1020,10 +1128,10 @@ if (ImGui::BeginTabItem(fmt::format("{} Hardware", ICON_FA_TOOLS).data())) { //
         }
 
         if (legacy::axes[i].label) { // Check if the axis has a label
-          if (ImGui::Button(fmt::format("{}##VirtualAxis{}SelectionButton", legacy::axes[i].label->data(), i).data(), { ImGui::GetContentRegionAvail().x, 40 })) { // Create a button with the label of the axis and a size of {content_region_width, 40}
+          if (ImGui::Button(ImFormat("{}##VirtualAxis{}SelectionButton", legacy::axes[i].label->data(), i), { ImGui::GetContentRegionAvail().x, 40 })) { // Create a button with the label of the axis and a size of {content_region_width, 40}
             current_selection = i; // Set the current selection to the current axis
           }
-        } else if (ImGui::Button(fmt::format("Axis #{}##VirtualAxis{}SelectionButton", i, i).data(), { ImGui::GetContentRegionAvail().x, 40 })) { // Create a button with the label "Axis #" and the axis number, and a size of {content_region_width, 40}
+        } else if (ImGui::Button(ImFormat("Axis #{}##VirtualAxis{}SelectionButton", i, i), { ImGui::GetContentRegionAvail().x, 40 })) { // Create a button with the label "Axis #" and the axis number, and a size of {content_region_width, 40}
           current_selection = i; // Set the current selection to the current axis
         }
 
@@ -1038,17 +1146,17 @@ if (ImGui::BeginTabItem(fmt::format("{} Hardware", ICON_FA_TOOLS).data())) { //
     ImGui::SameLine(0, ImGui::GetStyle().FramePadding.x); // Move the cursor to the same line with frame padding
     ImGui::SetCursorScreenPos({ ImGui::GetCursorScreenPos().x, top_y }); // Set the cursor position to the top y-coordinate
 
-    if (ImGui::BeginChild(fmt::format("##VirtualAxis#{}_Window", current_selection).data(), { 0, 0 }, true, ImGuiWindowFlags_MenuBar)) { // Begin a child window with the ID "##VirtualAxis#{}_Window" and a dynamic size, along with a menubar
+    if (ImGui::BeginChild(ImFormat("##VirtualAxis#{}_Window", current_selection), { 0, 0 }, true, ImGuiWindowFlags_MenuBar)) { // Begin a child window with the ID "##VirtualAxis#{}_Window" and a dynamic size, along with a menubar
       if (ImGui::BeginMenuBar()) { // Begin the menubar
-        ImGui::Text(fmt::format("{} Axis #{} Configurations", ICON_FA_COGS, current_selection + 1).data()); // Display the axis configurations with the axis number
+        ImGui::Text(ImFormat("{} Axis #{} Configurations", ICON_FA_COGS, current_selection + 1)); // Display the axis configurations with the axis number
         ImGui::EndMenuBar(); // End the menubar
       }
 
       ImGui::SetNextItemWidth(400); // Set the width of the next item to 400 pixels
-      ImGui::InputTextWithHint(fmt::format("##VirtualAxis#{}_LabelInput", current_selection).data(), "Label", legacy::axes[current_selection].label_buffer.data(), legacy::axes[current_selection].label_buffer.size()); // Create an input text field for the label of the axis
+      ImGui::InputTextWithHint(ImFormat("##VirtualAxis#{}_LabelInput", current_selection), "Label", legacy::axes[current_selection].label_buffer.data(), legacy::axes[current_selection].label_buffer.size()); // Create an input text field for the label of the axis
 
       ImGui::SameLine(); // Move to the same line
-      if (ImGui::Button(fmt::format("Set Label##VirtualAxis#{}_LabelUpdateButton", current_selection).data(), { ImGui::GetContentRegionAvail().x, 0 })) { // Create a button with the label "Set Label"
+      if (ImGui::Button(ImFormat("Set Label##VirtualAxis#{}_LabelUpdateButton", current_selection), { ImGui::GetContentRegionAvail().x, 0 })) { // Create a button with the label "Set Label"
         if (const auto trimmed = pystring::strip(legacy::axes[current_selection].label_buffer.data(), ""); trimmed != "") { // Trim the label and check if it is not empty
           spdlog::debug("Update label: {}", trimmed); // Output a debug message with the trimmed label
           legacy::axes[current_selection].label = trimmed; // Set the label of the current axis to the trimmed label
@@ -1061,16 +1169,16 @@ if (ImGui::BeginTabItem(fmt::format("{} Hardware", ICON_FA_TOOLS).data())) { //
         bool update_axis_range = false; // Define a boolean variable to track if the axis range should be updated
 
         if (ImGui::BeginMenuBar()) { // Begin the menubar
-          ImGui::Text(fmt::format("{} Range", ICON_FA_RULER).data()); // Display the "Range" text in the menubar
+          ImGui::Text(IM_LABEL("{} Range", ICON_FA_RULER)); // Display the "Range" text in the menubar
           ImGui::EndMenuBar(); // End the menubar
         }
 
-        ImGui::ProgressBar(legacy::axes[current_selection].input_raw, { ImGui::GetContentRegionAvail().x, 0 }, fmt::format("{}", legacy::axes[current_selection].input_steps).data()); // Display a progress bar for the raw input of the axis
+        ImGui::ProgressBar(legacy::axes[current_selection].input_raw, { ImGui::GetContentRegionAvail().x, 0 }, ImFormat("{}", legacy::axes[current_selection].input_steps)); // Display a progress bar for the raw input of the axis
 
         ImGui::SameLine(); // Move to the same line
         ImGui::Text("Raw Input"); // Display the "Raw Input" text
 
-        if (ImGui::Button(fmt::format(" {} Set Min ", ICON_FA_ARROW_TO_LEFT).data(), { 100, 0 })) { // Create a button with the label "Set Min" and the "Arrow to Left" icon
+        if (ImGui::Button(IM_LABEL(" {} Set Min ", ICON_FA_ARROW_TO_LEFT), { 100, 0 })) { // Create a button with the label "Set Min" and the "Arrow to Left" icon
           legacy::axes[current_selection].output_steps_min = legacy::axes[current_selection].input_steps; // Set the minimum output steps to the input steps of the axis
           update_axis_range = true; // Set the flag to update the axis range
         }
@@ -1098,7 +1206,7 @@ if (ImGui::BeginTabItem(fmt::format("{} Hardware", ICON_FA_TOOLS).data())) { //
 
         ImGui::SameLine(); // Move to the same line
 
-        if (ImGui::Button(fmt::format(" {} Set Max ", ICON_FA_ARROW_TO_RIGHT).data(), { 100, 0 })) { // Create a button with the label "Set Max" and the "Arrow to Right" icon
+        if (ImGui::Button(IM_LABEL(" {} Set Max ", ICON_FA_ARROW_TO_RIGHT), { 100, 0 })) { // Create a button with the label "Set Max" and the "Arrow to Right" icon
           legacy::axes[current_selection].output_steps_max = legacy::axes[current_selection].input_steps; // Set the maximum output steps to the input steps of the axis
           update_axis_range = true; // Set the flag to update the axis range
         }
@@ -1128,7 +1236,7 @@ const auto old_y = ImGui::GetCursorPos().y;
 ImGui::SetCursorPos({ ImGui::GetCursorPos().x, ImGui::GetCursorPos().y + 2 });
 
 // Display the "Signal Slash" icon and align it with the previous position
-ImGui::Text(fmt::format("{}", ICON_FA_SIGNAL_SLASH).data());
+ImGui::Text(IM_LABEL("{}", ICON_FA_SIGNAL_SLASH));
 ImGui::SameLine();
 ImGui::SetCursorPos({ ImGui::GetCursorPos().x, old_y });
 
@@ -1150,7 +1258,7 @@ ImGui::PopStyleColor();
 
 // Display the "Signal" icon
 ImGui::SameLine();
-ImGui::Text(fmt::format("{}", ICON_FA_SIGNAL).data());
+ImGui::Text(IM_LABEL("{}", ICON_FA_SIGNAL));
 
 // Display a progress bar representing the output of the axis
 ImGui::SameLine();
@@ -1171,24 +1279,26 @@ if (!legacy::axes[current_selection].present) {
 // End the child window
 ImGui::EndChild();
 
+// Display the axis history
+emit_axis_trace(ImFormat("##Axis{}TraceWindow", current_selection), legacy::traces[current_selection]);
+
 // Begin the child window for the axis curve settings
-if (ImGui::BeginChild(fmt::format("##Axis{}CurveWindow", current_selection).data(), { 0, 0 }, true, ImGuiWindowFlags_MenuBar)) {
+if (ImGui::BeginChild(ImFormat("##Axis{}CurveWindow", current_selection), { 0, 0 }, true, ImGuiWindowFlags_MenuBar)) {
     // Display the menu bar with the title
     if (ImGui::BeginMenuBar()) {
-        ImGui::Text(fmt::format("{} Curve", ICON_FA_BEZIER_CURVE).data());
+        ImGui::Text(IM_LABEL("{} Curve", ICON_FA_BEZIER_CURVE));
         ImGui::EndMenuBar();
     }
 
     // Get the label for the selected curve model
-    const std::string selected_model_label = legacy::axes[current_selection].model_edit_i >= 0 ? (legacy::models[legacy::axes[current_selection].model_edit_i].label ? fmt::format("{} (#{})", *legacy::models[legacy::axes[current_selection].model_edit_i].label, legacy::axes[current_selection].model_edit_i) : fmt::format("Model #{}", legacy::axes[current_selection].model_edit_i)) : "None selected.";
+    const char *selected_model_label = legacy::axes[current_selection].model_edit_i >= 0 ? (legacy::models[legacy::axes[current_selection].model_edit_i].label ? ImFormat("{} (#{})", *legacy::models[legacy::axes[current_selection].model_edit_i].label, legacy::axes[current_selection].model_edit_i) : ImFormat("Model #{}", legacy::axes[current_selection].model_edit_i)) : "None selected.";
 
     // Display the combo box for selecting the curve model
-    if (ImGui::BeginCombo(fmt::format("##Axis{}CurveOptions", current_selection).data(), selected_model_label.data())) {
+    if (ImGui::BeginCombo(ImFormat("##Axis{}CurveOptions", current_selection), selected_model_label)) {
         for (int model_i = 0; model_i < legacy::models.size(); model_i++) {
-            std::string this_label = legacy::models[model_i].label ? fmt::format("{} (#{})", *legacy::models[model_i].label, model_i) : fmt::format("Model #{}", model_i);
-            if (model_i == legacy::axes[current_selection].curve_i)
-                this_label += " *";
-            if (ImGui::Selectable(this_label.data()))
+            const auto current_mark = model_i == legacy::axes[current_selection].curve_i ? " *" : "";
+            const auto this_label = legacy::models[model_i].label ? ImFormat("{} (#{}){}", *legacy::models[model_i].label, model_i, current_mark) : ImFormat("Model #{}{}", model_i, current_mark);
+            if (ImGui::Selectable(this_label))
                 legacy::axes[current_selection].model_edit_i = model_i;
         }
         ImGui::EndCombo();
@@ -1208,8 +1318,9 @@ if (ImGui::BeginChild(fmt::format("##Axis{}CurveWindow", current_selection).data
             legacy::models[legacy::axes[current_selection].model_edit_i].label = legacy::models[legacy::axes[current_selection].model_edit_i].label_buffer.data();
         }
 
-        // Create a vector of glm::dvec2 points for the model
-        std::vector<glm::dvec2> model;
+        // Create a vector of glm::dvec2 points for the model; reused between frames, so the plot doesn't allocate
+        static std::vector<glm::dvec2> model;
+        model.clear();
         for (auto& percent : legacy::models[legacy::axes[current_selection].model_edit_i].points) {
             model.push_back({
                 static_cast<double>(percent.x) / 100.0,
@@ -1232,7 +1343,7 @@ if (ImGui::BeginChild(fmt::format("##Axis{}CurveWindow", current_selection).data
 
         // Begin the child window for the right panel
         ImGui::SameLine();
-        if (ImGui::BeginChild(fmt::format("##Axis{}CurveWindowRightPanel", current_selection).data(), { ImGui::GetContentRegionAvail().x, ImGui::GetContentRegionAvail().y }, false)) {
+        if (ImGui::BeginChild(ImFormat("##Axis{}CurveWindowRightPanel", current_selection), { ImGui::GetContentRegionAvail().x, ImGui::GetContentRegionAvail().y }, false)) {
             ImGui::PushItemWidth(80);
 
             for (int i = 0; i < legacy::models[legacy::axes[current_selection].model_edit_i].points.size(); i++) {
@@ -1261,21 +1372,21 @@ if (ImGui::BeginChild(fmt::format("##Axis{}CurveWindow", current_selection).data
                 ImGui::SameLine();
 
                 // Button to decrease the y value of a point
-                if (ImGui::Button(fmt::format("{}##YM{}", ICON_FA_MINUS, i + 1).data()) && legacy::models[legacy::axes[current_selection].model_edit_i].points[i].y > 0) {
+                if (ImGui::Button(ImFormat("{}##YM{}", ICON_FA_MINUS, i + 1)) && legacy::models[legacy::axes[current_selection].model_edit_i].points[i].y > 0) {
                     legacy::models[legacy::axes[current_selection].model_edit_i].points[i].y--;
                 }
 
                 ImGui::SameLine();
 
                 // Button to increase the y value of a point
-                if (ImGui::Button(fmt::format("{}##YP{}", ICON_FA_PLUS, i + 1).data()) && legacy::models[legacy::axes[current_selection].model_edit_i].points[i].y < 100) {
+                if (ImGui::Button(ImFormat("{}##YP{}", ICON_FA_PLUS, i + 1)) && legacy::models[legacy::axes[current_selection].model_edit_i].points[i].y < 100) {
                     legacy::models[legacy::axes[current_selection].model_edit_i].points[i].y++;
                 }
 
                 ImGui::SameLine();
 
                 // Slider to adjust the y value of a point
-                if (ImGui::SliderInt(fmt::format("Y##{}", i + 1).data(), &legacy::models[legacy::axes[current_selection].model_edit_i].points[i].y, 0, 100)) {}
+                if (ImGui::SliderInt(ImFormat("Y##{}", i + 1), &legacy::models[legacy::axes[current_selection].model_edit_i].points[i].y, 0, 100)) {}
             }
 
             ImGui::PopItemWidth();
@@ -1312,16 +1423,16 @@ ImGui::EndTabBar();
     // Calculate window bounds
     pen.CalculateWindowBounds();
     // Get the centered position of the image
-    const auto image_pos = pen.GetCenteredPosition(GLMD_IM2(animation_scan.frames[animation_scan.frame_i]->size));
+    const auto image_pos = pen.GetCenteredPosition(GLMD_IM2(animation_scan.size));
     // Set the cursor screen position to the image position
     ImGui::SetCursorScreenPos(image_pos);
 
-    // Check if animation frames exist
-    if (animation_scan.frames.size()) {
+    // Check if the current animation frame is ready
+    if (const auto texture = animation_scan.texture(); texture) {
         // Display the image using ImGui::Image
         ImGui::Image(
-            reinterpret_cast<ImTextureID>(animation_scan.frames[animation_scan.frame_i]->handle),
-            GLMD_IM2(animation_scan.frames[animation_scan.frame_i]->size),
+            reinterpret_cast<ImTextureID>(texture->handle),
+            GLMD_IM2(animation_scan.size),
             { 0, 0 },
             { 1, 1 },
             { 1, 1, 1, animation_scan.playing ? 1 : 0.8f }
@@ -1334,12 +1445,10 @@ ImGui::EndTabItem();
 }
 
 // Begin a new tab item with the title "iRacing". The icon is set using a font awesome icon.
-if (ImGui::BeginTabItem(fmt::format("{} iRacing", ICON_FA_FLAG_CHECKERED).data())) {
+if (ImGui::BeginTabItem(IM_LABEL("{} iRacing", ICON_FA_FLAG_CHECKERED))) {
     
-    // Display the current status of the iRacing connection as text.
-    // The status is retrieved using the get_status() function from the iracing namespace.
-    // The status is converted to a string using the magic_enum::enum_name() function.
-    ImGui::Text(fmt::format("Status: {}", magic_enum::enum_name(iracing::get_status())).data());
+    // Display the iRacing telemetry and the session recorder.
+    gui::iracing::emit_content();
     
     // End the tab item.
     ImGui::EndTabItem();
@@ -1349,24 +1458,41 @@ if (ImGui::BeginTabItem(fmt::format("{} iRacing", ICON_FA_FLAG_CHECKERED).data()
 ImGui::EndTabBar();
 }
 
+static void open_url(const char *url) {
+#ifdef _WIN32
+    // Let the shell open the URL in the default browser
+    ShellExecuteA(0, 0, url, 0, 0, SW_SHOW);
+#else
+    // Hand the URL to the desktop's opener without waiting for it
+    std::system(fmt::format("xdg-open '{}' &", url).data());
+#endif
+}
+
+static void apply_legacy_support_result(const std::optional<std::string> &err) {
+    if (err) {
+        // Report why legacy support couldn't be enabled
+        legacy_support_error = true;
+        legacy_support_error_description = *err;
+    } else {
+        enable_legacy_support = true;
+    }
+}
+
 static void try_toggle_legacy_support() {
     if (enable_legacy_support) {
         // Disable legacy support
         legacy::disable();
         enable_legacy_support = false;
-    } else if (const auto err = legacy::enable(); err) {
-        // Enable legacy support and handle error if any
-        legacy_support_error = true;
-        legacy_support_error_description = *err;
     } else {
-        enable_legacy_support = true;
+        // Enable legacy support and handle error if any
+        apply_legacy_support_result(legacy::enable());
     }
 }
 
 static void emit_primary_window_menu_bar() {
     if (ImGui::BeginMenuBar()) {
-        if (ImGui::BeginMenu(fmt::format("{} File", ICON_FA_SAVE).data())) {
-            if (account_session_token && ImGui::Selectable(fmt::format("{} Logout", ICON_FA_UNDO).data())) {
+        if (ImGui::BeginMenu(IM_LABEL("{} File", ICON_FA_SAVE))) {
+            if (account_session_token && ImGui::Selectable(IM_LABEL("{} Logout", ICON_FA_UNDO))) {
                 // Reset account information and erase session data from config
                 account_email.reset();
                 account_session_token.reset();
@@ -1375,26 +1501,26 @@ static void emit_primary_window_menu_bar() {
                 cfg.erase("session_person_name");
                 cfg.erase("session_token");
             }
-            if (ImGui::Selectable(fmt::format("{} Save", ICON_FA_SAVE).data())) {
+            if (ImGui::Selectable(IM_LABEL("{} Save", ICON_FA_SAVE))) {
                 // Save configuration
                 cfg_save();
             }
             // Theme selection option (commented out)
-            // if (ImGui::Selectable(fmt::format("{} Theme", ICON_FA_PAINT_ROLLER).data()));
+            // if (ImGui::Selectable(IM_LABEL("{} Theme", ICON_FA_PAINT_ROLLER)));
 
-            if (ImGui::Selectable(fmt::format("{} Quit", ICON_FA_SKULL).data())) {
+            if (ImGui::Selectable(IM_LABEL("{} Quit", ICON_FA_SKULL))) {
                 // Set keep_running to false to exit the program
                 keep_running = false;
             }
             ImGui::EndMenu();
         }
         /*s
-        if (ImGui::BeginMenu(fmt::format("{} System", ICON_FA_CALCULATOR).data())) {
+        if (ImGui::BeginMenu(IM_LABEL("{} System", ICON_FA_CALCULATOR))) {
             if (!legacy_is_default) {
                 if (devices.size() || device_contexts.size()) {
                     for (auto &device : devices)
-                        ImGui::TextDisabled(fmt::format("{} {} {} (#{})", ICON_FA_MICROCHIP, device->org, device->name, device->serial).data());
-                    if (ImGui::Selectable(fmt::format("{} Release Hardware", ICON_FA_STOP).data())) {
+                        ImGui::TextDisabled(ImFormat("{} {} {} (#{})", ICON_FA_MICROCHIP, device->org, device->name, device->serial));
+                    if (ImGui::Selectable(IM_LABEL("{} Release Hardware", ICON_FA_STOP))) {
                         // Clear devices and device contexts
                         devices.clear();
                         device_contexts.clear();
@@ -1403,10 +1529,10 @@ static void emit_primary_window_menu_bar() {
                     ImGui::TextDisabled("No devices.");
                 }
             }
-            if (ImGui::Selectable(fmt::format("{} Clear System Calibrations", ICON_FA_ERASER).data())) {
+            if (ImGui::Selectable(IM_LABEL("{} Clear System Calibrations", ICON_FA_ERASER))) {
                 // Clear system calibrations (implementation not shown)
             }
-            if (!legacy_is_default && ImGui::Selectable(fmt::format("{} {} Legacy Support", ICON_FA_RECYCLE, enable_legacy_support ? "Disable" : "Enable").data())) {
+            if (!legacy_is_default && ImGui::Selectable(ImFormat("{} {} Legacy Support", ICON_FA_RECYCLE, enable_legacy_support ? "Disable" : "Enable"))) {
                 // Toggle legacy support
                 try_toggle_legacy_support();
             }
@@ -1415,9 +1541,9 @@ static void emit_primary_window_menu_bar() {
         */
 
         // Get Help button with tooltip
-        if (ImGui::SmallButton(fmt::format("{} Get Help", ICON_FA_HANDS_HELPING).data())) {
+        if (ImGui::SmallButton(IM_LABEL("{} Get Help", ICON_FA_HANDS_HELPING))) {
             // Open the Discord page for help
-            ShellExecuteA(0, 0, "https://discord.com/invite/4jNDqjyZnK", 0, 0, SW_SHOW);
+            open_url("https://discord.com/invite/4jNDqjyZnK");
         }
         if (ImGui::IsItemHovered()) {
             ImGui::BeginTooltip();
@@ -1440,8 +1566,8 @@ static void emit_legacy_hardware_enablement_error_popup(const glm::ivec2 &frameb
     if (ImGui::BeginPopupModal(legacy_is_default ? "Hardware Enablement Error" : "Legacy Hardware Enablement Error",
                                nullptr, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove)) {
         // Display the error message
-        ImGui::TextWrapped(fmt::format("{} support was unable to be activated. There are additional drivers required for this functionality. Make sure they're installed.",
-                                       legacy_is_default ? "Hardware" : "Legacy hardware").data());
+        ImGui::TextWrapped(ImFormat("{} support was unable to be activated. There are additional drivers required for this functionality. Make sure they're installed.",
+                                       legacy_is_default ? "Hardware" : "Legacy hardware"));
         ImGui::NewLine();
 
         {
@@ -1449,7 +1575,7 @@ static void emit_legacy_hardware_enablement_error_popup(const glm::ivec2 &frameb
             ImGui::SetCursorPos({ ImGui::GetCursorPos().x, ImGui::GetCursorPos().y + 2 });
 
             // Display the exclamation triangle icon
-            ImGui::Text(fmt::format("{}", ICON_FA_EXCLAMATION_TRIANGLE).data());
+            ImGui::Text(IM_LABEL("{}", ICON_FA_EXCLAMATION_TRIANGLE));
 
             ImGui::SameLine();
             ImGui::SetCursorPos({ ImGui::GetCursorPos().x, old_y });
@@ -1478,50 +1604,163 @@ static void emit_legacy_hardware_enablement_error_popup(const glm::ivec2 &frameb
     ImGui::PopStyleColor();
 }
 
-void sc::visor::gui::initialize() {
-    // Load settings from config file
-    if (const auto err = cfg_load(); err) {
-        spdlog::error("Unable to load settings: {}", *err);
-    } else if (cfg.find("session_token") != cfg.end() && cfg.find("session_person_name") != cfg.end() &&
-               cfg.find("session_email") != cfg.end()) {
-        // If session token and account information are found in the config, set them
-        account_session_token = cfg["session_token"];
-        account_person_name = cfg["session_person_name"];
-        account_email = cfg["session_email"];
-        should_verify_session_token = true;
-        spdlog::info("Stored session token: {} ({})", cfg["session_person_name"], cfg["session_token"]);
-
-        // Check the session token with the server
-        account_login_response = api::customer::check_session_token(account_email->data(), account_session_token->data());
-    }
+static void emit_startup_status(const glm::ivec2 &framebuffer_size) {
+    // Set the position and size of the primary window
+    ImGui::SetNextWindowPos({ 0, 0 }, ImGuiCond_Always);
+    ImGui::SetNextWindowSize({ static_cast<float>(framebuffer_size.x), static_cast<float>(framebuffer_size.y) }, ImGuiCond_Always);
 
-    // Prepare styling and load animations
-    prepare_styling();
-    load_animations();
+    if (ImGui::Begin("##StartupWindow", nullptr,
+                     ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoTitleBar)) {
+        ImGui::TextDisabled("Starting up...");
+        ImGui::Separator();
+
+        // List every startup task with its state
+        for (const auto &task : startup_tasks.snapshot()) {
+            switch (task.status) {
+                case sc::boot::task_graph::state::pending: ImGui::TextDisabled("%s", ImFormat("{} {}", ICON_FA_HOURGLASS_HALF, task.name)); break;
+                case sc::boot::task_graph::state::running: ImGui::TextUnformatted(ImFormat("{} {}", ICON_FA_SPINNER, task.name)); break;
+                case sc::boot::task_graph::state::done: ImGui::TextUnformatted(ImFormat("{} {}", ICON_FA_CHECK, task.name)); break;
+                case sc::boot::task_graph::state::failed: ImGui::TextUnformatted(ImFormat("{} {}: {}", ICON_FA_EXCLAMATION_TRIANGLE, task.name, task.error.value_or(""))); break; // The error may quote a file
+            }
+        }
+    }
+    ImGui::End();
+}
 
+void sc::visor::gui::initialize() {
     // Set animation loop options
     animation_scan.loop = true;
     animation_comm.loop = true;
 
-    // Toggle legacy support if it's the default option
+    // The tasks below run concurrently on the startup pool while the window already renders; nothing else touches
+    // the state they initialize until ready() has seen all of them finish.
+    startup_tasks.add("Settings", {}, []() -> std::optional<std::string> {
+        // Load settings from config file
+        if (const auto err = cfg_load(); err) {
+            spdlog::error("Unable to load settings: {}", *err);
+        } else if (cfg.find("session_token") != cfg.end() && cfg.find("session_person_name") != cfg.end() &&
+                   cfg.find("session_email") != cfg.end()) {
+            // If session token and account information are found in the config, set them
+            account_session_token = cfg["session_token"];
+            account_person_name = cfg["session_person_name"];
+            account_email = cfg["session_email"];
+            should_verify_session_token = true;
+            spdlog::info("Stored session token: {} ({})", cfg["session_person_name"], cfg["session_token"]);
+
+            // Check the session token with the server
+            account_login_response = api::customer::check_session_token(account_email->data(), account_session_token->data());
+        }
+        return std::nullopt;  // A missing settings file is a first start, not a failure
+    });
+    startup_tasks.add("Profiles", {}, []() -> std::optional<std::string> {
+        // Load the car/track profile rules
+        if (const auto err = profiles::load(); err) spdlog::debug("Unable to load profile rules: {}", *err);
+        return std::nullopt;  // Rules are optional
+    });
     if (legacy_is_default) {
-        try_toggle_legacy_support();
+        // Enable legacy support if it's the default option; the driver queries and ViGEm connect are the slowest part of startup
+        startup_tasks.add("Hardware support", {}, []() {
+            legacy_startup_error = legacy::enable();
+            return std::optional<std::string>(std::nullopt);  // Reported through the enablement error popup instead
+        });
     }
+    startup_tasks.start();
+}
+
+bool sc::visor::gui::ready() {
+    if (startup_applied) return true;
+    if (!startup_tasks.finished()) return false;
+
+    // Every startup task has finished, so its results can be taken over by the main thread
+    if (legacy_is_default) apply_legacy_support_result(legacy_startup_error);
+    startup_applied = true;
+    spdlog::info("Startup finished in {} ms.", std::chrono::duration_cast<std::chrono::milliseconds>(startup_tasks.elapsed()).count());
+    if (const auto err = startup_tasks.save_trace(startup_trace_file); err) spdlog::warn("Unable to save startup trace: {}", *err);
+    return true;
 }
 
 void sc::visor::gui::shutdown() {
+    // Let startup finish before tearing down what it initializes
+    startup_tasks.wait();
+
+    // Finish any recording or replay before the devices go away
+    gui::iracing::shutdown();
+
     // Clear device-related data and save settings to config file
     devices_future = { };
     devices.clear();
-    animation_scan.frames.clear();
-    animation_comm.frames.clear();
-    animation_under_construction.frames.clear();
-    if (const auto err = cfg_save(); err) {
+    animation_scan.player.reset();
+    animation_comm.player.reset();
+    animation_under_construction.player.reset();
+    cfg_save();
+    if (const auto err = file::writer::shared().flush(); err) {  // Wait for every queued save, so nothing is lost at exit
         spdlog::error("Unable to save settings: {}", *err);
     }
 }
 
+void sc::visor::gui::show() {
+    // Prepare styling and load animations for the new ImGui context
+    ImPlot::CreateContext();
+    prepare_styling();
+    load_animations();
+}
+
+void sc::visor::gui::hide() {
+    // Release the animation players and their textures; they are prepared again the next time the UI comes up
+    for (auto instance : { &animation_scan, &animation_comm, &animation_under_construction }) {
+        instance->player.reset();
+        instance->frame_i = 0;
+    }
+
+    // Popups are opened again in the next ImGui context
+    for (auto &e : popups) e.launched = false;
+
+    // The plot context goes with the ImGui context
+    ImPlot::DestroyContext();
+
+    // Release the curve shader while the GL context is still current; it is built again when a curve is next drawn
+    ImCurve::Shutdown();
+}
+
+void sc::visor::gui::update() {
+    // The services' state belongs to the startup tasks until they finish
+    if (!ready()) return;
+
+    // Poll devices
+    poll_devices();
+
+    // Report saves that failed in the background
+    if (const auto err = file::writer::shared().error(); err) spdlog::error("Unable to save settings: {}", *err);
+
+    // Hand the pedals and telemetry back to the hardware once a replay has run out
+    gui::iracing::update();
+
+    // Sync profile rules with the signed-in account, then switch pedal profiles when the iRacing session changes
+    profiles::set_account(account_email, account_session_token);
+    profiles::update(device_contexts);
+
+    // Feed the corner analytics, whether or not the coaching tab is visible
+    gui::coaching::update(device_contexts);
+}
+
+void sc::visor::gui::attach(std::shared_ptr<device_context> context) {
+    // Show the context next to the ones the device scan created; it is only updated if it has a handle
+    device_contexts.push_back(std::move(context));
+}
+
 void sc::visor::gui::emit(const glm::ivec2 &framebuffer_size, bool *const force_redraw) {
+    if (!first_frame_marked) {
+        // Record when the first frame was built, relative to the startup tasks
+        startup_tasks.mark("First frame");
+        first_frame_marked = true;
+    }
+
+    if (!ready()) {
+        // Show which subsystems are still starting until all of them are
+        emit_startup_status(framebuffer_size);
+        return;
+    }
+
     // Clean up any existing popups
     popups_cleanup();
 
@@ -1559,7 +1798,4 @@ void sc::visor::gui::emit(const glm::ivec2 &framebuffer_size, bool *const force_
         ImGui::OpenPopup(legacy_is_default ? "Hardware Enablement Error" : "Legacy Hardware Enablement Error");
         legacy_support_error = false;
     }
-
-    // Poll devices
-    poll_devices();
 }
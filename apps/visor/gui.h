@@ -6,6 +6,12 @@
 #include <string_view> // Include the string_view header
 #include <functional> // Include the functional header
 #include <optional> // Include the optional header
+#include <memory> // Include the memory header
+
+namespace sc::visor {
+
+    struct device_context; // Forward declaration of the device context, defined in device_context.h
+}
 
 namespace sc::visor::gui {
 
@@ -18,8 +24,13 @@ namespace sc::visor::gui {
         void launch(); // Declare a member function named "launch" that launches the popup
     };
 
-    void initialize(); // Declare a global function named "initialize" that initializes the GUI
+    void initialize(); // Declare a global function named "initialize" that initializes the GUI's services; needs no ImGui context
     void shutdown(); // Declare a global function named "shutdown" that shuts down the GUI
+    void show(); // Declare a global function named "show" that prepares styling and textures for a newly created ImGui context
+    void hide(); // Declare a global function named "hide" that releases everything "show" prepared, before the ImGui context goes away
+    bool ready(); // Declare a global function named "ready" that tells whether the startup tasks have finished and their results were taken over
+    void attach(std::shared_ptr<device_context> context); // Declare a global function named "attach" that adds a device context the device scan didn't find, such as a simulated one
+    void update(); // Declare a global function named "update" that runs the device, profile and analytics services, with or without a UI
     void emit(const glm::ivec2 &framebuffer_size, bool *const force_redraw = nullptr);
     // Declare a global function named "emit" that takes the framebuffer size as a glm::ivec2 reference and an optional pointer to a bool, and triggers an event
 }
@@ -18,12 +18,17 @@
 #include "bezier.h" // Include the "bezier.h" header
 
 #include "../../libs/file/file.h" // Include the file library's header
+#include "../../libs/recorder/recorder.h" // Include the recorder library's header
+#include "../../libs/boot/wakeup.h" // Include the main loop wakeup header
+
+#include <mutex> // Include the <mutex> header
 
 #undef min // Undefine the min macro
 #undef max // Undefine the max macro
 
 std::array<sc::visor::legacy::axis_info, 4> sc::visor::legacy::axes; // Define an array of axis_info structs with a size of 4
 std::array<sc::visor::legacy::model, 5> sc::visor::legacy::models; // Define an array of model structs with a size of 5
+std::array<sc::visor::pedal_trace, 4> sc::visor::legacy::traces; // Define the axis histories the UI plots
 
 namespace sc::visor::legacy {
 
@@ -94,6 +99,66 @@ namespace sc::visor::legacy {
 
         return std::nullopt;
     }
+
+    static std::shared_ptr<const profiles::pedal_settings> pending_settings; // Only accessed through std::atomic_store/std::atomic_exchange
+
+    static void take_pending_settings() {
+        const auto settings = std::atomic_exchange(&pending_settings, std::shared_ptr<const profiles::pedal_settings>());
+        if (!settings) return;
+        for (int i = 0; i < axes.size(); i++) {
+            const auto &axis = settings->axes[i];
+            if (axis.min) axes[i].output_steps_min = *axis.min; // Apply the minimum output steps for the axis
+            if (axis.max) axes[i].output_steps_max = *axis.max; // Apply the maximum output steps for the axis
+            if (axis.deadzone) axes[i].deadzone = *axis.deadzone; // Apply the deadzone value for the axis
+            if (axis.limit) axes[i].output_limit = *axis.limit; // Apply the output limit value for the axis
+            if (axis.curve_i && *axis.curve_i >= -1 && *axis.curve_i < static_cast<int>(models.size())) axes[i].curve_i = axes[i].model_edit_i = *axis.curve_i; // Apply the curve index for the axis
+        }
+        for (int i = 0; i < models.size(); i++) {
+            if (settings->models[i]) models[i].points = *settings->models[i]; // Apply the points of the model
+        }
+    }
+
+    static std::mutex replay_mutex; // Guards "replay_inputs"
+    static std::optional<std::array<float, 4>> replay_inputs; // Recorded inputs set by the replay thread
+
+    static void process_axis(const int &j, float value) {
+        axes[j].present = true; // Set the axis as present
+
+        axes[j].input_raw = value; // Set the raw input value
+
+        axes[j].input_steps = glm::round(value * 1000.f); // Convert input value to steps
+
+        auto max_input = axes[j].output_steps_max / 1000.f; // Calculate the maximum input value
+        auto min_input = (axes[j].output_steps_min + ((axes[j].output_steps_max - axes[j].output_steps_min) * (axes[j].deadzone / 100.f))) / 1000.f; // Calculate the minimum input value with deadzone
+
+        if (min_input > max_input) min_input = max_input;
+
+        value -= min_input; // Adjust value based on minimum input
+        value *= 1.f / (max_input - min_input); // Scale value based on input range
+        value = glm::min(1.f, glm::max(0.f, value)); // Clamp value between 0 and 1
+
+        if (axes[j].curve_i >= 0) { // Check if a curve is assigned to the axis
+            std::vector<glm::dvec2> model;
+            for (auto &percent : legacy::models[axes[j].curve_i].points) {
+                model.push_back({
+                    static_cast<double>(percent.x) / 100.0,
+                    static_cast<double>(percent.y) / 100.0
+                });
+            }
+            value = bezier::calculate(model, value).y; // Apply bezier curve transformation to the value
+        }
+
+        value = glm::min(value, axes[j].output_limit / 100.f); // Clamp value based on the output limit
+
+        if (vigem_gamepad_report) {
+            if (j == 0) vigem_gamepad_report->bThumbLX = 127 + glm::round(128 * value); // Set the gamepad report's thumbstick LX value
+            else if (j == 1) vigem_gamepad_report->bThumbLY = 127 + glm::round(128 * value); // Set the gamepad report's thumbstick LY value
+            else if (j == 2) vigem_gamepad_report->bThumbRX = 127 + glm::round(128 * value); // Set the gamepad report's thumbstick RX value
+            else if (j == 3) vigem_gamepad_report->bThumbRY = 127 + glm::round(128 * value); // Set the gamepad report's thumbstick RY value
+        }
+
+        axes[j].output = value; // Set the output value for the axis
+    }
 }
 
 // Enable the legacy support
@@ -159,14 +224,22 @@ void sc::visor::legacy::disable() {
 }
 
 std::optional<std::string> sc::visor::legacy::process() {
+    take_pending_settings(); // A profile switch lands between two passes, never in the middle of one
+
     for (auto &axis : axes) {
         axis.present = false;
         axis.input_raw = 0.f;
     }
 
-    if (!vigem_client || !vigem_gamepad) return std::nullopt; // Check if ViGEm client and gamepad are valid
+    std::optional<std::array<float, 4>> replayed; // Recorded inputs that replace the hardware while a replay is running
+    {
+        std::lock_guard guard(replay_mutex);
+        replayed = replay_inputs;
+    }
+
+    if ((!vigem_client || !vigem_gamepad) && !replayed) return std::nullopt; // Check if ViGEm client and gamepad are valid
 
-    if (!vigem_gamepad_report) {
+    if (vigem_gamepad && !vigem_gamepad_report) {
         vigem_gamepad_report = DS4_REPORT();
         DS4_REPORT_INIT(&*vigem_gamepad_report);
         vigem_gamepad_report->bThumbLX = 128;
@@ -180,63 +253,64 @@ std::optional<std::string> sc::visor::legacy::process() {
 
     found_legacy_hardware = false;
 
-    for (int i = 0; i < GLFW_JOYSTICK_LAST; i++) {
-        if (!glfwJoystickPresent(i)) continue; // Check if the joystick is present
-
-        if (strcmp("Sim Coaches P1 Pro Pedals", glfwGetJoystickName(i)) != 0) continue; // Check if the joystick is "Sim Coaches P1 Pro Pedals"
-
-        int num_axes;
-        const auto inputs = glfwGetJoystickAxes(i, &num_axes); // Get the joystick axes
-
-        if (!inputs) continue;
+    if (replayed) {
+        for (int j = 0; j < axes.size(); j++) process_axis(j, (*replayed)[j]); // Run the recorded inputs through the same pipeline
+        found_legacy_hardware = true;
+    } else {
+        for (int i = 0; i < GLFW_JOYSTICK_LAST; i++) {
+            if (!glfwJoystickPresent(i)) continue; // Check if the joystick is present
 
-        for (int j = 0; j < glm::min(num_axes, static_cast<int>(axes.size())); j++) {
-            axes[j].present = true; // Set the axis as present
-            float value = glm::max(0.f, glm::min(1.f, (inputs[j] + 1.f) * .5f)); // Normalize the axis value
+            if (strcmp("Sim Coaches P1 Pro Pedals", glfwGetJoystickName(i)) != 0) continue; // Check if the joystick is "Sim Coaches P1 Pro Pedals"
 
-            axes[j].input_raw = value; // Set the raw input value
+            int num_axes;
+            const auto inputs = glfwGetJoystickAxes(i, &num_axes); // Get the joystick axes
 
-            axes[j].input_steps = glm::round(value * 1000.f); // Convert input value to steps
+            if (!inputs) continue;
 
-            auto max_input = axes[j].output_steps_max / 1000.f; // Calculate the maximum input value
-            auto min_input = (axes[j].output_steps_min + ((axes[j].output_steps_max - axes[j].output_steps_min) * (axes[j].deadzone / 100.f))) / 1000.f; // Calculate the minimum input value with deadzone
+            for (int j = 0; j < glm::min(num_axes, static_cast<int>(axes.size())); j++) {
+                process_axis(j, glm::max(0.f, glm::min(1.f, (inputs[j] + 1.f) * .5f))); // Normalize the axis value and run it through the pipeline
+            }
 
-            if (min_input > max_input) min_input = max_input;
+            found_legacy_hardware = true;
+            break;
+        }
+    }
 
-            value -= min_input; // Adjust value based on minimum input
-            value *= 1.f / (max_input - min_input); // Scale value based on input range
-            value = glm::min(1.f, glm::max(0.f, value)); // Clamp value between 0 and 1
+    if (found_legacy_hardware) {
+        const auto now_us = recorder::now_us();
+        for (int j = 0; j < axes.size(); j++) traces[j].push(now_us, axes[j].input_raw, axes[j].output); // Extend the axis histories the UI plots
 
-            if (axes[j].curve_i >= 0) { // Check if a curve is assigned to the axis
-                std::vector<glm::dvec2> model;
-                for (auto &percent : legacy::models[axes[j].curve_i].points) {
-                    model.push_back({
-                        static_cast<double>(percent.x) / 100.0,
-                        static_cast<double>(percent.y) / 100.0
-                    });
-                }
-                value = bezier::calculate(model, value).y; // Apply bezier curve transformation to the value
-            }
+        sc::boot::schedule(); // Joysticks don't produce events, so keep the loop polling while the pedals are present
+    }
 
-            value = glm::min(value, axes[j].output_limit / 100.f); // Clamp value based on the output limit
+    if (vigem_client && vigem_gamepad) vigem_target_ds4_update(*vigem_client, *vigem_gamepad, *vigem_gamepad_report); // Update the ViGEm gamepad with the gamepad report
 
-            if (j == 0) vigem_gamepad_report->bThumbLX = 127 + glm::round(128 * value); // Set the gamepad report's thumbstick LX value
-            else if (j == 1) vigem_gamepad_report->bThumbLY = 127 + glm::round(128 * value); // Set the gamepad report's thumbstick LY value
-            else if (j == 2) vigem_gamepad_report->bThumbRX = 127 + glm::round(128 * value); // Set the gamepad report's thumbstick RX value
-            else if (j == 3) vigem_gamepad_report->bThumbRY = 127 + glm::round(128 * value); // Set the gamepad report's thumbstick RY value
-
-            axes[j].output = value; // Set the output value for the axis
+    if (found_legacy_hardware && recorder::recording()) { // Record the pipeline's inputs and outputs
+        recorder::sample value;
+        value.timestamp_us = recorder::now_us();
+        value.source = recorder::source::pedals_legacy;
+        for (int j = 0; j < axes.size(); j++) {
+            value.input[j] = axes[j].input_raw;
+            value.output[j] = axes[j].output;
         }
-
-        found_legacy_hardware = true;
-        break;
+        recorder::push(value);
     }
 
-    vigem_target_ds4_update(*vigem_client, *vigem_gamepad, *vigem_gamepad_report); // Update the ViGEm gamepad with the gamepad report
-
     return std::nullopt;
 }
 
+void sc::visor::legacy::apply_settings(std::shared_ptr<const profiles::pedal_settings> settings) {
+    std::atomic_store(&pending_settings, std::move(settings));
+}
+
+void sc::visor::legacy::replay(const std::optional<std::array<float, 4>> &inputs) {
+    {
+        std::lock_guard guard(replay_mutex);
+        replay_inputs = inputs;
+    }
+    sc::boot::wakeup();
+}
+
 bool sc::visor::legacy::present() {
     return found_legacy_hardware; // Return whether legacy hardware is present
 }
@@ -283,11 +357,13 @@ std::optional<std::string> sc::visor::legacy::save_settings() {
 
     doc["models"] = models_doc;
 
-    auto doc_content = doc.dump(4); // Serialize the JSON document with indentation
-    std::vector<std::byte> doc_data;
-    doc_data.resize(doc_content.size());
-    memcpy(doc_data.data(), doc_content.data(), glm::min(doc_data.size(), doc_content.size()));
-    if (const auto err = file::save("virtual-pedals.json", doc_data); err) return *err; // Save the document to a file
+    file::writer::shared().save("virtual-pedals.json", [doc = std::move(doc)]() { // The document is the snapshot; serializing and writing happen in the background
+        auto doc_content = doc.dump(4); // Serialize the JSON document with indentation
+        std::vector<std::byte> doc_data;
+        doc_data.resize(doc_content.size());
+        memcpy(doc_data.data(), doc_content.data(), glm::min(doc_data.size(), doc_content.size()));
+        return doc_data;
+    });
 
     return std::nullopt;
 }
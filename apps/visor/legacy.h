@@ -5,9 +5,13 @@
 #include <optional> // Include the optional header
 #include <cstdint> // Include the cstdint header
 #include <limits> // Include the limits header
+#include <memory> // Include the memory header
 
 #include <glm/vec2.hpp> // Include the glm/vec2 header
 
+#include "profiles.h" // Include the profiles header
+#include "pedal_trace.h" // Include the pedal trace header
+
 namespace sc::visor::legacy {
 
     // Structure to store information about an axis
@@ -45,6 +49,7 @@ namespace sc::visor::legacy {
 
     extern std::array<axis_info, 4> axes; // Array of axis_info structs
     extern std::array<model, 5> models; // Array of model structs
+    extern std::array<pedal_trace, 4> traces; // Input/output history of each axis, written by process()
 
     extern std::optional<int> axis_i_throttle; // Optional index of the throttle axis
     extern std::optional<int> axis_i_brake; // Optional index of the brake axis
@@ -54,7 +59,10 @@ namespace sc::visor::legacy {
     void disable(); // Function to disable legacy support
     std::optional<std::string> process(); // Function to process legacy inputs
     bool present(); // Function to check if legacy hardware is present
+    void replay(const std::optional<std::array<float, 4>> &inputs); // Function to replace the hardware inputs with recorded ones, or return to the hardware when empty
+
+    void apply_settings(std::shared_ptr<const profiles::pedal_settings> settings); // Function to swap in profile settings; taken over as a whole by the next process()
 
     std::optional<std::string> load_settings(); // Function to load legacy settings
-    std::optional<std::string> save_settings(); // Function to save legacy settings
+    std::optional<std::string> save_settings(); // Function to save legacy settings; written in the background by file::writer
 }
@@ -6,6 +6,7 @@
 #define SC_FEATURE_ENHANCED_FONTS // Enable the enhanced fonts feature
 #define SC_FEATURE_RENDER_ON_RESIZE // Enable the render on resize feature
 #define SC_FEATURE_SYSTEM_TRAY // Enable the system tray feature
+#define SC_FEATURE_HEADLESS_BACKGROUND // Enable the headless background feature; no ImGui context exists while the window is hidden
 #define SC_FEATURE_CENTER_WINDOW // Enable the center window feature
 
 #define SC_VIEW_INIT_W 728 // Define the initial width of the view
@@ -40,9 +41,10 @@ static tl::expected<bool, std::string> sc::boot::on_fixed_update() {
     return true; // Return true to continue execution
 }
 
-// Function called during update
-static tl::expected<bool, std::string> sc::boot::on_update(const glm::ivec2 &framebuffer_size, bool *const force_redraw) {
-    visor::gui::emit(framebuffer_size, force_redraw); // Emit GUI events passing framebuffer size and force_redraw flag
+// Function that runs the device, virtual pedal and telemetry services, with or without a UI
+static tl::expected<bool, std::string> update_services() {
+    if (!visor::gui::ready()) return visor::keep_running; // Startup tasks still own the services' state
+    visor::gui::update(); // Poll devices and feed profiles and analytics
     if (const auto err = visor::legacy::process(); err) { // Process legacy support and check for errors
         sc::visor::legacy_support_error = true; // Set the legacy support error flag
         sc::visor::legacy_support_error_description = *err; // Set the legacy support error description
@@ -50,6 +52,28 @@ static tl::expected<bool, std::string> sc::boot::on_update(const glm::ivec2 &fra
     return visor::keep_running; // Return the value of keep_running flag
 }
 
+// Function called during update
+static tl::expected<bool, std::string> sc::boot::on_update(const glm::ivec2 &framebuffer_size, bool *const force_redraw) {
+    visor::gui::emit(framebuffer_size, force_redraw); // Emit GUI events passing framebuffer size and force_redraw flag
+    return update_services(); // Run the services after the UI
+}
+
+// Function called instead of on_update while the window is hidden
+static tl::expected<bool, std::string> sc::boot::on_service_update() {
+    return update_services(); // Run the services without building a frame
+}
+
+// Function called after the ImGui context was created
+static std::optional<std::string> sc::boot::on_ui_startup() {
+    visor::gui::show(); // Prepare styling and textures
+    return std::nullopt; // Return no error
+}
+
+// Function called before the ImGui context is destroyed
+static void sc::boot::on_ui_shutdown() {
+    visor::gui::hide(); // Release textures
+}
+
 // Function called during application shutdown
 static void sc::boot::on_shutdown() {
     visor::gui::shutdown(); // Shutdown the GUI module
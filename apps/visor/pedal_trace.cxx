@@ -0,0 +1,72 @@
+#include "pedal_trace.h" // Include the pedal trace header
+
+void sc::visor::pedal_trace::push(const int64_t &timestamp_us, const float &input, const float &output) {
+    const auto n = head.load(std::memory_order_relaxed);
+    auto &slot = slots[n & (capacity - 1)];
+    slot.timestamp_us.store(timestamp_us, std::memory_order_relaxed);
+    slot.input.store(input, std::memory_order_relaxed);
+    slot.output.store(output, std::memory_order_relaxed);
+    head.store(n + 1, std::memory_order_release); // Publishes the slot
+}
+
+void sc::visor::pedal_trace::downsample(const int64_t &now_us, const double &seconds, const size_t &max_points, series &input, series &output) const {
+    input.time.clear();
+    input.value.clear();
+    output.time.clear();
+    output.value.clear();
+
+    const auto published = head.load(std::memory_order_acquire);
+    const auto timestamp_us = [this](const uint64_t &n) { return slots[n & (capacity - 1)].timestamp_us.load(std::memory_order_relaxed); };
+
+    // Binary search for the first sample in the window; the ring is ordered by time
+    const auto from_us = now_us - static_cast<int64_t>(seconds * 1e6);
+    auto begin = published > capacity - margin ? published - (capacity - margin) : 0;
+    for (auto end = published; begin < end;) {
+        const auto mid = begin + ((end - begin) / 2);
+        if (timestamp_us(mid) < from_us) begin = mid + 1;
+        else end = mid;
+    }
+    const auto n = static_cast<size_t>(published - begin);
+    if (!n) return;
+
+    const auto time = [&](const size_t &i) { return static_cast<double>(timestamp_us(begin + i) - now_us); }; // Microseconds; LTTB only compares areas, so the unit doesn't matter
+    const auto reduce = [&](const std::atomic<float> slot::*member, series &line) {
+        const auto value = [&](const size_t &i) { return (slots[(begin + i) & (capacity - 1)].*member).load(std::memory_order_relaxed); };
+        lttb(n, max_points, time, value, [&](const size_t &i) {
+            line.time.push_back(static_cast<float>(time(i) / 1e6));
+            line.value.push_back(value(i));
+        });
+    };
+    reduce(&slot::input, input);
+    reduce(&slot::output, output);
+
+    // The writer only gets near what was read after pushing "margin" samples in the meantime; if it did, the lines may mix old and new samples
+    if (head.load(std::memory_order_acquire) - begin >= capacity) { // At "capacity", the slot of "begin" may be being rewritten
+        input.time.clear();
+        input.value.clear();
+        output.time.clear();
+        output.value.clear();
+    }
+}
+
+std::optional<float> sc::visor::pedal_trace::output_at(const int64_t &timestamp_us, const int64_t &max_age_us, uint64_t &cursor) const {
+    const auto published = head.load(std::memory_order_acquire);
+    if (!published) return std::nullopt;
+    const auto timestamp = [this](const uint64_t &n) { return slots[n & (capacity - 1)].timestamp_us.load(std::memory_order_relaxed); };
+
+    // Skip what the writer is about to rewrite, then step to the last sample at or before the timestamp
+    const auto oldest = published > capacity - margin ? published - (capacity - margin) : 0;
+    cursor = std::clamp(cursor, oldest, published - 1);
+    while (cursor + 1 < published && timestamp(cursor + 1) <= timestamp_us) cursor++;
+    const auto found_us = timestamp(cursor);
+    if (found_us > timestamp_us || timestamp_us - found_us > max_age_us) return std::nullopt;
+    const auto value = slots[cursor & (capacity - 1)].output.load(std::memory_order_relaxed);
+
+    // As in downsample(), a writer that got to the slot meanwhile makes the value unreliable
+    if (head.load(std::memory_order_acquire) - cursor >= capacity) return std::nullopt;
+    return value;
+}
+
+uint64_t sc::visor::pedal_trace::size() const {
+    return head.load(std::memory_order_acquire);
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <algorithm> // Include the algorithm header
+#include <array> // Include the array header
+#include <atomic> // Include the atomic header
+#include <cmath> // Include the cmath header
+#include <cstdint> // Include the cstdint header
+#include <optional> // Include the optional header
+#include <vector> // Include the vector header
+
+namespace sc::visor {
+
+    // Scrolling input/output history of one pedal axis.
+    // A fixed ring with one writer, the I/O thread, and one reader, the UI. The writer never waits; the reader stays
+    // "margin" samples clear of the slots being rewritten, and throws away what it read if the writer lapped it anyway.
+    struct pedal_trace {
+
+        static constexpr size_t capacity = 1 << 16; // Samples kept, about 65 seconds at 1 kHz
+        static constexpr size_t margin = 1 << 10; // Oldest samples the reader leaves alone
+
+        struct series { // A downsampled line, with times in seconds relative to "now"
+
+            std::vector<float> time, value;
+        };
+
+        // Appends a sample; timestamps come from recorder::now_us() and never go backwards. Only one thread may call this.
+        void push(const int64_t &timestamp_us, const float &input, const float &output);
+
+        // Downsamples the samples of the last "seconds" up to "now_us" to at most "max_points" per line, while push() may be running.
+        void downsample(const int64_t &now_us, const double &seconds, const size_t &max_points, series &input, series &output) const;
+
+        // The output at "timestamp_us": the last sample at or before it, found by reading on from "cursor", which the
+        // caller keeps between calls with rising timestamps, so each call costs O(1) amortized. Nothing if there is no
+        // sample from within "max_age_us" before it, or the sample was overwritten while it was read.
+        std::optional<float> output_at(const int64_t &timestamp_us, const int64_t &max_age_us, uint64_t &cursor) const;
+
+        // Number of samples pushed so far.
+        uint64_t size() const;
+
+    private:
+
+        struct slot {
+
+            std::atomic<int64_t> timestamp_us = 0;
+            std::atomic<float> input = 0, output = 0;
+        };
+
+        std::array<slot, capacity> slots;
+        std::atomic<uint64_t> head = 0;
+    };
+
+    // Largest-Triangle-Three-Buckets: keeps the first and last of "n" points, and from each of "threshold - 2" buckets in
+    // between the point forming the largest triangle with the previously kept point and the average of the next bucket.
+    // Spikes survive, unlike with decimation or averaging. "x(i)" and "y(i)" read point i; "keep(i)" gets the kept indices in order.
+    template<typename X, typename Y, typename Keep> void lttb(const size_t &n, const size_t &threshold, X x, Y y, Keep keep) {
+        if (threshold >= n || threshold < 3) {
+            for (size_t i = 0; i < n; i++) keep(i);
+            return;
+        }
+        const auto every = static_cast<double>(n - 2) / static_cast<double>(threshold - 2); // Bucket size; the first and last points are buckets of their own
+        size_t a = 0;
+        keep(a);
+        for (size_t bucket_i = 0; bucket_i < threshold - 2; bucket_i++) {
+            const auto next_begin = static_cast<size_t>(std::floor((bucket_i + 1) * every)) + 1;
+            const auto next_end = std::min(static_cast<size_t>(std::floor((bucket_i + 2) * every)) + 1, n);
+            double avg_x = 0, avg_y = 0;
+            for (auto i = next_begin; i < next_end; i++) {
+                avg_x += x(i);
+                avg_y += y(i);
+            }
+            avg_x /= static_cast<double>(next_end - next_begin);
+            avg_y /= static_cast<double>(next_end - next_begin);
+
+            const auto a_x = static_cast<double>(x(a)), a_y = static_cast<double>(y(a));
+            const auto begin = static_cast<size_t>(std::floor(bucket_i * every)) + 1;
+            double max_area = -1;
+            auto max_i = begin;
+            for (auto i = begin; i < next_begin; i++) {
+                const auto area = std::abs(((a_x - avg_x) * (y(i) - a_y)) - ((a_x - x(i)) * (avg_y - a_y))); // Twice the triangle's area
+                if (area <= max_area) continue;
+                max_area = area;
+                max_i = i;
+            }
+            keep(max_i);
+            a = max_i;
+        }
+        keep(n - 1);
+    }
+}
@@ -0,0 +1,235 @@
+#include "profile_store.h" // Include the "profile_store.h" header file
+
+#include <algorithm> // Include the <algorithm> header
+#include <cstring> // Include the <cstring> header
+#include <numeric> // Include the <numeric> header
+
+static_assert(sizeof(sc::visor::profiles::format::header) == 32, "The store layout changed; bump format::file_version");
+static_assert(sizeof(sc::visor::profiles::format::rule_record) == 1120, "The store layout changed; bump format::file_version");
+
+namespace sc::visor::profiles {
+
+    static char lower(const char &c) {
+        return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c; // ASCII only, as pystring::lower
+    }
+
+    // Function to order strings ignoring ASCII case
+    static int compare_ci(const std::string_view &a, const std::string_view &b) {
+        for (size_t i = 0; i < std::min(a.size(), b.size()); i++) {
+            const auto ca = static_cast<unsigned char>(lower(a[i])), cb = static_cast<unsigned char>(lower(b[i]));
+            if (ca != cb) return ca < cb ? -1 : 1;
+        }
+        return a.size() == b.size() ? 0 : (a.size() < b.size() ? -1 : 1);
+    }
+
+    // What the car and track index is sorted by: rules without a car come first, then by car, the same again for the track
+    struct match_key {
+
+        bool has_car;
+        std::string_view car;
+        bool has_track;
+        std::string_view track;
+
+        static match_key of(const format::rule_record &record) {
+            return { (record.flags & format::has_car) != 0, store::field(record.car), (record.flags & format::has_track) != 0, store::field(record.track) };
+        }
+
+        int compare(const match_key &other) const {
+            if (has_car != other.has_car) return has_car ? 1 : -1;
+            if (const auto res = compare_ci(car, other.car); res) return res;
+            if (has_track != other.has_track) return has_track ? 1 : -1;
+            return compare_ci(track, other.track);
+        }
+    };
+
+    // Function to copy a string into a fixed-size field, cut at a character boundary if it doesn't fit
+    template<size_t N> static void put(std::array<char, N> &target, const std::string_view &value) {
+        auto size = std::min(value.size(), N);
+        if (size < value.size()) while (size > 0 && (static_cast<unsigned char>(value[size]) & 0xC0) == 0x80) size--; // Don't split a UTF-8 sequence
+        std::memcpy(target.data(), value.data(), size);
+    }
+
+    static format::settings_record to_record(const pedal_settings &settings) {
+        format::settings_record record;
+        for (size_t i = 0; i < settings.axes.size(); i++) {
+            const auto &axis = settings.axes[i];
+            auto &axis_record = record.axes[i];
+            const std::array<std::pair<const std::optional<int> *, int32_t *>, 5> members = { {
+                { &axis.min, &axis_record.min }, { &axis.max, &axis_record.max }, { &axis.deadzone, &axis_record.deadzone }, { &axis.limit, &axis_record.limit }, { &axis.curve_i, &axis_record.curve_i },
+            } };
+            for (size_t j = 0; j < members.size(); j++) {
+                if (!*members[j].first) continue;
+                *members[j].second = **members[j].first;
+                axis_record.present |= 1u << j;
+            }
+        }
+        for (size_t i = 0; i < settings.models.size(); i++) {
+            if (!settings.models[i]) continue;
+            for (size_t j = 0; j < settings.models[i]->size(); j++) record.models[i][j] = { (*settings.models[i])[j].x, (*settings.models[i])[j].y };
+            record.models_present |= 1u << i;
+        }
+        return record;
+    }
+
+    // FNV-1a over 32-bit words rather than bytes, so checking a store at startup stays well under a millisecond; every part
+    // of a store is a multiple of four bytes long
+    static uint32_t checksum(const std::byte *data, const size_t &size) {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i + 4 <= size; i += 4) {
+            uint32_t word;
+            std::memcpy(&word, data + i, sizeof(word));
+            hash = (hash ^ word) * 16777619u;
+        }
+        return hash;
+    }
+}
+
+tl::expected<std::shared_ptr<const sc::visor::profiles::store>, std::string> sc::visor::profiles::store::open(const std::filesystem::path &path) {
+    auto map_res = file::mapping::open(path);
+    if (!map_res.has_value()) return tl::make_unexpected(map_res.error());
+    auto res = std::make_shared<store>();
+    res->bytes = std::move(*map_res);
+    if (!res->index()) return tl::make_unexpected("Not a profile store, or one of another version.");
+    return res;
+}
+
+std::shared_ptr<const sc::visor::profiles::store> sc::visor::profiles::store::build(const std::vector<rule> &rules) {
+    std::vector<format::rule_record> records(rules.size());
+    for (size_t i = 0; i < rules.size(); i++) {
+        const auto &entry = rules[i];
+        auto &record = records[i];
+        put(record.id, entry.id);
+        put(record.name, entry.name);
+        if (entry.car) {
+            put(record.car, *entry.car);
+            record.flags |= format::has_car;
+        }
+        if (entry.track) {
+            put(record.track, *entry.track);
+            record.flags |= format::has_track;
+        }
+        if (entry.legacy) {
+            record.legacy = to_record(*entry.legacy);
+            record.flags |= format::has_legacy;
+        }
+        if (entry.mk4) {
+            record.mk4 = to_record(*entry.mk4);
+            record.flags |= format::has_mk4;
+        }
+    }
+
+    // Equal keys stay in rule order, so ties go to the earlier rule
+    std::vector<uint32_t> by_id(records.size()), by_name(records.size()), by_match(records.size());
+    for (auto *index : { &by_id, &by_name, &by_match }) std::iota(index->begin(), index->end(), 0u);
+    std::stable_sort(by_id.begin(), by_id.end(), [&](const uint32_t &a, const uint32_t &b) { return field(records[a].id) < field(records[b].id); });
+    std::stable_sort(by_name.begin(), by_name.end(), [&](const uint32_t &a, const uint32_t &b) { return field(records[a].name) < field(records[b].name); });
+    std::stable_sort(by_match.begin(), by_match.end(), [&](const uint32_t &a, const uint32_t &b) { return match_key::of(records[a]).compare(match_key::of(records[b])) < 0; });
+
+    format::header header;
+    header.num_records = static_cast<uint32_t>(records.size());
+    const auto records_size = records.size() * sizeof(format::rule_record), index_size = records.size() * sizeof(uint32_t);
+    std::vector<std::byte> data(sizeof(header) + records_size + 3 * index_size);
+    auto *at = data.data() + sizeof(header);
+    if (records_size) std::memcpy(at, records.data(), records_size);
+    at += records_size;
+    for (const auto *index : { &by_id, &by_name, &by_match }) {
+        if (index_size) std::memcpy(at, index->data(), index_size);
+        at += index_size;
+    }
+    header.checksum = checksum(data.data() + sizeof(header), data.size() - sizeof(header));
+    std::memcpy(data.data(), &header, sizeof(header));
+
+    auto res = std::make_shared<store>();
+    res->bytes = std::move(data);
+    res->index();
+    return res;
+}
+
+bool sc::visor::profiles::store::index() {
+    const auto *data = this->data();
+    const auto size = data_size();
+    if (size < sizeof(format::header)) return false;
+    const auto *header = reinterpret_cast<const format::header *>(data);
+    if (header->magic != format::file_magic || header->version != format::file_version || header->record_size != sizeof(format::rule_record)) return false;
+    const size_t n = header->num_records;
+    if (size != sizeof(format::header) + n * (sizeof(format::rule_record) + 3 * sizeof(uint32_t))) return false;
+    if (checksum(data + sizeof(format::header), size - sizeof(format::header)) != header->checksum) return false;
+    records = reinterpret_cast<const format::rule_record *>(data + sizeof(format::header));
+    by_id = reinterpret_cast<const uint32_t *>(records + n);
+    by_name = by_id + n;
+    by_match = by_name + n;
+    for (size_t i = 0; i < 3 * n; i++) if (by_id[i] >= n) return false; // The searches trust these
+    num_records = n;
+    return true;
+}
+
+const sc::visor::profiles::format::rule_record *sc::visor::profiles::store::find_id(const std::string_view &id) const {
+    const auto it = std::lower_bound(by_id, by_id + num_records, id, [&](const uint32_t &i, const std::string_view &value) { return field(records[i].id) < value; });
+    return it != by_id + num_records && field(records[*it].id) == id ? &records[*it] : nullptr;
+}
+
+const sc::visor::profiles::format::rule_record *sc::visor::profiles::store::find_name(const std::string_view &name) const {
+    const auto it = std::lower_bound(by_name, by_name + num_records, name, [&](const uint32_t &i, const std::string_view &value) { return field(records[i].name) < value; });
+    return it != by_name + num_records && field(records[*it].name) == name ? &records[*it] : nullptr;
+}
+
+const sc::visor::profiles::format::rule_record *sc::visor::profiles::store::match(const std::string_view &car, const std::string_view &track) const {
+    // Most specific first: car and track, car, track, catch-all
+    const std::array<match_key, 4> probes = { {
+        { true, car, true, track }, { true, car, false, { } }, { false, { }, true, track }, { false, { }, false, { } },
+    } };
+    for (const auto &probe : probes) {
+        const auto it = std::lower_bound(by_match, by_match + num_records, probe, [&](const uint32_t &i, const match_key &key) { return match_key::of(records[i]).compare(key) < 0; });
+        if (it != by_match + num_records && match_key::of(records[*it]).compare(probe) == 0) return &records[*it];
+    }
+    return nullptr;
+}
+
+const std::byte *sc::visor::profiles::store::data() const {
+    if (const auto *built = std::get_if<std::vector<std::byte>>(&bytes)) return built->data();
+    return std::get<file::mapping>(bytes).data();
+}
+
+size_t sc::visor::profiles::store::data_size() const {
+    if (const auto *built = std::get_if<std::vector<std::byte>>(&bytes)) return built->size();
+    return std::get<file::mapping>(bytes).size();
+}
+
+std::string_view sc::visor::profiles::store::field(const std::array<char, 40> &value) {
+    return { value.data(), strnlen(value.data(), value.size()) };
+}
+
+std::string_view sc::visor::profiles::store::field(const std::array<char, 128> &value) {
+    return { value.data(), strnlen(value.data(), value.size()) };
+}
+
+sc::visor::profiles::rule sc::visor::profiles::store::to_rule(const format::rule_record &record) {
+    rule entry;
+    entry.id = field(record.id);
+    entry.name = field(record.name);
+    if (record.flags & format::has_car) entry.car = std::string(field(record.car));
+    if (record.flags & format::has_track) entry.track = std::string(field(record.track));
+    if (record.flags & format::has_legacy) entry.legacy = to_settings(record.legacy);
+    if (record.flags & format::has_mk4) entry.mk4 = to_settings(record.mk4);
+    return entry;
+}
+
+sc::visor::profiles::pedal_settings sc::visor::profiles::store::to_settings(const format::settings_record &record) {
+    pedal_settings settings;
+    for (size_t i = 0; i < settings.axes.size(); i++) {
+        const auto &axis_record = record.axes[i];
+        auto &axis = settings.axes[i];
+        if (axis_record.present & (1u << 0)) axis.min = axis_record.min;
+        if (axis_record.present & (1u << 1)) axis.max = axis_record.max;
+        if (axis_record.present & (1u << 2)) axis.deadzone = axis_record.deadzone;
+        if (axis_record.present & (1u << 3)) axis.limit = axis_record.limit;
+        if (axis_record.present & (1u << 4)) axis.curve_i = axis_record.curve_i;
+    }
+    for (size_t i = 0; i < settings.models.size(); i++) {
+        if (!(record.models_present & (1u << i))) continue;
+        std::array<glm::ivec2, 6> points;
+        for (size_t j = 0; j < points.size(); j++) points[j] = { record.models[i][j][0], record.models[i][j][1] };
+        settings.models[i] = points;
+    }
+    return settings;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <array> // Include the array header
+#include <cstdint> // Include the fixed width integer header
+#include <memory> // Include the memory header
+#include <string_view> // Include the string_view header
+#include <variant> // Include the variant header
+#include <vector> // Include the vector header
+
+#include <tl/expected.hpp> // Include the tl/expected header
+
+#include "profiles.h" // Include the "profiles.h" header file
+#include "../../libs/file/file.h" // Include the file library's header
+
+namespace sc::visor::profiles::format { // On-disk layout of "profiles.bin"
+
+    // A store is a header, the records, and three arrays of record numbers: sorted by id, by name, and by car and track.
+    // Every record has the same size and holds a whole rule, so a lookup is a binary search and applying a rule is a copy.
+    // Car and track are compared ignoring ASCII case, as match() does.
+
+    constexpr std::array<char, 8> file_magic = { 'S', 'C', 'P', 'R', 'O', 'F', '0', '1' };
+    constexpr uint32_t file_version = 1; // Bumped whenever a record changes; a store of another version is ignored and profiles.json imported
+
+    enum : uint32_t {
+        has_car = 1 << 0,
+        has_track = 1 << 1,
+        has_legacy = 1 << 2,
+        has_mk4 = 1 << 3,
+    };
+
+    struct axis_record {
+
+        int32_t min = 0, max = 0, deadzone = 0, limit = 0, curve_i = 0;
+        uint32_t present = 0; // Bit per member above, in order
+    };
+
+    struct settings_record {
+
+        std::array<axis_record, 4> axes;
+        std::array<std::array<std::array<int32_t, 2>, 6>, 5> models = { }; // Curve models, in percent
+        uint32_t models_present = 0; // Bit per model
+        uint32_t _padding_1 = 0;
+    };
+
+    struct rule_record {
+
+        std::array<char, 40> id = { }; // Strings are zero-padded; a string filling its array isn't zero-terminated
+        std::array<char, 128> name = { };
+        std::array<char, 128> car = { };
+        std::array<char, 128> track = { };
+        uint32_t flags = 0;
+        uint32_t _padding_1 = 0;
+        settings_record legacy, mk4;
+    };
+
+    struct header {
+
+        std::array<char, 8> magic = file_magic;
+        uint32_t version = file_version;
+        uint32_t record_size = sizeof(rule_record); // Guards against a layout that changed without a version bump
+        uint32_t num_records = 0;
+        uint32_t checksum = 0; // FNV-1a of everything after the header
+        uint64_t _padding_1 = 0;
+    };
+}
+
+namespace sc::visor::profiles {
+
+    // Immutable, memory-mapped set of rules. Updates build a new store and swap it in, so a reader holding the old one
+    // keeps a consistent view; nothing is ever written in place.
+    class store {
+    public:
+
+        static tl::expected<std::shared_ptr<const store>, std::string> open(const std::filesystem::path &path); // Function to map a store file and check it
+        static std::shared_ptr<const store> build(const std::vector<rule> &rules); // Function to lay out rules as a store in memory
+
+        size_t size() const { return num_records; } // Function to get the number of rules
+        const format::rule_record &operator[](const size_t &i) const { return records[i]; } // Function to access a rule's record
+
+        const format::rule_record *find_id(const std::string_view &id) const; // Function to find a rule by id
+        const format::rule_record *find_name(const std::string_view &name) const; // Function to find the first rule with a name
+        const format::rule_record *match(const std::string_view &car, const std::string_view &track) const; // Same choice as profiles::match
+
+        const std::byte *data() const; // Function to access the store's bytes, e.g. to save a built store
+        size_t data_size() const;
+
+        static std::string_view field(const std::array<char, 40> &value); // Functions to read a zero-padded string
+        static std::string_view field(const std::array<char, 128> &value);
+        static rule to_rule(const format::rule_record &record); // Function to turn a record back into a rule
+        static pedal_settings to_settings(const format::settings_record &record); // Function to get a record's settings, no allocation
+
+    private:
+
+        bool index(); // Function to point into the bytes once they are in place; false if they aren't a valid store
+
+        std::variant<std::vector<std::byte>, file::mapping> bytes; // Built in memory or mapped from disk
+        const format::rule_record *records = nullptr;
+        const uint32_t *by_id = nullptr, *by_name = nullptr, *by_match = nullptr;
+        size_t num_records = 0;
+    };
+}
@@ -0,0 +1,416 @@
+#include "profiles.h" // Include the "profiles.h" header file
+#include "device_context.h" // Include the "device_context.h" header file
+#include "legacy.h" // Include the "legacy.h" header file
+#include "profile_store.h" // Include the "profile_store.h" header file
+
+#include <algorithm> // Include the <algorithm> header
+#include <future> // Include the <future> header
+#include <map> // Include the <map> header
+#include <random> // Include the <random> header
+
+#include <spdlog/spdlog.h> // Include the spdlog library's header
+#include <nlohmann/json.hpp> // Include the nlohmann/json library's header
+#include <pystring.h> // Include the pystring library's header
+
+#include "../../libs/defer.hpp" // Include the defer header
+#include "../../libs/boot/wakeup.h" // Include the main loop wakeup header
+#include "../../libs/file/file.h" // Include the file library's header
+#include "../../libs/iracing/iracing.h" // Include the iracing library's header
+
+namespace sc::visor::profiles {
+
+    static std::vector<rule> loaded_rules; // Rules loaded from "profiles.bin", for editing and syncing
+    static std::shared_ptr<const store> current_store; // The same rules, indexed; what update() matches against
+    static std::optional<std::string> active_rule; // Name of the rule applied for the current session
+
+    static std::optional<std::string> applied_key; // Car and track the virtual pedals were last switched for
+    static std::map<std::string, std::string> applied_devices; // Car and track each MK4 device (by serial) was last switched for
+    static std::map<std::string, std::pair<std::string, std::future<std::optional<std::string>>>> device_switches; // Switches still talking to a device, and the car and track they are for, by serial
+    static std::map<std::string, std::chrono::steady_clock::time_point> device_retries; // When a device whose switch failed is tried again, by serial
+
+    // Function to get the engine that syncs the rules with the cloud, started on first use
+    static api::sync_engine &sync() {
+        static const auto engine = []() {
+            api::sync_options opts;
+            opts.root = "profiles-sync"; // Next to "profiles.json"
+            return std::make_unique<api::sync_engine>(opts);
+        }();
+        return *engine;
+    }
+
+    static std::optional<int> optional_int(const nlohmann::json &doc, const char *key) {
+        if (const auto value = doc.find(key); value != doc.end() && value->is_number_integer()) return value->get<int>();
+        return std::nullopt;
+    }
+
+    static pedal_settings parse_settings(const nlohmann::json &doc) {
+        pedal_settings settings;
+        if (const auto axes_doc = doc.find("axes"); axes_doc != doc.end() && axes_doc->is_array()) {
+            for (int i = 0; i < std::min(axes_doc->size(), settings.axes.size()); i++) {
+                const auto &axis_doc = axes_doc->at(i);
+                if (!axis_doc.is_object()) continue; // null leaves the axis untouched
+                settings.axes[i].min = optional_int(axis_doc, "min");
+                settings.axes[i].max = optional_int(axis_doc, "max");
+                settings.axes[i].deadzone = optional_int(axis_doc, "deadzone");
+                settings.axes[i].limit = optional_int(axis_doc, "limit");
+                settings.axes[i].curve_i = optional_int(axis_doc, "curve");
+            }
+        }
+        if (const auto models_doc = doc.find("models"); models_doc != doc.end() && models_doc->is_array()) {
+            for (int i = 0; i < std::min(models_doc->size(), settings.models.size()); i++) {
+                const auto points_doc = models_doc->at(i).find("points");
+                if (points_doc == models_doc->at(i).end() || !points_doc->is_array() || points_doc->size() != 6) continue;
+                std::array<glm::ivec2, 6> points;
+                for (int j = 0; j < points.size(); j++) points[j] = { points_doc->at(j).value("x", 0), points_doc->at(j).value("y", 0) };
+                settings.models[i] = points;
+            }
+        }
+        return settings;
+    }
+
+    static nlohmann::json dump_settings(const pedal_settings &settings) {
+        nlohmann::json doc, axes_doc = nlohmann::json::array(), models_doc = nlohmann::json::array();
+        for (const auto &axis : settings.axes) {
+            nlohmann::json axis_doc = nlohmann::json::object();
+            if (axis.min) axis_doc["min"] = *axis.min;
+            if (axis.max) axis_doc["max"] = *axis.max;
+            if (axis.deadzone) axis_doc["deadzone"] = *axis.deadzone;
+            if (axis.limit) axis_doc["limit"] = *axis.limit;
+            if (axis.curve_i) axis_doc["curve"] = *axis.curve_i;
+            axes_doc.push_back(axis_doc);
+        }
+        for (const auto &model : settings.models) {
+            nlohmann::json model_doc = nlohmann::json::object();
+            if (model) for (const auto &point : *model) model_doc["points"].push_back({ { "x", point.x }, { "y", point.y } });
+            models_doc.push_back(model_doc);
+        }
+        doc["axes"] = axes_doc;
+        doc["models"] = models_doc;
+        return doc;
+    }
+
+    static rule parse_rule(const nlohmann::json &rule_doc, const size_t &rule_i) {
+        rule entry;
+        entry.id = rule_doc.value("id", "");
+        entry.name = rule_doc.value("name", fmt::format("Rule #{}", rule_i));
+        if (const auto car = rule_doc.find("car"); car != rule_doc.end() && car->is_string()) entry.car = car->get<std::string>();
+        if (const auto track = rule_doc.find("track"); track != rule_doc.end() && track->is_string()) entry.track = track->get<std::string>();
+        if (const auto legacy_doc = rule_doc.find("virtual"); legacy_doc != rule_doc.end() && legacy_doc->is_object()) entry.legacy = parse_settings(*legacy_doc);
+        if (const auto mk4_doc = rule_doc.find("mk4"); mk4_doc != rule_doc.end() && mk4_doc->is_object()) entry.mk4 = parse_settings(*mk4_doc);
+        return entry;
+    }
+
+    static nlohmann::json dump_rule(const rule &entry) {
+        nlohmann::json rule_doc;
+        rule_doc["name"] = entry.name;
+        if (entry.car) rule_doc["car"] = *entry.car;
+        if (entry.track) rule_doc["track"] = *entry.track;
+        if (entry.legacy) rule_doc["virtual"] = dump_settings(*entry.legacy);
+        if (entry.mk4) rule_doc["mk4"] = dump_settings(*entry.mk4);
+        return rule_doc; // Without the id, which is the key it is synced under
+    }
+
+    // Function to make an id no other rig will make for its rules
+    static std::string new_id() {
+        std::random_device device;
+        return fmt::format("{:08x}{:08x}{:08x}{:08x}", device(), device(), device(), device());
+    }
+
+    // Function to hand the set of rules to the sync engine; one that may lack rules, e.g. one recovered from an older copy,
+    // isn't "complete", so the rules it lacks come back from the engine instead of being deleted everywhere
+    static void publish(const bool &complete = true) {
+        api::sync_engine::documents docs;
+        for (const auto &entry : loaded_rules) docs[entry.id] = dump_rule(entry);
+        sync().publish(std::move(docs), complete);
+    }
+
+    // Function to swap in a store of the rules and write it in the background
+    static void write() {
+        // Copy-on-write: the old store stays valid for whoever still holds it, the new one is swapped in whole
+        current_store = store::build(loaded_rules);
+        file::writer::shared().save("profiles.bin", [built = current_store]() { // Written in the background
+            return std::vector<std::byte>(built->data(), built->data() + built->data_size());
+        });
+    }
+
+    // Function to read rules exported as JSON; rules without an id, or with one that is taken, get a new one
+    static tl::expected<std::vector<rule>, std::string> read_json(const std::filesystem::path &path) {
+        const auto load_res = file::load(path); // Load the JSON document from a file
+        if (!load_res.has_value()) return tl::make_unexpected(load_res.error());
+        const auto doc = nlohmann::json::parse(*load_res, nullptr, false);
+        if (doc.is_discarded()) return tl::make_unexpected(fmt::format("Unable to parse {}.", path.string()));
+        std::vector<rule> parsed;
+        if (const auto rules_doc = doc.find("rules"); rules_doc != doc.end() && rules_doc->is_array()) {
+            for (const auto &rule_doc : *rules_doc) {
+                if (!rule_doc.is_object()) continue;
+                auto entry = parse_rule(rule_doc, parsed.size());
+                if (entry.id.empty() || std::any_of(parsed.begin(), parsed.end(), [&](const rule &other) { return other.id == entry.id; })) entry.id = new_id();
+                parsed.push_back(std::move(entry));
+            }
+        }
+        return parsed;
+    }
+
+    // Sends only what differs from the device's current state, then commits once. Runs on its own thread, and talks to
+    // the device without holding the context's mutex, so the UI doesn't wait for a commit; "switching_profile" keeps
+    // device_context::update and the device's controls off the device meanwhile.
+    static std::optional<std::string> switch_mk4(std::shared_ptr<device_context> context, const pedal_settings &settings) {
+        DEFER(context->switching_profile = false; sc::boot::wakeup();); // Bring the controls back
+
+        std::shared_ptr<firmware::mk4::device_handle> handle;
+        std::vector<firmware::mk4::device_handle::axis_info> axes;
+        std::vector<device_context::axis_info_ex> axes_ex;
+        std::array<std::array<glm::ivec2, 6>, std::tuple_size_v<decltype(device_context::models)>> models;
+        {
+            std::lock_guard guard(context->mutex); // Only for a consistent copy of the device's state
+            handle = context->handle;
+            axes = context->axes;
+            axes_ex = context->axes_ex;
+            for (int model_i = 0; model_i < models.size(); model_i++) models[model_i] = context->models[model_i].points;
+        }
+        if (!handle) return std::nullopt;
+
+        bool changed = false;
+        const auto err = [&]() -> std::optional<std::string> {
+            for (int axis_i = 0; axis_i < std::min({ axes.size(), axes_ex.size(), settings.axes.size() }); axis_i++) {
+                const auto &desired = settings.axes[axis_i];
+                auto &current = axes[axis_i];
+                const auto min = desired.min.value_or(current.min), max = desired.max.value_or(current.max);
+                const auto deadzone = desired.deadzone.value_or(current.deadzone), limit = desired.limit.value_or(current.limit);
+                if (min != current.min || max != current.max || deadzone != current.deadzone || limit != current.limit) {
+                    if (const auto err = handle->set_axis_range(axis_i, min, max, deadzone, limit); err) return err;
+                    axes_ex[axis_i].range_min = min;
+                    axes_ex[axis_i].range_max = max;
+                    axes_ex[axis_i].deadzone = deadzone;
+                    axes_ex[axis_i].limit = limit;
+                    changed = true;
+                }
+                if (desired.curve_i && *desired.curve_i != current.curve_i && *desired.curve_i >= -1 && *desired.curve_i < static_cast<int>(models.size())) {
+                    if (const auto err = handle->set_axis_bezier_index(axis_i, *desired.curve_i); err) return err;
+                    current.curve_i = *desired.curve_i;
+                    axes_ex[axis_i].model_edit_i = *desired.curve_i;
+                    changed = true;
+                }
+            }
+            for (int model_i = 0; model_i < std::min(models.size(), settings.models.size()); model_i++) {
+                if (!settings.models[model_i] || *settings.models[model_i] == models[model_i]) continue;
+                std::array<glm::vec2, 6> model;
+                for (int i = 0; i < model.size(); i++) model[i] = glm::vec2((*settings.models[model_i])[i]) / 100.f;
+                if (const auto err = handle->set_bezier_model(model_i, model); err) return err;
+                models[model_i] = *settings.models[model_i];
+                changed = true;
+            }
+            return std::nullopt;
+        }();
+
+        {
+            std::lock_guard guard(context->mutex); // Show what the device took, even if a later write failed
+            for (int axis_i = 0; axis_i < std::min({ axes.size(), context->axes.size(), context->axes_ex.size() }); axis_i++) {
+                context->axes[axis_i].curve_i = axes[axis_i].curve_i;
+                context->axes_ex[axis_i] = axes_ex[axis_i];
+            }
+            for (int model_i = 0; model_i < models.size(); model_i++) context->models[model_i].points = models[model_i];
+        }
+        if (err || !changed) return err;
+        return handle->commit(); // One EEPROM write for the whole switch
+    }
+}
+
+int sc::visor::profiles::rule::specificity() const {
+    return (car ? 2 : 0) + (track ? 1 : 0);
+}
+
+std::optional<std::string> sc::visor::profiles::load() {
+    // A save still waiting in the writer is newer than the file; mapping the file before it lands would revert it
+    if (const auto err = file::writer::shared().flush("profiles.bin"); err) return err;
+
+    const auto backup = file::backup_path("profiles.bin");
+    for (const auto &path : { std::filesystem::path("profiles.bin"), backup }) {
+        auto opened = store::open(path); // Mapped, not parsed; only the records are copied out for editing
+        if (!opened.has_value()) {
+            spdlog::debug("Unable to open {}: {}", path.string(), opened.error());
+            continue;
+        }
+        current_store = std::move(*opened);
+        std::vector<rule> decoded;
+        decoded.reserve(current_store->size());
+        for (size_t i = 0; i < current_store->size(); i++) decoded.push_back(store::to_rule((*current_store)[i]));
+        loaded_rules = std::move(decoded);
+        applied_key.reset(); // Re-evaluate the current session against the new rules
+        applied_devices.clear();
+        if (path == backup) { // A crash cut the last save short; the backup is the set before it
+            spdlog::warn("Restored the profile rules from {}.", backup.string());
+            publish(false);
+            write();
+        } else publish();
+        return std::nullopt;
+    }
+
+    // First start with the store, or a store that is unreadable or of another version: import the rules kept as JSON before
+    std::error_code ec;
+    const auto absent = !std::filesystem::exists("profiles.bin", ec) && !std::filesystem::exists(backup, ec);
+    auto imported = read_json("profiles.json");
+    if (!imported.has_value()) return imported.error();
+    loaded_rules = std::move(*imported);
+    applied_key.reset();
+    applied_devices.clear();
+    if (absent) return save(); // Writes the store and publishes
+    for (auto &entry : loaded_rules) if (entry.id.empty()) entry.id = new_id();
+    publish(false); // profiles.json may be far older than the store was; only the sync engine knows which rules were deleted since
+    write();
+    return std::nullopt;
+}
+
+std::optional<std::string> sc::visor::profiles::save() {
+    for (auto &entry : loaded_rules) if (entry.id.empty()) entry.id = new_id();
+    publish(); // Journaled by the sync engine even if writing the file fails
+    write();
+    return std::nullopt;
+}
+
+std::optional<std::string> sc::visor::profiles::import_json(const std::filesystem::path &path) {
+    auto imported = read_json(path);
+    if (!imported.has_value()) return imported.error();
+    for (auto &entry : *imported) {
+        const auto existing = std::find_if(loaded_rules.begin(), loaded_rules.end(), [&](const rule &other) { return other.id == entry.id; });
+        if (existing != loaded_rules.end()) *existing = std::move(entry); // Exported earlier, so the same rule
+        else loaded_rules.push_back(std::move(entry));
+    }
+    applied_key.reset();
+    applied_devices.clear();
+    return save();
+}
+
+std::optional<std::string> sc::visor::profiles::export_json(const std::filesystem::path &path) {
+    nlohmann::json doc, rules_doc = nlohmann::json::array();
+    for (const auto &entry : loaded_rules) {
+        auto rule_doc = dump_rule(entry);
+        rule_doc["id"] = entry.id;
+        rules_doc.push_back(rule_doc);
+    }
+    doc["rules"] = rules_doc;
+    file::writer::shared().save(path, [doc = std::move(doc)]() { // Serialized and written in the background
+        const auto doc_content = doc.dump(4); // Serialize the JSON document with indentation
+        std::vector<std::byte> doc_data(doc_content.size());
+        memcpy(doc_data.data(), doc_content.data(), doc_content.size());
+        return doc_data;
+    });
+    return file::writer::shared().flush(path); // Someone is waiting for the file, so report whether it was written
+}
+
+const sc::visor::profiles::rule *sc::visor::profiles::match(const std::vector<rule> &rules, const std::string &car, const std::string &track) {
+    const rule *best = nullptr;
+    for (const auto &entry : rules) {
+        if (entry.car && pystring::lower(*entry.car) != pystring::lower(car)) continue;
+        if (entry.track && pystring::lower(*entry.track) != pystring::lower(track)) continue;
+        if (!best || entry.specificity() > best->specificity()) best = &entry;
+    }
+    return best;
+}
+
+void sc::visor::profiles::update(const std::vector<std::shared_ptr<device_context>> &contexts) {
+    if (const auto remote = sync().take_remote(); remote) { // Rules changed on another rig
+        for (const auto &[id, rule_doc] : *remote) {
+            const auto existing = std::find_if(loaded_rules.begin(), loaded_rules.end(), [&](const rule &entry) { return entry.id == id; });
+            if (!rule_doc) {
+                if (existing != loaded_rules.end()) loaded_rules.erase(existing);
+                continue;
+            }
+            auto entry = parse_rule(*rule_doc, loaded_rules.size());
+            entry.id = id;
+            if (existing != loaded_rules.end()) *existing = std::move(entry);
+            else loaded_rules.push_back(std::move(entry));
+        }
+        if (const auto err = save(); err) spdlog::error("Unable to save synced profile rules: {}", *err);
+        applied_key.reset(); // Re-evaluate the current session against the changed rules
+        applied_devices.clear();
+    }
+
+    for (auto it = device_switches.begin(); it != device_switches.end();) { // Collect finished device switches without waiting on the others
+        auto &[switched_key, result] = it->second;
+        if (result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            it++;
+            continue;
+        }
+        if (const auto err = result.get(); err) {
+            spdlog::error("Unable to switch profile on device {}: {}", it->first, *err);
+            device_retries[it->first] = std::chrono::steady_clock::now() + std::chrono::seconds(5); // Not applied, so it is tried again
+        } else {
+            spdlog::info("Switched profile on device {}.", it->first);
+            applied_devices[it->first] = switched_key; // Only once the device took it
+        }
+        it = device_switches.erase(it);
+    }
+
+    const auto info = sc::iracing::session();
+    if (!info) return;
+    const auto player = info->player();
+    const auto car = player ? player->car_path : std::string();
+    const auto key = fmt::format("{}|{}", car, info->track_name);
+    const auto image = current_store; // Keeps the records below alive even if a save swaps the store
+    const auto chosen = image ? image->match(car, info->track_name) : nullptr; // Binary searches, no allocation
+
+    if (applied_key != key) {
+        applied_key = key;
+        active_rule = chosen ? std::optional(std::string(store::field(chosen->name))) : std::nullopt;
+        if (chosen && (chosen->flags & format::has_legacy)) legacy::apply_settings(std::make_shared<const pedal_settings>(store::to_settings(chosen->legacy))); // Swapped in by the pedal pipeline as a whole
+        spdlog::info("Session changed to {} @ {}, profile: {}", car, info->track_name, active_rule.value_or("none"));
+    }
+
+    for (const auto &context : contexts) {
+        if (!context->handle || !context->initial_communication_complete) continue; // Deltas need the device's current state
+        if (device_switches.count(context->serial)) continue;
+        if (const auto applied = applied_devices.find(context->serial); applied != applied_devices.end() && applied->second == key) continue;
+        if (const auto retry = device_retries.find(context->serial); retry != device_retries.end() && std::chrono::steady_clock::now() < retry->second) continue;
+        if (!chosen || !(chosen->flags & format::has_mk4)) {
+            applied_devices[context->serial] = key; // Nothing to send
+            continue;
+        }
+        context->switching_profile = true; // Set before the switch starts, so no update or control gets in between
+        device_switches[context->serial] = { key, std::async(std::launch::async, [context, settings = store::to_settings(chosen->mk4)]() {
+            return switch_mk4(context, settings);
+        }) };
+    }
+}
+
+std::optional<std::string> sc::visor::profiles::capture_legacy() {
+    const auto info = sc::iracing::session();
+    if (!info) return "No iRacing session.";
+    const auto player = info->player();
+    if (!player) return "The local driver is not part of the session yet.";
+    pedal_settings settings;
+    for (int i = 0; i < settings.axes.size(); i++) {
+        settings.axes[i].min = legacy::axes[i].output_steps_min;
+        settings.axes[i].max = legacy::axes[i].output_steps_max;
+        settings.axes[i].deadzone = legacy::axes[i].deadzone;
+        settings.axes[i].limit = legacy::axes[i].output_limit;
+        if (legacy::axes[i].curve_i >= 0) settings.axes[i].curve_i = legacy::axes[i].curve_i;
+    }
+    for (int i = 0; i < settings.models.size(); i++) settings.models[i] = legacy::models[i].points;
+    const auto existing = std::find_if(loaded_rules.begin(), loaded_rules.end(), [&](const rule &entry) {
+        return entry.car == player->car_path && entry.track == info->track_name;
+    });
+    auto &target = existing != loaded_rules.end() ? *existing : loaded_rules.emplace_back();
+    target.name = fmt::format("{} @ {}", player->car_screen_name, info->track_display_name);
+    target.car = player->car_path;
+    target.track = info->track_name;
+    target.legacy = settings;
+    active_rule = target.name;
+    return save();
+}
+
+std::vector<sc::visor::profiles::rule> &sc::visor::profiles::rules() {
+    return loaded_rules;
+}
+
+std::optional<std::string> sc::visor::profiles::active() {
+    return active_rule;
+}
+
+void sc::visor::profiles::set_account(const std::optional<std::string> &email, const std::optional<std::string> &token) {
+    sync().set_account(email, token);
+}
+
+sc::api::sync_status sc::visor::profiles::sync_status() {
+    return sync().status();
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array> // Include the array header
+#include <filesystem> // Include the filesystem header
+#include <memory> // Include the memory header
+#include <optional> // Include the optional header
+#include <string> // Include the string header
+#include <vector> // Include the vector header
+
+#include <glm/vec2.hpp> // Include the glm/vec2 header
+
+#include "../../libs/api/sync.h" // Include the profile sync header
+
+namespace sc::visor {
+
+    struct device_context; // Forward declaration of the MK4 device context
+}
+
+namespace sc::visor::profiles {
+
+    // Settings a profile applies to one pedal axis; empty members are left as they are
+    struct axis_settings {
+
+        std::optional<int> min, max; // Input range
+        std::optional<int> deadzone, limit; // Deadzone and output limit, in percent
+        std::optional<int> curve_i; // Index of the curve model assigned to the axis
+    };
+
+    // Everything a profile applies to one kind of pedals
+    struct pedal_settings {
+
+        std::array<axis_settings, 4> axes; // Per-axis settings
+        std::array<std::optional<std::array<glm::ivec2, 6>>, 5> models; // Curve models, in percent
+    };
+
+    // A rule mapping a car and/or track to pedal settings
+    struct rule {
+
+        std::string id; // Stable id the rule is synced under, generated when it is first saved
+        std::string name; // Display name of the rule
+        std::optional<std::string> car; // iRacing car path to match, any car when empty
+        std::optional<std::string> track; // iRacing track name to match, any track when empty
+        std::optional<pedal_settings> legacy; // Settings for the virtual pedals
+        std::optional<pedal_settings> mk4; // Settings for every MK4 device
+
+        int specificity() const; // Car and track beats car, car beats track, track beats a catch-all rule
+    };
+
+    std::optional<std::string> load(); // Function to map the rules from "profiles.bin", or its backup, importing "profiles.json" the first time
+    std::optional<std::string> save(); // Function to rebuild the rule store and write "profiles.bin" in the background
+
+    std::optional<std::string> import_json(const std::filesystem::path &path); // Function to add rules exported as JSON, replacing those with the same id
+    std::optional<std::string> export_json(const std::filesystem::path &path); // Function to write every rule as JSON, e.g. to edit or share them
+
+    // Function to pick the most specific rule for a car and track, ties go to the earlier rule
+    const rule *match(const std::vector<rule> &rules, const std::string &car, const std::string &track);
+
+    // Function to apply the matching rule whenever the session changes or a device connects; never waits on a device
+    void update(const std::vector<std::shared_ptr<device_context>> &contexts);
+
+    std::optional<std::string> capture_legacy(); // Function to save the current virtual pedal setup as a rule for the current car and track
+
+    std::vector<rule> &rules(); // Function to access the loaded rules
+    std::optional<std::string> active(); // Function to get the name of the rule that was applied last
+
+    // Function to pass the account the rules are synced with; changes are kept locally until there is one
+    void set_account(const std::optional<std::string> &email, const std::optional<std::string> &token);
+    api::sync_status sync_status(); // Function to get the state of the cloud sync
+}
@@ -3,8 +3,8 @@
 #include <botan/hex.h> // Include the Botan hex library
 #include <botan/sha3.h> // Include the Botan SHA-3 library
 
-#include "../defer.hpp" // Include the "defer" utility
 #include "../rest/rest.h" // Include the REST library
+#include "../boot/wakeup.h" // Include the main loop wakeup header
 
 // Function to hash a password using the SHA-3 algorithm
 static std::string hash_password(const std::string_view &password) {
@@ -19,9 +19,7 @@ sc::api::response sc::api::customer::create_new(const std::string_view &email, c
     doc["email"] = email.data(); // Set the email field in the JSON object
     doc["name"] = name.data(); // Set the name field in the JSON object
     doc["password_hash"] = hash_password(password); // Set the password_hash field in the JSON object with the hashed password
-    return std::async(std::launch::async, [doc]() mutable -> tl::expected<nlohmann::json, std::string> {
-        return eon::rest::post("http://simcoaches.io/api/customers/create_new", doc); // Send a POST request with the JSON data to create a new customer
-    });
+    return eon::rest::client::shared().post("http://simcoaches.io/api/customers/create_new", doc, sc::boot::wakeup); // Send a POST request with the JSON data to create a new customer; the UI is woken up as soon as it arrives
 }
 
 // Implementation of the "check_session_token" function for the "customer" API
@@ -29,9 +27,7 @@ sc::api::response sc::api::customer::check_session_token(const std::string_view
     nlohmann::json doc; // Create a JSON object to hold the data
     doc["email"] = email; // Set the email field in the JSON object
     doc["session_token"] = token; // Set the session_token field in the JSON object
-    return std::async(std::launch::async, [doc]() mutable -> tl::expected<nlohmann::json, std::string> {
-        return eon::rest::post("http://simcoaches.io/api/customers/check_session_token", doc); // Send a POST request with the JSON data to check the session token
-    });
+    return eon::rest::client::shared().post("http://simcoaches.io/api/customers/check_session_token", doc, sc::boot::wakeup); // Send a POST request with the JSON data to check the session token; the UI is woken up as soon as it arrives
 }
 
 // Implementation of the "get_session_token" function for the "customer" API
@@ -39,9 +35,7 @@ sc::api::response sc::api::customer::get_session_token(const std::string_view &e
     nlohmann::json doc; // Create a JSON object to hold the data
     doc["email"] = email.data(); // Set the email field in the JSON object
     doc["password_hash"] = hash_password(password); // Set the password_hash field in the JSON object with the hashed password
-    return std::async(std::launch::async, [doc]() mutable -> tl::expected<nlohmann::json, std::string> {
-        return eon::rest::post("http://simcoaches.io/api/customers/get_session_token", doc); // Send a POST request with the JSON data to get the session token
-    });
+    return eon::rest::client::shared().post("http://simcoaches.io/api/customers/get_session_token", doc, sc::boot::wakeup); // Send a POST request with the JSON data to get the session token; the UI is woken up as soon as it arrives
 }
 
 // Implementation of the "activate_account" function for the "customer" API
@@ -49,18 +43,14 @@ sc::api::response sc::api::customer::activate_account(const std::string_view &em
     nlohmann::json doc; // Create a JSON object to hold the data
     doc["email"] = email; // Set the email field in the JSON object
     doc["code"] = code; // Set the code field in the JSON object
-    return std::async(std::launch::async, [doc]() mutable -> tl::expected<nlohmann::json, std::string> {
-        return eon::rest::post("http://simcoaches.io/api/customers/create_new_confirm", doc); // Send a POST request with the JSON data to activate the account
-    });
+    return eon::rest::client::shared().post("http://simcoaches.io/api/customers/create_new_confirm", doc, sc::boot::wakeup); // Send a POST request with the JSON data to activate the account; the UI is woken up as soon as it arrives
 }
 
 // Implementation of the "request_password_reset" function for the "customer" API
 sc::api::response sc::api::customer::request_password_reset(const std::string_view &email) {
     nlohmann::json doc; // Create a JSON object to hold the data
     doc["email"] = email; // Set the email field in the JSON object
-    return std::async(std::launch::async, [doc]() mutable -> tl::expected<nlohmann::json, std::string> {
-        return eon::rest::post("http://simcoaches.io/api/customers/reset_password", doc); // Send a POST request with the JSON data to request a password reset
-    });
+    return eon::rest::client::shared().post("http://simcoaches.io/api/customers/reset_password", doc, sc::boot::wakeup); // Send a POST request with the JSON data to request a password reset; the UI is woken up as soon as it arrives
 }
 
 // Implementation of the "password_reset" function for the "customer" API
@@ -69,7 +59,5 @@ sc::api::response sc::api::customer::password_reset(const std::string_view &emai
     doc["email"] = email; // Set the email field in the JSON object
     doc["code"] = code; // Set the code field in the JSON object
     doc["hash"] = hash_password(password); // Set the hash field in the JSON object with the hashed password
-    return std::async(std::launch::async, [doc]() mutable -> tl::expected<nlohmann::json, std::string> {
-        return eon::rest::post("http://simcoaches.io/api/customers/reset_password_confirm", doc); // Send a POST request with the JSON data to reset the password
-    });
+    return eon::rest::client::shared().post("http://simcoaches.io/api/customers/reset_password_confirm", doc, sc::boot::wakeup); // Send a POST request with the JSON data to reset the password; the UI is woken up as soon as it arrives
 }
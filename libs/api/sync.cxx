@@ -0,0 +1,469 @@
+#include "sync.h" // Include the header file "sync.h"
+
+#include <algorithm> // Include the header file for std::max
+#include <condition_variable> // Include the header file for condition variables
+#include <fstream> // Include the header file for file streams
+#include <mutex> // Include the header file for mutexes
+#include <set> // Include the header file for sets
+#include <thread> // Include the header file for threads
+#include <vector> // Include the header file for vectors
+
+#include <botan/hex.h> // Include the Botan hex library
+#include <botan/sha3.h> // Include the Botan SHA-3 library
+#include <spdlog/spdlog.h> // Include the spdlog library
+
+#include "../rest/rest.h" // Include the REST library
+
+using hashes = std::map<std::string, std::string>; // Document id to the hash of its content; absent when deleted
+
+struct sc::api::sync_engine::state {
+
+    sync_options opts; // Where and how often to sync
+    eon::rest::client client; // Its own connection pool, so it can outlive the shared one at exit
+
+    // Shared between the UI and the background thread, guarded by "mutex"
+    std::mutex mutex;
+    std::condition_variable wake; // Signalled for new input, sync requests and shutdown
+    bool stopping = false; // Set by the destructor
+    bool sync_requested = false; // Set by sync_now()
+    std::optional<documents> inbox; // The set published last, until the background thread takes it
+    bool inbox_complete = true; // Whether documents missing from the inbox were deleted
+    uint64_t published_seq = 0; // Number of the set published last
+    uint64_t applied_id = 0; // Change set the UI applied last
+    uint64_t inbox_ack = 0; // "applied_id" as of the set in the inbox
+    std::optional<changes> outbox; // Changes for the UI, until it takes them
+    uint64_t outbox_id = 0, outbox_base = 0; // Number of the change set and of the published set it applies to
+    std::optional<std::string> email, token; // Credentials
+    std::vector<std::shared_ptr<std::promise<std::optional<std::string>>>> waiting; // Callers of sync_now()
+    sync_status shared_status; // Copy of the background thread's status
+
+    // Background thread only
+    hashes view; // What the UI has once it applied every change set
+    hashes acked; // What the UI published last, which the change set in the outbox applies to
+    hashes base; // What the server had when each document was last in sync
+    std::string index_etag; // ETag of the index pulled last
+    uint64_t issued_id = 0; // Number of the change set issued last
+    uint64_t processed_seq = 0; // Number of the published set processed last
+    uint64_t processed_ack = 0; // Change set that set was published after
+    std::map<std::string, nlohmann::json> blob_cache; // Blobs read or written this run, by hash
+    bool dirty = false; // Whether the state file is behind
+    std::thread thread;
+
+    std::filesystem::path state_path() const { return opts.root / "state.json"; }
+    std::filesystem::path journal_path() const { return opts.root / "journal.jsonl"; }
+    std::filesystem::path blob_path(const std::string &hash) const { return opts.root / "blobs" / (hash + ".json"); }
+
+    // Function to store a document under its hash, once
+    std::string store(const nlohmann::json &doc) {
+        auto hash = sync_engine::hash(doc);
+        if (blob_cache.count(hash)) return hash;
+        if (const auto path = blob_path(hash); !std::filesystem::exists(path)) {
+            std::ofstream ofs(path.string() + ".tmp", std::ios::binary | std::ios::trunc);
+            ofs << doc.dump();
+            ofs.close();
+            std::error_code ec;
+            if (ofs) std::filesystem::rename(path.string() + ".tmp", path, ec); // Complete or absent, never half written
+        }
+        blob_cache[hash] = doc;
+        return hash;
+    }
+
+    // Function to get a stored document; null for a deleted one or a blob that can't be read
+    nlohmann::json blob(const std::string &hash) {
+        if (hash.empty()) return nullptr;
+        if (const auto cached = blob_cache.find(hash); cached != blob_cache.end()) return cached->second;
+        std::ifstream ifs(blob_path(hash), std::ios::binary);
+        if (!ifs) return nullptr;
+        auto doc = nlohmann::json::parse(ifs, nullptr, false);
+        if (doc.is_discarded() || sync_engine::hash(doc) != hash) return nullptr;
+        blob_cache[hash] = doc;
+        return doc;
+    }
+
+    // Function to change what the UI should have, journaling it first so it survives a crash
+    void set_view(const std::string &id, const std::string &hash) {
+        const auto current = view.find(id);
+        if ((current == view.end() && hash.empty()) || (current != view.end() && current->second == hash)) return;
+        std::ofstream journal(journal_path(), std::ios::binary | std::ios::app);
+        journal << nlohmann::json({ { "id", id }, { "hash", hash.empty() ? nlohmann::json(nullptr) : nlohmann::json(hash) } }).dump() << "\n";
+        if (hash.empty()) view.erase(id);
+        else view[id] = hash;
+        dirty = true;
+    }
+
+    static std::string get(const hashes &map, const std::string &id) {
+        const auto it = map.find(id);
+        return it == map.end() ? std::string() : it->second;
+    }
+
+    static std::set<std::string> ids(const std::initializer_list<const hashes *> &maps) {
+        std::set<std::string> res;
+        for (const auto &map : maps) for (const auto &[id, hash] : *map) res.insert(id);
+        return res;
+    }
+
+    // Function to read the state and replay the journal on top of it
+    void load() {
+        std::error_code ec;
+        std::filesystem::create_directories(opts.root / "blobs", ec);
+        if (std::ifstream ifs(state_path(), std::ios::binary); ifs) {
+            const auto doc = nlohmann::json::parse(ifs, nullptr, false);
+            if (doc.is_object()) {
+                index_etag = doc.value("etag", "");
+                for (const auto &[key, map] : { std::pair<const char *, hashes *> { "view", &view }, { "acked", &acked }, { "base", &base } }) {
+                    if (const auto it = doc.find(key); it != doc.end() && it->is_object()) for (const auto &[id, hash] : it->items()) if (hash.is_string()) (*map)[id] = hash.get<std::string>();
+                }
+            }
+        }
+        if (std::ifstream ifs(journal_path(), std::ios::binary); ifs) {
+            for (std::string line; std::getline(ifs, line);) {
+                const auto entry = nlohmann::json::parse(line, nullptr, false);
+                if (!entry.is_object()) continue; // A line cut short by a crash
+                const auto id = entry.find("id"), hash = entry.find("hash");
+                if (id == entry.end() || !id->is_string() || hash == entry.end()) continue; // Not a line set_view() wrote
+                if (hash->is_string()) view[id->get<std::string>()] = hash->get<std::string>();
+                else view.erase(id->get<std::string>());
+                dirty = true;
+            }
+        }
+        if (view != acked) issued_id = 1; // The UI may not have applied these before the last run ended; merge with what it publishes first
+    }
+
+    // Function to write the state and start a new journal
+    void persist() {
+        if (!dirty) return;
+        nlohmann::json doc = { { "etag", index_etag }, { "view", view }, { "acked", acked }, { "base", base } };
+        const auto tmp_path = state_path().string() + ".tmp";
+        {
+            std::ofstream ofs(tmp_path, std::ios::binary | std::ios::trunc);
+            ofs << doc.dump(4);
+            if (!ofs) return;
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmp_path, state_path(), ec);
+        if (ec) return;
+        std::filesystem::remove(journal_path(), ec); // Everything in it is part of the state now
+        dirty = false;
+    }
+
+    // Function to take over a set the UI published; an incomplete one only adds and changes documents
+    void absorb(const documents &published_docs, const bool &complete, const uint64_t &seq, const uint64_t &ack) {
+        hashes published;
+        for (const auto &[id, doc] : published_docs) published[id] = store(doc);
+        if (ack == issued_id) { // The UI has every change set, so its set is the truth
+            for (const auto &id : complete ? ids({ &view, &published }) : ids({ &published })) set_view(id, get(published, id));
+        } else { // Edited without a change set that is still on its way; merge both with what the UI had before
+            for (const auto &id : complete ? ids({ &acked, &view, &published }) : ids({ &published })) {
+                const auto before = get(acked, id), mine = get(published, id), theirs = get(view, id);
+                if (mine == before || mine == theirs) continue;
+                if (theirs == before) set_view(id, mine);
+                else {
+                    const auto merged = sync_engine::merge(blob(before), blob(mine), blob(theirs));
+                    set_view(id, merged.is_null() ? std::string() : store(merged));
+                }
+            }
+        }
+        if (acked != published) dirty = true;
+        acked = std::move(published);
+        processed_seq = seq;
+        processed_ack = ack;
+    }
+
+    // Function to build a request to the service
+    eon::rest::request request(const std::string &method, const std::string &path, const std::string &email, const std::string &token) const {
+        eon::rest::request req;
+        req.method = method;
+        req.url = opts.base_url + path;
+        req.headers = { "Accept: application/json", "Authorization: Bearer " + token, "X-Account-Email: " + email };
+        return req;
+    }
+
+    static std::optional<std::string> check(const eon::rest::raw_response &res) {
+        if (!res) return res.error();
+        if (res->status == 401 || res->status == 403) return "The session has expired.";
+        return std::nullopt;
+    }
+
+    // Function to pull the index and bring in every document that changed on the server
+    std::optional<std::string> pull(const std::string &email, const std::string &token) {
+        auto req = request("GET", "", email, token);
+        if (!index_etag.empty()) req.headers.push_back("If-None-Match: " + index_etag); // Costs only headers while nothing changed
+        const auto res = client.send(req).get();
+        if (const auto err = check(res); err) return err;
+        if (res->status == 304) return std::nullopt;
+        if (res->status != 200) return fmt::format("HTTP error #{}.", res->status);
+        const auto doc = nlohmann::json::parse(res->body, nullptr, false);
+        if (!doc.is_object() || !doc.contains("profiles") || !doc["profiles"].is_object()) return "Unable to parse the profile index.";
+        hashes remote;
+        for (const auto &[id, hash] : doc["profiles"].items()) if (hash.is_string()) remote[id] = hash.get<std::string>(); // null is a deleted document
+
+        std::map<std::string, std::shared_future<eon::rest::raw_response>> downloads; // Only blobs this rig has never seen
+        for (const auto &[id, hash] : remote) {
+            if (hash != get(base, id) && blob(hash).is_null() && !downloads.count(hash)) downloads[hash] = client.send(request("GET", "/blobs/" + hash, email, token));
+        }
+        for (const auto &[hash, download] : downloads) {
+            const auto &blob_res = download.get();
+            if (const auto err = check(blob_res); err) return err;
+            if (blob_res->status != 200) return fmt::format("HTTP error #{}.", blob_res->status);
+            const auto blob_doc = nlohmann::json::parse(blob_res->body, nullptr, false);
+            if (blob_doc.is_discarded() || store(blob_doc) != hash) return "A downloaded profile doesn't match its hash.";
+        }
+
+        for (const auto &id : ids({ &remote, &base })) {
+            const auto theirs = get(remote, id), before = get(base, id), mine = get(view, id);
+            if (theirs == before) continue;
+            if (mine == before) set_view(id, theirs); // Only changed remotely
+            else if (mine != theirs) { // Changed on both sides
+                const auto merged = sync_engine::merge(blob(before), blob(mine), blob(theirs));
+                set_view(id, merged.is_null() ? std::string() : store(merged));
+                spdlog::info("Merged concurrent changes to profile {}.", id);
+            }
+            if (theirs.empty()) base.erase(id);
+            else base[id] = theirs;
+            dirty = true;
+        }
+        if (index_etag != res->etag) dirty = true;
+        index_etag = res->etag;
+        return std::nullopt;
+    }
+
+    // Function to push every document that differs from its base; "conflict" is set when the server had moved on
+    std::optional<std::string> push(const std::string &email, const std::string &token, bool &conflict) {
+        std::map<std::string, std::shared_future<eon::rest::raw_response>> uploads;
+        for (const auto &id : ids({ &view, &base })) {
+            const auto mine = get(view, id), before = get(base, id);
+            if (mine == before) continue;
+            auto req = request(mine.empty() ? "DELETE" : "PUT", "/" + id, email, token);
+            if (before.empty()) req.headers.push_back("If-None-Match: *"); // Only create it if nobody else did
+            else req.headers.push_back("If-Match: \"" + before + "\""); // Only replace the version this one is based on
+            if (!mine.empty()) {
+                req.headers.push_back("Content-Type: application/json");
+                req.body = blob(mine).dump();
+            }
+            uploads[id] = client.send(req);
+        }
+        std::optional<std::string> res_err;
+        for (const auto &[id, upload] : uploads) {
+            const auto &res = upload.get();
+            if (const auto err = check(res); err) res_err = err;
+            else if (res->status == 412) conflict = true; // Pulled and merged next
+            else if (res->status >= 200 && res->status < 300) {
+                const auto mine = get(view, id);
+                if (mine.empty()) base.erase(id);
+                else base[id] = mine;
+                dirty = true;
+            } else res_err = fmt::format("HTTP error #{}.", res->status);
+        }
+        return res_err;
+    }
+
+    bool stopped() {
+        std::lock_guard guard(mutex);
+        return stopping;
+    }
+
+    // Function to run one synchronization with the service, giving up between requests once the engine is stopping
+    std::optional<std::string> exchange(const std::string &email, const std::string &token) {
+        for (int round = 0; round < 3; round++) {
+            if (stopped()) return "Sync stopped.";
+            if (const auto err = pull(email, token); err) return err;
+            if (stopped()) return "Sync stopped.";
+            bool conflict = false;
+            if (const auto err = push(email, token, conflict); err) return err;
+            if (!conflict) return std::nullopt;
+        }
+        return "Profiles kept changing on the server during the sync.";
+    }
+
+    // Function to offer the UI everything it doesn't have yet, replacing an earlier offer
+    void issue() {
+        if (view == acked) return;
+        changes offered;
+        for (const auto &id : ids({ &view, &acked })) {
+            const auto theirs = get(view, id);
+            if (theirs == get(acked, id)) continue;
+            if (theirs.empty()) offered[id] = std::nullopt;
+            else offered[id] = blob(theirs);
+        }
+        std::lock_guard guard(mutex);
+        if (!outbox && applied_id == issued_id && processed_ack != issued_id) return; // Taken, and the set with them applied is yet to come
+        if (outbox && outbox_id == issued_id && outbox_base == processed_seq && *outbox == offered) return; // Still waiting to be taken
+        outbox = std::move(offered);
+        outbox_id = ++issued_id;
+        outbox_base = processed_seq;
+    }
+
+    size_t pending() const {
+        size_t res = 0;
+        for (const auto &id : ids({ &view, &base })) if (get(view, id) != get(base, id)) res++;
+        return res;
+    }
+
+    void run() {
+        load();
+        auto backoff = opts.min_backoff;
+        auto next_attempt = std::chrono::steady_clock::now();
+        std::optional<std::string> last_error; // Set while backing off
+        for (;;) {
+            std::optional<documents> docs;
+            bool complete;
+            uint64_t seq, ack;
+            std::optional<std::string> email_copy, token_copy;
+            std::vector<std::shared_ptr<std::promise<std::optional<std::string>>>> callers;
+            bool attempt;
+            {
+                std::unique_lock lock(mutex);
+                wake.wait_until(lock, next_attempt, [&]() { return stopping || sync_requested || inbox.has_value(); });
+                if (stopping) {
+                    for (const auto &caller : waiting) caller->set_value("Sync stopped.");
+                    waiting.clear();
+                    break;
+                }
+                docs = std::move(inbox);
+                inbox.reset();
+                complete = inbox_complete;
+                seq = published_seq;
+                ack = inbox_ack;
+                email_copy = email;
+                token_copy = token;
+                callers.swap(waiting);
+                attempt = sync_requested || std::chrono::steady_clock::now() >= next_attempt;
+                sync_requested = false;
+            }
+
+            if (docs) {
+                const auto before = view;
+                absorb(*docs, complete, seq, ack);
+                if (view != before && !last_error) attempt = true; // Local changes go out right away, unless backing off
+            }
+            const bool signed_in = email_copy && token_copy;
+            std::optional<std::string> err = last_error;
+            if (!signed_in) err = "Not signed in.";
+            else if (attempt) err = exchange(*email_copy, *token_copy);
+            issue();
+            persist();
+
+            const auto now = std::chrono::steady_clock::now();
+            if (!signed_in || (attempt && !err)) {
+                backoff = opts.min_backoff;
+                next_attempt = now + opts.interval;
+                last_error.reset();
+            } else if (attempt) {
+                next_attempt = now + backoff;
+                backoff = std::min(backoff * 2, opts.max_backoff);
+                last_error = err;
+                spdlog::debug("Unable to sync profiles, trying again in {} ms: {}", std::chrono::duration_cast<std::chrono::milliseconds>(next_attempt - now).count(), *err);
+            }
+            {
+                std::lock_guard guard(mutex);
+                shared_status = { signed_in, pending(), err };
+            }
+            for (const auto &caller : callers) caller->set_value(err);
+        }
+        persist();
+    }
+};
+
+sc::api::sync_engine::sync_engine(const sync_options &opts) : s(std::make_unique<state>()) {
+    s->opts = opts; // Keep the options
+    s->thread = std::thread([this]() { s->run(); }); // Start the background thread
+}
+
+sc::api::sync_engine::~sync_engine() {
+    {
+        std::lock_guard guard(s->mutex);
+        s->stopping = true; // Ask the background thread to finish
+    }
+    s->wake.notify_all(); // Wake it if it is waiting
+    s->client.cancel(); // Fail the requests in flight now, rather than after the client's timeout
+    if (s->thread.joinable()) s->thread.join();
+}
+
+void sc::api::sync_engine::publish(documents local, const bool &complete) {
+    {
+        std::lock_guard guard(s->mutex);
+        s->inbox_complete = complete && (!s->inbox || s->inbox_complete); // What an incomplete set lacks may be missing from the one replacing it too
+        s->inbox = std::move(local); // Replaces a set the background thread hasn't taken yet
+        s->published_seq++; // Number the set
+        s->inbox_ack = s->applied_id; // Remember which changes it already contains
+    }
+    s->wake.notify_all(); // Let the background thread journal it
+}
+
+std::optional<sc::api::sync_engine::changes> sc::api::sync_engine::take_remote() {
+    std::lock_guard guard(s->mutex);
+    if (!s->outbox) return std::nullopt; // Nothing arrived
+    if (s->outbox_base != s->published_seq) return std::nullopt; // Worked out for an older set; offered again once merged with the newer one
+    s->applied_id = s->outbox_id; // The next published set contains these changes
+    auto res = std::move(s->outbox);
+    s->outbox.reset();
+    return res;
+}
+
+void sc::api::sync_engine::set_account(const std::optional<std::string> &email, const std::optional<std::string> &token) {
+    {
+        std::lock_guard guard(s->mutex);
+        if (s->email == email && s->token == token) return; // Called every frame; only a change matters
+        s->email = email;
+        s->token = token;
+        if (email && token) s->sync_requested = true; // Sync right after signing in
+    }
+    s->wake.notify_all();
+}
+
+std::shared_future<std::optional<std::string>> sc::api::sync_engine::sync_now() {
+    const auto caller = std::make_shared<std::promise<std::optional<std::string>>>();
+    auto res = caller->get_future().share();
+    {
+        std::lock_guard guard(s->mutex);
+        if (s->stopping) caller->set_value("Sync stopped.");
+        else {
+            s->waiting.push_back(caller);
+            s->sync_requested = true;
+        }
+    }
+    s->wake.notify_all();
+    return res;
+}
+
+sc::api::sync_status sc::api::sync_engine::status() {
+    std::lock_guard guard(s->mutex);
+    return s->shared_status;
+}
+
+std::string sc::api::sync_engine::hash(const nlohmann::json &doc) {
+    auto hasher = Botan::SHA_3_256(); // Create an instance of the SHA-3 hash algorithm
+    hasher.update(doc.dump()); // Object members are sorted by name, so equal documents dump equally
+    return Botan::hex_encode(hasher.final(), false); // Return the hexadecimal encoded hash
+}
+
+nlohmann::json sc::api::sync_engine::merge(const nlohmann::json &base, const nlohmann::json &local, const nlohmann::json &remote) {
+    if (local == remote) return local; // Nothing to merge
+    if (local == base) return remote; // Only changed remotely
+    if (remote == base) return local; // Only changed locally
+    if (local.is_object() && remote.is_object()) { // Merge member by member
+        const auto member = [](const nlohmann::json &doc, const std::string &key) {
+            const auto it = doc.is_object() ? doc.find(key) : doc.end();
+            return it == doc.end() ? nlohmann::json(nullptr) : *it;
+        };
+        nlohmann::json res = nlohmann::json::object();
+        std::set<std::string> keys;
+        for (const auto &doc : { &base, &local, &remote }) if (doc->is_object()) for (const auto &[key, value] : doc->items()) keys.insert(key);
+        for (const auto &key : keys) {
+            auto value = merge(member(base, key), member(local, key), member(remote, key));
+            if (!value.is_null()) res[key] = std::move(value); // Removed on one side and untouched on the other
+        }
+        return res;
+    }
+    if (local.is_array() && remote.is_array() && local.size() == remote.size()) { // Fixed-size arrays like the axes merge element by element
+        nlohmann::json res = nlohmann::json::array();
+        for (size_t i = 0; i < local.size(); i++) {
+            const auto base_element = base.is_array() && i < base.size() ? base[i] : nlohmann::json(nullptr);
+            res.push_back(merge(base_element, local[i], remote[i]));
+        }
+        return res;
+    }
+    if (local.is_null()) return remote; // Edited on one side, deleted on the other: keep the edit
+    if (remote.is_null()) return local;
+    return local.dump() > remote.dump() ? local : remote; // Changed differently on both sides: the same winner on every rig
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono> // Include the header file for durations
+#include <filesystem> // Include the header file for paths
+#include <future> // Include the header file for futures
+#include <map> // Include the header file for maps
+#include <memory> // Include the header file for unique pointers
+#include <optional> // Include the header file for optional values
+#include <string> // Include the header file for strings
+
+#include <nlohmann/json.hpp> // Include the header file for JSON parsing
+
+namespace sc::api { // Define a namespace called "sc::api"
+
+    // Where and how often profiles are synchronized
+    struct sync_options {
+
+        std::string base_url = "http://simcoaches.io/api/profiles"; // The index lives here, documents at <base_url>/<id> and blobs at <base_url>/blobs/<hash>
+        std::filesystem::path root = "sync"; // Directory of the journal, the sync state and the content-addressed blobs
+        std::chrono::milliseconds interval = std::chrono::minutes(1); // Time between pulls while nothing changes locally
+        std::chrono::milliseconds min_backoff = std::chrono::seconds(5); // Wait after the first failed attempt, doubled after every further one
+        std::chrono::milliseconds max_backoff = std::chrono::minutes(5); // Longest wait between failed attempts
+    };
+
+    // What the UI shows about synchronization
+    struct sync_status {
+
+        bool signed_in = false; // Whether there are credentials to sync with
+        size_t pending = 0; // Local changes that are not on the server yet
+        std::optional<std::string> error; // Why the last attempt failed, if it did
+    };
+
+    // Offline-first synchronization of JSON documents, keyed by a stable id, with a web service.
+    // The UI publishes its complete set after every change and applies the remote changes it is handed; a background thread
+    // journals local changes, stores every version as a blob named by its hash, pulls the index only when its ETag changed,
+    // fetches only blobs it doesn't have and pushes documents with If-Match, so concurrent edits are detected on the server.
+    // Diverged documents are merged field by field against their common base; when both sides changed the same field the
+    // value that sorts last wins, so every rig arrives at the same result. Nothing here ever waits on the network for the caller.
+    class sync_engine {
+    public:
+
+        using documents = std::map<std::string, nlohmann::json>; // Document id to content
+        using changes = std::map<std::string, std::optional<nlohmann::json>>; // Document id to its new content, or nothing when it was deleted
+
+        explicit sync_engine(const sync_options &opts = { }); // Loads the journal and starts the background thread
+        ~sync_engine(); // Stops the background thread; what hasn't been pushed stays in the journal for next time
+
+        sync_engine(const sync_engine &) = delete;
+        sync_engine &operator=(const sync_engine &) = delete;
+
+        // Hands over the complete local set; documents missing from it count as deleted. Only moves it into a mailbox.
+        // A set that isn't "complete", e.g. one recovered from an old copy, deletes nothing; the documents it lacks are
+        // offered back through take_remote() instead.
+        void publish(documents local, const bool &complete = true);
+
+        // Changes to apply on top of the set published last, once per arrival. Nothing if the UI published again since they
+        // were worked out; the background thread then merges them with the newer set and offers them again.
+        std::optional<changes> take_remote();
+
+        // Credentials to sync with; without them, changes are only journaled.
+        void set_account(const std::optional<std::string> &email, const std::optional<std::string> &token);
+
+        // Asks for a sync right away; the future completes after that attempt, with the error if it failed.
+        std::shared_future<std::optional<std::string>> sync_now();
+
+        sync_status status(); // Function to get the current status
+
+        static std::string hash(const nlohmann::json &doc); // Hex SHA3-256 of the document's canonical form
+
+        // Three-way merge of JSON values; null stands for a deleted document or a missing member.
+        static nlohmann::json merge(const nlohmann::json &base, const nlohmann::json &local, const nlohmann::json &remote);
+
+    private:
+
+        struct state; // Shared mailboxes plus the background thread's bookkeeping
+        std::unique_ptr<state> s;
+    };
+}
@@ -0,0 +1,264 @@
+#include "sync.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <random>
+
+#include <spdlog/spdlog.h>
+
+#include "../rest/stand_in_server.h"
+#include "../check.hpp"
+
+using sc::test::check;
+
+// The profile service as sync_engine expects it, in memory
+class profile_store {
+public:
+
+    static constexpr auto token = "t0k3n";
+
+    std::optional<eon::rest::stand_in_server::route_reply> route(const eon::rest::stand_in_server::route_request &req) {
+        constexpr std::string_view prefix = "/api/profiles";
+        if (req.path.rfind(prefix, 0) != 0) return std::nullopt;
+        eon::rest::stand_in_server::route_reply reply;
+        if (req.header("authorization") != std::string("Bearer ") + token) {
+            reply.status = 401;
+            return reply;
+        }
+        const auto path = req.path.substr(prefix.size());
+        std::lock_guard guard(mutex);
+        const auto etag = "\"v" + std::to_string(version) + "\"";
+        if (path.empty() && req.method == "GET") {
+            reply.headers.push_back("ETag: " + etag);
+            if (req.header("if-none-match") == etag) reply.status = 304;
+            else {
+                nlohmann::json index = nlohmann::json::object();
+                for (const auto &[id, hash] : profiles) index[id] = hash;
+                reply.body = nlohmann::json({ { "profiles", index } }).dump();
+            }
+        } else if (path.rfind("/blobs/", 0) == 0 && req.method == "GET") {
+            const auto blob = blobs.find(path.substr(7));
+            if (blob == blobs.end()) reply.status = 404;
+            else reply.body = blob->second;
+        } else if (path.size() > 1 && (req.method == "PUT" || req.method == "DELETE")) {
+            const auto id = path.substr(1);
+            const auto current = profiles.find(id);
+            const auto precondition = current == profiles.end() ? req.header("if-none-match") == "*" : req.header("if-match") == "\"" + current->second + "\"";
+            if (!precondition) reply.status = 412;
+            else if (req.method == "DELETE") {
+                profiles.erase(id);
+                version++;
+                reply.status = 204;
+            } else {
+                const auto doc = nlohmann::json::parse(req.body, nullptr, false);
+                if (doc.is_discarded()) reply.status = 400;
+                else {
+                    const auto hash = sc::api::sync_engine::hash(doc);
+                    blobs[hash] = doc.dump();
+                    profiles[id] = hash;
+                    version++;
+                }
+            }
+        } else reply.status = 404;
+        return reply;
+    }
+
+    std::optional<nlohmann::json> profile(const std::string &id) {
+        std::lock_guard guard(mutex);
+        const auto it = profiles.find(id);
+        if (it == profiles.end()) return std::nullopt;
+        return nlohmann::json::parse(blobs[it->second]);
+    }
+
+private:
+
+    std::mutex mutex;
+    std::map<std::string, std::string> profiles; // id to hash
+    std::map<std::string, std::string> blobs; // hash to content
+    uint64_t version = 1;
+};
+
+// One installation: the UI's documents plus its engine
+struct rig {
+
+    sc::api::sync_engine::documents docs;
+    std::unique_ptr<sc::api::sync_engine> engine;
+
+    rig(const std::filesystem::path &root, const std::string &base_url) {
+        sc::api::sync_options opts;
+        opts.root = root;
+        opts.base_url = base_url;
+        engine = std::make_unique<sc::api::sync_engine>(opts);
+    }
+
+    // Applies what arrived, as the UI does every frame
+    void update() {
+        const auto remote = engine->take_remote();
+        if (!remote) return;
+        for (const auto &[id, doc] : *remote) {
+            if (doc) docs[id] = *doc;
+            else docs.erase(id);
+        }
+        engine->publish(docs);
+    }
+
+    std::optional<std::string> sync() {
+        const auto res = engine->sync_now().get();
+        update();
+        return res;
+    }
+
+    void edit(const std::function<void(sc::api::sync_engine::documents &)> &change) {
+        update();
+        change(docs);
+        engine->publish(docs);
+    }
+};
+
+static void test_merge() {
+    using json = nlohmann::json;
+    const json base = { { "name", "Spa" }, { "brake", { { "gamma", 1.0 }, { "min", 0 } } }, { "axes", { 1, 2, 3 } } };
+    auto local = base, remote = base;
+    local["name"] = "Spa wet";
+    remote["brake"]["gamma"] = 1.4;
+    remote["axes"][2] = 9;
+    const auto merged = sc::api::sync_engine::merge(base, local, remote);
+    check(merged["name"] == "Spa wet" && merged["brake"]["gamma"] == 1.4 && merged["brake"]["min"] == 0 && merged["axes"] == json({ 1, 2, 9 }), "edits to different fields are combined");
+
+    remote["name"] = "Spa dry";
+    check(sc::api::sync_engine::merge(base, local, remote) == sc::api::sync_engine::merge(base, remote, local), "a conflict resolves the same way on both sides");
+    check(sc::api::sync_engine::merge(base, nullptr, remote) == remote, "an edit wins over a deletion");
+    check(sc::api::sync_engine::merge(base, nullptr, base).is_null(), "a deletion of an unchanged document stands");
+    auto added = base;
+    added["track"] = "spa";
+    check(sc::api::sync_engine::merge(base, added, base).contains("track"), "an added member is kept");
+    check(!sc::api::sync_engine::merge(added, base, added).contains("track"), "a removed member stays removed");
+}
+
+static void test_sync(const std::filesystem::path &dir) {
+    profile_store store;
+    eon::rest::stand_in_server server([&](const auto &req) { return store.route(req); });
+    check(server.ok(), "stand-in server listens");
+    if (!server.ok()) return;
+    const auto base_url = server.url("/api/profiles");
+
+    rig a(dir / "a", base_url), b(dir / "b", base_url);
+    a.engine->set_account("driver@example.com", profile_store::token);
+    b.engine->set_account("driver@example.com", profile_store::token);
+
+    // A new profile reaches the other rig
+    a.edit([](auto &docs) { docs["p1"] = { { "name", "Spa" }, { "brake", { { "gamma", 1.0 } } } }; });
+    check(!a.sync(), "rig A syncs");
+    check(store.profile("p1").has_value(), "the profile is on the server");
+    check(!b.sync(), "rig B syncs");
+    check(b.docs.count("p1") && b.docs["p1"]["name"] == "Spa", "the profile reaches rig B");
+    check(a.engine->status().pending == 0 && b.engine->status().pending == 0, "nothing is pending once both are in sync");
+
+    // Nothing changed: one request, answered without a body
+    const auto requests_before = server.num_requests();
+    check(!b.sync(), "rig B syncs again");
+    check(server.num_requests() == requests_before + 1, "an unchanged index costs one conditional request");
+
+    // Different fields edited on both rigs
+    a.edit([](auto &docs) { docs["p1"]["name"] = "Spa wet"; });
+    b.edit([](auto &docs) { docs["p1"]["brake"]["gamma"] = 1.4; });
+    check(!a.sync() && !b.sync() && !a.sync(), "both rigs sync their edits");
+    check(a.docs["p1"]["name"] == "Spa wet" && a.docs["p1"]["brake"]["gamma"] == 1.4, "rig A has both edits");
+    check(a.docs == b.docs, "both rigs agree after a merge");
+
+    // The same field edited on both rigs
+    a.edit([](auto &docs) { docs["p1"]["name"] = "Spa A"; });
+    b.edit([](auto &docs) { docs["p1"]["name"] = "Spa B"; });
+    check(!a.sync() && !b.sync() && !a.sync(), "both rigs sync a conflict");
+    check(a.docs == b.docs && a.docs["p1"]["name"] == "Spa B", "a conflict converges on the same value everywhere");
+
+    // Edited offline, pushed after a restart
+    {
+        rig c(dir / "c", base_url);
+        c.engine->set_account("driver@example.com", profile_store::token);
+        check(!c.sync(), "rig C pulls");
+        c.engine->set_account(std::nullopt, std::nullopt);
+        c.edit([](auto &docs) { docs["p2"] = { { "name", "Monza" } }; });
+        check(c.sync() == std::optional<std::string>("Not signed in."), "syncing without an account fails");
+        check(c.engine->status().pending == 1, "the offline edit is pending");
+    }
+    check(!store.profile("p2"), "the offline edit stays local");
+    {
+        rig c(dir / "c", base_url);
+        c.engine->set_account("driver@example.com", profile_store::token);
+        check(!c.sync(), "rig C syncs after the restart");
+    }
+    check(store.profile("p2").has_value(), "the offline edit is pushed after a restart");
+    check(!a.sync() && a.docs.count("p2"), "the offline edit reaches rig A");
+
+    // Deletion
+    a.edit([](auto &docs) { docs.erase("p2"); });
+    check(!a.sync() && !b.sync(), "both rigs sync a deletion");
+    check(!store.profile("p2") && !b.docs.count("p2") && b.docs.count("p1"), "a deletion reaches the server and rig B");
+
+    // An expired session
+    b.engine->set_account("driver@example.com", "expired");
+    check(b.sync() == std::optional<std::string>("The session has expired."), "a rejected session is reported");
+}
+
+static void test_journal(const std::filesystem::path &dir) {
+    std::filesystem::create_directories(dir);
+    {
+        std::ofstream journal(dir / "journal.jsonl", std::ios::binary);
+        journal << "[1]\n" << R"({"id": 5, "hash": "x"})" << "\n" << R"({"id": "p1"})" << "\n" << R"({"hash": "y"})" << "\n";
+        journal << R"({"id": "p2", "hash": "abc"})" << "\n" << R"({"id": "p3", "ha)";
+    }
+    rig d(dir, "http://127.0.0.1:9/api/profiles");
+    check(d.sync() == std::optional<std::string>("Not signed in."), "an engine starts from a journal with malformed lines");
+    check(d.engine->status().pending == 1, "only the well-formed journal lines are replayed");
+}
+
+static void test_incomplete(const std::filesystem::path &dir) {
+    const auto offline = "http://127.0.0.1:9/api/profiles";
+    {
+        rig f(dir, offline);
+        f.edit([](auto &docs) { docs["p1"] = { { "name", "Spa" } }; docs["p2"] = { { "name", "Monza" } }; });
+        f.sync();
+    }
+
+    // Restarted with an older copy of the set that only has "p1", and edited it
+    rig f(dir, offline);
+    f.docs["p1"] = { { "name", "Spa wet" } };
+    f.engine->publish(f.docs, false);
+    f.sync();
+    check(f.docs.count("p2") && f.docs["p1"]["name"] == "Spa wet", "an incomplete set deletes nothing and gets back what it lacks");
+    f.edit([](auto &docs) { docs.erase("p2"); });
+    f.sync();
+    check(!f.docs.count("p2") && f.docs.count("p1"), "a complete set published after it deletes again");
+}
+
+static void test_shutdown(const std::filesystem::path &dir) {
+    eon::rest::stand_in_server server([](const auto &) -> std::optional<eon::rest::stand_in_server::route_reply> {
+        std::this_thread::sleep_for(std::chrono::seconds(3)); // A server that doesn't answer in time
+        return eon::rest::stand_in_server::route_reply { };
+    });
+    if (!server.ok()) return;
+    rig e(dir, server.url("/api/profiles"));
+    e.engine->set_account("driver@example.com", profile_store::token);
+    const auto result = e.engine->sync_now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200)); // Let the pull go out
+    const auto start = std::chrono::steady_clock::now();
+    e.engine.reset();
+    check(std::chrono::steady_clock::now() - start < std::chrono::seconds(1), "stopping the engine doesn't wait for a request in flight");
+    check(result.wait_for(std::chrono::seconds(0)) == std::future_status::ready && result.get().has_value(), "a sync cut short by stopping fails");
+}
+
+int main() {
+    test_merge();
+    const auto dir = std::filesystem::temp_directory_path() / fmt::format("visor-test-sync-{:x}", std::random_device()());
+    test_sync(dir);
+    test_journal(dir / "d");
+    test_incomplete(dir / "f");
+    test_shutdown(dir / "e");
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+    return sc::test::finish("sync");
+}
@@ -7,6 +7,7 @@
 #include <optional>
 #include <string>
 #include <functional>
+#include <chrono>
 
 #include <tl/expected.hpp>
 
@@ -40,12 +41,20 @@ static argparse::ArgumentParser program(VER_APP_NAME, VER_APP_VER); // Create an
 #define SC_FONT_SIZE 16 // Define the default font size as 16
 #endif
 
+#ifndef SC_FONT_CACHE_FILE // Check if SC_FONT_CACHE_FILE is not defined
+#define SC_FONT_CACHE_FILE "fonts.cache" // Define where the built font atlas is cached between runs
+#endif
+
 #ifdef SC_FEATURE_SYSTEM_TRAY // Check if SC_FEATURE_SYSTEM_TRAY is defined
 
     #include "../systray/systray.h" // Include the library for system tray functionality
 
 #endif
 
+#if defined(SC_FEATURE_HEADLESS_BACKGROUND) && !defined(SC_FEATURE_SYSTEM_TRAY)
+    #error "SC_FEATURE_HEADLESS_BACKGROUND needs SC_FEATURE_SYSTEM_TRAY to bring the window back." // Without a tray icon, a hidden window could never be shown again
+#endif
+
 #include "../imgui/imgui_impl_opengl3.h" // Include the ImGui library for OpenGL 3 implementation
 #include "../imgui/imgui_impl_glfw.h" // Include the ImGui library for GLFW implementation
 #include "../imgui/imgui_utils.hpp" // Include the utility functions for ImGui
@@ -54,6 +63,7 @@ static argparse::ArgumentParser program(VER_APP_NAME, VER_APP_VER); // Create an
 
 #include "gl-proc-address.h" // Include the header for getting OpenGL function addresses
 #include "gl-dbg-msg-cb.h" // Include the header for OpenGL debug message callback
+#include "wakeup.h" // Include the header for waking the main loop from other threads
 
 #include <glbinding/gl33core/gl.h> // Include the glbinding library for OpenGL 3.3 core profile
 
@@ -63,11 +73,88 @@ using namespace gl; // Use the gl namespace for convenience
 
 #include <GLFW/glfw3.h> // Include the GLFW library for window and input handling
 
+#ifndef SC_IDLE_UPDATE_MS // Check if SC_IDLE_UPDATE_MS is not defined
+#define SC_IDLE_UPDATE_MS 1000 // Define the longest time the main loop waits without input, wakeups or scheduled updates
+#endif
+
 static glm::ivec2 _sc_current_framebuffer_size = { 0, 0 }; // Initialize the current framebuffer size as (0, 0)
 static bool _sc_force_redraw = false; // Initialize the force redraw flag as false
+static bool _sc_refresh_rate_stale = true; // Set when the window moves or monitors change; the refresh rate is looked up again on the next iteration
+
+#ifdef SC_FEATURE_HEADLESS_BACKGROUND
+static std::atomic_bool _sc_ui_wanted = false; // Whether the window should be shown; while false, there is no ImGui context and only services run
+#endif
+
+#ifdef SC_FEATURE_ENHANCED_FONTS
+static ImFreetypeEnablement _sc_freetype; // Rebuilds the font atlas with Freetype before the first frame of every ImGui context
+#endif
 
 static void _sc_glfw_window_resize_cb(GLFWwindow *window, int w, int h); // Declare the callback function for GLFW window resize event
 
+static void _sc_glfw_window_pos_cb(GLFWwindow *window, int x, int y) {
+    _sc_refresh_rate_stale = true; // The window may have moved to another monitor
+}
+
+static void _sc_glfw_window_size_cb(GLFWwindow *window, int w, int h) {
+    _sc_refresh_rate_stale = true; // The window's center may have moved to another monitor
+}
+
+static void _sc_glfw_monitor_cb(GLFWmonitor *monitor, int event) {
+    _sc_refresh_rate_stale = true; // A monitor was connected or disconnected
+}
+
+static void _sc_glfw_wakeup() {
+    glfwPostEmptyEvent(); // Interrupt glfwWaitEventsTimeout; safe to call from any thread
+}
+
+static tl::expected<ImGuiContext *, std::string> _sc_imgui_startup(GLFWwindow *glfw_window) {
+    // Create an ImGui context with its GLFW and OpenGL implementations and fonts
+    // glfw_window is the GLFW window to attach to
+    // It returns the new context, or an error message after undoing any partial initialization
+
+    const auto imgui_ctx = ImGui::CreateContext(); // Create an ImGui context
+    if (!imgui_ctx) return tl::make_unexpected("Failed to create ImGui context."); // Return an error message if ImGui context creation fails
+
+    ImGui::GetIO().ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard; // Enable keyboard navigation in ImGui
+
+    if (!ImGui_ImplGlfw_InitForOpenGL(glfw_window, true)) { // Initialize the ImGui GLFW implementation
+        ImGui::DestroyContext(imgui_ctx);
+        return tl::make_unexpected("Failed to prepare ImGui GLFW implementation.");
+    }
+
+    if (!ImGui_ImplOpenGL3_Init("#version 130")) { // Initialize the ImGui OpenGL implementation
+        ImGui_ImplGlfw_Shutdown();
+        ImGui::DestroyContext(imgui_ctx);
+        return tl::make_unexpected("Failed to prepare ImGui OpenGL implementation.");
+    }
+
+    #ifdef SC_FEATURE_ENHANCED_FONTS
+        #pragma message("[EON] Using Freetype to enhance fonts.") // Display a message during compilation indicating the use of enhanced fonts with Freetype
+        if (!sc::font::imgui::load(SC_FONT_SIZE)) { // Load enhanced fonts with the specified font size
+            ImGui_ImplOpenGL3_Shutdown();
+            ImGui_ImplGlfw_Shutdown();
+            ImGui::DestroyContext(imgui_ctx);
+            return tl::make_unexpected("Failed to load fonts.");
+        }
+        _sc_freetype.needs_rebuild = true; // The new atlas has not been built yet
+        _sc_freetype.cache_path = SC_FONT_CACHE_FILE; // Reuse the atlas built by a previous run when nothing about the fonts changed
+    #endif
+
+    return imgui_ctx; // Return the new context
+}
+
+static void _sc_imgui_shutdown(ImGuiContext *imgui_ctx) {
+    // Shut down the ImGui implementations and destroy the context, releasing its GPU and CPU memory
+    // imgui_ctx is the context returned by _sc_imgui_startup
+
+    spdlog::debug("Shutting down ImGui OpenGL3..."); // Log a debug message
+    ImGui_ImplOpenGL3_Shutdown(); // Shutdown the ImGui OpenGL implementation
+    spdlog::debug("Shutting down ImGui GLFW..."); // Log a debug message
+    ImGui_ImplGlfw_Shutdown(); // Shutdown the ImGui GLFW implementation
+    spdlog::debug("Destroying ImGui context..."); // Log a debug message
+    ImGui::DestroyContext(imgui_ctx); // Destroy the ImGui context
+}
+
 static std::optional<std::string> _sc_bootstrap(std::function<std::optional<std::string>(GLFWwindow *, ImGuiContext *)> success_cb) {
     // Bootstrap function for initializing the application
     // success_cb is a callback function to be executed if the bootstrap is successful
@@ -122,6 +209,13 @@ static std::optional<std::string> _sc_bootstrap(std::function<std::optional<std:
     glfwSetWindowSizeLimits(glfw_window, SC_VIEW_MIN_W, SC_VIEW_MIN_H, GLFW_DONT_CARE, GLFW_DONT_CARE); // Set the minimum window size limits
     #endif
 
+    glfwSetWindowPosCallback(glfw_window, _sc_glfw_window_pos_cb); // Track window moves for the refresh rate lookup
+    glfwSetWindowSizeCallback(glfw_window, _sc_glfw_window_size_cb); // Track window resizes for the refresh rate lookup
+    glfwSetMonitorCallback(_sc_glfw_monitor_cb); // Track monitor changes for the refresh rate lookup; installed before ImGui, which chains to it
+
+    sc::boot::wakeup_hook = _sc_glfw_wakeup; // Let worker threads interrupt the main loop's wait
+    DEFER(sc::boot::wakeup_hook = nullptr);
+
     #ifdef SC_FEATURE_RENDER_ON_RESIZE
         #pragma message("[EON] Using rendering within window size callback.") // Display a message during compilation indicating the use of rendering within window size callback
         glfwSetFramebufferSizeCallback(glfw_window, _sc_glfw_window_resize_cb); // Set the GLFW framebuffer size callback function
@@ -133,31 +227,14 @@ static std::optional<std::string> _sc_bootstrap(std::function<std::optional<std:
     glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS); // Enable synchronous OpenGL debug output
     spdlog::debug("GL: {} ({})", glGetString(GL_VERSION), glGetString(GL_RENDERER)); // Log the OpenGL version and renderer information
 
-    const auto imgui_ctx = ImGui::CreateContext(); // Create an ImGui context
-    if (!imgui_ctx) return "Failed to create ImGui context."; // Return an error message if ImGui context creation fails
-
-    DEFER({
-        spdlog::debug("Destroying ImGui context..."); // Log a debug message
-        ImGui::DestroyContext(imgui_ctx); // Destroy the ImGui context
-    });
-
-    ImGui::GetIO().ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard; // Enable keyboard navigation in ImGui
-
-    if (!ImGui_ImplGlfw_InitForOpenGL(glfw_window, true)) return "Failed to prepare ImGui GLFW implementation."; // Initialize the ImGui GLFW implementation
-    DEFER({
-        spdlog::debug("Shutting down ImGui GLFW..."); // Log a debug message
-        ImGui_ImplGlfw_Shutdown(); // Shutdown the ImGui GLFW implementation
-    });
-
-    if (!ImGui_ImplOpenGL3_Init("#version 130")) return "Failed to prepare ImGui OpenGL implementation."; // Initialize the ImGui OpenGL implementation
-    DEFER({
-        spdlog::debug("Shutting down ImGui OpenGL3..."); // Log a debug message
-        ImGui_ImplOpenGL3_Shutdown(); // Shutdown the ImGui OpenGL implementation
-    });
-
-    #ifdef SC_FEATURE_ENHANCED_FONTS
-        #pragma message("[EON] Using Freetype to enhance fonts.") // Display a message during compilation indicating the use of enhanced fonts with Freetype
-        if (!sc::font::imgui::load(SC_FONT_SIZE)) return "Failed to load fonts."; // Load enhanced fonts with the specified font size
+    #ifdef SC_FEATURE_HEADLESS_BACKGROUND
+        #pragma message("[EON] Using headless background mode.") // Display a message during compilation indicating the use of headless background mode
+        ImGuiContext *const imgui_ctx = nullptr; // The ImGui context is created by _sc_run once the window is wanted
+    #else
+        const auto imgui_ctx_res = _sc_imgui_startup(glfw_window); // Create the ImGui context and its implementations
+        if (!imgui_ctx_res.has_value()) return imgui_ctx_res.error(); // Return an error message if the ImGui context could not be prepared
+        const auto imgui_ctx = *imgui_ctx_res;
+        DEFER(_sc_imgui_shutdown(imgui_ctx)); // Register the ImGui shutdown for deferred execution
     #endif
 
     #ifdef SC_FEATURE_CENTER_WINDOW
@@ -193,19 +270,37 @@ namespace sc::boot {
     static tl::expected<bool, std::string> on_fixed_update();
     static tl::expected<bool, std::string> on_update(const glm::ivec2 &framebuffer_size, bool *const force_redraw = nullptr);
     static void on_shutdown();
+
+    #ifdef SC_FEATURE_HEADLESS_BACKGROUND
+    static std::optional<std::string> on_ui_startup(); // Called after an ImGui context was created for the window
+    static void on_ui_shutdown(); // Called before the window's ImGui context is destroyed
+    static tl::expected<bool, std::string> on_service_update(); // Called instead of on_update while the window is hidden
+    #endif
 }
 
-static tl::expected<bool, std::string> _sc_glfw_process_events(GLFWwindow *glfw_window) {
-    // Process GLFW events and return true to continue the application or false to exit
+static tl::expected<bool, std::string> _sc_glfw_process_events(GLFWwindow *glfw_window, const std::chrono::steady_clock::time_point &deadline, const std::chrono::steady_clock::time_point &earliest) {
+    // Wait for GLFW events and return true to continue the application or false to exit
     // glfw_window is the GLFW window to process events for
+    // deadline is the latest time to return at, even without input or wakeups
+    // earliest is the earliest time to return at, which paces the loop to the refresh rate
+
+    if (const auto now = std::chrono::steady_clock::now(); now < deadline) glfwWaitEventsTimeout(std::chrono::duration<double>(deadline - now).count()); // Block until input, a wakeup or the deadline
+    else glfwPollEvents(); // Poll for events
+
+    for (auto now = std::chrono::steady_clock::now(); now < earliest; now = std::chrono::steady_clock::now()) {
+        glfwWaitEventsTimeout(std::chrono::duration<double>(earliest - now).count()); // Keep handling events until the next frame is due
+    }
 
-    glfwPollEvents(); // Poll for events
+    sc::boot::wakeup_pending = false; // Wakeups from here on are picked up by the next iteration
 
     if (glfwWindowShouldClose(glfw_window)) {
         glfwHideWindow(glfw_window); // Hide the window
 
         #ifdef SC_FEATURE_SYSTEM_TRAY
         glfwSetWindowShouldClose(glfw_window, GLFW_FALSE); // Set the window should not close flag
+            #ifdef SC_FEATURE_HEADLESS_BACKGROUND
+            _sc_ui_wanted = false; // Tear the UI down until the tray icon is clicked
+            #endif
         #else
         return false; // Return false to exit the application
         #endif
@@ -214,15 +309,103 @@ static tl::expected<bool, std::string> _sc_glfw_process_events(GLFWwindow *glfw_
     return true; // Return true to continue the application
 }
 
-static void _sc_glfw_render() {
+#ifdef SC_FEATURE_MINIMAL_REDRAW
+
+static GLuint _sc_back_buffer = 0; // Framebuffer object that keeps the previous frame, so only damaged rectangles need drawing
+static GLuint _sc_back_buffer_texture = 0; // Color attachment of the back buffer
+static glm::ivec2 _sc_back_buffer_size = { 0, 0 }; // Size the back buffer was created with
+static bool _sc_back_buffer_failed = false; // Set when the driver refused the framebuffer object; everything is then drawn directly
+
+static void _sc_release_back_buffer() {
+    // Delete the back buffer's GL objects
+
+    if (_sc_back_buffer) glDeleteFramebuffers(1, &_sc_back_buffer);
+    if (_sc_back_buffer_texture) glDeleteTextures(1, &_sc_back_buffer_texture);
+    _sc_back_buffer = _sc_back_buffer_texture = 0;
+    _sc_back_buffer_size = { 0, 0 };
+}
+
+static bool _sc_prepare_back_buffer(const glm::ivec2 &size) {
+    // Make sure the back buffer matches the framebuffer size and return whether it can be used
+    // size is the framebuffer size in pixels
+
+    if (_sc_back_buffer_failed) return false;
+    if (_sc_back_buffer && _sc_back_buffer_size == size) return true;
+
+    _sc_release_back_buffer();
+    glGenTextures(1, &_sc_back_buffer_texture);
+    glBindTexture(GL_TEXTURE_2D, _sc_back_buffer_texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size.x, size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glGenFramebuffers(1, &_sc_back_buffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, _sc_back_buffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _sc_back_buffer_texture, 0);
+    const auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        spdlog::warn("Unable to create the back buffer. Redrawing the whole window from now on."); // Log a warning message
+        _sc_release_back_buffer();
+        _sc_back_buffer_failed = true;
+        return false;
+    }
+
+    _sc_back_buffer_size = size;
+    return true;
+}
+
+static void _sc_render_damage(ImDrawData *const draw_data, const ImDrawDamage &damage) {
+    // Clear and draw again only the damaged rectangles of the bound back buffer, which holds the previous frame everywhere else
+    // draw_data is the ImGui draw data, whose clip rectangles are limited to one damaged rectangle per pass and restored afterwards
+    // damage is where the draw data changed since the previous frame, in whole display pixels
+
+    static std::vector<ImVec4> clip_rects; // The draw data's own clip rectangles
+    clip_rects.clear();
+    for (int i = 0; i < draw_data->CmdListsCount; i++) {
+        for (const auto &cmd : draw_data->CmdLists[i]->CmdBuffer) clip_rects.push_back(cmd.ClipRect);
+    }
+
+    const ImVec4 display = { draw_data->DisplayPos.x, draw_data->DisplayPos.y, draw_data->DisplayPos.x + draw_data->DisplaySize.x, draw_data->DisplayPos.y + draw_data->DisplaySize.y };
+    for (const auto &damaged : damage.rects) {
+        const auto rect = ImDrawDamage::Clip(damaged, display);
+        if (rect.x == -FLT_MAX) continue; // Off screen
+
+        glEnable(GL_SCISSOR_TEST); // Clear the rectangle only; the backend scissors the same pixels with the clip rectangles below
+        glScissor(static_cast<GLint>(rect.x - display.x), static_cast<GLint>(display.w - rect.w), static_cast<GLsizei>(rect.z - rect.x), static_cast<GLsizei>(rect.w - rect.y));
+        glClear(GL_COLOR_BUFFER_BIT);
+        glDisable(GL_SCISSOR_TEST);
+
+        size_t cmd_i = 0;
+        for (int i = 0; i < draw_data->CmdListsCount; i++) {
+            for (auto &cmd : draw_data->CmdLists[i]->CmdBuffer) cmd.ClipRect = ImDrawDamage::Clip(clip_rects[cmd_i++], rect);
+        }
+        ImGui_ImplOpenGL3_RenderDrawData(draw_data); // Render the ImGui draw data using OpenGL
+    }
+
+    size_t cmd_i = 0;
+    for (int i = 0; i < draw_data->CmdListsCount; i++) {
+        for (auto &cmd : draw_data->CmdLists[i]->CmdBuffer) cmd.ClipRect = clip_rects[cmd_i++];
+    }
+}
+
+#endif
+
+static void _sc_glfw_render(const ImDrawDamage *const damage = nullptr) {
     // Render ImGui and swap the GLFW window's buffers
+    // damage is where the draw data changed since the previously rendered frame, or nullptr to render everything
 
     const auto glfw_window = glfwGetCurrentContext(); // Get the current GLFW window
     const auto draw_data = ImGui::GetDrawData(); // Get the ImGui draw data
 
-    glClearColor(0, 0, 0, 0); // Clear the color buffer
-    glClear(GL_COLOR_BUFFER_BIT); // Clear the color buffer
-
+    #if defined(SC_FEATURE_HEADLESS_BACKGROUND)
+    if (!glfwGetWindowAttrib(glfw_window, GLFW_VISIBLE)) {
+        spdlog::debug("First render of the UI complete. Making window visible."); // Log a debug message
+        glfwShowWindow(glfw_window); // Show the window
+        glfwRestoreWindow(glfw_window); // Restore the window from minimized or maximized state
+    }
+    #else
     #ifdef SC_FEATURE_SYSTEM_TRAY
     if (static bool bg = program.get<bool>("--background"); !bg) {
     #else
@@ -234,8 +417,32 @@ static void _sc_glfw_render() {
             shown_window = true;
         }
     }
+    #endif
+
+    glClearColor(0, 0, 0, 0); // Clear the color buffer
+
+    #ifdef SC_FEATURE_MINIMAL_REDRAW
+    const bool back_buffer_fresh = _sc_back_buffer_size != _sc_current_framebuffer_size; // A new back buffer holds nothing to keep
+    if (_sc_prepare_back_buffer(_sc_current_framebuffer_size)) {
+        const bool scaled = draw_data->FramebufferScale.x != 1 || draw_data->FramebufferScale.y != 1; // Whole display pixels are only whole framebuffer pixels without scaling
+        glBindFramebuffer(GL_FRAMEBUFFER, _sc_back_buffer);
+        if (!damage || damage->full || back_buffer_fresh || scaled) {
+            glClear(GL_COLOR_BUFFER_BIT); // Clear the color buffer
+            ImGui_ImplOpenGL3_RenderDrawData(draw_data); // Render the ImGui draw data using OpenGL
+        } else _sc_render_damage(draw_data, *damage);
+
+        // The window's own back buffer is undefined after a swap, so the whole frame is copied; a copy costs far less fill rate than blended UI
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, _sc_back_buffer);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        glBlitFramebuffer(0, 0, _sc_back_buffer_size.x, _sc_back_buffer_size.y, 0, 0, _sc_back_buffer_size.x, _sc_back_buffer_size.y, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    } else
+    #endif
+    {
+        glClear(GL_COLOR_BUFFER_BIT); // Clear the color buffer
+        ImGui_ImplOpenGL3_RenderDrawData(draw_data); // Render the ImGui draw data using OpenGL
+    }
 
-    ImGui_ImplOpenGL3_RenderDrawData(draw_data); // Render the ImGui draw data using OpenGL
     glfwSwapBuffers(glfw_window); // Swap the window's buffers
 }
 
@@ -244,10 +451,10 @@ static tl::expected<bool, std::string> _sc_imgui_render(bool *const force_redraw
     // force_redraw is a pointer to a flag indicating whether a redraw is forced
 
     #ifdef SC_FEATURE_ENHANCED_FONTS
-        static ImFreetypeEnablement freetype;
-        freetype.PreNewFrame();
+        _sc_freetype.PreNewFrame();
     #endif
 
+    ImFrameArena::Get().Reset(); // Labels formatted during the previous frame are no longer referenced
     ImGui_ImplOpenGL3_NewFrame(); // Start a new ImGui frame for OpenGL
     ImGui_ImplGlfw_NewFrame(); // Start a new ImGui frame for GLFW
     ImGui::NewFrame(); // Start a new ImGui frame
@@ -275,10 +482,42 @@ static void _sc_glfw_window_resize_cb(GLFWwindow *window, int w, int h) {
 
     glViewport(0, 0, w, h); // Set the OpenGL viewport
 
+    if (!ImGui::GetCurrentContext()) return; // Nothing to draw while the UI is torn down
+
     _sc_imgui_render(); // Render the ImGui UI
     _sc_glfw_render(); // Render the GLFW window
 }
 
+static int _sc_find_refresh_rate(GLFWwindow *glfw_window) {
+    // Find the refresh rate of the monitor that contains the window's center
+    // glfw_window is the GLFW window
+
+    int num_monitors;
+    const auto monitors = glfwGetMonitors(&num_monitors);
+    if (num_monitors > 0) {
+        int wx, wy;
+        glfwGetWindowPos(glfw_window, &wx, &wy);
+        int ww, wh;
+        glfwGetWindowSize(glfw_window, &ww, &wh);
+        if (ww > 0 && wh > 0) {
+            for (int i = 0; i < num_monitors; i++) {
+                int dx, dy;
+                glfwGetMonitorPos(monitors[i], &dx, &dy);
+                const auto video_mode = glfwGetVideoMode(monitors[i]);
+                if (!video_mode) continue;
+                const int wcx = wx + (ww / 2);
+                const int wcy = wy + (wh / 2);
+                if (wcx >= dx && wcx < dx + video_mode->width) {
+                    if (wcy >= dy && wcy < dy + video_mode->height) {
+                        if (video_mode->refreshRate > 0) return video_mode->refreshRate; // Return the monitor's refresh rate
+                    }
+                }
+            }
+        }
+    }
+    return 60; // Default refresh rate
+}
+
 static std::optional<std::string> _sc_run(GLFWwindow *glfw_window, ImGuiContext *imgui_ctx) {
     // Main function for running the application
     // glfw_window is the GLFW window
@@ -288,71 +527,92 @@ static std::optional<std::string> _sc_run(GLFWwindow *glfw_window, ImGuiContext
 
     if (const auto res = sc::boot::on_startup(); res.has_value()) return *res; // Call the on_startup function and return an error message if it fails
 
+    #ifdef SC_FEATURE_HEADLESS_BACKGROUND
+        auto ui_ctx = imgui_ctx; // Only exists while the window is wanted
+        DEFER({
+            if (ui_ctx) {
+                sc::boot::on_ui_shutdown(); // Let the application release its UI resources first
+                _sc_imgui_shutdown(ui_ctx);
+            }
+        });
+    #endif
+
     #ifdef SC_FEATURE_SYSTEM_TRAY
         #pragma message("[EON] Using system tray.") // Display a message during compilation indicating the use of system tray
+        #ifdef SC_FEATURE_HEADLESS_BACKGROUND
+        _sc_ui_wanted = !program.get<bool>("--background"); // Start without a UI when launched into the tray
+        sc::systray::enable([]() {
+            _sc_ui_wanted = true; // The main loop creates the UI and shows the window after its first render
+            sc::boot::wakeup(); // Bring the UI up right away instead of at the next idle update
+        });
+        #else
         sc::systray::enable([glfw_window]() {
             glfwShowWindow(glfw_window); // Show the window
             glfwRestoreWindow(glfw_window); // Restore the window from minimized or maximized state
             _sc_force_redraw = true; // Set the force redraw flag
+            sc::boot::wakeup(); // Redraw right away instead of at the next idle update
         });
+        #endif
         DEFER(sc::systray::disable()); // Register the systray disable function for deferred execution
     #endif
 
     #ifdef SC_FEATURE_MINIMAL_REDRAW
         #pragma message("[EON] Using redraw minimization.") // Display a message during compilation indicating the use of redraw minimization
         ImDrawCompare im_draw_cache;
+        DEFER(_sc_release_back_buffer()); // Release the back buffer while the GL context still exists
     #endif
 
     glm::ivec2 recent_framebuffer_size { 0, 0 }; // Initialize the recent framebuffer size as (0, 0)
 
+    int hz = 60; // Refresh rate of the monitor the window is on, looked up again only when it may have changed
+    std::chrono::steady_clock::time_point last_update; // Start of the most recent iteration; the first iteration runs immediately
+
     for (;;) {
-        if (const auto res = _sc_glfw_process_events(glfw_window); res.has_value()) {
+        const auto frame_interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / hz));
+        auto deadline = last_update + std::chrono::milliseconds(SC_IDLE_UPDATE_MS);
+        if (const auto scheduled = sc::boot::take_scheduled_update(); scheduled && *scheduled < deadline) deadline = *scheduled;
+
+        if (const auto res = _sc_glfw_process_events(glfw_window, deadline, last_update + frame_interval); res.has_value()) {
             if (!*res) {
                 spdlog::warn("Quit signalled."); // Log a warning message
                 break; // Break the loop to exit the application
             }
         } else return res.error();
 
-        const auto hz = [&]() -> std::optional<int> {
-            int num_monitors;
-            const auto monitors = glfwGetMonitors(&num_monitors);
-            if (num_monitors > 0) {
-                int wx, wy;
-                glfwGetWindowPos(glfw_window, &wx, &wy);
-                int ww, wh;
-                glfwGetWindowSize(glfw_window, &ww, &wh);
-                if (ww > 0 && wh > 0) {
-                    for (int i = 0; i < num_monitors; i++) {
-                        int dx, dy;
-                        glfwGetMonitorPos(monitors[i], &dx, &dy);
-                        const auto video_mode = glfwGetVideoMode(monitors[i]);
-                        if (!video_mode) continue;
-                        const int wcx = wx + (ww / 2);
-                        const int wcy = wy + (wh / 2);
-                        if (wcx >= dx && wcx < dx + video_mode->width) {
-                            if (wcy >= dy && wcy < dy + video_mode->height) {
-                                return video_mode->refreshRate; // Return the monitor's refresh rate
-                            }
-                        }
-                    }
-                }
-            }
-            return 60; // Default refresh rate
-        }();
+        last_update = std::chrono::steady_clock::now();
 
-        {
-            static auto last_hz = hz;
-            if (hz && hz && *hz != *last_hz) spdlog::debug("Changing refresh rate to {}/second.", *hz); // Log a debug message
-            last_hz = hz;
+        #ifdef SC_FEATURE_HEADLESS_BACKGROUND
+        if (!_sc_ui_wanted) {
+            if (ui_ctx) {
+                spdlog::debug("Window hidden. Tearing down the UI."); // Log a debug message
+                sc::boot::on_ui_shutdown(); // Let the application release its UI resources first
+                _sc_imgui_shutdown(ui_ctx);
+                ui_ctx = nullptr;
+            }
+            if (const auto res = sc::boot::on_service_update(); res.has_value()) {
+                if (!*res) break; // Break the loop to exit the application
+            } else return res.error();
+            continue; // Continue to the next iteration of the loop without building a frame
         }
+        if (!ui_ctx) {
+            spdlog::debug("Window wanted. Bringing up the UI."); // Log a debug message
+            const auto res = _sc_imgui_startup(glfw_window); // Create a fresh ImGui context
+            if (!res.has_value()) return res.error();
+            ui_ctx = *res;
+            if (const auto err = sc::boot::on_ui_startup(); err.has_value()) return *err; // Let the application prepare its UI resources
+            #ifdef SC_FEATURE_MINIMAL_REDRAW
+            im_draw_cache = { }; // The previous context's draw data says nothing about the new one
+            #endif
+            recent_framebuffer_size = { 0, 0 }; // Set the viewport again
+            _sc_force_redraw = true; // Set the force redraw flag
+        }
+        #endif
 
-        {
-            static auto last_info = std::chrono::system_clock::now();
-            const auto now = std::chrono::system_clock::now();
-            if (hz && std::chrono::duration_cast<std::chrono::milliseconds>(now - last_info).count() > 3000) {
-                spdlog::debug("Refresh rate is {}/second.", *hz); // Log a debug message
-                last_info = now;
-            }            
+        if (_sc_refresh_rate_stale) {
+            _sc_refresh_rate_stale = false;
+            const auto found_hz = _sc_find_refresh_rate(glfw_window);
+            if (found_hz != hz) spdlog::debug("Changing refresh rate to {}/second.", found_hz); // Log a debug message
+            hz = found_hz;
         }
 
         _sc_current_framebuffer_size = [&]() -> glm::ivec2 {
@@ -376,12 +636,14 @@ static std::optional<std::string> _sc_run(GLFWwindow *glfw_window, ImGuiContext
 
         #ifdef SC_FEATURE_MINIMAL_REDRAW
             const bool draw_data_changed = !im_draw_cache.Check(draw_data);
+            if (draw_data_changed) sc::boot::schedule(); // Keep updating until the UI settles, e.g. hover and popup transitions
+            if (ImGui::GetIO().WantTextInput) sc::boot::schedule(std::chrono::milliseconds(500)); // Keep the text cursor blinking
             const bool need_redraw = force_redraw || framebuffer_size_changed || draw_data_changed || _sc_force_redraw;
-            if (!need_redraw) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(1000 / (hz ? *hz : 60))); // Sleep to reduce the frame rate
-                continue; // Continue to the next iteration of the loop
-            }
+            if (!need_redraw) continue; // Continue to the next iteration of the loop, which waits for something to change
+            force_redraw = force_redraw || _sc_force_redraw; // Either way, the whole window is drawn again below
             _sc_force_redraw = false;
+        #else
+            sc::boot::schedule(); // Without redraw minimization every iteration renders, paced to the refresh rate
         #endif
 
         if (framebuffer_size_changed) {
@@ -391,7 +653,12 @@ static std::optional<std::string> _sc_run(GLFWwindow *glfw_window, ImGuiContext
             recent_framebuffer_size.y = _sc_current_framebuffer_size.y;
         }
 
+        #ifdef SC_FEATURE_MINIMAL_REDRAW
+        const auto damage = (force_redraw || framebuffer_size_changed) ? nullptr : &im_draw_cache.damage; // Only the changed rectangles, unless everything was asked for
+        if (_sc_current_framebuffer_size.x && _sc_current_framebuffer_size.y) _sc_glfw_render(damage); // Render the GLFW window if the framebuffer size is valid
+        #else
         if (_sc_current_framebuffer_size.x && _sc_current_framebuffer_size.y) _sc_glfw_render(); // Render the GLFW window if the framebuffer size is valid
+        #endif
 
         static uint64_t num_frame_i = 0;
         num_frame_i++;
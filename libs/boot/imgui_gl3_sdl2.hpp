@@ -176,6 +176,7 @@ static std::optional<std::string> _sc_run(SDL_Window *sdl_window, ImGuiContext *
         #ifdef SC_FEATURE_ENHANCED_FONTS
             freetype.PreNewFrame();
         #endif
+        ImFrameArena::Get().Reset();
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplSDL2_NewFrame();
         ImGui::NewFrame();
@@ -0,0 +1,180 @@
+#include "startup.h"
+#include "wakeup.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+#include <nlohmann/json.hpp>
+
+sc::boot::task_graph::task_graph() : origin(std::chrono::steady_clock::now()) {}
+
+sc::boot::task_graph::~task_graph() {
+    wait();
+    for (auto &worker : workers) worker.join();
+}
+
+std::optional<std::string> sc::boot::task_graph::add(const std::string &name, const std::vector<std::string> &dependencies, task_function fn) {
+    std::lock_guard guard(mutex);
+    if (started) return fmt::format("Unable to add task \"{}\" after startup began.", name);
+    const auto find = [this](const std::string &name) {
+        return std::find_if(tasks.begin(), tasks.end(), [&](const task &t) { return t.name == name; });
+    };
+    if (find(name) != tasks.end()) return fmt::format("Duplicate task: {}", name);
+    for (const auto &dependency : dependencies) {
+        if (find(dependency) == tasks.end()) return fmt::format("Task \"{}\" depends on unknown task \"{}\".", name, dependency);
+    }
+    const auto task_i = tasks.size();
+    for (const auto &dependency : dependencies) find(dependency)->dependents.push_back(task_i);
+    task new_task;
+    new_task.name = name;
+    new_task.num_dependencies = dependencies.size();
+    new_task.num_waiting = dependencies.size();
+    new_task.fn = std::move(fn);
+    tasks.push_back(std::move(new_task));
+    return std::nullopt;
+}
+
+void sc::boot::task_graph::start(const size_t &num_threads) {
+    {
+        std::lock_guard guard(mutex);
+        if (started) return;
+        started = true;
+        num_unfinished = tasks.size();
+        for (size_t i = 0; i < tasks.size(); i++) {
+            if (!tasks[i].num_dependencies) ready.push_back(i);
+        }
+        if (!num_unfinished) completed = std::chrono::steady_clock::now();
+    }
+    const auto num_workers = std::min<size_t>(num_threads ? num_threads : std::max(1u, std::thread::hardware_concurrency()), tasks.size());
+    for (size_t i = 0; i < num_workers; i++) workers.emplace_back(&task_graph::work, this, i);
+}
+
+void sc::boot::task_graph::mark(const std::string &name) {
+    std::lock_guard guard(mutex);
+    marks.emplace_back(name, std::chrono::steady_clock::now());
+}
+
+void sc::boot::task_graph::wait() {
+    std::unique_lock lock(mutex);
+    cv.wait(lock, [this]() { return !started || !num_unfinished; });
+}
+
+bool sc::boot::task_graph::finished() const {
+    std::lock_guard guard(mutex);
+    return started && !num_unfinished;
+}
+
+std::optional<sc::boot::task_graph::state> sc::boot::task_graph::status(const std::string &name) const {
+    std::lock_guard guard(mutex);
+    for (const auto &t : tasks) if (t.name == name) return t.status;
+    return std::nullopt;
+}
+
+std::optional<std::string> sc::boot::task_graph::error(const std::string &name) const {
+    std::lock_guard guard(mutex);
+    for (const auto &t : tasks) if (t.name == name) return t.error;
+    return std::nullopt;
+}
+
+std::vector<sc::boot::task_graph::task_status> sc::boot::task_graph::snapshot() const {
+    std::lock_guard guard(mutex);
+    std::vector<task_status> res;
+    res.reserve(tasks.size());
+    for (const auto &t : tasks) res.push_back({ t.name, t.status, t.error });
+    return res;
+}
+
+std::chrono::steady_clock::duration sc::boot::task_graph::elapsed() const {
+    std::lock_guard guard(mutex);
+    return completed.value_or(std::chrono::steady_clock::now()) - origin;
+}
+
+std::optional<std::string> sc::boot::task_graph::save_trace(const std::filesystem::path &path) const {
+    const auto us = [this](const std::chrono::steady_clock::time_point &at) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(at - origin).count();
+    };
+    auto events = nlohmann::json::array();
+    {
+        std::lock_guard guard(mutex);
+        for (const auto &t : tasks) {
+            if (t.status != state::done && t.status != state::failed) continue;
+            nlohmann::json event = {
+                { "name", t.name },
+                { "ph", "X" },
+                { "pid", 1 },
+                { "tid", t.worker_i },
+                { "ts", us(t.started) },
+                { "dur", us(t.ended) - us(t.started) }
+            };
+            if (t.error) event["args"] = { { "error", *t.error } };
+            events.push_back(std::move(event));
+        }
+        for (const auto &[name, at] : marks) {
+            events.push_back({ { "name", name }, { "ph", "i" }, { "s", "g" }, { "pid", 1 }, { "tid", 0 }, { "ts", us(at) } });
+        }
+    }
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) return fmt::format("Unable to open: {}", path.string());
+    file << nlohmann::json({ { "traceEvents", std::move(events) }, { "displayTimeUnit", "ms" } }).dump();
+    if (!file) return fmt::format("Unable to write: {}", path.string());
+    return std::nullopt;
+}
+
+void sc::boot::task_graph::work(const size_t &worker_i) {
+    std::unique_lock lock(mutex);
+    for (;;) {
+        cv.wait(lock, [this]() { return !ready.empty() || !num_unfinished; });
+        if (ready.empty()) return;
+        const auto task_i = ready.front();
+        ready.pop_front();
+        auto &t = tasks[task_i];
+        t.status = state::running;
+        t.worker_i = worker_i;
+        t.started = std::chrono::steady_clock::now();
+        const auto fn = std::move(t.fn);
+        lock.unlock();
+        std::optional<std::string> error;
+        try {
+            error = fn();
+        } catch (const std::exception &exc) { // Fails the task, instead of ending the process from a worker thread
+            error = fmt::format("Unexpected error: {}", exc.what());
+        } catch (...) {
+            error = "Unexpected error.";
+        }
+        lock.lock();
+        finish(task_i, std::move(error));
+    }
+}
+
+void sc::boot::task_graph::finish(const size_t &task_i, std::optional<std::string> error) {
+    // A failed task fails everything that depends on it, without running it.
+    std::vector<std::pair<size_t, std::optional<std::string>>> finishing = { { task_i, std::move(error) } };
+    while (!finishing.empty()) {
+        auto [i, err] = std::move(finishing.back());
+        finishing.pop_back();
+        auto &t = tasks[i];
+        if (t.status == state::done || t.status == state::failed) continue; // Reached through two failed dependencies
+        t.ended = std::chrono::steady_clock::now();
+        if (t.status == state::pending) t.started = t.ended;
+        t.status = err ? state::failed : state::done;
+        t.error = std::move(err);
+        num_unfinished--;
+        if (t.error) spdlog::warn("Startup task \"{}\" failed: {}", t.name, *t.error);
+        else spdlog::debug("Startup task \"{}\" finished in {} ms.", t.name, std::chrono::duration_cast<std::chrono::milliseconds>(t.ended - t.started).count());
+        for (const auto dependent_i : t.dependents) {
+            auto &dependent = tasks[dependent_i];
+            if (dependent.status != state::pending) continue;
+            if (t.error) {
+                dependent.num_waiting = SIZE_MAX; // Never becomes ready, even when its other dependencies succeed
+                finishing.emplace_back(dependent_i, fmt::format("Dependency \"{}\" failed.", t.name));
+            } else if (!--dependent.num_waiting) ready.push_back(dependent_i);
+        }
+    }
+    if (!num_unfinished) completed = std::chrono::steady_clock::now();
+    cv.notify_all();
+    wakeup(); // Let the UI show the new readiness
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <chrono> // Include the library for time points and durations
+#include <condition_variable> // Include the library for condition variables
+#include <deque> // Include the library for double-ended queues
+#include <filesystem> // Include the library for file paths
+#include <functional> // Include the library for function objects
+#include <mutex> // Include the library for mutexes
+#include <optional> // Include the library for optional values
+#include <string> // Include the library for strings
+#include <thread> // Include the library for threads
+#include <utility> // Include the library for pairs
+#include <vector> // Include the library for vectors
+
+namespace sc::boot {
+
+    // Runs startup work as a graph of tasks on a small thread pool, so independent subsystems initialize concurrently
+    // while the main loop already renders. A task starts once all of its dependencies are done; if one of them failed, it fails too.
+    // Every task is timed, and the timings can be written as a Chrome trace (chrome://tracing, Perfetto) to catch startup regressions.
+    struct task_graph {
+
+        enum class state { pending, running, done, failed };
+
+        using task_function = std::function<std::optional<std::string>()>; // Returns an error message on failure
+
+        struct task_status {
+
+            std::string name;
+            state status;
+            std::optional<std::string> error;
+        };
+
+        task_graph();
+        task_graph(const task_graph &) = delete;
+        task_graph &operator=(const task_graph &) = delete;
+        ~task_graph(); // Waits for running tasks
+
+        // Adds a task; dependencies must have been added before. Tasks cannot be added after start().
+        std::optional<std::string> add(const std::string &name, const std::vector<std::string> &dependencies, task_function fn);
+
+        // Starts running the tasks on up to num_threads threads (0 picks one per hardware thread, up to the number of tasks).
+        void start(const size_t &num_threads = 0);
+
+        // Records an instant event in the trace, e.g. the first frame; callable from any thread.
+        void mark(const std::string &name);
+
+        void wait(); // Blocks until every task has finished
+        bool finished() const; // Whether every task has finished, successfully or not
+        std::optional<state> status(const std::string &name) const;
+        std::optional<std::string> error(const std::string &name) const;
+        std::vector<task_status> snapshot() const; // Every task's status, in the order they were added
+        std::chrono::steady_clock::duration elapsed() const; // From construction until the last task finished, or until now
+
+        std::optional<std::string> save_trace(const std::filesystem::path &path) const;
+
+    private:
+
+        struct task {
+
+            std::string name;
+            std::vector<size_t> dependents;
+            size_t num_dependencies = 0;
+            size_t num_waiting = 0; // Dependencies that haven't finished yet
+            task_function fn;
+            state status = state::pending;
+            std::optional<std::string> error;
+            std::chrono::steady_clock::time_point started, ended;
+            size_t worker_i = 0;
+        };
+
+        void work(const size_t &worker_i);
+        void finish(const size_t &task_i, std::optional<std::string> error); // Called with the mutex held
+
+        mutable std::mutex mutex;
+        std::condition_variable cv;
+        std::vector<task> tasks;
+        std::deque<size_t> ready; // Tasks whose dependencies are all done, in the order they became ready
+        std::vector<std::thread> workers;
+        std::vector<std::pair<std::string, std::chrono::steady_clock::time_point>> marks;
+        size_t num_unfinished = 0;
+        bool started = false;
+        const std::chrono::steady_clock::time_point origin;
+        std::optional<std::chrono::steady_clock::time_point> completed;
+    };
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic> // Include the library for atomic operations
+#include <chrono> // Include the library for time points and durations
+#include <cstdint> // Include the library for fixed width integers
+#include <optional> // Include the library for optional values
+
+namespace sc::boot {
+
+    // The main loop blocks until there is input, a wakeup, or a scheduled update is due.
+    // Worker threads call wakeup() when they have produced something the UI should show;
+    // code running in an update that polls without producing events (joysticks, animations) calls schedule() to be updated again.
+
+    inline std::atomic<void (*)()> wakeup_hook = nullptr; // Installed by the boot header; interrupts the main loop's wait
+    inline std::atomic_bool wakeup_pending = false; // Coalesces wakeups so the loop receives at most one per iteration
+    inline std::atomic<int64_t> scheduled_update_ns = INT64_MAX; // Steady clock time of the earliest requested update
+
+    // Wakes the main loop from any thread. Cheap enough to call on every change.
+    inline void wakeup() {
+        if (wakeup_pending.exchange(true, std::memory_order_acq_rel)) return;
+        if (const auto hook = wakeup_hook.load(std::memory_order_acquire); hook) hook();
+    }
+
+    // Asks the main loop to run an update no later than `delay` from now. Only the earliest request is kept.
+    inline void schedule(const std::chrono::steady_clock::duration &delay = std::chrono::steady_clock::duration::zero()) {
+        const int64_t at = std::chrono::duration_cast<std::chrono::nanoseconds>((std::chrono::steady_clock::now() + delay).time_since_epoch()).count();
+        auto current = scheduled_update_ns.load(std::memory_order_relaxed);
+        while (at < current && !scheduled_update_ns.compare_exchange_weak(current, at, std::memory_order_acq_rel));
+    }
+
+    // Takes the earliest requested update, resetting the schedule. Called by the main loop once per iteration.
+    inline std::optional<std::chrono::steady_clock::time_point> take_scheduled_update() {
+        const auto at = scheduled_update_ns.exchange(INT64_MAX, std::memory_order_acq_rel);
+        if (at == INT64_MAX) return std::nullopt;
+        return std::chrono::steady_clock::time_point(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(at)));
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <iostream>
+#include <string_view>
+
+// The harness of the libraries' test executables: check() records failures as they happen, and main() returns what
+// finish() gives it, so a failing test exits non-zero.
+
+namespace sc::test {
+
+    inline int num_failures = 0; // Checks failed so far
+
+    // Reports "what" was expected, unless it "passed"
+    inline void check(const bool &passed, const std::string_view &what) {
+        if (passed) return;
+        std::cerr << "FAILED: " << what << std::endl;
+        num_failures++;
+    }
+
+    // Prints the summary of the "suite" and returns main()'s exit code
+    inline int finish(const std::string_view &suite) {
+        if (num_failures) std::cerr << num_failures << " check(s) failed" << std::endl;
+        else std::cout << "All " << suite << " checks passed" << std::endl;
+        return num_failures ? 1 : 0;
+    }
+}
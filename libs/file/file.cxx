@@ -1,10 +1,52 @@
 #include "file.h"  // We are including the file.h file we wrote earlier.
 
 #include <fstream>  // This is a library that lets us work with files.
+#include <algorithm>  // This helps us pick the smallest of two things.
+#include <cerrno>  // This tells us why the computer said no.
+#include <cstring>  // This turns that reason into words.
+
+// These let us talk to the operating system directly, so we can ask it to really put our data on the disk.
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+    #include <io.h>
+    #include <fcntl.h>
+    #include <share.h>
+    #include <sys/stat.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+// This reads one file, without looking for a backup.
+static tl::expected<std::vector<std::byte>, std::string> load_one(const std::filesystem::path &path);
 
 // Now we're defining how the 'load' function works.
 tl::expected<std::vector<std::byte>, std::string> sc::file::load(const std::filesystem::path &path) {
 
+    // We try the file first. If it is there and has something in it, that's what we give back.
+    auto res = load_one(path);
+    if (res.has_value()) return res;
+
+    // If not, a crash may have happened right between putting the backup aside and putting the new file in place,
+    // so we try the backup. If that doesn't work either, we tell the caller what was wrong with the file itself.
+    if (auto backup = load_one(backup_path(path)); backup.has_value()) return backup;
+    return res;
+}
+
+// This is where a file's backup lives: right next to it, with ".bak" added to its name.
+std::filesystem::path sc::file::backup_path(const std::filesystem::path &path) {
+    auto res = path;
+    res += ".bak";
+    return res;
+}
+
+// Now we're defining how the 'load_one' function works.
+static tl::expected<std::vector<std::byte>, std::string> load_one(const std::filesystem::path &path) {
+
     // We're trying to open the file at the 'path' we were given. We open it in binary mode (which means we're reading the raw data, not text), 
     // and we're starting at the end of the file.
     std::ifstream ifs(path, std::ios::binary | std::ios::ate);
@@ -37,18 +79,250 @@ tl::expected<std::vector<std::byte>, std::string> sc::file::load(const std::file
 // Now we're defining how the 'save' function works.
 std::optional<std::string> sc::file::save(const std::filesystem::path &path, const std::vector<std::byte> &data) {
 
-    // We're trying to open the file at the 'path' we were given. We open it in binary mode, and 'trunc' means we delete anything that was in the file before.
-    std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+    // We write everything to a temporary file next to the real one first, so the real one stays whole while we work.
+    auto tmp_path = path;
+    tmp_path += ".tmp";
+
+    // We open the temporary file in binary mode, and delete anything that was left in it by an earlier crash.
+#ifdef _WIN32
+    int fd = -1;
+    _wsopen_s(&fd, tmp_path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _SH_DENYWR, _S_IREAD | _S_IWRITE);
+#else
+    const int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
 
     // If we couldn't open the file, we return an error message.
-    if (!ofs) return "Unable to open file.";
+    if (fd < 0) return "Unable to open file.";
+
+    // We try to write our data to the file, a piece at a time if the computer wants it that way.
+    for (size_t written = 0; written < data.size();) {
+#ifdef _WIN32
+        const auto n = _write(fd, data.data() + written, static_cast<unsigned int>(data.size() - written));
+#else
+        const auto n = write(fd, data.data() + written, data.size() - written);
+#endif
+        if (n <= 0) {
+#ifdef _WIN32
+            _close(fd);
+#else
+            close(fd);
+#endif
+            // If we couldn't write to the file, we return an error message.
+            return "Unable to write data.";
+        }
+        written += static_cast<size_t>(n);
+    }
+
+    // We ask the computer to really put the data on the disk, not just keep it in memory for later.
+#ifdef _WIN32
+    const auto synced = _commit(fd) == 0;
+    _close(fd);
+#else
+    const auto synced = fsync(fd) == 0;
+    close(fd);
+#endif
+    if (!synced) return "Unable to flush data to disk.";
 
-    // We try to write our data to the file.
-    ofs.write(reinterpret_cast<const char *>(data.data()), data.size());
+    // We keep the old file as the backup. Moving a file within a folder happens all at once, so there is never half a file.
+    std::error_code ec;
+    if (std::filesystem::exists(path, ec)) std::filesystem::rename(path, backup_path(path), ec);
 
-    // If we couldn't write to the file, we return an error message.
-    if (!ofs) return "Unable to write data.";
+    // Now we put the new file in its place, again all at once.
+    std::filesystem::rename(tmp_path, path, ec);
+    if (ec) return ec.message();
+
+#ifndef _WIN32
+    // On some systems the move itself only reaches the disk once the folder is flushed too.
+    const auto dir = path.has_parent_path() ? path.parent_path() : std::filesystem::path(".");
+    if (const int dir_fd = open(dir.c_str(), O_RDONLY); dir_fd >= 0) {
+        fsync(dir_fd);
+        close(dir_fd);
+    }
+#endif
 
     // If we got this far, everything worked! We don't return anything, which is what 'nullopt' means.
     return std::nullopt;
 }
+
+// Mapping a file asks the computer to show the file's bytes at an address in memory, and to read them from disk only when touched.
+tl::expected<sc::file::mapping, std::string> sc::file::mapping::open(const std::filesystem::path &path) {
+    mapping res;
+#ifdef _WIN32
+    // Sharing delete lets save rename a new version over this one while it's mapped
+    const auto file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return tl::make_unexpected("Unable to open file.");
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return tl::make_unexpected("Unable to determine file size.");
+    }
+    const auto section = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);  // The section keeps the file open
+    if (!section) return tl::make_unexpected("Unable to map file.");
+    const auto view = MapViewOfFile(section, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(section);  // The view keeps the section alive
+    if (!view) return tl::make_unexpected("Unable to map file.");
+    res.view = static_cast<const std::byte *>(view);
+    res.length = static_cast<size_t>(size.QuadPart);
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return tl::make_unexpected("Unable to open file.");
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return tl::make_unexpected("Unable to determine file size.");
+    }
+    const auto view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // The mapping keeps the file open
+    if (view == MAP_FAILED) return tl::make_unexpected(std::strerror(errno));
+    res.view = static_cast<const std::byte *>(view);
+    res.length = static_cast<size_t>(info.st_size);
+#endif
+    return res;
+}
+
+// Moving a mapping hands it over; the one moved from maps nothing anymore.
+sc::file::mapping::mapping(mapping &&other) noexcept : view(other.view), length(other.length) {
+    other.view = nullptr;
+    other.length = 0;
+}
+
+sc::file::mapping &sc::file::mapping::operator=(mapping &&other) noexcept {
+    if (this == &other) return *this;
+    this->~mapping();
+    view = other.view;
+    length = other.length;
+    other.view = nullptr;
+    other.length = 0;
+    return *this;
+}
+
+// When the mapping goes away, the computer forgets the address it gave us.
+sc::file::mapping::~mapping() {
+    if (!view) return;
+#ifdef _WIN32
+    UnmapViewOfFile(view);
+#else
+    munmap(const_cast<std::byte *>(view), length);
+#endif
+    view = nullptr;
+}
+
+// The writer starts its helper thread right away; the thread sleeps until there is something to save.
+sc::file::writer::writer(const std::chrono::milliseconds &coalesce) : coalesce(coalesce) {
+    thread = std::thread([this]() { run(); });
+}
+
+// Before the writer goes away, it saves everything still waiting, so nothing queued is lost.
+sc::file::writer::~writer() {
+    {
+        std::lock_guard guard(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (thread.joinable()) thread.join();
+}
+
+// Queuing a save only puts it in the list; a newer save of the same file replaces the older one but keeps its place in time,
+// so a file that is saved all the time is still written at least every "coalesce".
+void sc::file::writer::save(const std::filesystem::path &path, serializer serialize) {
+    {
+        std::lock_guard guard(mutex);
+        if (const auto existing = queued.find(path); existing != queued.end()) existing->second.serialize = std::move(serialize);
+        else queued[path] = { std::move(serialize), std::chrono::steady_clock::now() + coalesce };
+    }
+    wake.notify_all();
+}
+
+void sc::file::writer::save(const std::filesystem::path &path, std::vector<std::byte> data) {
+    save(path, [data = std::move(data)]() { return data; });
+}
+
+// Flushing tells the helper not to wait for newer saves, then waits until the list is empty and nothing is being written.
+std::optional<std::string> sc::file::writer::flush() {
+    std::unique_lock lock(mutex);
+    flushing++;
+    wake.notify_all();
+    done.wait(lock, [&]() { return queued.empty() && !writing; });
+    flushing--;
+    std::optional<std::string> res;
+    if (!errors.empty()) res = std::move(errors.front().second);
+    errors.clear();
+    return res;
+}
+
+// Flushing one file still hurries every save along, but only waits for that file, and leaves the errors of the others alone.
+std::optional<std::string> sc::file::writer::flush(const std::filesystem::path &path) {
+    std::unique_lock lock(mutex);
+    flushing++;
+    wake.notify_all();
+    done.wait(lock, [&]() { return !queued.count(path) && !writing; });
+    flushing--;
+    const auto it = std::find_if(errors.begin(), errors.end(), [&](const auto &entry) { return entry.first == path; });
+    if (it == errors.end()) return std::nullopt;
+    auto res = std::move(it->second);
+    errors.erase(it);
+    return res;
+}
+
+std::optional<std::string> sc::file::writer::error() {
+    std::lock_guard guard(mutex);
+    std::optional<std::string> res;
+    if (!errors.empty()) res = std::move(errors.front().second);
+    errors.clear();
+    return res;
+}
+
+uint64_t sc::file::writer::num_writes() const {
+    std::lock_guard guard(mutex);
+    return writes;
+}
+
+sc::file::writer &sc::file::writer::shared() {
+    static writer instance;
+    return instance;
+}
+
+// This is what the helper thread does all day: wait for saves that are due, then write them one after another.
+void sc::file::writer::run() {
+    std::unique_lock lock(mutex);
+    for (;;) {
+        // We sleep until there is something in the list, or we're asked to stop.
+        wake.wait(lock, [&]() { return stopping || !queued.empty(); });
+        if (queued.empty()) return;  // Only when stopping, with nothing left to save
+
+        // We find the save that is due first, and wait for it unless someone is in a hurry.
+        auto due = std::chrono::steady_clock::time_point::max();
+        for (const auto &[path, entry] : queued) due = std::min(due, entry.due);
+        if (!stopping && !flushing && std::chrono::steady_clock::now() < due) {
+            wake.wait_until(lock, due, [&]() { return stopping || flushing > 0; });
+            continue;  // A newer save may have arrived meanwhile; look at the list again
+        }
+
+        // We take every save that is due out of the list, so new saves can be queued while we write.
+        std::vector<std::pair<std::filesystem::path, serializer>> batch;
+        const auto now = std::chrono::steady_clock::now();
+        for (auto it = queued.begin(); it != queued.end();) {
+            if (stopping || flushing || it->second.due <= now) {
+                batch.emplace_back(it->first, std::move(it->second.serialize));
+                it = queued.erase(it);
+            } else it++;
+        }
+        writing = true;
+        lock.unlock();
+
+        // The slow part happens without holding the lock: turning the settings into bytes and writing them.
+        std::vector<std::pair<std::filesystem::path, std::string>> batch_errors;
+        for (const auto &[path, serialize] : batch) {
+            if (const auto err = sc::file::save(path, serialize()); err) batch_errors.emplace_back(path, path.string() + ": " + *err);
+        }
+
+        lock.lock();
+        writing = false;
+        writes += batch.size();
+        for (auto &[path, err] : batch_errors) {  // A file that already failed keeps its first error
+            if (std::none_of(errors.begin(), errors.end(), [&](const auto &entry) { return entry.first == path; })) errors.emplace_back(path, std::move(err));
+        }
+        done.notify_all();
+    }
+}
@@ -17,6 +17,15 @@
 // Optional is like a box that might have a present (a value) in it, or it might be empty.
 #include <optional>
 
+// Chrono measures time, function holds a piece of work to run later, and mutex, condition_variable and thread let
+// a helper work in the background without stepping on anyone's toes.
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+
 // Tl/expected is a tool that tells us if a task was successful or gives us an error message if it failed.
 #include <tl/expected.hpp>
 
@@ -26,10 +35,84 @@ namespace sc::file {
     // This is a function called load. You give it a path (like an address of a file) and it tries to get all the data from that file.
     // If it can get the data, it gives you the data as a bunch of bytes (like tiny pieces of information). 
     // If it can't, it tells you why with a string (text).
+    // If the file is missing or empty, it reads the backup that save keeps next to it ("<path>.bak") instead.
     tl::expected<std::vector<std::byte>, std::string> load(const std::filesystem::path &path);  // end of load function declaration
 
     // This function is called save. You give it a path and some data (those tiny pieces of information), and it tries to save the data to that file.
     // If everything goes okay, it doesn't give you anything back. 
     // But if something goes wrong, it gives you a string (text) that tells you what happened.
+    // It never writes over the file itself: it writes a temporary file, makes sure it reached the disk, keeps the old file as
+    // "<path>.bak" and only then puts the new one in its place. A crash leaves either the old or the new file, never half of one.
     std::optional<std::string> save(const std::filesystem::path &path, const std::vector<std::byte> &data); // end of save function declaration
+
+    // The backup save keeps of a file.
+    std::filesystem::path backup_path(const std::filesystem::path &path);
+
+    // A whole file, mapped read-only into memory. The computer pages it in as it's read, so opening is instant however big the
+    // file is. Save never writes into a file, it renames a new one into place, so a mapping keeps showing the content it
+    // was opened with. On Windows, a file that is still mapped can't be deleted, so drop the mapping before saving twice.
+    class mapping {
+    public:
+
+        static tl::expected<mapping, std::string> open(const std::filesystem::path &path);  // An empty file is an error
+
+        mapping() = default;
+        mapping(mapping &&other) noexcept;
+        mapping &operator=(mapping &&other) noexcept;
+        ~mapping();
+
+        const std::byte *data() const { return view; }
+        size_t size() const { return length; }
+
+    private:
+
+        const std::byte *view = nullptr;
+        size_t length = 0;
+    };
+
+    // A helper that saves files in the background, so the UI never waits for the disk.
+    // You hand it a path and a small piece of work that turns a copy of your settings into bytes. If you hand it the same
+    // path again before it got to it, only the newest piece of work runs, so a burst of saves becomes one write.
+    class writer {
+    public:
+
+        using serializer = std::function<std::vector<std::byte>()>;  // Runs on the writer's thread; it must only use what it captured
+
+        explicit writer(const std::chrono::milliseconds &coalesce = std::chrono::milliseconds(250));  // How long a save waits for newer ones
+        ~writer();  // Writes whatever is still waiting before it goes away
+
+        writer(const writer &) = delete;
+        writer &operator=(const writer &) = delete;
+
+        void save(const std::filesystem::path &path, serializer serialize);  // Queues a save and returns right away
+        void save(const std::filesystem::path &path, std::vector<std::byte> data);  // Same, for bytes that are ready
+
+        std::optional<std::string> flush();  // Waits until everything queued is on disk; gives back the first error since the last check
+        std::optional<std::string> flush(const std::filesystem::path &path);  // Same, for one file and only its error; others stay for the next check
+        std::optional<std::string> error();  // Gives back the first error since the last check without waiting
+
+        uint64_t num_writes() const;  // How many files were written so far
+
+        static writer &shared();  // The writer the whole app uses
+
+    private:
+
+        struct pending {
+
+            serializer serialize;
+            std::chrono::steady_clock::time_point due;  // When the first save of a burst was queued, plus the coalesce time
+        };
+
+        void run();
+
+        std::chrono::milliseconds coalesce;
+        mutable std::mutex mutex;
+        std::condition_variable wake, done;  // "wake" for the writer's thread, "done" for whoever waits in flush()
+        std::map<std::filesystem::path, pending> queued;
+        int flushing = 0;  // How many callers wait in flush(); while there are any, nothing waits for newer saves
+        bool writing = false, stopping = false;
+        std::vector<std::pair<std::filesystem::path, std::string>> errors;  // Not checked yet, oldest first, one per file
+        uint64_t writes = 0;
+        std::thread thread;
+    };
 }  // end of sc::file namespace
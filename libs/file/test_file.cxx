@@ -0,0 +1,88 @@
+#include "file.h"
+
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+#include "../check.hpp"
+
+using sc::test::check;
+
+static std::vector<std::byte> bytes(const std::string &text) {
+    std::vector<std::byte> res(text.size());
+    std::memcpy(res.data(), text.data(), text.size());
+    return res;
+}
+
+static std::string text(const tl::expected<std::vector<std::byte>, std::string> &res) {
+    if (!res.has_value()) return "<" + res.error() + ">";
+    return std::string(reinterpret_cast<const char *>(res->data()), res->size());
+}
+
+static void test_save(const std::filesystem::path &dir) {
+    const auto path = dir / "settings.json";
+    check(!sc::file::save(path, bytes("one")), "a new file is saved");
+    check(text(sc::file::load(path)) == "one", "a saved file loads");
+    check(!sc::file::save(path, bytes("two")), "a file is saved over");
+    check(text(sc::file::load(path)) == "two", "the newest version loads");
+    check(text(sc::file::load(sc::file::backup_path(path))) == "one", "the previous version is kept as the backup");
+    check(!std::filesystem::exists(dir / "settings.json.tmp"), "no temporary file is left behind");
+
+    // A crash between putting the backup aside and renaming the new file into place
+    std::filesystem::remove(path);
+    check(text(sc::file::load(path)) == "one", "a missing file falls back to the backup");
+
+    // An empty file, as an in-place write that was cut short left it
+    std::ofstream(path, std::ios::trunc).close();
+    check(text(sc::file::load(path)) == "one", "an empty file falls back to the backup");
+
+    check(!sc::file::load(dir / "missing.json").has_value(), "a file without a backup still fails to load");
+
+    const auto mapped_path = dir / "profiles.bin";
+    check(!sc::file::save(mapped_path, bytes("mapped")), "a file to map is saved");
+    if (auto mapped = sc::file::mapping::open(mapped_path); !mapped.has_value()) check(false, "a saved file can be mapped");
+    else {
+        check(std::string(reinterpret_cast<const char *>(mapped->data()), mapped->size()) == "mapped", "a mapping shows the file");
+        auto moved = std::move(*mapped);
+        check(!sc::file::save(mapped_path, bytes("replaced")), "a mapped file is saved over");
+        check(std::string(reinterpret_cast<const char *>(moved.data()), moved.size()) == "mapped", "a mapping keeps showing what it was opened with");
+    }
+    std::ofstream(dir / "empty.bin", std::ios::trunc).close();
+    check(!sc::file::mapping::open(dir / "empty.bin").has_value(), "an empty file can't be mapped");
+}
+
+static void test_writer(const std::filesystem::path &dir) {
+    const auto path = dir / "virtual-pedals.json";
+    {
+        sc::file::writer writer(std::chrono::milliseconds(100));
+        std::atomic<int> num_serialized = 0;
+        for (int i = 0; i < 100; i++) writer.save(path, [&, i]() { num_serialized++; return bytes(std::to_string(i)); });
+        check(!writer.flush(), "a burst of saves is written");
+        check(num_serialized == 1, "a burst of saves is serialized once");
+        check(writer.num_writes() == 1, "a burst of saves is written once");
+        check(text(sc::file::load(path)) == "99", "the newest save of a burst wins");
+
+        writer.save(path, bytes("queued"));
+        check(writer.num_writes() == 1, "a save waits for newer ones");
+        writer.save(dir / "no-such-dir" / "x.json", bytes("x"));
+        const auto err = writer.flush();
+        check(err.has_value(), "a failed write is reported by flush");
+        check(!writer.error(), "an error is reported once");
+        check(text(sc::file::load(path)) == "queued", "flush writes saves that weren't due yet");
+
+        writer.save(path, bytes("at exit"));
+    }
+    check(text(sc::file::load(path)) == "at exit", "destroying the writer writes what is still queued");
+}
+
+int main() {
+    const auto dir = std::filesystem::temp_directory_path() / ("visor-test-file-" + std::to_string(std::random_device()()));
+    std::filesystem::create_directories(dir);
+    test_save(dir);
+    test_writer(dir);
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+    return sc::test::finish("file");
+}
@@ -0,0 +1,304 @@
+#include "avr109.h"
+
+#include <spdlog/spdlog.h>
+#include <fmt/format.h>
+
+#include <algorithm>
+
+using namespace std::chrono_literals;
+
+// Pages sent before waiting for the oldest to be acknowledged. Two is enough for the next page to be on its way while the
+// bootloader programs one; USB flow control holds back anything more, so a deeper window gains nothing.
+static constexpr size_t pages_in_flight = 2;
+
+static constexpr auto reply_timeout = 1000ms;
+static constexpr auto erase_timeout = 10000ms; // Caterina erases the application section a page at a time, about a second
+
+static std::byte to_byte(const char &c) { return static_cast<std::byte>(c); }
+static std::byte to_byte(const size_t &value) { return static_cast<std::byte>(value & 0xFF); }
+
+std::optional<std::string> sc::firmware::avr109::programmer::send() {
+    return comm.write(command);
+}
+
+std::optional<std::string> sc::firmware::avr109::programmer::receive(std::byte *data, const size_t &size, const std::chrono::milliseconds &timeout) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    size_t num_received = 0;
+    while (num_received < size) {
+        const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (remaining <= 0ms) return "The bootloader stopped answering.";
+        const auto res = comm.read_some(data + num_received, size - num_received, remaining);
+        if (!res.has_value()) return res.error();
+        num_received += *res;
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> sc::firmware::avr109::programmer::expect_acks(const size_t &count, const std::string_view &what, const std::chrono::milliseconds &timeout) {
+    std::array<std::byte, 4> replies;
+    for (size_t i = 0; i < count; ) {
+        const auto n = std::min(count - i, replies.size());
+        if (const auto err = receive(replies.data(), n, timeout); err) return err;
+        for (size_t j = 0; j < n; j++) {
+            if (replies[j] == to_byte('\r')) continue;
+            if (replies[j] == to_byte('?')) return fmt::format("The bootloader doesn't support {}.", what);
+            return fmt::format("The bootloader refused {}.", what);
+        }
+        i += n;
+    }
+    return std::nullopt;
+}
+
+bool sc::firmware::avr109::programmer::put_address(const size_t &address) {
+    if (next_address == address) return false;
+    const auto word_address = address / 2; // Flash is addressed in 16-bit words
+    command.insert(command.end(), { to_byte('A'), to_byte(word_address >> 8), to_byte(word_address) });
+    return true;
+}
+
+std::vector<size_t> sc::firmware::avr109::programmer::pages(const ihex::image &image) const {
+    std::vector<size_t> res;
+    for (size_t address = 0; address < image.bytes.size(); address += block_size) {
+        if (image.has_data(address, block_size)) res.push_back(address);
+    }
+    return res;
+}
+
+tl::expected<sc::firmware::avr109::device_info, std::string> sc::firmware::avr109::programmer::connect() {
+    // Whatever an earlier session left unread would be taken for replies
+    std::array<std::byte, 64> stale;
+    for (;;) {
+        const auto res = comm.read_some(stale.data(), stale.size(), 0ms);
+        if (!res.has_value()) return tl::make_unexpected(res.error());
+        if (!*res) break;
+    }
+
+    // Software id, auto-increment, block size, programming mode and signature, asked all at once
+    command.assign({ to_byte('S'), to_byte('a'), to_byte('b'), to_byte('P'), to_byte('s') });
+    if (const auto err = send(); err) return tl::make_unexpected(*err);
+    device_info info;
+    std::array<std::byte, 7> software_id;
+    if (const auto err = receive(software_id.data(), software_id.size(), reply_timeout); err) return tl::make_unexpected(*err);
+    info.software_id.assign(reinterpret_cast<const char *>(software_id.data()), software_id.size());
+    std::array<std::byte, 3> reply;
+    if (const auto err = receive(reply.data(), 2, reply_timeout); err) return tl::make_unexpected(*err);
+    auto_increment = reply[0] == to_byte('Y');
+    if (reply[1] != to_byte('Y')) return tl::make_unexpected(fmt::format("The bootloader ({}) has no block mode.", info.software_id));
+    if (const auto err = receive(reply.data(), 2, reply_timeout); err) return tl::make_unexpected(*err);
+    block_size = std::to_integer<size_t>(reply[0]) << 8 | std::to_integer<size_t>(reply[1]);
+    if (block_size == 0 || block_size % 2) return tl::make_unexpected(fmt::format("The bootloader reports an unusable block size of {}.", block_size));
+    if (const auto err = expect_acks(1, "programming mode", reply_timeout); err) return tl::make_unexpected(*err);
+    if (const auto err = receive(reply.data(), 3, reply_timeout); err) return tl::make_unexpected(*err);
+    for (size_t i = 0; i < 3; i++) info.signature[i] = std::to_integer<uint8_t>(reply[2 - i]); // Sent last byte first
+    info.block_size = block_size;
+    next_address = std::nullopt;
+    return info;
+}
+
+std::optional<std::string> sc::firmware::avr109::programmer::erase() {
+    if (!block_size) return "Not connected to the bootloader.";
+    command.assign({ to_byte('e') });
+    if (const auto err = send(); err) return err;
+    return expect_acks(1, "erasing", erase_timeout);
+}
+
+std::optional<std::string> sc::firmware::avr109::programmer::write(const ihex::image &image, const progress_callback &on_progress) {
+    if (!block_size) return "Not connected to the bootloader.";
+    const auto list = pages(image);
+    std::vector<uint8_t> acks(list.size()); // Replies each page's commands are owed
+    size_t num_acked = 0;
+    const auto wait_oldest = [&]() -> std::optional<std::string> {
+        if (const auto err = expect_acks(acks[num_acked], fmt::format("writing 0x{:04X}", list[num_acked]), reply_timeout); err) return err;
+        num_acked++;
+        if (on_progress) on_progress(num_acked * block_size, list.size() * block_size);
+        return std::nullopt;
+    };
+    for (size_t i = 0; i < list.size(); i++) {
+        const auto address = list[i];
+        command.clear();
+        acks[i] = put_address(address) ? 2 : 1;
+        command.insert(command.end(), { to_byte('B'), to_byte(block_size >> 8), to_byte(block_size), to_byte('F') });
+        const auto available = std::min(block_size, image.bytes.size() - address);
+        command.insert(command.end(), image.bytes.begin() + address, image.bytes.begin() + address + available);
+        command.resize(command.size() + block_size - available, std::byte { 0xFF });
+        next_address = auto_increment ? std::optional(address + block_size) : std::nullopt;
+        if (const auto err = send(); err) return err;
+        if (i + 1 - num_acked >= pages_in_flight) {
+            if (const auto err = wait_oldest(); err) return err;
+        }
+    }
+    while (num_acked < list.size()) {
+        if (const auto err = wait_oldest(); err) return err;
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> sc::firmware::avr109::programmer::verify(const ihex::image &image, const progress_callback &on_progress) {
+    if (!block_size) return "Not connected to the bootloader.";
+    const auto list = pages(image);
+    std::vector<uint8_t> addressed(list.size()); // Whether each page's read came after an 'A', which is owed a reply first
+    std::vector<std::byte> page(block_size);
+    size_t num_checked = 0;
+    const auto check_oldest = [&]() -> std::optional<std::string> {
+        const auto address = list[num_checked];
+        if (addressed[num_checked]) {
+            if (const auto err = expect_acks(1, "setting the address", reply_timeout); err) return err;
+        }
+        if (const auto err = receive(page.data(), page.size(), reply_timeout); err) return err;
+        for (size_t i = 0; i < block_size && address + i < image.bytes.size(); i++) {
+            if (image.written[address + i] && page[i] != image.bytes[address + i]) {
+                return fmt::format("Verification failed at 0x{:04X}: wrote 0x{:02X}, read 0x{:02X}.", address + i, std::to_integer<int>(image.bytes[address + i]), std::to_integer<int>(page[i]));
+            }
+        }
+        num_checked++;
+        if (on_progress) on_progress(num_checked * block_size, list.size() * block_size);
+        return std::nullopt;
+    };
+    for (size_t i = 0; i < list.size(); i++) {
+        command.clear();
+        addressed[i] = put_address(list[i]);
+        command.insert(command.end(), { to_byte('g'), to_byte(block_size >> 8), to_byte(block_size), to_byte('F') });
+        next_address = auto_increment ? std::optional(list[i] + block_size) : std::nullopt;
+        if (const auto err = send(); err) return err;
+        if (i + 1 - num_checked >= pages_in_flight) {
+            if (const auto err = check_oldest(); err) return err;
+        }
+    }
+    while (num_checked < list.size()) {
+        if (const auto err = check_oldest(); err) return err;
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> sc::firmware::avr109::programmer::leave() {
+    if (!block_size) return "Not connected to the bootloader.";
+    command.assign({ to_byte('L'), to_byte('E') });
+    if (const auto err = send(); err) return err;
+    block_size = 0;
+    return expect_acks(2, "starting the application", reply_timeout);
+}
+
+tl::expected<std::string, std::string> sc::firmware::avr109::wait_for_bootloader(const std::optional<std::string> &reset_port, const std::chrono::milliseconds &timeout, const std::vector<serial::usb_id> &accepted) {
+    auto known = serial::list_ports();
+    if (!known.has_value()) return tl::make_unexpected(known.error());
+    if (reset_port) {
+        serial::comm_instance touch;
+        if (const auto err = touch.open(*reset_port, 1200); err) return tl::make_unexpected(*err);
+        touch.close();
+    }
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(100ms);
+        const auto now = serial::list_ports();
+        if (!now.has_value()) return tl::make_unexpected(now.error());
+        for (const auto &port : *now) {
+            if (std::find(known->begin(), known->end(), port) != known->end()) continue;
+            if (accepted.empty()) return port;
+            const auto id = serial::port_usb_id(port);
+            if (!id) continue; // Can't be told yet; asked again next time
+            if (std::find(accepted.begin(), accepted.end(), *id) != accepted.end()) return port;
+            spdlog::debug("Ignoring {} ({:04x}:{:04x}), which appeared while waiting for the bootloader but isn't one.", port, id->vendor, id->product);
+            known->push_back(port);
+        }
+        // A board that resets drops its port; when the bootloader comes up under the same name, that is a new port too
+        known->erase(std::remove_if(known->begin(), known->end(), [&](const std::string &port) {
+            return std::find(now->begin(), now->end(), port) == now->end();
+        }), known->end());
+    }
+    return tl::make_unexpected("The bootloader didn't show up; press the reset button on the device and try again.");
+}
+
+const char *sc::firmware::avr109::describe(const stage &value) {
+    switch (value) {
+        case stage::reading: return "Reading the firmware";
+        case stage::waiting_for_bootloader: return "Waiting for the bootloader";
+        case stage::connecting: return "Connecting";
+        case stage::erasing: return "Erasing";
+        case stage::writing: return "Writing";
+        case stage::verifying: return "Verifying";
+        case stage::finishing: return "Starting the new firmware";
+        case stage::done: return "Done";
+        case stage::failed: return "Failed";
+    }
+    return "";
+}
+
+sc::firmware::avr109::flash_job::flash_job(flash_options options) : options(std::move(options)) {
+    thread = std::thread(&flash_job::run, this);
+}
+
+sc::firmware::avr109::flash_job::~flash_job() {
+    if (thread.joinable()) thread.join();
+}
+
+float sc::firmware::avr109::flash_job::fraction() const {
+    const auto total_bytes = total.load(std::memory_order_relaxed);
+    return total_bytes ? static_cast<float>(done.load(std::memory_order_relaxed)) / total_bytes : 0.f;
+}
+
+std::optional<std::string> sc::firmware::avr109::flash_job::error() const {
+    std::lock_guard guard(error_mutex);
+    return last_error;
+}
+
+void sc::firmware::avr109::flash_job::report(const stage &value, const size_t &done_bytes, const size_t &total_bytes) {
+    done.store(done_bytes, std::memory_order_relaxed);
+    total.store(total_bytes, std::memory_order_relaxed);
+    current.store(value, std::memory_order_release);
+    if (options.on_progress) options.on_progress();
+}
+
+void sc::firmware::avr109::flash_job::run() {
+    if (const auto err = flash(); err) {
+        spdlog::error("Unable to flash {}: {}", options.hex_path.filename().string(), *err);
+        {
+            std::lock_guard guard(error_mutex);
+            last_error = err;
+        }
+        report(stage::failed);
+    } else {
+        spdlog::info("Flashed {}", options.hex_path.filename().string());
+        report(stage::done);
+    }
+}
+
+std::optional<std::string> sc::firmware::avr109::flash_job::flash() {
+    // Read the file first, so a bad one fails before the board is reset
+    const auto image = ihex::load(options.hex_path, options.max_size);
+    if (!image.has_value()) return image.error();
+    if (std::find(image->written.begin(), image->written.end(), true) == image->written.end()) return "The firmware file has no data.";
+
+    report(stage::waiting_for_bootloader);
+    auto port = options.port;
+    if (!port) {
+        const auto found = wait_for_bootloader(options.reset_port, options.bootloader_timeout, options.bootloader_ids);
+        if (!found.has_value()) return found.error();
+        port = *found;
+    }
+
+    // A port that has just appeared may not open for a moment
+    report(stage::connecting);
+    serial::comm_instance comm;
+    const auto open_deadline = std::chrono::steady_clock::now() + 2s;
+    while (const auto err = comm.open(*port, options.baud_rate)) {
+        if (std::chrono::steady_clock::now() > open_deadline) return err;
+        std::this_thread::sleep_for(100ms);
+    }
+    programmer device(comm);
+    const auto info = device.connect();
+    if (!info.has_value()) return info.error();
+    if (info->signature != options.signature) {
+        device.leave();
+        return fmt::format("The firmware is for another microcontroller; the bootloader reports signature {:02X}{:02X}{:02X}.", info->signature[0], info->signature[1], info->signature[2]);
+    }
+    spdlog::debug("Bootloader {} on {}, {}-byte pages", info->software_id, *port, info->block_size);
+
+    report(stage::erasing);
+    if (const auto err = device.erase(); err) return err;
+    report(stage::writing);
+    if (const auto err = device.write(*image, [&](const size_t &done, const size_t &total) { report(stage::writing, done, total); }); err) return err;
+    report(stage::verifying);
+    if (const auto err = device.verify(*image, [&](const size_t &done, const size_t &total) { report(stage::verifying, done, total); }); err) return err;
+    report(stage::finishing);
+    return device.leave();
+}
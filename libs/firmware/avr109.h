@@ -0,0 +1,139 @@
+#pragma once
+
+#include "ihex.h"  // Include the Intel HEX reader
+#include "../serial/serial.h"  // Include the serial port library
+
+#include <tl/expected.hpp>  // Include a library for handling expected results
+
+#include <array>  // Include a library for arrays
+#include <atomic>  // Include a library for atomic operations
+#include <chrono>  // Include a library for durations
+#include <cstddef>  // Include a library for size-related types
+#include <filesystem>  // Include a library for paths
+#include <functional>  // Include a library for callbacks
+#include <mutex>  // Include a library for mutexes (locks)
+#include <optional>  // Include a library for optional values
+#include <string>  // Include a library for strings
+#include <thread>  // Include a library for threads
+#include <vector>  // Include a library for dynamic arrays
+
+namespace sc::firmware::avr109 {
+
+    constexpr std::array<uint8_t, 3> atmega32u4_signature = { 0x1E, 0x95, 0x87 };  // The MK4's microcontroller, as on the Leonardo
+    constexpr size_t atmega32u4_application_size = 0x7000;  // The flash below the 4 KiB Caterina bootloader
+    constexpr std::array<serial::usb_id, 2> caterina_ids = { { { 0x2341, 0x0036 }, { 0x2341, 0x0037 } } };  // Caterina on Leonardo-class boards, like the MK4, and on the Micro
+
+    // What the bootloader said about itself
+    struct device_info {
+
+        std::string software_id;  // "CATERIN" for the Caterina bootloader
+        std::array<uint8_t, 3> signature = { };  // The microcontroller's signature bytes
+        size_t block_size = 0;  // The flash page size, which block writes must match
+    };
+
+    using progress_callback = std::function<void(const size_t &done, const size_t &total)>;
+
+    // Talks the AVR109 protocol of Atmel's application note, as the Caterina bootloader implements it. Writes and reads
+    // go a flash page at a time in block mode, skip pages the image has no data for, and keep a couple of pages in flight
+    // so the bootloader programs one page while the next is on its way.
+    class programmer {
+    public:
+
+        explicit programmer(serial::comm_instance &comm) : comm(comm) { }
+
+        // Function to identify the bootloader and enter programming mode
+        tl::expected<device_info, std::string> connect();
+
+        // Function to erase the application section of the flash
+        std::optional<std::string> erase();
+
+        // Function to write every page an image has data for
+        std::optional<std::string> write(const ihex::image &image, const progress_callback &on_progress = { });
+
+        // Function to read back every page an image has data for and compare it
+        std::optional<std::string> verify(const ihex::image &image, const progress_callback &on_progress = { });
+
+        // Function to leave programming mode and start the application
+        std::optional<std::string> leave();
+
+    private:
+
+        std::optional<std::string> send();  // Function to write the command gathered in "command"
+        std::optional<std::string> receive(std::byte *data, const size_t &size, const std::chrono::milliseconds &timeout);  // Function to wait for a reply
+        std::optional<std::string> expect_acks(const size_t &count, const std::string_view &what, const std::chrono::milliseconds &timeout);  // Function to wait for "\r" replies
+        bool put_address(const size_t &address);  // Function to add an 'A' command unless the address is already there; true if it was added
+        std::vector<size_t> pages(const ihex::image &image) const;  // Function to list the pages an image has data for
+
+        serial::comm_instance &comm;
+        size_t block_size = 0;
+        bool auto_increment = false;
+        std::optional<size_t> next_address;  // Where the bootloader's address points, if known
+        std::vector<std::byte> command;  // Reused for every command, so a flash doesn't allocate per page
+    };
+
+    // Function to find the port of a bootloader that has just started: the reset port, if given, is opened and closed at
+    // 1200 baud, which resets Arduino-style boards into their bootloader; then the first port that wasn't there before wins.
+    // Unless "accepted" is empty, a new port only counts if its USB device is one of those, so other boards are left alone.
+    tl::expected<std::string, std::string> wait_for_bootloader(const std::optional<std::string> &reset_port, const std::chrono::milliseconds &timeout, const std::vector<serial::usb_id> &accepted = { });
+
+    // What a flash_job is doing
+    enum class stage {
+
+        reading,
+        waiting_for_bootloader,
+        connecting,
+        erasing,
+        writing,
+        verifying,
+        finishing,
+        done,
+        failed,
+    };
+
+    // Function to describe a stage to the user
+    const char *describe(const stage &value);
+
+    struct flash_options {
+
+        std::filesystem::path hex_path;  // The firmware to write
+        std::optional<std::string> port;  // The bootloader's port, if known; otherwise the job waits for one to appear
+        std::optional<std::string> reset_port;  // The application's port, to reset the board into its bootloader
+        std::vector<serial::usb_id> bootloader_ids = { caterina_ids.begin(), caterina_ids.end() };  // What a port that appears must be to count as the bootloader; empty for any
+        std::chrono::milliseconds bootloader_timeout = std::chrono::seconds(15);  // How long to wait for the bootloader, e.g. for the user to press reset
+        uint32_t baud_rate = 57600;  // Ignored by USB bootloaders, but the port needs one
+        std::array<uint8_t, 3> signature = atmega32u4_signature;  // The microcontroller the firmware is built for
+        size_t max_size = atmega32u4_application_size;  // The flash the firmware may use
+        std::function<void()> on_progress;  // Called on the job's thread whenever its stage or progress changes, e.g. to wake the UI
+    };
+
+    // Flashes firmware on its own thread, from reading the file to starting the new application. The UI reads the stage
+    // and progress every frame without waiting on anything. A flash can't be stopped halfway, so destroying a job waits
+    // for it to finish.
+    class flash_job {
+    public:
+
+        explicit flash_job(flash_options options);
+        ~flash_job();
+
+        flash_job(const flash_job &) = delete;
+        flash_job &operator=(const flash_job &) = delete;
+
+        stage current_stage() const { return current.load(std::memory_order_acquire); }  // Function to get the current stage
+        float fraction() const;  // Function to get how much of the current stage is done, from 0 to 1
+        bool finished() const { const auto value = current_stage(); return value == stage::done || value == stage::failed; }  // Function to check if the job is over
+        std::optional<std::string> error() const;  // Function to get why the job failed, if it did
+
+    private:
+
+        void run();  // Function to do the job
+        std::optional<std::string> flash();  // Function to do the job, returning why it failed
+        void report(const stage &value, const size_t &done = 0, const size_t &total = 0);  // Function to publish progress
+
+        flash_options options;
+        std::atomic<stage> current = stage::reading;
+        std::atomic<size_t> done = 0, total = 0;
+        mutable std::mutex error_mutex;
+        std::optional<std::string> last_error;
+        std::thread thread;
+    };
+}
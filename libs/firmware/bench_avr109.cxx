@@ -0,0 +1,140 @@
+#include "avr109.h"
+#include "stand_in_bootloader.h"
+
+#include <spdlog/spdlog.h>
+#include <fmt/format.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <random>
+
+using namespace sc::firmware;
+using bench_clock = std::chrono::steady_clock;
+
+// Firmware shaped like the MK4's: code from the start of flash, and a calibration table further up
+static std::string make_hex() {
+    std::mt19937 rng(5);
+    std::string res;
+    const auto put = [&](const uint32_t &address, const size_t &size) {
+        for (size_t i = 0; i < size; i += 16) {
+            const auto offset = static_cast<uint16_t>(address + i);
+            uint8_t sum = static_cast<uint8_t>(16 + (offset >> 8) + (offset & 0xFF));
+            res += fmt::format(":10{:04X}00", offset);
+            for (int j = 0; j < 16; j++) {
+                const auto value = static_cast<uint8_t>(rng());
+                res += fmt::format("{:02X}", value);
+                sum = static_cast<uint8_t>(sum + value);
+            }
+            res += fmt::format("{:02X}\r\n", static_cast<uint8_t>(-sum));
+        }
+    };
+    put(0, 22 * 1024);
+    put(0x6800, 1024);
+    return res + ":00000001FF\r\n";
+}
+
+// The commands avrdude's avr109 programmer sends, each waiting for its reply: the identification it does on connect, a
+// chip erase, block writes from the first address to the last, and reading all of it back to verify
+static std::optional<std::string> flash_like_avrdude(const std::string &port, const ihex::image &image) {
+    sc::serial::comm_instance comm;
+    if (const auto err = comm.open(port, 57600); err) return err;
+    const auto transact = [&](const std::vector<std::byte> &command, const size_t &reply_size) -> std::optional<std::string> {
+        if (const auto err = comm.write(command); err) return err;
+        std::vector<std::byte> reply(reply_size);
+        for (size_t at = 0; at < reply_size; ) {
+            const auto res = comm.read_some(reply.data() + at, reply_size - at, std::chrono::milliseconds(1000));
+            if (!res.has_value()) return res.error();
+            if (!*res) return "The bootloader stopped answering.";
+            at += *res;
+        }
+        return std::nullopt;
+    };
+    const auto bytes = [](const std::initializer_list<int> &values) {
+        std::vector<std::byte> res;
+        for (const auto &value : values) res.push_back(static_cast<std::byte>(value));
+        return res;
+    };
+    for (const auto &[command, reply_size] : std::initializer_list<std::pair<std::vector<std::byte>, size_t>> {
+        { bytes({ 'S' }), 7 }, { bytes({ 'V' }), 2 }, { bytes({ 'p' }), 1 }, { bytes({ 'a' }), 1 }, { bytes({ 'b' }), 3 },
+        { bytes({ 't' }), 2 }, { bytes({ 'T', 0x44 }), 1 }, { bytes({ 'P' }), 1 }, { bytes({ 's' }), 3 }, { bytes({ 'e' }), 1 },
+    }) {
+        if (const auto err = transact(command, reply_size); err) return err;
+    }
+    constexpr size_t block_size = avr109::stand_in_bootloader::page_size;
+    for (const auto read_back : { false, true }) {
+        if (const auto err = transact(bytes({ 'A', 0, 0 }), 1); err) return err;
+        for (size_t address = 0; address < image.bytes.size(); address += block_size) {
+            auto command = bytes({ read_back ? 'g' : 'B', block_size >> 8, block_size & 0xFF, 'F' });
+            if (!read_back) {
+                const auto available = std::min(block_size, image.bytes.size() - address);
+                command.insert(command.end(), image.bytes.begin() + address, image.bytes.begin() + address + available);
+                command.resize(command.size() + block_size - available, std::byte { 0xFF });
+            }
+            if (const auto err = transact(command, read_back ? block_size : 1); err) return err;
+        }
+    }
+    for (const auto &command : { 'L', 'E' }) {
+        if (const auto err = transact(bytes({ command }), 1); err) return err;
+    }
+    return std::nullopt;
+}
+
+static std::optional<std::string> flash_natively(const std::string &port, const std::filesystem::path &hex_path, size_t &num_progress_reports) {
+    avr109::flash_options options;
+    options.hex_path = hex_path;
+    options.port = port;
+    std::atomic<size_t> num_reports = 0;
+    options.on_progress = [&]() { num_reports++; };
+    avr109::flash_job job(options);
+    while (!job.finished()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    num_progress_reports = num_reports;
+    return job.error();
+}
+
+template<typename F> static double time_s(F &&f) {
+    const auto start = bench_clock::now();
+    if (const auto err = f(); err) {
+        spdlog::error("{}", *err);
+        std::exit(1);
+    }
+    return std::chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+int main() {
+    const auto hex_path = std::filesystem::temp_directory_path() / "visor-bench-firmware.hex";
+    std::ofstream(hex_path) << make_hex();
+    const auto image = ihex::load(hex_path, avr109::atmega32u4_application_size);
+    if (!image.has_value()) {
+        spdlog::error(image.error());
+        return 1;
+    }
+    const auto parse_ms = time_s([&]() { return ihex::load(hex_path, avr109::atmega32u4_application_size).has_value() ? std::nullopt : std::optional<std::string>("Unable to parse"); }) * 1000;
+
+    avr109::stand_in_bootloader bootloader(avr109::stand_in_bootloader::atmega32u4_timing());
+    spdlog::info("{} KiB firmware ({:.1f} ms to parse), against a stand-in ATmega32U4: 4 ms page erase and write, 1 ms USB latency",
+        std::count(image->written.begin(), image->written.end(), true) / 1024, parse_ms);
+
+    const auto like_avrdude_s = time_s([&]() { return flash_like_avrdude(bootloader.port(), *image); });
+    const size_t like_avrdude_pages = bootloader.num_page_writes;
+    spdlog::info("  avrdude's command sequence: {:.2f} s, {} pages written", like_avrdude_s, like_avrdude_pages);
+
+    size_t num_progress_reports = 0;
+    const auto native_s = time_s([&]() { return flash_natively(bootloader.port(), hex_path, num_progress_reports); });
+    spdlog::info("  native flash_job:           {:.2f} s, {} pages written, {} progress reports ({:.0f}% less time)",
+        native_s, bootloader.num_page_writes - like_avrdude_pages, num_progress_reports, 100 * (1 - native_s / like_avrdude_s));
+
+    // The real thing, where it is installed; it talks to the stand-in as it would to the board
+    const auto *avrdude = std::getenv("AVRDUDE");
+    const std::string avrdude_path = avrdude ? avrdude : "avrdude";
+    if (std::system(fmt::format("\"{}\" -? > /dev/null 2>&1", avrdude_path).c_str()) == 0 || std::system(fmt::format("\"{}\" -v > /dev/null 2>&1", avrdude_path).c_str()) == 0) {
+        const auto start = bench_clock::now();
+        const auto res = std::system(fmt::format("\"{}\" -q -q -c avr109 -p m32u4 -P {} -b 57600 -U flash:w:{}:i", avrdude_path, bootloader.port(), hex_path.string()).c_str());
+        const auto avrdude_s = std::chrono::duration<double>(bench_clock::now() - start).count();
+        if (res == 0) spdlog::info("  avrdude:                    {:.2f} s", avrdude_s);
+        else spdlog::warn("  avrdude failed ({})", res);
+    } else spdlog::info("  avrdude isn't installed; set AVRDUDE to its path to time it too");
+
+    std::error_code ec;
+    std::filesystem::remove(hex_path, ec);
+    return 0;
+}
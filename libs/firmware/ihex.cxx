@@ -0,0 +1,121 @@
+#include "ihex.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <fstream>
+
+static int hex_digit(const char &c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+std::optional<std::string> sc::firmware::ihex::image::put(const uint32_t &address, const std::byte *data, const size_t &size, const size_t &max_size) {
+    const size_t end = static_cast<size_t>(address) + size;
+    if (end > max_size) return fmt::format("Data at 0x{:X} doesn't fit in {} bytes of flash.", address, max_size);
+    if (end > bytes.size()) {
+        bytes.resize(end, std::byte { 0xFF });
+        written.resize(end, false);
+    }
+    std::copy(data, data + size, bytes.begin() + address);
+    std::fill(written.begin() + address, written.begin() + end, true);
+    return std::nullopt;
+}
+
+bool sc::firmware::ihex::image::has_data(const size_t &address, const size_t &size) const {
+    if (address >= written.size()) return false;
+    const auto end = std::min(address + size, written.size());
+    return std::find(written.begin() + address, written.begin() + end, true) != written.begin() + end;
+}
+
+std::optional<std::string> sc::firmware::ihex::parser::feed(const std::string_view &text) {
+    for (const auto &c : text) {
+        if (c == '\n' || c == '\r') {
+            if (line_size) {
+                if (const auto err = parse_line(); err) return err;
+                line_size = 0;
+            }
+            if (c == '\n') line_number++;
+            continue;
+        }
+        if (line_size == line.size()) return fmt::format("Line {} is too long for a record.", line_number);
+        line[line_size++] = c;
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> sc::firmware::ihex::parser::finish() {
+    if (line_size) {
+        if (const auto err = parse_line(); err) return err;
+        line_size = 0;
+    }
+    if (!ended) return "The file has no end-of-file record; it may be cut short.";
+    return std::nullopt;
+}
+
+std::optional<std::string> sc::firmware::ihex::parser::parse_line() {
+    if (ended) return fmt::format("Line {} follows the end-of-file record.", line_number);
+    if (line[0] != ':' || line_size < 11 || line_size % 2 == 0) return fmt::format("Line {} isn't a record.", line_number);
+
+    // Decode the hex pairs in place: they are never read again as text
+    auto *record = reinterpret_cast<uint8_t *>(line.data());
+    const auto num_bytes = (line_size - 1) / 2;
+    uint8_t sum = 0;
+    for (size_t i = 0; i < num_bytes; i++) {
+        const auto high = hex_digit(line[1 + 2 * i]), low = hex_digit(line[2 + 2 * i]);
+        if (high < 0 || low < 0) return fmt::format("Line {} has a character that isn't hex.", line_number);
+        record[i] = static_cast<uint8_t>(high << 4 | low);
+        sum = static_cast<uint8_t>(sum + record[i]);
+    }
+    const auto count = record[0];
+    if (num_bytes != 5u + count) return fmt::format("Line {} has {} data bytes but claims {}.", line_number, num_bytes - 5, count);
+    if (sum != 0) return fmt::format("Line {} fails its checksum.", line_number);
+    const auto offset = static_cast<uint32_t>(record[1] << 8 | record[2]);
+    const auto *data = record + 4;
+
+    switch (record[3]) {
+        case 0x00:
+            return on_data(base_address + offset, reinterpret_cast<const std::byte *>(data), count);
+        case 0x01:
+            ended = true;
+            return std::nullopt;
+        case 0x02:
+            if (count != 2) return fmt::format("Line {} has a malformed segment address.", line_number);
+            base_address = static_cast<uint32_t>(data[0] << 8 | data[1]) << 4;
+            return std::nullopt;
+        case 0x04:
+            if (count != 2) return fmt::format("Line {} has a malformed linear address.", line_number);
+            base_address = static_cast<uint32_t>(data[0] << 8 | data[1]) << 16;
+            return std::nullopt;
+        case 0x03:
+        case 0x05:
+            return std::nullopt; // Start addresses mean nothing to an AVR
+        default:
+            return fmt::format("Line {} has unknown record type 0x{:02X}.", line_number, record[3]);
+    }
+}
+
+tl::expected<sc::firmware::ihex::image, std::string> sc::firmware::ihex::parse(const std::string_view &text, const size_t &max_size) {
+    image res;
+    parser reader([&](const uint32_t &address, const std::byte *data, const size_t &size) { return res.put(address, data, size, max_size); });
+    if (const auto err = reader.feed(text); err) return tl::make_unexpected(*err);
+    if (const auto err = reader.finish(); err) return tl::make_unexpected(*err);
+    return res;
+}
+
+tl::expected<sc::firmware::ihex::image, std::string> sc::firmware::ihex::load(const std::filesystem::path &path, const size_t &max_size) {
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream) return tl::make_unexpected(fmt::format("Unable to open {}.", path.string()));
+    image res;
+    parser reader([&](const uint32_t &address, const std::byte *data, const size_t &size) { return res.put(address, data, size, max_size); });
+    std::array<char, 4096> chunk;
+    while (stream) {
+        stream.read(chunk.data(), chunk.size());
+        if (const auto err = reader.feed({ chunk.data(), static_cast<size_t>(stream.gcount()) }); err) return tl::make_unexpected(fmt::format("{}: {}", path.filename().string(), *err));
+    }
+    if (stream.bad()) return tl::make_unexpected(fmt::format("Unable to read {}.", path.string()));
+    if (const auto err = reader.finish(); err) return tl::make_unexpected(fmt::format("{}: {}", path.filename().string(), *err));
+    return res;
+}
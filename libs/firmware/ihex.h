@@ -0,0 +1,62 @@
+#pragma once
+
+#include <tl/expected.hpp>  // Include a library for handling expected results
+
+#include <array>  // Include a library for arrays
+#include <cstddef>  // Include a library for size-related types
+#include <cstdint>  // Include a library for fixed width integers
+#include <filesystem>  // Include a library for paths
+#include <functional>  // Include a library for callbacks
+#include <optional>  // Include a library for optional values
+#include <string>  // Include a library for strings
+#include <string_view>  // Include a library for string views
+#include <vector>  // Include a library for dynamic arrays
+
+namespace sc::firmware::ihex {
+
+    // Flash contents as a firmware file describes them: erased (0xFF) wherever the file has no data
+    struct image {
+
+        std::vector<std::byte> bytes;  // Indexed by address
+        std::vector<bool> written;  // Whether the file had data for each address
+
+        // Function to put data at an address, growing the image as needed
+        std::optional<std::string> put(const uint32_t &address, const std::byte *data, const size_t &size, const size_t &max_size);
+
+        // Function to check if the file had data anywhere in a range
+        bool has_data(const size_t &address, const size_t &size) const;
+    };
+
+    // Intel HEX reader that takes the text in pieces of any size, e.g. as it is read from disk, and hands over each
+    // data record as soon as its line is complete; it keeps one line at most
+    class parser {
+    public:
+
+        using sink = std::function<std::optional<std::string>(const uint32_t &address, const std::byte *data, const size_t &size)>;
+
+        explicit parser(sink on_data) : on_data(std::move(on_data)) { }
+
+        // Function to parse the next piece of text
+        std::optional<std::string> feed(const std::string_view &text);
+
+        // Function to check that the text ended with an end-of-file record
+        std::optional<std::string> finish();
+
+    private:
+
+        std::optional<std::string> parse_line();  // Function to parse the line gathered in "line"
+
+        sink on_data;
+        std::array<char, 1 + 2 * (1 + 2 + 1 + 255 + 1)> line;  // The longest record: colon, then count, address, type, data and checksum as hex
+        size_t line_size = 0;
+        size_t line_number = 1;
+        uint32_t base_address = 0;  // Set by extended segment and extended linear address records
+        bool ended = false;  // Whether the end-of-file record was seen
+    };
+
+    // Function to parse Intel HEX text into an image no larger than max_size
+    tl::expected<image, std::string> parse(const std::string_view &text, const size_t &max_size);
+
+    // Function to read an Intel HEX file into an image no larger than max_size, a piece at a time
+    tl::expected<image, std::string> load(const std::filesystem::path &path, const size_t &max_size);
+}
@@ -13,6 +13,20 @@
 #include <tuple>
 #include <algorithm>
 #include <iostream>
+#include <cstdlib>
+
+// Converts a HID string into a null-terminated narrow string; fails if it doesn't fit.
+static bool narrow_hid_string(const wchar_t *src, std::vector<char> &dst) {
+#ifdef _WIN32
+    size_t num_bytes;
+    return wcstombs_s(&num_bytes, dst.data(), dst.size(), src, dst.size()) == 0;
+#else
+    const auto num_bytes = std::wcstombs(dst.data(), src, dst.size());
+    if (num_bytes == static_cast<size_t>(-1) || num_bytes >= dst.size()) return false;
+    dst[num_bytes] = 0;
+    return true;
+#endif
+}
 
 sc::firmware::mk4::device_handle::device_handle(const uint16_t &vendor, const uint16_t &product, const std::string_view &org, const std::string_view &name, const std::string_view &uuid, const std::string_view &serial, void * const ptr) : vendor(vendor), product(product), org(org), name(name), uuid(uuid), serial(serial), ptr(ptr) {
 
@@ -44,14 +58,11 @@ tl::expected<std::vector<std::shared_ptr<sc::firmware::mk4::device_handle>>, std
                 }
                 if (const auto handle = hid_open_path(cur_dev->path); handle) {
                     std::vector<char> serial_buffer(256);
-                    size_t num_serial_bytes;
-                    if (wcstombs_s(&num_serial_bytes, serial_buffer.data(), serial_buffer.size(), cur_dev->serial_number, serial_buffer.size()) != 0) continue;
+                    if (!narrow_hid_string(cur_dev->serial_number, serial_buffer)) continue;
                     std::vector<char> org_buffer(256);
-                    size_t num_org_bytes;
-                    if (wcstombs_s(&num_org_bytes, org_buffer.data(), org_buffer.size(), cur_dev->manufacturer_string, org_buffer.size()) != 0) continue;
+                    if (!narrow_hid_string(cur_dev->manufacturer_string, org_buffer)) continue;
                     std::vector<char> name_buffer(256);
-                    size_t num_name_bytes;
-                    if (wcstombs_s(&num_name_bytes, name_buffer.data(), name_buffer.size(), cur_dev->product_string, name_buffer.size()) != 0) continue;
+                    if (!narrow_hid_string(cur_dev->product_string, name_buffer)) continue;
                     auto new_device_handle = std::make_shared<device_handle>(cur_dev->vendor_id, cur_dev->product_id, org_buffer.data(), name_buffer.data(), cur_dev->path, serial_buffer.data(), handle);
                     const auto comm_res = new_device_handle->get_new_communications_id();
                     if (comm_res.has_value()) {
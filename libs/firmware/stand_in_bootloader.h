@@ -0,0 +1,216 @@
+#pragma once
+
+// A Caterina-like AVR109 bootloader behind a pseudo-terminal, standing in for a board in tests and benchmarks. The
+// programmer opens port() as it would the board's serial port. Flash timing and USB latency can be modelled, so a
+// benchmark pays for page programming and round trips roughly as it would against an ATmega32U4.
+// POSIX only.
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sc::firmware::avr109 {
+
+    class stand_in_bootloader {
+    public:
+
+        struct timing {
+
+            std::chrono::microseconds page_erase { 0 }, page_write { 0 }; // Caterina erases each page before it writes it
+            std::chrono::microseconds latency { 0 }; // From the bootloader finishing a command to its reply reaching the host
+        };
+
+        // About an ATmega32U4 on full-speed USB: 4 ms to erase or write a page, a reply per 1 ms frame
+        static timing atmega32u4_timing() { return { std::chrono::microseconds(4000), std::chrono::microseconds(4000), std::chrono::microseconds(1000) }; }
+
+        static constexpr size_t flash_size = 0x8000, application_size = 0x7000, page_size = 128;
+
+        stand_in_bootloader() : stand_in_bootloader(timing { }) { }
+
+        explicit stand_in_bootloader(const timing &times) : times(times), memory(flash_size, std::byte { 0xFF }) {
+            master = posix_openpt(O_RDWR | O_NOCTTY);
+            if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) return;
+            slave_path = ptsname(master);
+            worker = std::thread(&stand_in_bootloader::run, this);
+            sender = std::thread(&stand_in_bootloader::send_replies, this);
+        }
+
+        ~stand_in_bootloader() {
+            stopping = true;
+            replies_cv.notify_all();
+            if (worker.joinable()) worker.join();
+            if (sender.joinable()) sender.join();
+            if (master >= 0) close(master);
+        }
+
+        const std::string &port() const { return slave_path; } // Empty if no pseudo-terminal could be opened
+
+        std::vector<std::byte> flash() const {
+            std::lock_guard guard(memory_mutex);
+            return memory;
+        }
+
+        void fill(const std::byte &value) {
+            std::lock_guard guard(memory_mutex);
+            std::fill(memory.begin(), memory.begin() + application_size, value);
+        }
+
+        std::atomic<size_t> num_commands = 0, num_page_writes = 0, num_erases = 0;
+        std::atomic<bool> exited = false; // Whether the programmer told it to start the application
+        std::atomic<int> corrupt_address = -1; // A byte the next write there gets wrong, as a failing flash cell would
+
+    private:
+
+        // Blocks for the next byte from the programmer; false once stopping
+        bool get(uint8_t &value) {
+            while (!stopping) {
+                pollfd fd = { master, POLLIN, 0 };
+                if (poll(&fd, 1, 20) <= 0) continue;
+                if (read(master, &value, 1) == 1) return true;
+                std::this_thread::sleep_for(std::chrono::milliseconds(1)); // Nobody has the port open, which a pseudo-terminal reports as a hang-up
+            }
+            return false;
+        }
+
+        void reply(std::vector<uint8_t> bytes) {
+            {
+                std::lock_guard guard(replies_mutex);
+                replies.push_back({ std::chrono::steady_clock::now() + times.latency, std::move(bytes) });
+            }
+            replies_cv.notify_all();
+        }
+
+        void send_replies() {
+            std::unique_lock lock(replies_mutex);
+            while (!stopping) {
+                if (replies.empty()) {
+                    replies_cv.wait_for(lock, std::chrono::milliseconds(20));
+                    continue;
+                }
+                const auto due = replies.front().first;
+                if (std::chrono::steady_clock::now() < due) {
+                    replies_cv.wait_until(lock, due);
+                    continue;
+                }
+                const auto bytes = std::move(replies.front().second);
+                replies.pop_front();
+                lock.unlock();
+                for (size_t at = 0; at < bytes.size(); ) {
+                    const auto n = write(master, bytes.data() + at, bytes.size() - at);
+                    if (n <= 0) break;
+                    at += static_cast<size_t>(n);
+                }
+                lock.lock();
+            }
+        }
+
+        void run() {
+            uint8_t c;
+            size_t address = 0; // In bytes; the protocol counts flash in words
+            while (get(c)) {
+                num_commands++;
+                switch (c) {
+                    case 0x1B: num_commands--; break; // Escape, which avrdude sends to cancel whatever was going on
+                    case 'S': reply({ 'C', 'A', 'T', 'E', 'R', 'I', 'N' }); break;
+                    case 'V': reply({ '1', '0' }); break;
+                    case 'p': reply({ 'S' }); break;
+                    case 'a': reply({ 'Y' }); break;
+                    case 'b': reply({ 'Y', page_size >> 8, page_size & 0xFF }); break;
+                    case 't': reply({ 0x44, 0x00 }); break;
+                    case 's': reply({ 0x87, 0x95, 0x1E }); break;
+                    case 'P': case 'L': reply({ '\r' }); break;
+                    case 'T': case 'x': case 'y': {
+                        uint8_t ignored;
+                        if (!get(ignored)) return;
+                        reply({ '\r' });
+                        break;
+                    }
+                    case 'E':
+                        exited = true;
+                        reply({ '\r' });
+                        break;
+                    case 'e':
+                        std::this_thread::sleep_for(times.page_erase * (application_size / page_size));
+                        fill(std::byte { 0xFF });
+                        num_erases++;
+                        reply({ '\r' });
+                        break;
+                    case 'A': {
+                        uint8_t high, low;
+                        if (!get(high) || !get(low)) return;
+                        address = static_cast<size_t>(high << 8 | low) * 2;
+                        reply({ '\r' });
+                        break;
+                    }
+                    case 'B': {
+                        uint8_t high, low, type;
+                        if (!get(high) || !get(low) || !get(type)) return;
+                        const size_t size = high << 8 | low;
+                        std::vector<uint8_t> data(size);
+                        for (auto &value : data) if (!get(value)) return;
+                        if (type != 'F' || size != page_size || address % page_size || address + size > application_size) {
+                            reply({ '?' });
+                            break;
+                        }
+                        std::this_thread::sleep_for(times.page_erase + times.page_write);
+                        {
+                            std::lock_guard guard(memory_mutex);
+                            for (size_t i = 0; i < size; i++) memory[address + i] = static_cast<std::byte>(data[i]);
+                            const auto corrupt = corrupt_address.exchange(-1);
+                            if (corrupt >= 0 && static_cast<size_t>(corrupt) - address < size) memory[corrupt] ^= std::byte { 0x01 };
+                            else if (corrupt >= 0) corrupt_address = corrupt;
+                        }
+                        num_page_writes++;
+                        address += size;
+                        reply({ '\r' });
+                        break;
+                    }
+                    case 'g': {
+                        uint8_t high, low, type;
+                        if (!get(high) || !get(low) || !get(type)) return;
+                        const size_t size = high << 8 | low;
+                        if (type != 'F' || address + size > flash_size) {
+                            reply({ '?' });
+                            break;
+                        }
+                        std::vector<uint8_t> data(size);
+                        {
+                            std::lock_guard guard(memory_mutex);
+                            for (size_t i = 0; i < size; i++) data[i] = std::to_integer<uint8_t>(memory[address + i]);
+                        }
+                        address += size;
+                        reply(std::move(data));
+                        break;
+                    }
+                    default:
+                        reply({ '?' });
+                        break;
+                }
+            }
+        }
+
+        timing times;
+        int master = -1;
+        std::string slave_path;
+        mutable std::mutex memory_mutex;
+        std::vector<std::byte> memory;
+        std::mutex replies_mutex;
+        std::condition_variable replies_cv;
+        std::deque<std::pair<std::chrono::steady_clock::time_point, std::vector<uint8_t>>> replies;
+        std::atomic<bool> stopping = false;
+        std::thread worker, sender;
+    };
+}
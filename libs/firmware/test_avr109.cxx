@@ -0,0 +1,192 @@
+#include "avr109.h"
+#include "ihex.h"
+#include "stand_in_bootloader.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+#include "../check.hpp"
+
+using namespace sc::firmware;
+
+using sc::test::check;
+
+// Intel HEX for data at an address, 16 bytes per record, with an extended linear address record if it is past 64 KiB
+static std::string to_hex(const uint32_t &address, const std::vector<uint8_t> &data) {
+    std::string res;
+    const auto record = [&](const uint8_t &type, const uint16_t &offset, const uint8_t *bytes, const size_t &size) {
+        uint8_t sum = static_cast<uint8_t>(size + (offset >> 8) + (offset & 0xFF) + type);
+        res += fmt::format(":{:02X}{:04X}{:02X}", size, offset, type);
+        for (size_t i = 0; i < size; i++) {
+            res += fmt::format("{:02X}", bytes[i]);
+            sum = static_cast<uint8_t>(sum + bytes[i]);
+        }
+        res += fmt::format("{:02X}\r\n", static_cast<uint8_t>(-sum));
+    };
+    if (address >> 16) {
+        const uint8_t upper[2] = { static_cast<uint8_t>(address >> 24), static_cast<uint8_t>(address >> 16) };
+        record(0x04, 0, upper, 2);
+    }
+    for (size_t i = 0; i < data.size(); i += 16) record(0x00, static_cast<uint16_t>(address + i), data.data() + i, std::min<size_t>(16, data.size() - i));
+    return res;
+}
+
+static const std::string end_record = ":00000001FF\r\n";
+
+static std::vector<uint8_t> random_bytes(std::mt19937 &rng, const size_t &size) {
+    std::vector<uint8_t> res(size);
+    for (auto &value : res) value = static_cast<uint8_t>(rng());
+    return res;
+}
+
+static void test_ihex() {
+    std::mt19937 rng(1);
+    const auto code = random_bytes(rng, 1000), table = random_bytes(rng, 100);
+    const auto text = to_hex(0, code) + to_hex(0x6000, table) + end_record;
+
+    const auto image = ihex::parse(text, avr109::atmega32u4_application_size);
+    check(image.has_value(), "a firmware file parses");
+    if (image) {
+        check(image->bytes.size() == 0x6000 + table.size(), "an image spans the highest address");
+        check(std::equal(code.begin(), code.end(), image->bytes.begin(), [](const uint8_t &a, const std::byte &b) { return std::byte { a } == b; }), "an image holds the data at its address");
+        check(image->bytes[2000] == std::byte { 0xFF } && !image->has_data(1024, 0x6000 - 1024), "a gap stays erased and without data");
+        check(image->has_data(0x6000 - 10, 20), "a range reaching into data has data");
+    }
+
+    // Handed over a byte at a time, as a slow disk might, the records come out the same
+    std::vector<std::pair<uint32_t, size_t>> records;
+    ihex::parser streaming([&](const uint32_t &address, const std::byte *, const size_t &size) -> std::optional<std::string> { records.emplace_back(address, size); return std::nullopt; });
+    bool fed = true;
+    for (const auto &c : text) fed = fed && !streaming.feed(std::string_view(&c, 1));
+    check(fed && !streaming.finish(), "a file fed a byte at a time parses");
+    check(records.size() == (code.size() + 15) / 16 + (table.size() + 15) / 16 && records.front() == std::pair<uint32_t, size_t>(0, 16), "a file fed a byte at a time gives the same records");
+
+    check(ihex::parse(to_hex(0x10000, { 1, 2, 3 }) + end_record, 0x20000).value_or(ihex::image { }).bytes.size() == 0x10003, "an extended linear address moves the data");
+    auto lower_case = to_hex(0, { 0xAB, 0xCD, 0xEF }) + end_record;
+    std::transform(lower_case.begin(), lower_case.end(), lower_case.begin(), [](const char &c) { return static_cast<char>(std::tolower(c)); });
+    check(ihex::parse(lower_case, 0x7000).has_value(), "lower-case hex parses");
+
+    auto bad_sum = text;
+    bad_sum[bad_sum.find('\r') - 1] ^= 1;
+    check(!ihex::parse(bad_sum, 0x7000).has_value(), "a record failing its checksum is an error");
+    check(!ihex::parse(to_hex(0, code), 0x7000).has_value(), "a file without an end-of-file record is an error");
+    check(!ihex::parse(to_hex(0x6F00, random_bytes(rng, 512)) + end_record, 0x7000).has_value(), "data past the flash is an error");
+    check(!ihex::parse(":0200000000\r\n" + end_record, 0x7000).has_value(), "a record shorter than it claims is an error");
+    check(!ihex::parse("hello\r\n" + end_record, 0x7000).has_value(), "a line that isn't a record is an error");
+    const auto err = ihex::parse(to_hex(0, code) + ":00000001FE\r\n", 0x7000);
+    check(!err.has_value() && err.error().find("Line 64") != std::string::npos, "an error names its line");
+}
+
+static void test_programmer() {
+    avr109::stand_in_bootloader bootloader;
+    if (bootloader.port().empty()) {
+        check(false, "a pseudo-terminal pair opens");
+        return;
+    }
+    std::mt19937 rng(2);
+    const auto code = random_bytes(rng, 3000), table = random_bytes(rng, 64);
+    const auto image = *ihex::parse(to_hex(0, code) + to_hex(0x6010, table) + end_record, avr109::atmega32u4_application_size);
+
+    sc::serial::comm_instance comm;
+    if (const auto err = comm.open(bootloader.port(), 57600); err) {
+        check(false, "the bootloader's port opens: " + *err);
+        return;
+    }
+    bootloader.fill(std::byte { 0x42 }); // Old firmware
+    avr109::programmer device(comm);
+    const auto info = device.connect();
+    check(info.has_value() && info->software_id == "CATERIN" && info->block_size == 128, "the bootloader identifies itself");
+    check(info.has_value() && info->signature == avr109::atmega32u4_signature, "the bootloader reports the microcontroller's signature");
+    check(!device.erase() && bootloader.num_erases == 1, "the flash is erased");
+    size_t last_done = 0, num_reports = 0;
+    bool monotonic = true;
+    const auto err = device.write(image, [&](const size_t &done, const size_t &total) {
+        monotonic = monotonic && done > last_done && done <= total;
+        last_done = done;
+        num_reports++;
+    });
+    check(!err, "an image is written");
+    check(bootloader.num_page_writes == (code.size() + 127) / 128 + 1, "only pages with data are written");
+    check(monotonic && num_reports == bootloader.num_page_writes, "progress is reported per page and only goes up");
+    const auto flash = bootloader.flash();
+    check(std::equal(code.begin(), code.end(), flash.begin(), [](const uint8_t &a, const std::byte &b) { return std::byte { a } == b; }), "the flash holds the image");
+    check(flash[0x6000] == std::byte { 0xFF } && flash[0x3000] == std::byte { 0xFF }, "the rest of the page and the gap stay erased");
+    check(!device.verify(image), "the image reads back");
+
+    // A cell that doesn't take its value is caught by reading back
+    bootloader.corrupt_address = 0x6020;
+    check(!device.write(image), "an image is written over itself");
+    const auto verify_err = device.verify(image);
+    check(verify_err && verify_err->find("0x6020") != std::string::npos, "a byte that didn't take fails verification at its address");
+
+    check(!device.leave() && bootloader.exited, "the programmer starts the application");
+    check(device.write(image).has_value(), "a programmer that left has to connect again");
+}
+
+static void test_job() {
+    avr109::stand_in_bootloader bootloader;
+    std::mt19937 rng(3);
+    const auto dir = std::filesystem::temp_directory_path() / fmt::format("visor-test-avr109-{}", std::random_device()());
+    std::filesystem::create_directories(dir);
+    const auto code = random_bytes(rng, 5000);
+    std::ofstream(dir / "firmware.hex") << to_hex(0, code) << end_record;
+    std::ofstream(dir / "broken.hex") << to_hex(0, code);
+
+    std::atomic<int> num_wakes = 0;
+    std::vector<avr109::stage> stages;
+    {
+        avr109::flash_options options;
+        options.hex_path = dir / "firmware.hex";
+        options.port = bootloader.port();
+        options.on_progress = [&]() {
+            num_wakes++;
+        };
+        avr109::flash_job job(options);
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(20);
+        while (!job.finished() && std::chrono::steady_clock::now() < deadline) {
+            // What the UI does every frame; none of it waits on the flash
+            if (stages.empty() || stages.back() != job.current_stage()) stages.push_back(job.current_stage());
+            const auto fraction = job.fraction();
+            check(fraction >= 0 && fraction <= 1, "a job's progress is a fraction");
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        check(job.current_stage() == avr109::stage::done && !job.error(), "a job flashes firmware: " + job.error().value_or(""));
+        check(num_wakes > 5, "a job reports its progress as it goes");
+    }
+    const auto flash = bootloader.flash();
+    check(std::equal(code.begin(), code.end(), flash.begin(), [](const uint8_t &a, const std::byte &b) { return std::byte { a } == b; }) && bootloader.exited, "a job's firmware ends up in the flash and runs");
+    check(std::is_sorted(stages.begin(), stages.end()), "a job's stages only go forward");
+
+    {
+        avr109::flash_options options;
+        options.hex_path = dir / "broken.hex";
+        options.port = bootloader.port();
+        avr109::flash_job job(options);
+        while (!job.finished()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        check(job.current_stage() == avr109::stage::failed && job.error(), "a job with a broken file fails");
+        check(bootloader.num_erases == 1, "a job with a broken file fails before touching the board");
+    }
+    {
+        avr109::flash_options options;
+        options.hex_path = dir / "firmware.hex";
+        options.port = bootloader.port();
+        options.signature = { 0x1E, 0x95, 0x0F }; // An ATmega328P
+        avr109::flash_job job(options);
+        while (!job.finished()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        check(job.error() && job.error()->find("1E9587") != std::string::npos && bootloader.num_erases == 1, "a job for another microcontroller fails before erasing");
+    }
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+}
+
+int main() {
+    test_ihex();
+    test_programmer();
+    test_job();
+    return sc::test::finish("AVR109");
+}
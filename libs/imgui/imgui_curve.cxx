@@ -0,0 +1,247 @@
+#include "imgui_curve.h"
+#include "imgui_utils.hpp"
+
+#include <glbinding/gl33core/gl.h>
+
+using namespace gl;
+
+#include <spdlog/spdlog.h>
+
+#include <string>
+
+static const char *curve_vertex_shader = R"(#version 330 core
+uniform vec4 u_quad;  // Clip space min and max of the rectangle to fill
+void main() {
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    gl_Position = vec4(mix(u_quad.xy, u_quad.zw, corner), 0, 1);
+}
+)";
+
+static const char *curve_fragment_shader = R"(#version 330 core
+const int max_coefficients = 8;
+const int num_samples = 32;
+uniform vec2 u_coefficients[max_coefficients];  // Already scaled to framebuffer pixels, relative to u_origin
+uniform int u_num_coefficients;
+uniform vec2 u_origin;  // Framebuffer position of the unit square's bottom left corner
+uniform vec2 u_size;  // Framebuffer size of the unit square
+uniform float u_thickness;
+uniform vec4 u_color;
+uniform vec4 u_shade_color;
+uniform vec2 u_shade;  // Unit square heights outside of which the shade color fills the square
+out vec4 o_color;
+
+vec2 point_at(float t) {
+    vec2 res = u_coefficients[u_num_coefficients - 1];
+    for (int i = u_num_coefficients - 2; i >= 0; i--) res = (res * t) + u_coefficients[i];
+    return res;
+}
+
+vec2 tangent_at(float t) {
+    vec2 res = vec2(0);
+    for (int i = u_num_coefficients - 1; i >= 1; i--) res = (res * t) + (float(i) * u_coefficients[i]);
+    return res;
+}
+
+vec2 curvature_at(float t) {
+    vec2 res = vec2(0);
+    for (int i = u_num_coefficients - 1; i >= 2; i--) res = (res * t) + (float(i * (i - 1)) * u_coefficients[i]);
+    return res;
+}
+
+void main() {
+    vec2 p = gl_FragCoord.xy - u_origin;
+
+    // The nearest of a few samples, then Newton's method on the derivative of the squared distance
+    float t = 0;
+    float nearest = 1e30;
+    for (int i = 0; i <= num_samples; i++) {
+        float sample_t = float(i) / float(num_samples);
+        vec2 d = point_at(sample_t) - p;
+        float distance_sq = dot(d, d);
+        if (distance_sq < nearest) {
+            nearest = distance_sq;
+            t = sample_t;
+        }
+    }
+    for (int i = 0; i < 4; i++) {
+        vec2 d = point_at(t) - p;
+        vec2 tangent = tangent_at(t);
+        float slope = dot(tangent, tangent) + dot(d, curvature_at(t));
+        if (abs(slope) < 1e-6) break;
+        t = clamp(t - (dot(d, tangent) / slope), 0.0, 1.0);
+    }
+    float coverage = clamp((u_thickness * 0.5) + 0.5 - length(point_at(t) - p), 0.0, 1.0);
+
+    vec2 unit = p / u_size;
+    bool inside = all(greaterThanEqual(unit, vec2(0))) && all(lessThanEqual(unit, vec2(1)));
+    vec4 shade = (inside && (unit.y < u_shade.x || unit.y > u_shade.y)) ? u_shade_color : vec4(0);
+
+    // The line over the shade; the backend blends with SRC_ALPHA, ONE_MINUS_SRC_ALPHA
+    float line_alpha = u_color.a * coverage;
+    float alpha = line_alpha + (shade.a * (1.0 - line_alpha));
+    if (alpha <= 0.0) discard;
+    o_color = vec4(((u_color.rgb * line_alpha) + (shade.rgb * shade.a * (1.0 - line_alpha))) / alpha, alpha);
+}
+)";
+
+namespace {
+
+    struct curve_renderer {
+
+        GLuint program = 0, vertex_array = 0;
+        GLint u_quad = -1, u_coefficients = -1, u_num_coefficients = -1, u_origin = -1, u_size = -1, u_thickness = -1, u_color = -1, u_shade_color = -1, u_shade = -1;
+        bool failed = false;
+
+        static curve_renderer &get() {
+            static curve_renderer renderer;
+            return renderer;
+        }
+
+        static GLuint compile(const GLenum &type, const char *source) {
+            const auto shader = glCreateShader(type);
+            glShaderSource(shader, 1, &source, nullptr);
+            glCompileShader(shader);
+            GLint status = 0;
+            glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+            if (status) return shader;
+            std::string log(1024, 0);
+            glGetShaderInfoLog(shader, static_cast<GLsizei>(log.size()), nullptr, log.data());
+            spdlog::error("Unable to compile the curve shader: {}", log.data());
+            glDeleteShader(shader);
+            return 0;
+        }
+
+        // Builds the program the first time a curve is rendered, while the backend's context is current.
+        bool prepare() {
+            if (program) return true;
+            if (failed) return false;
+            failed = true;
+            const auto vertex_shader = compile(GL_VERTEX_SHADER, curve_vertex_shader);
+            const auto fragment_shader = compile(GL_FRAGMENT_SHADER, curve_fragment_shader);
+            if (!vertex_shader || !fragment_shader) {
+                if (vertex_shader) glDeleteShader(vertex_shader);
+                if (fragment_shader) glDeleteShader(fragment_shader);
+                return false;
+            }
+            const auto linked = glCreateProgram();
+            glAttachShader(linked, vertex_shader);
+            glAttachShader(linked, fragment_shader);
+            glLinkProgram(linked);
+            glDeleteShader(vertex_shader);
+            glDeleteShader(fragment_shader);
+            GLint status = 0;
+            glGetProgramiv(linked, GL_LINK_STATUS, &status);
+            if (!status) {
+                spdlog::error("Unable to link the curve shader.");
+                glDeleteProgram(linked);
+                return false;
+            }
+            program = linked;
+            glGenVertexArrays(1, &vertex_array);  // The quad comes from gl_VertexID, but the core profile needs a bound vertex array
+            u_quad = glGetUniformLocation(program, "u_quad");
+            u_coefficients = glGetUniformLocation(program, "u_coefficients");
+            u_num_coefficients = glGetUniformLocation(program, "u_num_coefficients");
+            u_origin = glGetUniformLocation(program, "u_origin");
+            u_size = glGetUniformLocation(program, "u_size");
+            u_thickness = glGetUniformLocation(program, "u_thickness");
+            u_color = glGetUniformLocation(program, "u_color");
+            u_shade_color = glGetUniformLocation(program, "u_shade_color");
+            u_shade = glGetUniformLocation(program, "u_shade");
+            failed = false;
+            return true;
+        }
+
+        void release() {
+            if (vertex_array) glDeleteVertexArrays(1, &vertex_array);
+            if (program) glDeleteProgram(program);
+            vertex_array = program = 0;
+            failed = false;
+        }
+    };
+}
+
+static void ImCurveRender(const ImDrawList *, const ImDrawCmd *cmd) {
+    ImCurve curve;
+    memcpy(&curve, cmd->UserCallbackData, sizeof(curve));
+    auto &renderer = curve_renderer::get();
+    if (curve.NumCoefficients < 1 || !renderer.prepare()) return;
+
+    // Screen coordinates to framebuffer pixels with y up, as the backend maps them
+    const auto draw_data = ImGui::GetDrawData();
+    const auto scale = draw_data->FramebufferScale;
+    const ImVec2 framebuffer_size = { draw_data->DisplaySize.x * scale.x, draw_data->DisplaySize.y * scale.y };
+    if (framebuffer_size.x <= 0 || framebuffer_size.y <= 0) return;
+    const auto to_framebuffer = [&](const ImVec2 &p) -> ImVec2 {
+        return { (p.x - draw_data->DisplayPos.x) * scale.x, framebuffer_size.y - ((p.y - draw_data->DisplayPos.y) * scale.y) };
+    };
+
+    // The backend scissors its own commands only, so do the same for this one
+    const auto clip_min = to_framebuffer({ cmd->ClipRect.x, cmd->ClipRect.w });
+    const auto clip_max = to_framebuffer({ cmd->ClipRect.z, cmd->ClipRect.y });
+    if (clip_max.x <= clip_min.x || clip_max.y <= clip_min.y) return;
+    glScissor(static_cast<GLint>(clip_min.x), static_cast<GLint>(clip_min.y), static_cast<GLsizei>(clip_max.x - clip_min.x), static_cast<GLsizei>(clip_max.y - clip_min.y));
+
+    const auto origin = to_framebuffer({ curve.Min.x, curve.Max.y });
+    const ImVec2 size = { (curve.Max.x - curve.Min.x) * scale.x, (curve.Max.y - curve.Min.y) * scale.y };
+    const auto thickness = curve.Thickness * scale.x;
+    ImVec2 coefficients[ImCurve::MaxCoefficients];
+    for (int i = 0; i < curve.NumCoefficients; i++) coefficients[i] = { curve.Coefficients[i].x * size.x, curve.Coefficients[i].y * size.y };
+
+    // The unit square plus room for the line where it runs along the edges
+    const auto pad = thickness + 1;
+    const auto to_clip = [&](const float &value, const float &extent) { return ((value / extent) * 2.f) - 1.f; };
+    const auto line_color = ImGui::ColorConvertU32ToFloat4(curve.Color);
+    const auto shade_color = ImGui::ColorConvertU32ToFloat4(curve.ShadeColor);
+
+    glUseProgram(renderer.program);
+    glBindVertexArray(renderer.vertex_array);
+    glUniform4f(renderer.u_quad, to_clip(origin.x - pad, framebuffer_size.x), to_clip(origin.y - pad, framebuffer_size.y), to_clip(origin.x + size.x + pad, framebuffer_size.x), to_clip(origin.y + size.y + pad, framebuffer_size.y));
+    glUniform2fv(renderer.u_coefficients, curve.NumCoefficients, &coefficients[0].x);
+    glUniform1i(renderer.u_num_coefficients, curve.NumCoefficients);
+    glUniform2f(renderer.u_origin, origin.x, origin.y);
+    glUniform2f(renderer.u_size, size.x, size.y);
+    glUniform1f(renderer.u_thickness, thickness);
+    glUniform4f(renderer.u_color, line_color.x, line_color.y, line_color.z, line_color.w);
+    glUniform4f(renderer.u_shade_color, shade_color.x, shade_color.y, shade_color.z, shade_color.w);
+    glUniform2f(renderer.u_shade, curve.ShadeBelow, curve.ShadeAbove);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+}
+
+bool ImCurve::SetBezier(const ImVec2 *points, const int &count) {
+    if (count < 1 || count > MaxCoefficients) return false;
+    // Coefficient j of a degree n Bezier curve is C(n, j) * sum over i <= j of (-1)^(j - i) * C(j, i) * points[i]
+    const auto binomial = [](const int &n, const int &k) {
+        double res = 1;
+        for (int i = 1; i <= k; i++) res = (res * (n - k + i)) / i;
+        return res;
+    };
+    const auto degree = count - 1;
+    for (int j = 0; j < count; j++) {
+        double x = 0, y = 0;
+        for (int i = 0; i <= j; i++) {
+            const auto weight = (((j - i) % 2) ? -1.0 : 1.0) * binomial(j, i);
+            x += weight * points[i].x;
+            y += weight * points[i].y;
+        }
+        const auto scale = binomial(degree, j);
+        Coefficients[j] = { static_cast<float>(x * scale), static_cast<float>(y * scale) };
+    }
+    NumCoefficients = count;
+    return true;
+}
+
+void ImCurve::Add(ImDrawList *draw_list, const ImCurve &curve) {
+    const auto pad = curve.Thickness + 1;
+    draw_list->PushClipRect({ curve.Min.x - pad, curve.Min.y - pad }, { curve.Max.x + pad, curve.Max.y + pad }, true);  // Only this much needs drawing again when the curve changes
+    ImAddCallback(draw_list, ImCurveRender, curve);
+    draw_list->AddCallback(ImDrawCallback_ResetRenderState, nullptr);  // Give the backend its program, buffers and scissor back
+    draw_list->PopClipRect();
+}
+
+bool ImCurve::Failed() {
+    return curve_renderer::get().failed;
+}
+
+void ImCurve::Shutdown() {
+    curve_renderer::get().release();
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <imgui.h>
+
+// A polynomial curve drawn by the GPU from a draw callback, for the OpenGL 3 backend.
+// The fragment shader finds every pixel's distance to the curve by evaluating the polynomial, so the line is smooth at any
+// size and DPI and no geometry is built on the CPU. It also shades the output ranges outside ShadeBelow and ShadeAbove.
+struct ImCurve {
+
+    static constexpr int MaxCoefficients = 8;
+
+    ImVec2 Min, Max;  // Screen rectangle of the unit square the curve is given in; y grows upwards within it
+    ImVec2 Coefficients[MaxCoefficients];  // Power basis: point(t) = sum of Coefficients[i] * t^i, for t from 0 to 1
+    int NumCoefficients = 0;
+    float Thickness = 2;  // Line width in pixels
+    ImU32 Color = IM_COL32_WHITE;
+    ImU32 ShadeColor = 0;
+    float ShadeBelow = 0, ShadeAbove = 1;  // Unit square heights outside of which ShadeColor fills the rectangle
+
+    // Converts a Bezier curve of up to MaxCoefficients control points to the power basis; false if it has too many.
+    bool SetBezier(const ImVec2 *points, const int &count);
+
+    // Queues the curve; it is drawn within the current clip rectangle when the draw list is rendered.
+    static void Add(ImDrawList *draw_list, const ImCurve &curve);
+
+    // Whether the shader could not be built on this GPU; callers should draw the curve some other way then.
+    static bool Failed();
+
+    // Releases the GPU objects. Call with the GL context current, before the backend shuts down.
+    static void Shutdown();
+};
@@ -2,13 +2,249 @@
 
 #include <imgui.h>
 
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <utility>
+#include <type_traits>
+
+#include <fmt/format.h>
+
 #include "imgui_freetype.h"
 
+// 64-bit hash over four independent lanes of 64-bit words, so the lanes run in parallel in the pipeline.
+inline uint64_t ImHash64(const void *data, size_t size, uint64_t seed = 0) {
+    constexpr uint64_t p1 = 0x9E3779B185EBCA87ull, p2 = 0xC2B2AE3D27D4EB4Full, p3 = 0x165667B19E3779F9ull;
+    const auto rotl = [](uint64_t x, int r) { return (x << r) | (x >> (64 - r)); };
+    const auto bytes = static_cast<const unsigned char *>(data);
+    uint64_t lanes[4] = { seed + p1 + p2, seed + p2, seed, seed - p1 };
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        for (int lane = 0; lane < 4; lane++) {
+            uint64_t word;
+            memcpy(&word, bytes + i + lane * 8, 8);
+            lanes[lane] = rotl(lanes[lane] + word * p2, 31) * p1;
+        }
+    }
+    uint64_t hash = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) + rotl(lanes[3], 18) + size;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, bytes + i, 8);
+        hash = rotl(hash ^ (rotl(word * p2, 31) * p1), 27) * p1 + p3;
+    }
+    for (; i < size; i++) hash = rotl(hash ^ (bytes[i] * p3), 11) * p1;
+    hash ^= hash >> 33;
+    hash *= p2;
+    hash ^= hash >> 29;
+    hash *= p3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+// Keeps a built font atlas on disk: texture pixels, glyph tables and custom rectangles.
+// The key covers font data, sizes, ranges and every rasterizer setting, so any change to them is a miss and builds again.
+struct ImFontAtlasCache {
+
+    static uint64_t Key(ImFontAtlas *atlas) {
+        const struct {
+            uint32_t version, glyph_size, flags, builder_flags;
+            int tex_desired_width, tex_glyph_padding;
+        } atlas_fields = {
+            IMGUI_VERSION_NUM, sizeof(ImFontGlyph), static_cast<uint32_t>(atlas->Flags), atlas->FontBuilderFlags,
+            atlas->TexDesiredWidth, atlas->TexGlyphPadding
+        };
+        uint64_t hash = ImHash64(&atlas_fields, sizeof(atlas_fields));
+        for (const auto &cfg : atlas->ConfigData) {  // Field by field, so padding never takes part
+            const struct {
+                float size_pixels, glyph_offset_x, glyph_offset_y, extra_spacing_x, extra_spacing_y;
+                float min_advance_x, max_advance_x, rasterizer_multiply;
+                int font_no, oversample_h, oversample_v;
+                uint32_t merge_mode, pixel_snap_h, builder_flags, ellipsis_char;
+            } fields = {
+                cfg.SizePixels, cfg.GlyphOffset.x, cfg.GlyphOffset.y, cfg.GlyphExtraSpacing.x, cfg.GlyphExtraSpacing.y,
+                cfg.GlyphMinAdvanceX, cfg.GlyphMaxAdvanceX, cfg.RasterizerMultiply,
+                cfg.FontNo, cfg.OversampleH, cfg.OversampleV,
+                cfg.MergeMode, cfg.PixelSnapH, cfg.FontBuilderFlags, static_cast<uint32_t>(cfg.EllipsisChar)
+            };
+            hash = ImHash64(&fields, sizeof(fields), hash);
+            hash = ImHash64(cfg.FontData, cfg.FontDataSize, hash);
+            if (const auto ranges = cfg.GlyphRanges ? cfg.GlyphRanges : atlas->GetGlyphRangesDefault(); ranges) {
+                size_t count = 0;
+                while (ranges[count]) count++;
+                hash = ImHash64(ranges, sizeof(ImWchar) * count, hash);
+            }
+        }
+        return hash;
+    }
+
+    static bool Load(ImFontAtlas *atlas, const char *path, const uint64_t &key) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return false;
+        std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        size_t offset = 0;
+        const auto read = [&](void *dst, const size_t &size) {
+            if (data.size() - offset < size) return false;
+            memcpy(dst, data.data() + offset, size);
+            offset += size;
+            return true;
+        };
+        uint32_t magic = 0, use_colors = 0, num_rects = 0, num_fonts = 0;
+        uint64_t file_key = 0;
+        int width = 0, height = 0, pack_id_cursors = -1, pack_id_lines = -1;
+        ImVec2 uv_scale, uv_white;
+        ImVec4 uv_lines[IM_DRAWLIST_TEX_LINES_WIDTH_MAX + 1];
+        if (!read(&magic, sizeof(magic)) || magic != Magic || !read(&file_key, sizeof(file_key)) || file_key != key) return false;
+        if (!read(&width, sizeof(width)) || !read(&height, sizeof(height)) || !read(&use_colors, sizeof(use_colors))) return false;
+        if (!read(&uv_scale, sizeof(uv_scale)) || !read(&uv_white, sizeof(uv_white)) || !read(uv_lines, sizeof(uv_lines))) return false;
+        if (!read(&pack_id_cursors, sizeof(pack_id_cursors)) || !read(&pack_id_lines, sizeof(pack_id_lines))) return false;
+        if (width <= 0 || height <= 0) return false;
+        const size_t pixels_size = static_cast<size_t>(width) * height * (use_colors ? 4 : 1);
+        if (data.size() - offset < pixels_size) return false;
+        const auto pixels = data.data() + offset;
+        offset += pixels_size;
+
+        ImVector<ImFontAtlasCustomRect> rects;
+        ImVector<int> rect_fonts;
+        if (!read(&num_rects, sizeof(num_rects))) return false;
+        rects.resize(num_rects);
+        rect_fonts.resize(num_rects);
+        for (uint32_t i = 0; i < num_rects; i++) {
+            auto &rect = rects[i];
+            if (!read(&rect.Width, sizeof(rect.Width)) || !read(&rect.Height, sizeof(rect.Height)) || !read(&rect.X, sizeof(rect.X)) || !read(&rect.Y, sizeof(rect.Y))) return false;
+            if (!read(&rect.GlyphID, sizeof(rect.GlyphID)) || !read(&rect.GlyphAdvanceX, sizeof(rect.GlyphAdvanceX)) || !read(&rect.GlyphOffset, sizeof(rect.GlyphOffset)) || !read(&rect_fonts[i], sizeof(int))) return false;
+            if (rect_fonts[i] >= atlas->Fonts.Size) return false;
+        }
+
+        struct font_fields { float size, ascent, descent; int metrics_surface; uint32_t fallback_char, ellipsis_char, num_glyphs; };
+        if (!read(&num_fonts, sizeof(num_fonts)) || num_fonts != static_cast<uint32_t>(atlas->Fonts.Size)) return false;
+        std::vector<font_fields> fonts(num_fonts);
+        std::vector<size_t> glyph_offsets(num_fonts);
+        for (uint32_t i = 0; i < num_fonts; i++) {
+            if (!read(&fonts[i], sizeof(font_fields))) return false;
+            glyph_offsets[i] = offset;
+            if (data.size() - offset < sizeof(ImFontGlyph) * fonts[i].num_glyphs) return false;
+            offset += sizeof(ImFontGlyph) * fonts[i].num_glyphs;
+        }
+
+        // Everything has been validated, so the atlas can be replaced without leaving it half built.
+        atlas->ClearTexData();
+        atlas->TexWidth = width;
+        atlas->TexHeight = height;
+        atlas->TexPixelsUseColors = use_colors != 0;
+        if (use_colors) {
+            atlas->TexPixelsRGBA32 = (unsigned int *)IM_ALLOC(pixels_size);
+            memcpy(atlas->TexPixelsRGBA32, pixels, pixels_size);
+        } else {
+            atlas->TexPixelsAlpha8 = (unsigned char *)IM_ALLOC(pixels_size);
+            memcpy(atlas->TexPixelsAlpha8, pixels, pixels_size);
+        }
+        atlas->TexUvScale = uv_scale;
+        atlas->TexUvWhitePixel = uv_white;
+        memcpy(atlas->TexUvLines, uv_lines, sizeof(uv_lines));
+        atlas->PackIdMouseCursors = pack_id_cursors;
+        atlas->PackIdLines = pack_id_lines;
+        for (uint32_t i = 0; i < num_rects; i++) rects[i].Font = rect_fonts[i] < 0 ? nullptr : atlas->Fonts[rect_fonts[i]];
+        atlas->CustomRects.swap(rects);
+        for (uint32_t i = 0; i < num_fonts; i++) {
+            auto font = atlas->Fonts[i];
+            font->ClearOutputData();
+            font->ContainerAtlas = atlas;
+            font->ConfigData = nullptr;
+            font->ConfigDataCount = 0;
+            for (auto &cfg : atlas->ConfigData) {
+                if (cfg.DstFont != font) continue;
+                if (!font->ConfigData) font->ConfigData = &cfg;
+                font->ConfigDataCount++;
+            }
+            font->FontSize = fonts[i].size;
+            font->Ascent = fonts[i].ascent;
+            font->Descent = fonts[i].descent;
+            font->MetricsTotalSurface = fonts[i].metrics_surface;
+            font->FallbackChar = static_cast<ImWchar>(fonts[i].fallback_char);
+            font->EllipsisChar = static_cast<ImWchar>(fonts[i].ellipsis_char);
+            font->Glyphs.resize(fonts[i].num_glyphs);
+            if (fonts[i].num_glyphs) memcpy(static_cast<void *>(font->Glyphs.Data), data.data() + glyph_offsets[i], sizeof(ImFontGlyph) * fonts[i].num_glyphs);
+            font->BuildLookupTable();
+        }
+        atlas->TexReady = true;
+        return true;
+    }
+
+    static bool Save(const ImFontAtlas *atlas, const char *path, const uint64_t &key) {
+        if (!atlas->TexReady || (!atlas->TexPixelsAlpha8 && !atlas->TexPixelsRGBA32)) return false;
+        std::vector<char> data;
+        const auto write = [&](const void *src, const size_t &size) {
+            data.insert(data.end(), static_cast<const char *>(src), static_cast<const char *>(src) + size);
+        };
+        const uint32_t magic = Magic, use_colors = atlas->TexPixelsAlpha8 ? 0 : 1;
+        write(&magic, sizeof(magic));
+        write(&key, sizeof(key));
+        write(&atlas->TexWidth, sizeof(atlas->TexWidth));
+        write(&atlas->TexHeight, sizeof(atlas->TexHeight));
+        write(&use_colors, sizeof(use_colors));
+        write(&atlas->TexUvScale, sizeof(atlas->TexUvScale));
+        write(&atlas->TexUvWhitePixel, sizeof(atlas->TexUvWhitePixel));
+        write(atlas->TexUvLines, sizeof(atlas->TexUvLines));
+        write(&atlas->PackIdMouseCursors, sizeof(atlas->PackIdMouseCursors));
+        write(&atlas->PackIdLines, sizeof(atlas->PackIdLines));
+        if (use_colors) write(atlas->TexPixelsRGBA32, static_cast<size_t>(atlas->TexWidth) * atlas->TexHeight * 4);
+        else write(atlas->TexPixelsAlpha8, static_cast<size_t>(atlas->TexWidth) * atlas->TexHeight);
+
+        const uint32_t num_rects = atlas->CustomRects.Size;
+        write(&num_rects, sizeof(num_rects));
+        for (const auto &rect : atlas->CustomRects) {
+            const int font_i = rect.Font ? atlas->Fonts.index_from_ptr(std::find(atlas->Fonts.begin(), atlas->Fonts.end(), rect.Font)) : -1;
+            write(&rect.Width, sizeof(rect.Width));
+            write(&rect.Height, sizeof(rect.Height));
+            write(&rect.X, sizeof(rect.X));
+            write(&rect.Y, sizeof(rect.Y));
+            write(&rect.GlyphID, sizeof(rect.GlyphID));
+            write(&rect.GlyphAdvanceX, sizeof(rect.GlyphAdvanceX));
+            write(&rect.GlyphOffset, sizeof(rect.GlyphOffset));
+            write(&font_i, sizeof(font_i));
+        }
+
+        const uint32_t num_fonts = atlas->Fonts.Size;
+        write(&num_fonts, sizeof(num_fonts));
+        for (const auto font : atlas->Fonts) {
+            const struct { float size, ascent, descent; int metrics_surface; uint32_t fallback_char, ellipsis_char, num_glyphs; } fields = {
+                font->FontSize, font->Ascent, font->Descent, font->MetricsTotalSurface,
+                static_cast<uint32_t>(font->FallbackChar), static_cast<uint32_t>(font->EllipsisChar), static_cast<uint32_t>(font->Glyphs.Size)
+            };
+            write(&fields, sizeof(fields));
+            write(font->Glyphs.Data, sizeof(ImFontGlyph) * font->Glyphs.Size);
+        }
+
+        // Written next to the destination and renamed over it, so a crash never leaves a torn cache behind.
+        const auto temp_path = std::string(path) + ".tmp";
+        {
+            std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+            if (!file.write(data.data(), data.size())) return false;
+        }
+        std::error_code error;
+        std::filesystem::rename(temp_path, path, error);
+        return !error;
+    }
+
+private:
+
+    static constexpr uint32_t Magic = 0x41464353;  // "SCFA"
+};
+
 struct ImFreetypeEnablement {
 
     bool needs_rebuild = true;
     float alpha = 1;
     unsigned int build_flags = 0;
+    const char *cache_path = nullptr;  // When set, the built atlas is kept here and reused while fonts and settings stay the same
 
     bool PreNewFrame() {
         if (!needs_rebuild) return false;
@@ -16,51 +252,294 @@ struct ImFreetypeEnablement {
         for (int n = 0; n < atlas->ConfigData.Size; n++) ((ImFontConfig*)&atlas->ConfigData[n])->RasterizerMultiply = alpha;
         atlas->FontBuilderIO = ImGuiFreeType::GetBuilderForFreeType();
         atlas->FontBuilderFlags = build_flags;
-        atlas->Build();
+        const auto key = ImFontAtlasCache::Key(atlas);
+        if (!cache_path || !ImFontAtlasCache::Load(atlas, cache_path, key)) {
+            atlas->Build();
+            if (cache_path) ImFontAtlasCache::Save(atlas, cache_path, key);
+        }
         needs_rebuild = false;
         return true;
     }
 };
 
+// Sizes of the data of the draw callbacks added through ImAddCallback, so ImDrawListFingerprint can hash that data by value.
+inline std::vector<std::pair<ImDrawCallback, size_t>> &ImCallbackDataSizes() {
+    static std::vector<std::pair<ImDrawCallback, size_t>> sizes;
+    return sizes;
+}
+
+inline size_t ImCallbackDataSize(ImDrawCallback callback) {
+    for (const auto &[known, size] : ImCallbackDataSizes()) if (known == callback) return size;
+    return 0;
+}
+
+struct ImDrawListFingerprint {
+
+    int vtx_size = -1, idx_size = -1, cmd_size = -1;
+    uint64_t hash = 0;
+
+    bool operator==(const ImDrawListFingerprint &other) const {
+        return vtx_size == other.vtx_size && idx_size == other.idx_size && cmd_size == other.cmd_size && hash == other.hash;
+    }
+
+    bool operator!=(const ImDrawListFingerprint &other) const {
+        return !(*this == other);
+    }
+
+    static ImDrawListFingerprint Of(const ImDrawList *list) {
+        ImDrawListFingerprint print;
+        print.vtx_size = list->VtxBuffer.Size;
+        print.idx_size = list->IdxBuffer.Size;
+        print.cmd_size = list->CmdBuffer.Size;
+        print.hash = ImHash64(list->VtxBuffer.Data, sizeof(ImDrawVert) * list->VtxBuffer.Size);
+        print.hash = ImHash64(list->IdxBuffer.Data, sizeof(ImDrawIdx) * list->IdxBuffer.Size, print.hash);
+        for (const auto &cmd : list->CmdBuffer) {  // Field by field, so padding never takes part
+            const auto data_size = cmd.UserCallback ? ImCallbackDataSize(cmd.UserCallback) : 0;
+            const struct {
+                ImVec4 clip_rect;
+                uint64_t texture_id, callback, callback_data;
+                unsigned int vtx_offset, idx_offset, elem_count, _padding;
+            } fields = {
+                cmd.ClipRect,
+                static_cast<uint64_t>(reinterpret_cast<uintptr_t>(cmd.TextureId)),
+                static_cast<uint64_t>(reinterpret_cast<uintptr_t>(cmd.UserCallback)),
+                data_size ? 0 : static_cast<uint64_t>(reinterpret_cast<uintptr_t>(cmd.UserCallbackData)),  // Data in the frame arena moves whenever anything before it changes size
+                cmd.VtxOffset, cmd.IdxOffset, cmd.ElemCount, 0
+            };
+            print.hash = ImHash64(&fields, sizeof(fields), print.hash);
+            if (data_size && cmd.UserCallbackData) print.hash = ImHash64(cmd.UserCallbackData, data_size, print.hash);  // By value, wherever the arena put it
+        }
+        return print;
+    }
+};
+
+// Screen rectangles, in draw data coordinates, that have to be drawn again. Rectangles are kept whole-pixel and disjoint,
+// so drawing each one separately never blends a pixel twice, and there are never more than MaxRects of them.
+struct ImDrawDamage {
+
+    static constexpr size_t MaxRects = 4;  // Every rectangle costs a pass over the draw data
+
+    bool full = true;  // Everything has to be drawn again; rects is meaningless then
+    std::vector<ImVec4> rects;
+
+    void Reset(const bool &everything) {
+        full = everything;
+        rects.clear();
+    }
+
+    void Add(ImVec4 rect) {
+        if (full || rect.z <= rect.x || rect.w <= rect.y) return;
+        rect = { std::floor(rect.x), std::floor(rect.y), std::ceil(rect.z), std::ceil(rect.w) };
+        for (size_t i = 0; i < rects.size();) {  // Absorb every rectangle this one touches; having grown, it may touch ones it missed
+            if (rect.x > rects[i].z || rects[i].x > rect.z || rect.y > rects[i].w || rects[i].y > rect.w) {
+                i++;
+                continue;
+            }
+            rect = Union(rect, rects[i]);
+            rects.erase(rects.begin() + i);
+            i = 0;
+        }
+        rects.push_back(rect);
+        if (rects.size() > MaxRects) {
+            for (size_t i = 1; i < rects.size(); i++) rects[0] = Union(rects[0], rects[i]);
+            rects.resize(1);
+        }
+    }
+
+    float Area() const {
+        float res = 0;
+        for (const auto &rect : rects) res += (rect.z - rect.x) * (rect.w - rect.y);
+        return res;
+    }
+
+    static ImVec4 Union(const ImVec4 &a, const ImVec4 &b) {
+        return { std::min(a.x, b.x), std::min(a.y, b.y), std::max(a.z, b.z), std::max(a.w, b.w) };
+    }
+
+    // A command's clip rectangle limited to "rect"; off screen when they don't overlap, which the backend skips.
+    static ImVec4 Clip(const ImVec4 &clip_rect, const ImVec4 &rect) {
+        const ImVec4 res = { std::max(clip_rect.x, rect.x), std::max(clip_rect.y, rect.y), std::min(clip_rect.z, rect.z), std::min(clip_rect.w, rect.w) };
+        if (res.z <= res.x || res.w <= res.y) return { -FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        return res;
+    }
+};
+
+// Detects draw data changes by fingerprinting every draw list; no geometry is kept between frames.
+// The draw lists that changed are also fingerprinted command by command, so "damage" says where on screen they changed.
 struct ImDrawCompare {
 
-    std::vector<std::vector<ImDrawVert>> prev_vertices;
-    std::vector<std::vector<ImDrawIdx>> prev_indices;
+    struct Command {
+
+        uint64_t hash;
+        ImVec4 bounds;  // What the command may draw to: its vertices' bounding box within its clip rectangle
+    };
+
+    std::vector<ImDrawListFingerprint> prints;
+    std::vector<bool> changed;  // Per draw list, whether it differed from the previous frame
+    std::vector<std::vector<Command>> commands;  // Per draw list, as of the frame it last changed in
+    ImDrawDamage damage;  // Where the changed commands were and now are
 
     bool Check(ImDrawData *const data) {
-        const auto draw_list_num = data->CmdListsCount;
-        const bool prev_vertices_match = [&]() {
-            if (prev_vertices.size() < draw_list_num) return false;
-            for (int i = 0; i < prev_vertices.size() && i < data->CmdListsCount; i++) {
-                if (prev_vertices[i].size() < data->CmdLists[i]->VtxBuffer.size()) return false;
-                if (memcmp(prev_vertices[i].data(), data->CmdLists[i]->VtxBuffer.Data, sizeof(ImDrawVert) * data->CmdLists[i]->VtxBuffer.size()) != 0) return false;
+        bool unchanged = static_cast<int>(prints.size()) == data->CmdListsCount;
+        damage.Reset(!unchanged);  // A window appearing or going away can uncover anything
+        prints.resize(data->CmdListsCount);
+        changed.assign(data->CmdListsCount, false);
+        commands.resize(data->CmdListsCount);
+        for (int i = 0; i < data->CmdListsCount; i++) {
+            const auto print = ImDrawListFingerprint::Of(data->CmdLists[i]);
+            if (print == prints[i]) continue;
+            prints[i] = print;
+            changed[i] = true;
+            unchanged = false;
+            Commands(data->CmdLists[i], scratch);
+            const auto &previous = commands[i];
+            for (size_t j = 0; j < std::max(previous.size(), scratch.size()); j++) {
+                if (j < previous.size() && j < scratch.size() && previous[j].hash == scratch[j].hash) continue;
+                if (j < previous.size()) damage.Add(previous[j].bounds);
+                if (j < scratch.size()) damage.Add(scratch[j].bounds);
             }
-            return true;
-        }();
-        const bool prev_indices_match = [&]() {
-            if (prev_indices.size() < draw_list_num) return false;
-            for (int i = 0; i < prev_indices.size() && i < data->CmdListsCount; i++) {
-                if (prev_indices[i].size() < data->CmdLists[i]->IdxBuffer.size()) return false;
-                if (memcmp(prev_indices[i].data(), data->CmdLists[i]->IdxBuffer.Data, sizeof(ImDrawIdx) * data->CmdLists[i]->IdxBuffer.size()) != 0)  return false;
+            std::swap(commands[i], scratch);
+        }
+        return unchanged;
+    }
+
+    // Fingerprints each command by what it draws rather than where its data sits in the buffers,
+    // so a command that only moved because an earlier one grew compares equal.
+    static void Commands(const ImDrawList *list, std::vector<Command> &out) {
+        out.clear();
+        for (const auto &cmd : list->CmdBuffer) {
+            const auto data_size = cmd.UserCallback ? ImCallbackDataSize(cmd.UserCallback) : 0;
+            const struct {
+                ImVec4 clip_rect;
+                uint64_t texture_id, callback, callback_data;
+            } fields = {
+                cmd.ClipRect,
+                static_cast<uint64_t>(reinterpret_cast<uintptr_t>(cmd.TextureId)),
+                static_cast<uint64_t>(reinterpret_cast<uintptr_t>(cmd.UserCallback)),
+                data_size ? 0 : static_cast<uint64_t>(reinterpret_cast<uintptr_t>(cmd.UserCallbackData))  // Data copied into the frame arena sits elsewhere every frame; its contents are hashed below
+            };
+            Command command = { ImHash64(&fields, sizeof(fields)), { 0, 0, 0, 0 } };
+            if (cmd.UserCallback) {
+                if (data_size && cmd.UserCallbackData) command.hash = ImHash64(cmd.UserCallbackData, data_size, command.hash);
+                if (cmd.UserCallback != ImDrawCallback_ResetRenderState) command.bounds = cmd.ClipRect;  // Whatever a callback draws stays within its clip rectangle
+            } else if (cmd.ElemCount) {
+                const auto idx = list->IdxBuffer.Data + cmd.IdxOffset;
+                const auto [min_idx, max_idx] = std::minmax_element(idx, idx + cmd.ElemCount);
+                const auto vtx = list->VtxBuffer.Data + cmd.VtxOffset + *min_idx;
+                const auto vtx_count = static_cast<size_t>(*max_idx - *min_idx) + 1;
+                command.hash = ImHash64(vtx, sizeof(ImDrawVert) * vtx_count, command.hash);
+                ImDrawIdx relative[256];  // Indices counted from the command's first vertex
+                for (unsigned int i = 0; i < cmd.ElemCount; i += IM_ARRAYSIZE(relative)) {
+                    const auto n = std::min<unsigned int>(cmd.ElemCount - i, IM_ARRAYSIZE(relative));
+                    for (unsigned int j = 0; j < n; j++) relative[j] = static_cast<ImDrawIdx>(idx[i + j] - *min_idx);
+                    command.hash = ImHash64(relative, sizeof(ImDrawIdx) * n, command.hash);
+                }
+                ImVec4 box = { FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX };
+                for (size_t i = 0; i < vtx_count; i++) {
+                    box.x = std::min(box.x, vtx[i].pos.x);
+                    box.y = std::min(box.y, vtx[i].pos.y);
+                    box.z = std::max(box.z, vtx[i].pos.x);
+                    box.w = std::max(box.w, vtx[i].pos.y);
+                }
+                const auto clipped = ImDrawDamage::Clip(box, cmd.ClipRect);
+                if (clipped.x != -FLT_MAX) command.bounds = clipped;
             }
-            return true;
-        }();
-        if (prev_vertices_match && prev_indices_match) return true;
-        if (prev_vertices.size() < draw_list_num) prev_vertices.resize(draw_list_num);
-        if (prev_indices.size() < draw_list_num) prev_indices.resize(draw_list_num);
-        for (int i = 0; i < draw_list_num; i++) {
-            const auto this_draw_list = data->CmdLists[i];
-            const auto this_draw_list_vertex_num = this_draw_list->VtxBuffer.size();
-            const auto this_draw_list_index_num = this_draw_list->IdxBuffer.size();
-            if (prev_vertices[i].size() < this_draw_list_vertex_num) prev_vertices[i].resize(this_draw_list_vertex_num);
-            memcpy(prev_vertices[i].data(), this_draw_list->VtxBuffer.Data, sizeof(ImDrawVert) * this_draw_list->VtxBuffer.size());
-            if (prev_indices[i].size() < this_draw_list_index_num) prev_indices[i].resize(this_draw_list_index_num);
-            memcpy(prev_indices[i].data(), this_draw_list->IdxBuffer.Data, sizeof(ImDrawIdx) * this_draw_list->IdxBuffer.size());
-        }
-        return false;
+            out.push_back(command);
+        }
+    }
+
+private:
+
+    std::vector<Command> scratch;  // Keeps its capacity between frames
+};
+
+// Bump allocator for strings that only live until the end of the frame, such as widget labels and IDs.
+// Blocks are kept across frames and Reset() at the start of every frame makes them reusable,
+// so once the largest frame has been seen, building labels no longer touches the heap. Only the UI thread may use it.
+struct ImFrameArena {
+
+    static constexpr size_t BlockSize = 16 * 1024;
+
+    static ImFrameArena &Get() {
+        static ImFrameArena arena;
+        return arena;
     }
+
+    // The unused rest of the current block; pair it with Commit() to write in place without knowing the size up front.
+    std::pair<char *, size_t> Free() {
+        if (block_i >= blocks.size()) return { nullptr, 0 };
+        return { blocks[block_i].data.get() + offset, blocks[block_i].size - offset };
+    }
+
+    void Commit(const size_t &size) {
+        offset += size;
+        used += size;
+    }
+
+    char *Allocate(const size_t &size) {
+        while (block_i < blocks.size() && blocks[block_i].size - offset < size) {
+            block_i++;
+            offset = 0;
+        }
+        if (block_i >= blocks.size()) {
+            const auto block_size = std::max(BlockSize, size);
+            blocks.push_back({ std::make_unique<char[]>(block_size), block_size });
+            offset = 0;
+        }
+        const auto ptr = blocks[block_i].data.get() + offset;
+        Commit(size);
+        return ptr;
+    }
+
+    void Reset() {
+        block_i = offset = used = 0;
+    }
+
+    size_t Used() const { return used; }  // Bytes handed out since the last Reset()
+
+private:
+
+    struct Block {
+
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;
+    size_t block_i = 0, offset = 0;
+    size_t used = 0;
 };
 
+// Formats into the frame arena and returns a null-terminated string that stays valid until the next ImFrameArena::Reset().
+// A drop-in for fmt::format(...).data() in widget calls, without the heap allocation.
+template<typename... T> const char *ImFormat(fmt::format_string<T...> format, const T &...args) {
+    auto &arena = ImFrameArena::Get();
+    const auto [space, space_size] = arena.Free();
+    const auto res = fmt::format_to_n(space, space_size ? space_size - 1 : 0, format, args...);
+    char *out = space;
+    if (res.size < space_size) arena.Commit(res.size + 1);
+    else {  // Didn't fit in the current block; the first attempt measured it
+        out = arena.Allocate(res.size + 1);
+        fmt::format_to_n(out, res.size, format, args...);
+    }
+    out[res.size] = 0;
+    return out;
+}
+
+// Adds a draw callback with a copy of "data" that stays valid until the next ImFrameArena::Reset(), so through rendering.
+// ImDrawCompare hashes the copy, so a callback that only draws something different still causes a redraw; "T" must have no padding.
+template<typename T> void ImAddCallback(ImDrawList *list, ImDrawCallback callback, const T &data) {
+    static_assert(std::is_trivially_copyable_v<T>, "Callback data is copied byte by byte.");
+    if (!ImCallbackDataSize(callback)) ImCallbackDataSizes().push_back({ callback, sizeof(T) });
+    const auto copy = ImFrameArena::Get().Allocate(sizeof(T));
+    memcpy(copy, &data, sizeof(T));
+    list->AddCallback(callback, copy);
+}
+
+// Formats a label once per call site and keeps it for the program's lifetime.
+// For labels built only from constants, such as an icon and a caption; use ImFormat when any argument can change.
+#define IM_LABEL(...) ([]() -> const char * { static const std::string label = fmt::format(__VA_ARGS__); return label.data(); }())
+
 struct ImPenUtility {
 
     ImVec2 content_region_size, content_region_start;
@@ -0,0 +1,56 @@
+#include "imgui_utils.hpp"
+
+#include "../check.hpp"
+
+using sc::test::check;
+
+// Stands in for a widget's draw callback, such as ImCurve's; only its address and data matter here
+static void draw_curve(const ImDrawList *, const ImDrawCmd *) { }
+
+struct curve_data {
+
+    float points[8];
+    ImU32 color;
+};
+
+// A list with a curve callback whose data sits wherever the arena hands it out; returns where that is
+static const void *build(ImDrawList &list, const curve_data &curve) {
+    ImDrawCmd first;
+    first.ClipRect = { 0, 0, 640, 480 };
+    list.CmdBuffer.push_back(first);
+    ImAddCallback(&list, draw_curve, curve);
+    for (const auto &cmd : list.CmdBuffer) if (cmd.UserCallback == draw_curve) return cmd.UserCallbackData;
+    return nullptr;
+}
+
+static void test_fingerprint() {
+    const curve_data curve = { { 0, 0, .25f, .1f, .75f, .9f, 1, 1 }, IM_COL32_WHITE };
+    auto &arena = ImFrameArena::Get();
+
+    // Fingerprints are taken within the frame, before the arena is reset and reused
+    arena.Reset();
+    ImFormat("{:.1f} %", 12.5);
+    ImDrawList before(nullptr);
+    const auto before_data = build(before, curve);
+    const auto before_print = ImDrawListFingerprint::Of(&before);
+
+    // The next frame formats a longer label ahead of the curve, which moves its data
+    arena.Reset();
+    ImFormat("{:.1f} %", 100.0);
+    ImDrawList after(nullptr);
+    const auto after_data = build(after, curve);
+
+    check(before_data != after_data, "the curve's data moved in the arena");
+    check(before_print == ImDrawListFingerprint::Of(&after), "the same curve at another arena offset fingerprints the same");
+
+    auto edited = curve;
+    edited.points[3] = .2f;
+    ImDrawList changed(nullptr);
+    build(changed, edited);
+    check(before_print != ImDrawListFingerprint::Of(&changed), "a curve with other data fingerprints differently");
+}
+
+int main() {
+    test_fingerprint();
+    return sc::test::finish("imgui utils");
+}
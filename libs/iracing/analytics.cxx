@@ -0,0 +1,110 @@
+#include "analytics.h"  // Include the header file "analytics.h"
+
+#include <algorithm>  // Include the header file for using std::sort
+
+void sc::iracing::trace_analytics::set_segments(const std::vector<segment> &table) {  // Replaces the segment table
+    num_segments = std::min(table.size(), max_segments);
+    std::copy_n(table.begin(), num_segments, segments.begin());
+    std::sort(segments.begin(), segments.begin() + num_segments, [](const segment &first, const segment &second) { return first.start < second.start; });
+    reset();
+}
+
+void sc::iracing::trace_analytics::set_uniform_segments(const size_t &count) {  // Splits the lap into equal segments
+    std::vector<segment> table(std::min(count, max_segments));
+    for (size_t i = 0; i < table.size(); i++) {
+        table[i].start = static_cast<float>(i) / table.size();
+        table[i].end = static_cast<float>(i + 1) / table.size();
+        const auto label = "S" + std::to_string(i + 1);
+        label.copy(table[i].name.data(), table[i].name.size() - 1);
+    }
+    set_segments(table);
+}
+
+void sc::iracing::trace_analytics::reset() {  // Drops every lap
+    num_laps = 0;
+    last.reset();
+    in_segment = false;
+    segment_i = 0;
+}
+
+sc::iracing::trace_analytics::lap_metrics &sc::iracing::trace_analytics::begin_lap() {  // Starts a new lap in the ring, overwriting the oldest
+    auto &target = laps[num_laps % max_laps];
+    target = lap_metrics();
+    target.number = num_laps++;
+    in_segment = false;
+    return target;
+}
+
+void sc::iracing::trace_analytics::locate(const float &lap_percent) {  // Steps to the segment containing lap_percent; neighbours are almost always the answer
+    if (!num_segments) {
+        in_segment = false;
+        return;
+    }
+    if (segment_i >= num_segments) segment_i = 0;
+    for (size_t steps = 0; steps < num_segments; steps++) {
+        const auto &current = segments[segment_i];
+        if (lap_percent >= current.start && lap_percent < current.end) {
+            in_segment = true;
+            return;
+        }
+        if (lap_percent < current.start && segment_i > 0) segment_i--;
+        else if (lap_percent >= current.end && segment_i + 1 < num_segments) segment_i++;
+        else break;
+    }
+    in_segment = false;  // In a gap between configured corners
+}
+
+void sc::iracing::trace_analytics::push(const frame &value) {  // Consumes one telemetry frame with the sim's own pedals
+    push(value, value.throttle, value.brake);
+}
+
+void sc::iracing::trace_analytics::push(const frame &value, const float &throttle, const float &brake) {  // Consumes one telemetry frame in constant time
+    if (!last) {
+        last = value;
+        begin_lap();
+        return;
+    }
+    auto dt = static_cast<float>(value.tick - last->tick) / 60.f;  // iRacing ticks at 60 Hz
+    if (dt < 0 || dt > .5f) dt = 0;  // Pauses, resets and replays restarting do not count as driving time
+    auto *current_lap = &laps[(num_laps - 1) % max_laps];
+    if (last->lap_percent - value.lap_percent > .5f) {  // Crossed the line
+        current_lap->complete = true;
+        current_lap = &begin_lap();
+    }
+    current_lap->lap_time += dt;
+    last = value;
+
+    locate(value.lap_percent);
+    if (!in_segment) return;
+
+    auto &metrics = current_lap->corners[segment_i];
+    if (!metrics.visited) {  // Entering the segment
+        metrics.visited = true;
+        metrics.entry_speed = metrics.min_speed = value.speed;
+    }
+    const auto braking = brake > pedal_threshold, throttling = throttle > pedal_threshold;
+    if (braking && !metrics.braked) {  // Brake onset
+        metrics.braked = true;
+        metrics._onset_time = metrics._time_in;
+    }
+    if (braking && brake > metrics.peak_brake) {  // New peak
+        metrics.peak_brake = brake;
+        metrics.time_to_peak = metrics._time_in - metrics._onset_time;
+        metrics._peak_time = metrics._time_in;
+        metrics._released = false;
+    }
+    if (metrics.braked && !metrics._released && !braking) {  // Fully released after the peak
+        metrics._released = true;
+        const auto duration = metrics._time_in - metrics._peak_time;
+        metrics.release_slope = duration > 0 ? (metrics.peak_brake - brake) / duration : 0;
+    }
+    if (braking && throttling) metrics.overlap += dt;
+    if (!braking && !throttling) metrics.coasting += dt;
+    metrics.min_speed = std::min(metrics.min_speed, value.speed);
+    metrics._time_in += dt;
+}
+
+const sc::iracing::trace_analytics::lap_metrics *sc::iracing::trace_analytics::lap(const size_t &age) const {  // Looks a lap up by age
+    if (age >= max_laps || static_cast<int64_t>(age) >= num_laps) return nullptr;
+    return &laps[(num_laps - 1 - age) % max_laps];
+}
@@ -0,0 +1,74 @@
+#pragma once  // Ensures this header file is included only once during compilation
+
+#include <array>  // Include the header file for using std::array
+#include <cstdint>  // Include the header file for using fixed width integers
+#include <optional>  // Include the header file for using std::optional
+#include <string>  // Include the header file for using std::string
+#include <vector>  // Include the header file for using std::vector
+
+#include "telemetry_bus.h"  // Include the header file for the per-tick frames
+
+namespace sc::iracing {  // Start of the sc::iracing namespace
+
+    struct segment {  // A distance range of the lap, usually a corner
+
+        float start = 0, end = 1;  // LapDistPct range, start inclusive, end exclusive
+        std::array<char, 16> name = { 0 };  // Display name, e.g. "T1"
+    };
+
+    struct corner_metrics {  // Braking metrics of one segment on one lap
+
+        bool visited = false;  // Whether the car passed through the segment on this lap
+        bool braked = false;  // Whether the brake went past the threshold within the segment
+        float entry_speed = 0, min_speed = 0;  // Speed at the segment start and the lowest speed within it
+        float peak_brake = 0;  // Highest brake value, 0 to 1
+        float time_to_peak = 0;  // Seconds from brake onset to peak brake
+        float release_slope = 0;  // Trail-brake release rate from peak to release, in brake fraction per second
+        float overlap = 0;  // Seconds with throttle and brake applied together
+        float coasting = 0;  // Seconds with neither throttle nor brake applied
+
+        float _time_in = 0, _onset_time = 0, _peak_time = 0;  // Running state while the segment is active
+        bool _released = false;
+    };
+
+    // Incremental per-corner trace analytics. Each frame costs O(1): the active segment is tracked by stepping,
+    // and only the active segment's metrics are touched. Laps are kept in a fixed ring, so memory never grows.
+    struct trace_analytics {
+
+        static constexpr size_t max_segments = 32;  // Segments per lap
+        static constexpr size_t max_laps = 16;  // Laps kept, including the one in progress
+        static constexpr float pedal_threshold = .05f;  // Pedal fraction that counts as applied
+
+        struct lap_metrics {
+
+            int64_t number = 0;  // Sequential lap number since the analytics were reset
+            float lap_time = 0;  // Seconds, running while the lap is in progress
+            bool complete = false;  // Whether the lap was finished by crossing the line
+            std::array<corner_metrics, max_segments> corners;
+        };
+
+        std::array<segment, max_segments> segments;  // Active segment table, ordered by start
+        size_t num_segments = 0;
+
+        std::array<lap_metrics, max_laps> laps;  // Ring of laps
+        int64_t num_laps = 0;  // Laps started since the analytics were reset
+
+        void set_segments(const std::vector<segment> &table);  // Replaces the segment table and resets every lap
+        void set_uniform_segments(const size_t &count);  // Splits the lap into equal segments
+        void reset();  // Drops every lap
+
+        void push(const frame &value);  // Consumes one telemetry frame, with the pedals as the sim saw them
+        void push(const frame &value, const float &throttle, const float &brake);  // Consumes one telemetry frame, with the pedals from elsewhere, 0 to 1
+
+        const lap_metrics *lap(const size_t &age) const;  // 0 is the lap in progress, 1 the previous lap, ..., nullptr if not kept
+
+    private:
+
+        std::optional<frame> last;  // Previous frame
+        size_t segment_i = 0;  // Index of the segment the car is in
+        bool in_segment = false;  // Whether "segment_i" contains the car
+
+        lap_metrics &begin_lap();
+        void locate(const float &lap_percent);
+    };
+}  // End of the sc::iracing namespace
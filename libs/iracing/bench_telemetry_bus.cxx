@@ -0,0 +1,53 @@
+#include "telemetry_bus.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <atomic>
+
+#include <spdlog/spdlog.h>
+
+static constexpr uint64_t num_frames = 10'000'000;
+
+static void run(const int &num_consumers) {
+    auto bus = std::make_unique<sc::iracing::telemetry_bus>();
+    std::atomic_bool publishing = true;
+    std::vector<std::thread> consumers;
+    std::vector<sc::iracing::telemetry_bus::cursor> cursors(num_consumers);
+    std::vector<uint64_t> received(num_consumers, 0), out_of_order(num_consumers, 0);
+    for (int i = 0; i < num_consumers; i++) {
+        consumers.emplace_back([&, i]() {
+            int64_t last_tick = -1;
+            for (;;) {
+                const auto still_publishing = publishing.load();
+                while (const auto value = bus->read(cursors[i])) {
+                    if (value->tick <= last_tick) out_of_order[i]++;
+                    last_tick = value->tick;
+                    received[i]++;
+                }
+                if (!still_publishing) return;
+            }
+        });
+    }
+    const auto start = std::chrono::high_resolution_clock::now();
+    sc::iracing::frame current;
+    for (uint64_t n = 0; n < num_frames; n++) {
+        current.tick = static_cast<int64_t>(n);
+        current.rpm = static_cast<float>(n % 8000);
+        bus->publish(current);
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start).count();
+    publishing = false;
+    for (auto &consumer : consumers) consumer.join();
+    spdlog::info("{} consumer(s): {:.1f} ns per published frame ({} byte frames)", num_consumers, static_cast<double>(elapsed) / num_frames, sizeof(sc::iracing::frame));
+    for (int i = 0; i < num_consumers; i++) {
+        spdlog::info("  consumer {}: received {}, dropped {}, out of order {}", i, received[i], cursors[i].dropped, out_of_order[i]);
+        if (received[i] + cursors[i].dropped != num_frames || out_of_order[i]) spdlog::error("  consumer {} lost track of the stream", i);
+    }
+}
+
+int main() {
+    for (const auto num_consumers : { 0, 1, 2, 4 }) run(num_consumers);
+    return 0;
+}
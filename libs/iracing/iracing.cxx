@@ -7,8 +7,9 @@
 #include <optional>  // Include the header file for using std::optional
 #include <chrono>  // Include the header file for using std::chrono
 #include <algorithm>  // Include the header file for using std::algorithm
-#include <map>  // Include the header file for using std::map
+#include <cmath>  // Include the header file for using NAN
 #include <string>  // Include the header file for using std::string
+#include <cstring>  // Include the header file for using strnlen
 
 #include <spdlog/spdlog.h>  // Include the header file for using spdlog
 #include <spdlog/fmt/bin_to_hex.h>  // Include the header file for using spdlog hex formatting
@@ -16,6 +17,7 @@
 #include <windows.h>  // Include the Windows header file
 
 #include "../defer.hpp"  // Include the custom header file "defer.hpp"
+#include "../boot/wakeup.h"  // Include the header file for waking the main loop
 
 namespace sc::iracing {  // Start of the sc::iracing namespace
 
@@ -29,14 +31,18 @@ namespace sc::iracing {  // Start of the sc::iracing namespace
 
     static std::atomic<status> current_status = status::stopped;  // Declaration of a static std::atomic<status> variable "current_status"
 
-    std::mutex tele_members_mutex;  // Declaration of a std::mutex variable "tele_members_mutex"
-    std::map<std::string, int> tele_members;  // Declaration of a std::map<std::string, int> variable "tele_members"
+    static void set_status(const status &value) {  // Definition of a static function "set_status" that wakes the main loop when the status actually changes
+        if (current_status.exchange(value) != value) sc::boot::wakeup();
+    }
+
+    static std::shared_ptr<const variable_snapshot> published_variables;  // Only accessed through std::atomic_load/std::atomic_store
 
-    std::atomic<bool> tele_prev_valid = false;  // Declaration of a std::atomic<bool> variable "tele_prev_valid"
-    std::atomic<float> tele_lap_percent = 0;  // Declaration of a std::atomic<float> variable "tele_lap_percent"
-    std::atomic<float> tele_rpm = 0, tele_rpm_prev = 0;  // Declaration of std::atomic<float> variables "tele_rpm" and "tele_rpm_prev"
-    std::atomic<float> tele_speed = 0, tele_speed_prev = 0;  // Declaration of std::atomic<float> variables "tele_speed" and "tele_speed_prev"
-    std::atomic<int> tele_gear = 0, tele_gear_prev = 0;  // Declaration of std::atomic<int> variables "tele_gear" and "tele_gear_prev"
+    static std::mutex latest_values_mutex;  // Guards the copy of the latest variable buffer
+    static std::vector<std::byte> latest_values;  // The most recent variable buffer, copied out of the mapping every tick while it is read
+    static uint64_t latest_values_version = 0;  // Version of the snapshot that describes "latest_values"; 0 while it isn't kept up to date
+    static std::atomic<std::chrono::steady_clock::rep> latest_values_read = 0;  // When read_values() was last called, so the worker only copies while the variable browser is shown
+
+    static telemetry_bus bus;  // Declaration of a static telemetry_bus variable "bus" that every consumer reads frames from
 
     struct moment {  // Definition of a struct named "moment"
 
@@ -82,6 +88,35 @@ namespace sc::iracing {  // Start of the sc::iracing namespace
         std::byte unit[32];  // Declaration of a std::byte array member variable "unit"
     };
 
+    static void process_variables(header *telemetry_header, std::vector<std::byte> &last_headers) {  // Definition of a static function "process_variables" that publishes a new channel list when the variable headers changed
+        if (telemetry_header->num_variables < 0 || telemetry_header->variables_header_offset <= 0) return;  // Ignore headers that don't describe the variables yet
+        const auto length = static_cast<size_t>(telemetry_header->num_variables) * sizeof(variable_header);  // Size of every variable header together
+        if (static_cast<size_t>(telemetry_header->variables_header_offset) + length > mapped_file_length) return;  // Never read past the mapped view
+        const auto headers_begin = reinterpret_cast<const std::byte *>(reinterpret_cast<uintptr_t>(telemetry_header) + telemetry_header->variables_header_offset);  // Start of the variable headers within the mapping
+        if (last_headers.size() == length && memcmp(last_headers.data(), headers_begin, length) == 0) return;  // Nothing to do unless the headers changed, which happens when a session loads
+        last_headers.assign(headers_begin, headers_begin + length);  // Remember the headers so the list is only rebuilt once per change
+        std::vector<variable_info> list;  // The channels, in header order
+        list.reserve(telemetry_header->num_variables);
+        const auto field = [](const std::byte *value, const size_t &size) { return std::string(reinterpret_cast<const char *>(value), strnlen(reinterpret_cast<const char *>(value), size)); };  // Helper that copies a NUL padded header field
+        for (int i = 0; i < telemetry_header->num_variables; i++) {  // Iterate through the variable headers
+            variable_header variable;
+            memcpy(&variable, last_headers.data() + (i * sizeof(variable_header)), sizeof(variable_header));
+            list.push_back({ field(variable.name, sizeof(variable.name)), field(variable.description, sizeof(variable.description)), field(variable.unit, sizeof(variable.unit)), static_cast<variable_type>(variable.type), variable.offset, variable.count });
+        }
+        std::atomic_store(&published_variables, variable_snapshot::create(std::move(list)));  // Readers either see the old or the new list, never a partial one
+        spdlog::debug("iRacing exposes {} telemetry variables.", telemetry_header->num_variables);
+    }
+
+    static void process_session_info(header *telemetry_header, std::optional<int32_t> &last_session_info_update) {  // Definition of a static function "process_session_info" that hands changed session info to the background parser
+        if (last_session_info_update && *last_session_info_update == telemetry_header->session_info_update) return;  // Nothing to do unless iRacing bumped the update counter
+        if (telemetry_header->session_info_offset <= 0 || telemetry_header->session_info_length <= 0) return;  // Ignore headers that don't describe a session string yet
+        if (static_cast<size_t>(telemetry_header->session_info_offset) + static_cast<size_t>(telemetry_header->session_info_length) > mapped_file_length) return;  // Never read past the mapped view
+        const auto session_info_begin = reinterpret_cast<const char *>(reinterpret_cast<uintptr_t>(telemetry_header) + telemetry_header->session_info_offset);  // Start of the session string within the mapping
+        const auto session_info_size = strnlen(session_info_begin, telemetry_header->session_info_length);  // The string is NUL padded up to session_info_length
+        last_session_info_update = telemetry_header->session_info_update;  // Remember the counter so the copy happens once per change
+        session_parser::submit(*last_session_info_update, std::string(session_info_begin, session_info_size));  // Copy out of the mapping; parsing happens off this thread
+    }
+
     static variable_buffer_header *find_recent_valid_buffer(header *telemetry_header) {  // Definition of a static function "find_recent_valid_buffer" that returns a variable_buffer_header pointer and takes a header pointer "telemetry_header" as a parameter
         std::vector<variable_buffer_header *> sorted_buffers;  // Declaration of a std::vector<variable_buffer_header *> variable "sorted_buffers"
         for (int i = 0; i < telemetry_header->num_buffers; i++) sorted_buffers.push_back(&telemetry_header->buffers[i]);  // Iterate through the buffers and add their addresses to the "sorted_buffers" vector
@@ -91,8 +126,8 @@ namespace sc::iracing {  // Start of the sc::iracing namespace
         return sorted_buffers[1];  // Return the second element (index 1) of the sorted_buffers vector
     }
 
-    static void process_lap_progress() {  // Definition of a static function "process_lap_progress" that doesn't return anything and takes no parameters
-        const auto i = static_cast<size_t>(tele_lap_percent * static_cast<float>(moments.size()));  // Calculate the index i based on the tele_lap_percent and the size of the moments vector
+    static void process_lap_progress(frame &current) {  // Definition of a static function "process_lap_progress" that fills the previous-lap members of "current"
+        const auto i = static_cast<size_t>(current.lap_percent * static_cast<float>(moments.size()));  // Calculate the index i based on the lap percentage and the size of the moments vector
         if (i < 0 || i >= moments.size()) return;  // If the index i is out of range, return
         size_t nearest = -1;  // Declaration of a size_t variable "nearest" initialized with -1
         for (auto j = i + 1; j < moments.size() && j < i + 1000; j++) {  // Iterate through the moments vector starting from i+1 to i+1000
@@ -102,13 +137,13 @@ namespace sc::iracing {  // Start of the sc::iracing namespace
             }
         }
         if (nearest >= 0 && nearest < moments.size()) {  // If the nearest variable is within range
-            tele_prev_valid = true;  // Set tele_prev_valid to true
-            tele_rpm_prev = moments[nearest].rpm;  // Set tele_rpm_prev to the rpm value of the nearest moment
-            tele_speed_prev = moments[nearest].speed;  // Set tele_speed_prev to the speed value of the nearest moment
-            tele_gear_prev = moments[nearest].gear;  // Set tele_gear_prev to the gear value of the nearest moment
+            current.prev_valid = true;  // Mark the previous-lap members as valid
+            current.rpm_prev = moments[nearest].rpm;  // Set rpm_prev to the rpm value of the nearest moment
+            current.speed_prev = moments[nearest].speed;  // Set speed_prev to the speed value of the nearest moment
+            current.gear_prev = moments[nearest].gear;  // Set gear_prev to the gear value of the nearest moment
         }
         else {  // If no valid nearest moment is found
-            tele_prev_valid = false;  // Set tele_prev_valid to false
+            current.prev_valid = false;  // Mark the previous-lap members as invalid
             const auto now = std::chrono::system_clock::now();  // Get the current time
             static auto last = now;  // Declaration of a static auto variable "last" initialized with now
             if (std::chrono::duration_cast<std::chrono::seconds>(now - last).count() > 2) {  // If more than 2 seconds have passed since the last log
@@ -116,44 +151,64 @@ namespace sc::iracing {  // Start of the sc::iracing namespace
                 last = now;  // Update the last log time to now
             }
         }
-        if (tele_speed > 5) {  // If tele_speed is greater than 5
+        if (current.speed > 5) {  // If the speed is greater than 5
             moments[i] = {  // Assign a new moment at index i with the following values
                 true,
-                tele_rpm,
-                tele_speed,
-                tele_gear
+                current.rpm,
+                current.speed,
+                current.gear
             };
         }
     }
 
-    static void process_telemetry(header *telemetry_header, variable_header *variables) {  // Definition of a static function "process_telemetry" that doesn't return anything and takes a header pointer "telemetry_header" and a variable_header pointer "variables" as parameters
+    static void process_telemetry(header *telemetry_header, variable_header *variables, frame &current) {  // Definition of a static function "process_telemetry" that reads the most recent variable buffer into the frame "current"
         auto variable_buffer = find_recent_valid_buffer(telemetry_header);  // Get the recent valid buffer using the find_recent_valid_buffer function
+        current.tick = variable_buffer->tick_count;  // Stamp the frame with the tick of the buffer it was read from
+        current.session_version = telemetry_header->session_info_update;  // Stamp the frame with the session-info version it belongs to
+        const auto since_read = std::chrono::steady_clock::duration(std::chrono::steady_clock::now().time_since_epoch().count() - latest_values_read.load());
+        if (since_read > std::chrono::seconds(1)) {  // Nobody reads the values, e.g. the variable browser is hidden; stop copying, and drop what would go stale
+            if (latest_values_version) {
+                std::lock_guard guard(latest_values_mutex);
+                latest_values_version = 0;
+            }
+        } else if (const auto snapshot = std::atomic_load(&published_variables); snapshot && telemetry_header->buffer_length > 0) {  // Keep a copy of the whole buffer for the variable browser
+            const auto buffer_begin = reinterpret_cast<const std::byte *>(reinterpret_cast<uintptr_t>(telemetry_header) + variable_buffer->data_offset);
+            if (static_cast<size_t>(variable_buffer->data_offset) + telemetry_header->buffer_length <= mapped_file_length) {  // Never read past the mapped view
+                std::lock_guard guard(latest_values_mutex);
+                latest_values.assign(buffer_begin, buffer_begin + telemetry_header->buffer_length);  // Reuses the vector's storage once it has grown
+                latest_values_version = snapshot->version;
+            }
+        }
+        const auto value_of = [&](const variable_header &variable) {  // Helper that returns the address of a variable within the buffer
+            return reinterpret_cast<uintptr_t>(telemetry_header) + variable_buffer->data_offset + variable.offset;
+        };
         for (int i = 0; i < telemetry_header->num_variables; i++) {  // Iterate through the variables
-            if (strcmp("RPM", reinterpret_cast<char *>(variables[i].name)) == 0) {  // If the variable name is "RPM"
-                auto value = reinterpret_cast<float *>(reinterpret_cast<uintptr_t>(telemetry_header) + variable_buffer->data_offset + variables[i].offset);  // Get the value of the RPM variable
-                spdlog::info("RPM: {}, {}", *value, variables[i].type);  // Output a log message with the RPM value and type
-            } else if (strcmp("LapDistPct", reinterpret_cast<char *>(variables[i].name)) == 0) {  // If the variable name is "LapDistPct"
-                tele_lap_percent = *reinterpret_cast<float *>(reinterpret_cast<uintptr_t>(telemetry_header) + variable_buffer->data_offset + variables[i].offset);  // Get the value of the lap percentage
-            } else if (strcmp("Speed", reinterpret_cast<char *>(variables[i].name)) == 0) {  // If the variable name is "Speed"
-                tele_speed = *reinterpret_cast<float *>(reinterpret_cast<uintptr_t>(telemetry_header) + variable_buffer->data_offset + variables[i].offset);  // Get the value of the speed variable
-                tele_speed = tele_speed * 2.2f;  // Convert the speed from m/s to mph
-            } else if (strcmp("Gear", reinterpret_cast<char *>(variables[i].name)) == 0) {  // If the variable name is "Gear"
-                tele_gear = *reinterpret_cast<int *>(reinterpret_cast<uintptr_t>(telemetry_header) + variable_buffer->data_offset + variables[i].offset);  // Get the value of the gear variable
-            } else if (strcmp("LFshockDefl", reinterpret_cast<char *>(variables[i].name)) == 0) {  // If the variable name is "LFshockDefl"
-                // spdlog::info("LFshockDefl: {}", *reinterpret_cast<float *>(reinterpret_cast<uintptr_t>(telemetry_header) + variable_buffer->data_offset + variables[i].offset));
-            } else if (strcmp("LFshockVel_ST", reinterpret_cast<char *>(variables[i].name)) == 0) {  // If the variable name is "LFshockVel_ST"
-                spdlog::info("LFshockVel_ST: {}", *reinterpret_cast<float *>(reinterpret_cast<uintptr_t>(telemetry_header) + variable_buffer->data_offset + variables[i].offset));  // Output a log message with the LFshockVel_ST value
+            const auto name = reinterpret_cast<char *>(variables[i].name);  // Name of the current variable
+            if (strcmp("RPM", name) == 0) {  // If the variable name is "RPM"
+                current.rpm = *reinterpret_cast<float *>(value_of(variables[i]));  // Get the value of the RPM variable
+            } else if (strcmp("LapDistPct", name) == 0) {  // If the variable name is "LapDistPct"
+                current.lap_percent = *reinterpret_cast<float *>(value_of(variables[i]));  // Get the value of the lap percentage
+            } else if (strcmp("Speed", name) == 0) {  // If the variable name is "Speed"
+                current.speed = *reinterpret_cast<float *>(value_of(variables[i])) * 2.2f;  // Get the value of the speed variable and convert it from m/s to mph
+            } else if (strcmp("Gear", name) == 0) {  // If the variable name is "Gear"
+                current.gear = *reinterpret_cast<int *>(value_of(variables[i]));  // Get the value of the gear variable
+            } else if (strcmp("Throttle", name) == 0) {  // If the variable name is "Throttle"
+                current.throttle = *reinterpret_cast<float *>(value_of(variables[i]));  // Get the value of the throttle variable
+            } else if (strcmp("Brake", name) == 0) {  // If the variable name is "Brake"
+                current.brake = *reinterpret_cast<float *>(value_of(variables[i]));  // Get the value of the brake variable
+            } else if (strcmp("Clutch", name) == 0) {  // If the variable name is "Clutch"
+                current.clutch = *reinterpret_cast<float *>(value_of(variables[i]));  // Get the value of the clutch variable
             }
         }
     }
 
     static void work() {  // Definition of a static function "work" that doesn't return anything and takes no parameters
         DEFER(
-            current_status = status::stopped;  // Set current_status to status::stopped when exiting the function
+            set_status(status::stopped);  // Set current_status to status::stopped when exiting the function
         );
         std::optional<std::chrono::system_clock::time_point> last_file_handle_open_attempt;  // Declaration of an std::optional<std::chrono::system_clock::time_point> variable "last_file_handle_open_attempt"
         for (;;) {  // Infinite loop
-            current_status = status::searching;  // Set current_status to status::searching
+            set_status(status::searching);  // Set current_status to status::searching
             std::this_thread::sleep_for(std::chrono::milliseconds(100));  // Sleep for 100 milliseconds
             if (!working) return;  // If working is false, return from the function
             if (!last_file_handle_open_attempt || std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now() - *last_file_handle_open_attempt).count() > 1) {  // If there is no last_file_handle_open_attempt or more than 1 second has passed since the last attempt
@@ -185,17 +240,26 @@ namespace sc::iracing {  // Start of the sc::iracing namespace
                         if (auto attempted_event_handle = OpenEventA(SYNCHRONIZE, FALSE, data_event_name); attempted_event_handle) {  // Try to open the event handle with the specified parameters and get the handle
                             event_handle = attempted_event_handle;  // Assign the handle to the event_handle variable
                             spdlog::debug("iRacing telemetry is online.");
+                            std::optional<int32_t> last_session_info_update;  // Declaration of an std::optional<int32_t> variable "last_session_info_update", empty so that every new connection parses once
+                            std::vector<std::byte> last_variable_headers;  // Declaration of a std::vector<std::byte> variable "last_variable_headers", empty so that every new connection publishes the channel list once
                             while (working) {  // Loop while working is true
                                 const auto wait_res = WaitForSingleObject(*event_handle, 1000);  // Wait for the event handle with a timeout of 1000 milliseconds
                                 if (wait_res == WAIT_OBJECT_0) {  // If the event is signaled
-                                    current_status = status::live;  // Set current_status to status::live
+                                    set_status(status::live);  // Set current_status to status::live
+                                    process_session_info(reinterpret_cast<header *>(*mapped_file_buffer), last_session_info_update);  // Submit the session info if it changed
+                                    process_variables(reinterpret_cast<header *>(*mapped_file_buffer), last_variable_headers);  // Publish the channel list if it changed
+                                    frame current;  // Declaration of a frame variable "current" that collects this tick
                                     process_telemetry(
                                         reinterpret_cast<header *>(*mapped_file_buffer),  // Cast the mapped file buffer to a header pointer
-                                        reinterpret_cast<variable_header *>(reinterpret_cast<uintptr_t>(*mapped_file_buffer) + reinterpret_cast<header *>(*mapped_file_buffer)->variables_header_offset)  // Calculate the variable header pointer using the offset in the header
+                                        reinterpret_cast<variable_header *>(reinterpret_cast<uintptr_t>(*mapped_file_buffer) + reinterpret_cast<header *>(*mapped_file_buffer)->variables_header_offset),  // Calculate the variable header pointer using the offset in the header
+                                        current
                                     );
-                                    process_lap_progress();
+                                    process_lap_progress(current);
+                                    current.timestamp_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();  // Stamp the frame with the publication time
+                                    bus.publish(current);  // Publish the frame to every consumer at once
+                                    sc::boot::wakeup();  // Wake the main loop so the new frame is shown
                                 } else if (wait_res == WAIT_TIMEOUT) {  // If the wait timed out
-                                    current_status = status::connected;  // Set current_status to status::connected
+                                    set_status(status::connected);  // Set current_status to status::connected
                                 } else if (wait_res == WAIT_ABANDONED) {  // If the wait was abandoned
                                     spdlog::warn("iRacing synchronization handle was abandoned.");
                                     break;  // Exit the loop
@@ -216,6 +280,7 @@ namespace sc::iracing {  // Start of the sc::iracing namespace
 void sc::iracing::startup() {  // Definition of a function "startup" in the sc::iracing namespace
     shutdown();  // Call the shutdown function
     moments.resize(100000);  // Resize the moments vector to hold 100000 elements
+    session_parser::startup();  // Start the background session-info parser
     spdlog::debug("Starting up iRacing telemetry worker.");
     working = true;  // Set working to true
     worker = std::thread(work);  // Create a thread "worker" and assign it to the work function
@@ -227,41 +292,42 @@ void sc::iracing::shutdown() {  // Definition of a function "shutdown" in the sc
         worker.join();  // Join the worker thread
         spdlog::debug("Shutdown iRacing telemetry worker.");
     }
+    session_parser::shutdown();  // Stop the background session-info parser
     moments.clear();  // Clear the moments vector
+    std::atomic_store(&published_variables, std::shared_ptr<const variable_snapshot>());  // Drop the channel list; the next connection publishes it again
 }
 
 const sc::iracing::status &sc::iracing::get_status() {  // Definition of a function "get_status" in the sc::iracing namespace that returns a const reference to status
     return current_status;  // Return the current_status
 }
 
-const std::atomic<bool> &sc::iracing::prev() {  // Definition of a function "prev" in the sc::iracing namespace that returns a const reference to std::atomic<bool>
-    return tele_prev_valid;  // Return tele_prev_valid
-}
-
-const std::atomic<float> &sc::iracing::lap_percent() {  // Definition of a function "lap_percent" in the sc::iracing namespace that returns a const reference to std::atomic<float>
-    return tele_lap_percent;  // Return tele_lap_percent
-}
-
-const std::atomic<float> &sc::iracing::rpm() {  // Definition of a function "rpm" in the sc::iracing namespace that returns a const reference to std::atomic<float>
-    return tele_rpm;  // Return tele_rpm
+std::shared_ptr<const sc::iracing::session_info> sc::iracing::session() {  // Definition of a function "session" in the sc::iracing namespace that returns the latest parsed session info
+    return session_parser::current();  // Return the snapshot published by the parser
 }
 
-const std::atomic<float> &sc::iracing::rpm_prev() {  // Definition of a function "rpm_prev" in the sc::iracing namespace that returns a const reference to std::atomic<float>
-    return tele_rpm_prev;  // Return tele_rpm_prev
+std::shared_ptr<const sc::iracing::variable_snapshot> sc::iracing::variables() {  // Definition of a function "variables" in the sc::iracing namespace that returns the current channel list
+    return std::atomic_load(&published_variables);  // Return the snapshot published by the worker
 }
 
-const std::atomic<float> &sc::iracing::speed() {  // Definition of a function "speed" in the sc::iracing namespace that returns a const reference to std::atomic<float>
-    return tele_speed;  // Return tele_speed
+void sc::iracing::read_values(const variable_snapshot &snapshot, const std::vector<size_t> &indices, std::vector<double> &values) {  // Definition of a function "read_values" in the sc::iracing namespace that reads a few values of the latest tick
+    latest_values_read = std::chrono::steady_clock::now().time_since_epoch().count();  // Keeps the worker copying; the first values arrive with the next tick
+    values.resize(indices.size());
+    std::lock_guard guard(latest_values_mutex);
+    for (size_t i = 0; i < indices.size(); i++) {  // Only the requested variables are decoded, e.g. the rows that are visible
+        const auto valid = latest_values_version == snapshot.version && indices[i] < snapshot.variables.size();
+        values[i] = valid ? snapshot.variables[indices[i]].read(latest_values.data(), latest_values.size()) : NAN;
+    }
 }
 
-const std::atomic<float> &sc::iracing::speed_prev() {  // Definition of a function "speed_prev" in the sc::iracing namespace that returns a const reference to std::atomic<float>
-    return tele_speed_prev;  // Return tele_speed_prev
+const sc::iracing::telemetry_bus &sc::iracing::telemetry() {  // Definition of a function "telemetry" in the sc::iracing namespace that returns the frame bus
+    return bus;  // Return the bus
 }
 
-const std::atomic<int> &sc::iracing::gear() {  // Definition of a function "gear" in the sc::iracing namespace that returns a const reference to std::atomic<int>
-    return tele_gear;  // Return tele_gear
+std::optional<sc::iracing::frame> sc::iracing::latest() {  // Definition of a function "latest" in the sc::iracing namespace that returns the most recent frame
+    return bus.latest();  // Return the newest frame on the bus, if any
 }
 
-const std::atomic<int> &sc::iracing::gear_prev() {  // Definition of a function "gear_prev" in the sc::iracing namespace that returns a const reference to std::atomic<int>
-    return tele_gear_prev;  // Return tele_gear_prev
+void sc::iracing::replay(const frame &value) {  // Definition of a function "replay" in the sc::iracing namespace that publishes a recorded frame
+    bus.publish(value);  // The worker is stopped during replays, so this is the only producer
+    sc::boot::wakeup();  // Wake the main loop so the replayed frame is shown
 }
@@ -1,8 +1,14 @@
 #pragma once  // Ensures this header file is included only once during compilation
 
-#include <map>  // Include the header file for using std::map
 #include <atomic>  // Include the header file for using std::atomic
 #include <string>  // Include the header file for using std::string
+#include <memory>  // Include the header file for using std::shared_ptr
+#include <optional>  // Include the header file for using std::optional
+#include <vector>  // Include the header file for using std::vector
+
+#include "session.h"  // Include the header file for the parsed session-info snapshot
+#include "telemetry_bus.h"  // Include the header file for the per-tick frame bus
+#include "variables.h"  // Include the header file for the telemetry channel list
 
 namespace sc::iracing {  // Start of the sc::iracing namespace
 
@@ -18,16 +24,14 @@ namespace sc::iracing {  // Start of the sc::iracing namespace
 
     const status &get_status();  // Declaration of the function "get_status()" for retrieving the current connection status
 
-    std::map<std::string, int> variables();  // Declaration of the function "variables()" for retrieving various connection variables
+    std::shared_ptr<const session_info> session();  // Declaration of the function "session()" for retrieving the latest parsed session info, or nullptr if none was parsed yet
+
+    std::shared_ptr<const variable_snapshot> variables();  // Declaration of the function "variables()" for retrieving the telemetry channels; the snapshot is only replaced when iRacing's variable headers change, and is nullptr before the first connection
+    void read_values(const variable_snapshot &snapshot, const std::vector<size_t> &indices, std::vector<double> &values);  // Declaration of the function "read_values()" for reading the latest tick's values of the given variables; NaN while the tick belongs to another snapshot, and until the next tick after the first call in a while, as the values are only kept while something reads them
 
-    const std::atomic<bool> &prev();  // Declaration of the function "prev()" for retrieving the previous value
-    const std::atomic<float> &lap_percent();  // Declaration of the function "lap_percent()" for retrieving the lap percentage
-    const std::atomic<float> &rpm();  // Declaration of the function "rpm()" for retrieving the RPM value
-    const std::atomic<float> &rpm_prev();  // Declaration of the function "rpm_prev()" for retrieving the previous RPM value
-    const std::atomic<float> &speed();  // Declaration of the function "speed()" for retrieving the speed value
-    const std::atomic<float> &speed_prev();  // Declaration of the function "speed_prev()" for retrieving the previous speed value
-    const std::atomic<int> &gear();  // Declaration of the function "gear()" for retrieving the gear value
-    const std::atomic<int> &gear_prev();  // Declaration of the function "gear_prev()" for retrieving the previous gear value
+    const telemetry_bus &telemetry();  // Declaration of the function "telemetry()" for subscribing to the per-tick frame bus
+    std::optional<frame> latest();  // Declaration of the function "latest()" for retrieving the most recently published frame, or nothing if none was published yet
+    void replay(const frame &value);  // Declaration of the function "replay()" for publishing a recorded frame; only valid while the telemetry worker is stopped
 
 }  // End of the sc::iracing namespace
 
@@ -0,0 +1,138 @@
+#include "session.h"  // Include the header file "session.h"
+
+#include <mutex>  // Include the header file for using std::mutex
+#include <condition_variable>  // Include the header file for using std::condition_variable
+#include <thread>  // Include the header file for using std::thread
+#include <atomic>  // Include the header file for using std::atomic
+#include <optional>  // Include the header file for using std::optional
+#include <chrono>  // Include the header file for using std::chrono
+#include <utility>  // Include the header file for using std::pair
+
+#include <spdlog/spdlog.h>  // Include the header file for using spdlog
+#include <yaml-cpp/yaml.h>  // Include the header file for using yaml-cpp
+
+#include "../boot/wakeup.h"  // Include the header file for waking the main loop
+
+namespace sc::iracing::session_parser {  // Start of the sc::iracing::session_parser namespace
+
+    static std::thread worker;  // Thread that performs the parsing
+    static std::atomic_bool working = false;  // Keeps the parser thread alive
+
+    static std::mutex pending_mutex;  // Guards "pending"
+    static std::condition_variable pending_cv;  // Signalled whenever "pending" is filled or the parser is stopped
+    static std::optional<std::pair<int, std::string>> pending;  // Latest unparsed session string; newer submissions replace older ones
+
+    static std::shared_ptr<const session_info> published;  // Only accessed through std::atomic_load/std::atomic_store
+
+    static std::string latin1_to_utf8(const std::string &input) {  // iRacing writes names in Windows-1252, which yaml-cpp rejects as invalid UTF-8
+        std::string output;
+        output.reserve(input.size() + input.size() / 8);
+        for (const auto c : input) {
+            const auto byte = static_cast<unsigned char>(c);
+            if (byte < 0x80) output.push_back(c);  // ASCII passes through unchanged
+            else {
+                output.push_back(static_cast<char>(0xC0 | (byte >> 6)));  // Lead byte of the two byte sequence
+                output.push_back(static_cast<char>(0x80 | (byte & 0x3F)));  // Continuation byte
+            }
+        }
+        return output;
+    }
+
+    template<typename T> static T scalar(const YAML::Node &node, const char *key, const T &fallback) {  // Reads a scalar, tolerating missing or malformed keys
+        if (!node || !node.IsMap()) return fallback;
+        const auto child = node[key];
+        if (!child || !child.IsScalar()) return fallback;
+        try {
+            return child.as<T>();
+        } catch (const YAML::Exception &) {
+            return fallback;
+        }
+    }
+
+    static std::shared_ptr<const session_info> parse(int version, const std::string &yaml) {  // Converts the raw YAML into a session snapshot
+        const auto root = YAML::Load(latin1_to_utf8(yaml));
+        auto info = std::make_shared<session_info>();
+        info->version = version;
+        if (const auto weekend = root["WeekendInfo"]; weekend) {
+            info->track_id = scalar<int>(weekend, "TrackID", -1);
+            info->track_name = scalar<std::string>(weekend, "TrackName", "");
+            info->track_display_name = scalar<std::string>(weekend, "TrackDisplayName", "");
+            info->track_config_name = scalar<std::string>(weekend, "TrackConfigName", "");
+        }
+        if (const auto driver_info = root["DriverInfo"]; driver_info) {
+            info->driver_car_idx = scalar<int>(driver_info, "DriverCarIdx", -1);
+            if (const auto drivers = driver_info["Drivers"]; drivers && drivers.IsSequence()) {
+                info->drivers.reserve(drivers.size());
+                for (const auto &entry : drivers) {
+                    session_driver driver;
+                    driver.car_idx = scalar<int>(entry, "CarIdx", -1);
+                    driver.user_id = scalar<int>(entry, "UserID", -1);
+                    driver.car_id = scalar<int>(entry, "CarID", -1);
+                    driver.user_name = scalar<std::string>(entry, "UserName", "");
+                    driver.car_path = scalar<std::string>(entry, "CarPath", "");
+                    driver.car_screen_name = scalar<std::string>(entry, "CarScreenName", "");
+                    info->drivers.push_back(std::move(driver));
+                }
+            }
+        }
+        return info;
+    }
+
+    static void work() {  // Waits for submissions and publishes the parsed result
+        for (;;) {
+            std::pair<int, std::string> job;
+            {
+                std::unique_lock lock(pending_mutex);
+                pending_cv.wait(lock, []() { return !working || pending.has_value(); });
+                if (!working) return;
+                job = std::move(*pending);
+                pending.reset();
+            }
+            const auto start = std::chrono::high_resolution_clock::now();
+            try {
+                auto info = parse(job.first, job.second);
+                const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+                if (const auto player = info->player(); player) spdlog::info("iRacing session #{}: {} @ {} ({} bytes, {}us)", info->version, player->car_screen_name, info->track_display_name, job.second.size(), elapsed);
+                else spdlog::info("iRacing session #{}: {} ({} bytes, {}us)", info->version, info->track_display_name, job.second.size(), elapsed);
+                std::atomic_store(&published, std::shared_ptr<const session_info>(std::move(info)));  // Readers either see the old or the new snapshot, never a partial one
+                sc::boot::wakeup();  // Profile switching runs on the main loop
+            } catch (const YAML::Exception &exc) {
+                spdlog::warn("Unable to parse iRacing session info #{}: {}", job.first, exc.what());
+            }
+        }
+    }
+}  // End of the sc::iracing::session_parser namespace
+
+const sc::iracing::session_driver *sc::iracing::session_info::player() const {  // Finds the local driver's entry
+    for (const auto &driver : drivers) if (driver.car_idx == driver_car_idx) return &driver;
+    return nullptr;
+}
+
+void sc::iracing::session_parser::startup() {  // Starts the parser thread
+    shutdown();
+    working = true;
+    worker = std::thread(work);
+}
+
+void sc::iracing::session_parser::shutdown() {  // Stops the parser thread
+    {
+        std::lock_guard guard(pending_mutex);
+        working = false;
+        pending.reset();
+    }
+    pending_cv.notify_all();
+    if (worker.joinable()) worker.join();
+    std::atomic_store(&published, std::shared_ptr<const session_info>());
+}
+
+void sc::iracing::session_parser::submit(int version, std::string yaml) {  // Queues a session string for parsing
+    {
+        std::lock_guard guard(pending_mutex);
+        pending = std::make_pair(version, std::move(yaml));
+    }
+    pending_cv.notify_one();
+}
+
+std::shared_ptr<const sc::iracing::session_info> sc::iracing::session_parser::current() {  // Returns the latest snapshot
+    return std::atomic_load(&published);
+}
@@ -0,0 +1,42 @@
+#pragma once  // Ensures this header file is included only once during compilation
+
+#include <memory>  // Include the header file for using std::shared_ptr
+#include <string>  // Include the header file for using std::string
+#include <vector>  // Include the header file for using std::vector
+
+namespace sc::iracing {  // Start of the sc::iracing namespace
+
+    struct session_driver {  // A single entry of the "DriverInfo:Drivers" list
+
+        int car_idx = -1;  // Index of the car within the telemetry car arrays
+        int user_id = -1;  // iRacing customer ID of the driver
+        int car_id = -1;  // iRacing ID of the car model
+        std::string user_name;  // Display name of the driver
+        std::string car_path;  // Short, stable car identifier (e.g. "mx5 mx52016")
+        std::string car_screen_name;  // Human readable car name
+    };
+
+    struct session_info {  // Immutable snapshot of the parsed session-info YAML
+
+        int version = -1;  // Value of the header's session_info_update this snapshot was parsed from
+
+        int track_id = -1;  // iRacing ID of the track
+        std::string track_name;  // Short, stable track identifier
+        std::string track_display_name;  // Human readable track name
+        std::string track_config_name;  // Track layout name, may be empty
+
+        int driver_car_idx = -1;  // Car index of the local driver
+        std::vector<session_driver> drivers;  // Every driver in the session
+
+        const session_driver *player() const;  // The local driver's entry, or nullptr if not listed
+    };
+
+    namespace session_parser {  // Background YAML parser used by the telemetry worker
+
+        void startup();  // Starts the parser thread
+        void shutdown();  // Stops the parser thread and drops the published snapshot
+
+        void submit(int version, std::string yaml);  // Hands a copied session string to the parser, replacing any still pending one
+        std::shared_ptr<const session_info> current();  // Most recently published snapshot, or nullptr
+    }
+}  // End of the sc::iracing namespace
@@ -0,0 +1,121 @@
+#pragma once  // Ensures this header file is included only once during compilation
+
+#include <array>  // Include the header file for using std::array
+#include <atomic>  // Include the header file for using std::atomic
+#include <cstdint>  // Include the header file for using fixed width integers
+#include <cstring>  // Include the header file for using memcpy
+#include <optional>  // Include the header file for using std::optional
+#include <type_traits>  // Include the header file for using std::is_trivially_copyable_v
+
+namespace sc::iracing {  // Start of the sc::iracing namespace
+
+    // Single-producer/multi-consumer ring of fixed-layout values.
+    // Each slot is a sequence lock: the producer never waits on readers, readers never block the producer,
+    // and a reader that gets lapped notices it through the slot sequence and skips ahead, counting the drop.
+    template<typename T, size_t capacity> struct spmc_ring {
+
+        static_assert(std::is_trivially_copyable_v<T>, "Ring values are copied word by word.");
+        static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0, "Ring capacity must be a power of two.");
+
+        static constexpr size_t num_words = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);  // Value storage in 64-bit words
+
+        struct cursor {  // Per-consumer read position; consumers own one each and never share it
+
+            uint64_t next = 0;  // Sequence number of the next value to read
+            uint64_t dropped = 0;  // Total number of values this consumer missed because it was lapped
+        };
+
+        // Publishes a value. Only one thread may call this.
+        void publish(const T &value) {
+            const auto n = head.load(std::memory_order_relaxed);
+            auto &slot = slots[n & (capacity - 1)];
+            std::array<uint64_t, num_words> words { };
+            memcpy(words.data(), &value, sizeof(T));
+            slot.sequence.store((n * 2) + 1, std::memory_order_relaxed);  // Odd: being written
+            std::atomic_thread_fence(std::memory_order_release);
+            for (size_t i = 0; i < num_words; i++) slot.words[i].store(words[i], std::memory_order_relaxed);
+            slot.sequence.store((n * 2) + 2, std::memory_order_release);  // Even: value n is complete
+            head.store(n + 1, std::memory_order_release);
+        }
+
+        // Reads the next value for this consumer, or nothing if it is caught up.
+        std::optional<T> read(cursor &reader) const {
+            for (;;) {
+                const auto published = head.load(std::memory_order_acquire);
+                if (reader.next >= published) return std::nullopt;
+                if (published - reader.next > capacity) {  // Already overwritten; jump to the oldest value still in the ring
+                    reader.dropped += (published - capacity) - reader.next;
+                    reader.next = published - capacity;
+                }
+                if (const auto value = try_read(reader.next); value) {
+                    reader.next++;
+                    return value;
+                }
+                // The slot was overwritten while we copied it; re-evaluate against the new head.
+            }
+        }
+
+        // Reads the most recently published value without affecting any cursor.
+        std::optional<T> latest() const {
+            for (;;) {
+                const auto published = head.load(std::memory_order_acquire);
+                if (!published) return std::nullopt;
+                if (const auto value = try_read(published - 1); value) return value;
+            }
+        }
+
+        // Creates a cursor that starts at the next value to be published.
+        cursor subscribe() const {
+            return { head.load(std::memory_order_acquire), 0 };
+        }
+
+        // Number of values published so far.
+        uint64_t size() const {
+            return head.load(std::memory_order_acquire);
+        }
+
+    private:
+
+        struct alignas(64) slot {
+
+            std::atomic<uint64_t> sequence = 0;
+            std::array<std::atomic<uint64_t>, num_words> words { };
+        };
+
+        std::optional<T> try_read(const uint64_t &n) const {
+            const auto &slot = slots[n & (capacity - 1)];
+            const auto before = slot.sequence.load(std::memory_order_acquire);
+            if (before != (n * 2) + 2) return std::nullopt;
+            std::array<uint64_t, num_words> words;
+            for (size_t i = 0; i < num_words; i++) words[i] = slot.words[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != before) return std::nullopt;
+            T value;
+            memcpy(static_cast<void *>(&value), words.data(), sizeof(T));
+            return value;
+        }
+
+        std::array<slot, capacity> slots;
+        alignas(64) std::atomic<uint64_t> head = 0;
+    };
+
+    struct frame {  // Everything the telemetry worker extracted from one iRacing tick
+
+        int64_t tick = 0;  // iRacing tick_count of the variable buffer this frame was read from
+        int64_t timestamp_us = 0;  // Steady clock time of publication, in microseconds
+        int32_t session_version = -1;  // session_info_update at the time of this tick
+        int32_t gear = 0;  // Current gear, -1 reverse, 0 neutral
+        float lap_percent = 0;  // LapDistPct, 0 to 1
+        float speed = 0;  // Speed in mph
+        float rpm = 0;  // Engine RPM
+        float throttle = 0;  // Throttle as seen by the sim, 0 to 1
+        float brake = 0;  // Brake as seen by the sim, 0 to 1
+        float clutch = 0;  // Clutch as seen by the sim, 0 to 1
+        bool prev_valid = false;  // Whether the *_prev members hold data from the previous lap at this distance
+        int32_t gear_prev = 0;  // Gear at this lap distance on the previous lap
+        float speed_prev = 0;  // Speed at this lap distance on the previous lap
+        float rpm_prev = 0;  // RPM at this lap distance on the previous lap
+    };
+
+    using telemetry_bus = spmc_ring<frame, 1024>;  // About 17 seconds of history at iRacing's 60 Hz
+}  // End of the sc::iracing namespace
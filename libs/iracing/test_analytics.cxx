@@ -0,0 +1,144 @@
+#include "analytics.h"
+
+#include <cmath>
+#include <string>
+
+#include "../check.hpp"
+
+using namespace sc::iracing;
+using sc::test::check;
+
+static bool near(const float &a, const float &b, const float &tolerance = 1e-3f) {
+    return std::abs(a - b) <= tolerance;
+}
+
+// Feeds frames one iRacing tick apart
+struct driver {
+
+    trace_analytics &analytics;
+    int64_t tick = 0;
+
+    void drive(const float &lap_percent, const float &speed, const float &throttle, const float &brake) {
+        frame value;
+        value.tick = tick++;
+        value.lap_percent = lap_percent;
+        value.speed = speed;
+        value.throttle = throttle;
+        value.brake = brake;
+        analytics.push(value);
+    }
+
+    // A stretch of constant speed and pedals, from one distance to another
+    void cruise(const float &from, const float &to, const int &ticks, const float &speed, const float &throttle, const float &brake) {
+        for (int i = 0; i < ticks; i++) drive(from + (to - from) * i / ticks, speed, throttle, brake);
+    }
+};
+
+static std::string name_of(const segment &value) {
+    return value.name.data();
+}
+
+static void test_segments() {
+    trace_analytics analytics;
+    std::vector<segment> table(3);
+    table[0] = { .6f, .7f, { 'T', '3' } };
+    table[1] = { .1f, .2f, { 'T', '1' } };
+    table[2] = { .3f, .5f, { 'T', '2' } };
+    analytics.set_segments(table);
+    check(analytics.num_segments == 3 && name_of(analytics.segments[0]) == "T1" && name_of(analytics.segments[2]) == "T3", "segments are ordered by start");
+
+    driver car { analytics };
+    car.cruise(0, .99f, 990, 100, 1, 0);
+    const auto lap = analytics.lap(0);
+    check(lap && lap->corners[0].visited && lap->corners[1].visited && lap->corners[2].visited, "every segment on the way is visited");
+    check(lap && near(lap->corners[0].entry_speed, 100), "a segment records its entry speed");
+
+    // Driving backwards a little, as after an off, and jumping far ahead, as after a tow, find the right segments
+    trace_analytics jumps;
+    jumps.set_segments(table);
+    driver towed { jumps };
+    towed.drive(.65f, 50, 0, 0);
+    towed.drive(.15f, 40, 0, 0);
+    towed.drive(.66f, 30, 0, 0);
+    const auto jumped = jumps.lap(0);
+    check(jumped && jumped->corners[0].visited && jumped->corners[2].visited && !jumped->corners[1].visited, "a jump across segments lands in the right one");
+    check(jumped && near(jumped->corners[2].min_speed, 30), "returning to a segment keeps its metrics");
+
+    trace_analytics many;
+    many.set_uniform_segments(100);
+    check(many.num_segments == trace_analytics::max_segments, "the segment table is capped");
+    check(near(many.segments[many.num_segments - 1].end, 1), "uniform segments cover the whole lap");
+}
+
+static void test_laps() {
+    trace_analytics analytics;
+    analytics.set_uniform_segments(4);
+    driver car { analytics };
+    check(!analytics.lap(0), "there is no lap before the first frame");
+
+    car.cruise(0, 1, 600, 100, 1, 0);
+    car.drive(0, 100, 1, 0);  // Across the line
+    const auto previous = analytics.lap(1), current = analytics.lap(0);
+    check(previous && previous->complete && previous->number == 0, "crossing the line completes the lap");
+    check(previous && near(previous->lap_time, 600 / 60.f, .05f), "a lap's time counts the ticks driven");
+    check(current && !current->complete && current->number == 1, "crossing the line starts the next lap");
+
+    // A pause in the ticks, as when the sim is paused, doesn't count as driving time
+    car.drive(.01f, 100, 1, 0);
+    car.tick += 600;
+    car.drive(.02f, 100, 1, 0);
+    check(analytics.lap(0) && analytics.lap(0)->lap_time < .1f, "a pause doesn't count as lap time");
+
+    // The ring keeps a fixed number of laps, dropping the oldest
+    for (size_t i = 0; i < trace_analytics::max_laps * 2; i++) {
+        car.cruise(.05f, 1, 60, 100, 1, 0);
+        car.drive(0, 100, 1, 0);
+    }
+    const auto laps = 2 + static_cast<int64_t>(trace_analytics::max_laps) * 2;
+    check(analytics.num_laps == laps && analytics.lap(0) && analytics.lap(0)->number == laps - 1, "laps are numbered in order");
+    check(analytics.lap(trace_analytics::max_laps - 1) && !analytics.lap(trace_analytics::max_laps), "only the newest laps are kept");
+    check(analytics.lap(trace_analytics::max_laps - 1)->number == laps - static_cast<int64_t>(trace_analytics::max_laps), "the oldest lap kept is the right one");
+
+    analytics.set_uniform_segments(2);
+    check(!analytics.lap(0), "a new segment table drops the laps");
+}
+
+static void test_braking() {
+    trace_analytics analytics;
+    analytics.set_segments({ { 0, .5f, { 'T', '1' } } });
+    driver car { analytics };
+
+    car.cruise(0, .05f, 30, 120, 1, 0);  // Flat out
+    car.cruise(.05f, .06f, 6, 120, 1, .5f);  // Onto the brake while still on the throttle
+    car.cruise(.06f, .1f, 24, 100, 0, .5f);
+    car.cruise(.1f, .12f, 12, 90, 0, .9f);  // Peak
+    for (int i = 1; i <= 30; i++) car.drive(.12f + i * .001f, 80, 0, .9f * (1 - i / 30.f));  // Trail off over half a second
+    car.cruise(.15f, .2f, 30, 60, 0, 0);  // Coasting
+    car.cruise(.2f, .4f, 60, 70, 1, 0);
+
+    const auto &corner = analytics.lap(0)->corners[0];
+    check(corner.braked && near(corner.peak_brake, .9f), "the peak brake is the highest brake value");
+    check(near(corner.time_to_peak, 30 / 60.f, .02f), "the time to peak runs from onset to peak");
+    check(near(corner.overlap, 6 / 60.f, .02f), "throttle and brake together count as overlap");
+    check(near(corner.coasting, 30 / 60.f, .04f), "neither pedal counts as coasting");
+    check(near(corner.release_slope, (.9f - .03f) / (41 / 60.f), .05f), "the release slope is the brake given up per second, from first reaching the peak");
+    check(near(corner.entry_speed, 120) && near(corner.min_speed, 60), "a corner keeps its entry and minimum speed");
+
+    // Pedals given alongside the frame replace the sim's, as the visor does with its own pedal output
+    trace_analytics own;
+    own.set_segments({ { 0, .5f, { 'T', '1' } } });
+    frame value;
+    for (int i = 0; i < 10; i++) {
+        value.tick = i;
+        value.lap_percent = i * .01f;
+        own.push(value, 0, i < 5 ? .3f : .7f);
+    }
+    check(own.lap(0)->corners[0].braked && near(own.lap(0)->corners[0].peak_brake, .7f), "given pedals are used over the frame's");
+}
+
+int main() {
+    test_segments();
+    test_laps();
+    test_braking();
+    return sc::test::finish("analytics");
+}
@@ -0,0 +1,85 @@
+#include "variables.h"  // Include the header file "variables.h"
+
+#include <algorithm>  // Include the header file for using std::sort
+#include <atomic>  // Include the header file for using std::atomic
+#include <cctype>  // Include the header file for using std::tolower
+#include <cmath>  // Include the header file for using NAN
+#include <cstring>  // Include the header file for using memcpy
+
+size_t sc::iracing::variable_info::size() const {  // Returns the size of one element in bytes
+    switch (type) {
+        case variable_type::character:
+        case variable_type::boolean:
+            return 1;
+        case variable_type::float64:
+            return 8;
+        default:
+            return 4;
+    }
+}
+
+double sc::iracing::variable_info::read(const std::byte *buffer, const size_t &length) const {  // Reads the first element, copying it out since the buffer has no alignment guarantees
+    if (offset < 0 || static_cast<size_t>(offset) + size() > length) return NAN;
+    const auto at = buffer + offset;
+    switch (type) {
+        case variable_type::character: {
+            char value;
+            memcpy(&value, at, sizeof(value));
+            return value;
+        }
+        case variable_type::boolean: {
+            bool value;
+            memcpy(&value, at, sizeof(value));
+            return value ? 1 : 0;
+        }
+        case variable_type::integer: {
+            int32_t value;
+            memcpy(&value, at, sizeof(value));
+            return value;
+        }
+        case variable_type::bit_field: {
+            uint32_t value;
+            memcpy(&value, at, sizeof(value));
+            return value;
+        }
+        case variable_type::float32: {
+            float value;
+            memcpy(&value, at, sizeof(value));
+            return value;
+        }
+        case variable_type::float64: {
+            double value;
+            memcpy(&value, at, sizeof(value));
+            return value;
+        }
+    }
+    return NAN;
+}
+
+std::shared_ptr<const sc::iracing::variable_snapshot> sc::iracing::variable_snapshot::create(std::vector<variable_info> variables) {  // Builds a snapshot with the next version
+    static std::atomic<uint64_t> last_version = 0;
+    auto res = std::make_shared<variable_snapshot>();
+    res->version = ++last_version;
+    res->variables = std::move(variables);
+    std::sort(res->variables.begin(), res->variables.end(), [](const variable_info &first, const variable_info &second) {
+        return first.name < second.name;
+    });
+    res->keys.reserve(res->variables.size());
+    for (const auto &variable : res->variables) {
+        auto key = variable.name + " " + variable.description + " " + variable.unit;
+        std::transform(key.begin(), key.end(), key.begin(), [](const char &c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+        res->keys.push_back(std::move(key));
+    }
+    return res;
+}
+
+void sc::iracing::variable_snapshot::search(const std::string_view &query, std::vector<size_t> &matches, const bool &refine) const {  // Filters in place, so typing one more character only rescans the previous matches
+    if (!refine) {
+        matches.resize(variables.size());
+        for (size_t i = 0; i < matches.size(); i++) matches[i] = i;
+    }
+    if (query.empty()) return;
+    matches.erase(std::remove_if(matches.begin(), matches.end(), [&](const size_t &i) {
+        return i >= keys.size() || std::string_view(keys[i]).find(query) == std::string_view::npos;
+    }), matches.end());
+}
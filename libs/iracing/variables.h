@@ -0,0 +1,46 @@
+#pragma once  // Ensures this header file is included only once during compilation
+
+#include <cstddef>  // Include the header file for using std::byte
+#include <cstdint>  // Include the header file for using fixed width integers
+#include <memory>  // Include the header file for using std::shared_ptr
+#include <string>  // Include the header file for using std::string
+#include <string_view>  // Include the header file for using std::string_view
+#include <vector>  // Include the header file for using std::vector
+
+namespace sc::iracing {  // Start of the sc::iracing namespace
+
+    enum class variable_type : int32_t {  // Value types of the iRacing SDK (irsdk_VarType)
+        character = 0,  // 1 byte character
+        boolean = 1,  // 1 byte boolean
+        integer = 2,  // 4 byte signed integer
+        bit_field = 3,  // 4 byte bit mask
+        float32 = 4,  // 4 byte float
+        float64 = 5  // 8 byte double
+    };
+
+    struct variable_info {  // A telemetry channel as described by its variable header
+
+        std::string name;  // Channel name, e.g. "Throttle"
+        std::string description;  // Human readable description
+        std::string unit;  // Unit of the values, may be empty
+        variable_type type = variable_type::float32;  // Type of each element
+        int32_t offset = 0;  // Byte offset of the first element within a variable buffer
+        int32_t count = 1;  // Number of elements; more than one for per-car arrays
+
+        size_t size() const;  // Size of one element in bytes
+        double read(const std::byte *buffer, const size_t &length) const;  // The first element within a variable buffer of "length" bytes, or NaN if it lies outside
+    };
+
+    struct variable_snapshot {  // Immutable list of the channels; replaced as a whole when iRacing's variable headers change
+
+        uint64_t version = 0;  // Increases with every new snapshot, so consumers can tell whether anything changed
+        std::vector<variable_info> variables;  // Sorted by name
+        std::vector<std::string> keys;  // Lower-case "name description unit" of each variable, prebuilt for search()
+
+        static std::shared_ptr<const variable_snapshot> create(std::vector<variable_info> variables);  // Sorts the variables and builds the search keys
+
+        // Narrows "matches" (indices into "variables") to the variables whose key contains "query", which must be lower-case.
+        // With "refine", only the current matches are tested; that is valid when "query" contains the query they were found with.
+        void search(const std::string_view &query, std::vector<size_t> &matches, const bool &refine) const;
+    };
+}  // End of the sc::iracing namespace
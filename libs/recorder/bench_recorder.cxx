@@ -0,0 +1,97 @@
+#include "recorder.h"
+
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#include <spdlog/spdlog.h>
+
+static constexpr size_t num_samples = 500'000;
+
+static sc::recorder::sample synthesize(const size_t &i) {  // Deterministic mix of telemetry rows and pedal rows, as the writer would merge them
+    sc::recorder::sample value;
+    value.timestamp_us = 1'000'000 + static_cast<int64_t>(i) * 3'333;
+    value.source = (i % 4 == 0) ? sc::recorder::source::telemetry : sc::recorder::source::pedals_mk4;
+    const auto t = static_cast<float>(i - (i % 4));  // Telemetry columns only change on telemetry rows
+    value.tick = static_cast<int64_t>(i / 4);
+    value.gear = 1 + static_cast<int64_t>((i / 2000) % 6);
+    value.lap_percent = std::fmod(t, 30'000.f) / 30'000.f;
+    value.speed = 80.f + 40.f * std::sin(t * 0.001f);
+    value.rpm = 4000.f + 2500.f * std::sin(t * 0.003f);
+    value.throttle = (i / 5000) % 2 ? 1.f : 0.f;
+    if (!i) return value;
+    const auto p = static_cast<float>(i % 4 ? i : i - 1);  // Pedal columns only change on pedal rows
+    for (size_t j = 0; j < value.input.size(); j++) {
+        value.input[j] = std::round(std::fabs(std::sin((p + j * 97) * 0.002f)) * 1000.f) / 1000.f;
+        value.output[j] = value.input[j] * value.input[j];
+    }
+    return value;
+}
+
+static bool same(const sc::recorder::sample &first, const sc::recorder::sample &second) {
+    return first.timestamp_us == second.timestamp_us && first.source == second.source && first.tick == second.tick && first.gear == second.gear &&
+        first.lap_percent == second.lap_percent && first.speed == second.speed && first.rpm == second.rpm &&
+        first.throttle == second.throttle && first.brake == second.brake && first.clutch == second.clutch &&
+        first.input == second.input && first.output == second.output;
+}
+
+int main() {
+    const auto path = std::filesystem::temp_directory_path() / "bench_recorder.screc";
+    if (const auto err = sc::recorder::start(path); err) {
+        spdlog::error(*err);
+        return 1;
+    }
+    uint64_t retries = 0;
+    const auto push_start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < num_samples; i++) {
+        const auto value = synthesize(i);
+        while (!sc::recorder::push(value)) {  // The bench wants every sample; real producers simply drop
+            retries++;
+            std::this_thread::yield();
+        }
+    }
+    const auto push_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - push_start).count();
+    sc::recorder::stop();
+    const auto file_size = std::filesystem::file_size(path);
+    spdlog::info("push: {:.1f} ns per sample ({} retries on a full queue)", static_cast<double>(push_ns) / num_samples, retries);
+    spdlog::info("size: {} bytes, {:.2f} bytes per sample vs {} raw ({:.1f}x)", file_size, static_cast<double>(file_size) / num_samples, sizeof(sc::recorder::sample), static_cast<double>(sizeof(sc::recorder::sample) * num_samples) / file_size);
+
+    auto opened = sc::recorder::reader::open(path);
+    if (!opened.has_value()) {
+        spdlog::error(opened.error());
+        return 1;
+    }
+    auto source = *opened;
+    size_t num_read = 0, mismatches = 0;
+    const auto read_start = std::chrono::high_resolution_clock::now();
+    for (;;) {
+        const auto next = source->next();
+        if (!next.has_value()) {
+            spdlog::error(next.error());
+            return 1;
+        }
+        if (!next->has_value()) break;
+        if (!same(**next, synthesize(num_read))) mismatches++;
+        num_read++;
+    }
+    const auto read_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - read_start).count();
+    spdlog::info("decode: {:.1f} ns per sample, {} chunks, {} samples, {} mismatches", static_cast<double>(read_ns) / num_read, source->chunks.size(), num_read, mismatches);
+
+    const auto seek_to = synthesize(num_samples / 2).timestamp_us;
+    const auto seek_start = std::chrono::high_resolution_clock::now();
+    if (const auto err = source->seek(seek_to); err) spdlog::error(*err);
+    const auto seeked = source->next();
+    const auto seek_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - seek_start).count();
+    spdlog::info("seek: {} us, landed on the expected sample: {}", seek_us, seeked.has_value() && seeked->has_value() && same(**seeked, synthesize(num_samples / 2)));
+
+    std::atomic<size_t> num_played = 0;  // Replay as fast as possible; the callback is where a pipeline under test would sit
+    const auto play_start = std::chrono::high_resolution_clock::now();
+    sc::recorder::player::start(path, [&](const sc::recorder::sample &) { num_played++; }, 0.f);
+    while (sc::recorder::player::playing()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    sc::recorder::player::stop();
+    const auto play_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - play_start).count();
+    spdlog::info("replay: {} samples, {:.1f} ns per sample", num_played.load(), static_cast<double>(play_ns) / num_played.load());
+
+    std::filesystem::remove(path);
+    return (mismatches || num_read != num_samples) ? 1 : 0;
+}
@@ -0,0 +1,163 @@
+#include "codec.h"
+
+#include <cstring>
+
+namespace sc::recorder::codec {
+
+    static uint64_t zigzag(const int64_t &value) {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    static int64_t unzigzag(const uint64_t &value) {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    static int leading_zeros(uint32_t value) {
+        int n = 0;
+        for (uint32_t bit = 0x80000000u; bit && !(value & bit); bit >>= 1) n++;
+        return n;
+    }
+
+    static int trailing_zeros(uint32_t value) {
+        int n = 0;
+        for (uint32_t bit = 1; bit && !(value & bit); bit <<= 1) n++;
+        return n;
+    }
+
+    struct bit_writer {
+
+        std::vector<uint8_t> &out;
+        uint64_t pending = 0;
+        int num_pending = 0;
+
+        void put(const uint32_t &value, const int &num_bits) {  // Appends the lowest num_bits of value, most significant first
+            if (!num_bits) return;
+            pending = (pending << num_bits) | (num_bits == 32 ? value : (value & ((1u << num_bits) - 1)));
+            num_pending += num_bits;
+            while (num_pending >= 8) {
+                num_pending -= 8;
+                out.push_back(static_cast<uint8_t>(pending >> num_pending));
+            }
+        }
+
+        void flush() {
+            if (num_pending) out.push_back(static_cast<uint8_t>(pending << (8 - num_pending)));
+            num_pending = 0;
+        }
+    };
+
+    struct bit_reader {
+
+        const uint8_t *data;
+        size_t size;
+        size_t bit_i = 0;
+
+        bool get(const int &num_bits, uint32_t &value) {
+            if (bit_i + num_bits > size * 8) return false;
+            value = 0;
+            for (int i = 0; i < num_bits; i++, bit_i++) value = (value << 1) | ((data[bit_i / 8] >> (7 - (bit_i % 8))) & 1);
+            return true;
+        }
+    };
+}
+
+void sc::recorder::codec::put_varint(std::vector<uint8_t> &out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+bool sc::recorder::codec::get_varint(const uint8_t *&data, const uint8_t *const end, uint64_t &value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && data < end; shift += 7) {
+        const auto byte = *data++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+void sc::recorder::codec::encode_ints(const std::vector<int64_t> &values, std::vector<uint8_t> &out) {
+    int64_t previous = 0;
+    for (const auto &value : values) {
+        put_varint(out, zigzag(value - previous));
+        previous = value;
+    }
+}
+
+bool sc::recorder::codec::decode_ints(const uint8_t *data, const size_t &size, const size_t &count, std::vector<int64_t> &values) {
+    const auto end = data + size;
+    values.resize(count);
+    int64_t previous = 0;
+    for (auto &value : values) {
+        uint64_t encoded;
+        if (!get_varint(data, end, encoded)) return false;
+        value = previous + unzigzag(encoded);
+        previous = value;
+    }
+    return true;
+}
+
+void sc::recorder::codec::encode_floats(const std::vector<float> &values, std::vector<uint8_t> &out) {
+    bit_writer writer { out };
+    uint32_t previous = 0;
+    int window_leading = -1, window_trailing = 0;
+    for (size_t i = 0; i < values.size(); i++) {
+        uint32_t bits;
+        memcpy(&bits, &values[i], sizeof(bits));
+        if (!i) writer.put(bits, 32);  // The first value is stored verbatim
+        else if (const auto delta = bits ^ previous; !delta) writer.put(0, 1);  // Unchanged
+        else {
+            writer.put(1, 1);
+            const auto leading = leading_zeros(delta), trailing = trailing_zeros(delta);
+            if (window_leading >= 0 && leading >= window_leading && trailing >= window_trailing) {  // Fits the previous meaningful-bit window
+                writer.put(0, 1);
+                writer.put(delta >> window_trailing, 32 - window_leading - window_trailing);
+            } else {
+                const auto meaningful = 32 - leading - trailing;
+                writer.put(1, 1);
+                writer.put(static_cast<uint32_t>(leading), 5);
+                writer.put(static_cast<uint32_t>(meaningful - 1), 5);
+                writer.put(delta >> trailing, meaningful);
+                window_leading = leading;
+                window_trailing = trailing;
+            }
+        }
+        previous = bits;
+    }
+    writer.flush();
+}
+
+bool sc::recorder::codec::decode_floats(const uint8_t *data, const size_t &size, const size_t &count, std::vector<float> &values) {
+    bit_reader reader { data, size };
+    values.resize(count);
+    uint32_t previous = 0;
+    int window_leading = 0, window_trailing = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t bits = 0, flag = 0;
+        if (!i) {
+            if (!reader.get(32, bits)) return false;
+        } else {
+            if (!reader.get(1, flag)) return false;
+            if (!flag) bits = previous;
+            else {
+                if (!reader.get(1, flag)) return false;
+                if (flag) {
+                    uint32_t leading, meaningful;
+                    if (!reader.get(5, leading) || !reader.get(5, meaningful)) return false;
+                    window_leading = static_cast<int>(leading);
+                    window_trailing = 32 - window_leading - static_cast<int>(meaningful + 1);
+                    if (window_trailing < 0) return false;
+                }
+                uint32_t delta;
+                if (!reader.get(32 - window_leading - window_trailing, delta)) return false;
+                bits = previous ^ (delta << window_trailing);
+            }
+        }
+        memcpy(&values[i], &bits, sizeof(bits));
+        previous = bits;
+    }
+    return true;
+}
@@ -0,0 +1,21 @@
+#pragma once  // Ensures this header file is included only once during compilation
+
+#include <cstdint>  // Include the header file for using fixed width integers
+#include <cstddef>  // Include the header file for using size_t
+#include <vector>  // Include the header file for using std::vector
+
+namespace sc::recorder::codec {  // Column encoders used by the recording format
+
+    // Integer columns: each value is stored as the zigzag encoded difference to its predecessor, as a LEB128 varint.
+    // Slowly changing channels (ticks, timestamps, gear) shrink to one byte per row or less.
+    void encode_ints(const std::vector<int64_t> &values, std::vector<uint8_t> &out);
+    bool decode_ints(const uint8_t *data, const size_t &size, const size_t &count, std::vector<int64_t> &values);
+
+    // Float columns: Gorilla-style XOR compression against the previous value.
+    // A repeated value costs one bit; a changing one only costs its meaningful XOR bits.
+    void encode_floats(const std::vector<float> &values, std::vector<uint8_t> &out);
+    bool decode_floats(const uint8_t *data, const size_t &size, const size_t &count, std::vector<float> &values);
+
+    void put_varint(std::vector<uint8_t> &out, uint64_t value);
+    bool get_varint(const uint8_t *&data, const uint8_t *const end, uint64_t &value);
+}
@@ -0,0 +1,76 @@
+#include "format.h"
+
+#include "codec.h"
+
+namespace sc::recorder::format {
+
+    template<typename row_t> static auto &int_column(row_t &row, const size_t &column_i) {
+        switch (column_i) {
+            case 0: return row.timestamp_us;
+            case 1: return row.source;
+            case 2: return row.tick;
+            default: return row.gear;
+        }
+    }
+
+    template<typename row_t> static auto &float_column(row_t &row, const size_t &column_i) {
+        switch (column_i) {
+            case 0: return row.lap_percent;
+            case 1: return row.speed;
+            case 2: return row.rpm;
+            case 3: return row.throttle;
+            case 4: return row.brake;
+            case 5: return row.clutch;
+            default: return column_i < 10 ? row.input[column_i - 6] : row.output[column_i - 10];
+        }
+    }
+}
+
+std::vector<uint8_t> sc::recorder::format::encode(const std::vector<sample> &rows) {
+    std::vector<uint8_t> payload, column;
+    std::vector<int64_t> ints(rows.size());
+    for (size_t column_i = 0; column_i < num_int_columns; column_i++) {
+        for (size_t row_i = 0; row_i < rows.size(); row_i++) ints[row_i] = int_column(rows[row_i], column_i);
+        column.clear();
+        codec::encode_ints(ints, column);
+        codec::put_varint(payload, column.size());
+        payload.insert(payload.end(), column.begin(), column.end());
+    }
+    std::vector<float> floats(rows.size());
+    for (size_t column_i = 0; column_i < num_float_columns; column_i++) {
+        for (size_t row_i = 0; row_i < rows.size(); row_i++) floats[row_i] = float_column(rows[row_i], column_i);
+        column.clear();
+        codec::encode_floats(floats, column);
+        codec::put_varint(payload, column.size());
+        payload.insert(payload.end(), column.begin(), column.end());
+    }
+    return payload;
+}
+
+bool sc::recorder::format::decode(const uint8_t *data, const size_t &size, const uint32_t &num_rows, std::vector<sample> &rows) {
+    const auto end = data + size;
+    rows.assign(num_rows, sample { });
+    const auto next_column = [&](const uint8_t *&column, size_t &column_size) {
+        uint64_t length;
+        if (!codec::get_varint(data, end, length) || length > static_cast<uint64_t>(end - data)) return false;
+        column = data;
+        column_size = static_cast<size_t>(length);
+        data += length;
+        return true;
+    };
+    std::vector<int64_t> ints;
+    for (size_t column_i = 0; column_i < num_int_columns; column_i++) {
+        const uint8_t *column;
+        size_t column_size;
+        if (!next_column(column, column_size) || !codec::decode_ints(column, column_size, num_rows, ints)) return false;
+        for (size_t row_i = 0; row_i < num_rows; row_i++) int_column(rows[row_i], column_i) = ints[row_i];
+    }
+    std::vector<float> floats;
+    for (size_t column_i = 0; column_i < num_float_columns; column_i++) {
+        const uint8_t *column;
+        size_t column_size;
+        if (!next_column(column, column_size) || !codec::decode_floats(column, column_size, num_rows, floats)) return false;
+        for (size_t row_i = 0; row_i < num_rows; row_i++) float_column(rows[row_i], column_i) = floats[row_i];
+    }
+    return true;
+}
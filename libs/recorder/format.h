@@ -0,0 +1,52 @@
+#pragma once  // Ensures this header file is included only once during compilation
+
+#include <array>  // Include the header file for using std::array
+#include <cstdint>  // Include the header file for using fixed width integers
+#include <vector>  // Include the header file for using std::vector
+
+#include "recorder.h"  // Include the header file for the sample layout
+
+namespace sc::recorder::format {  // On-disk layout shared by the writer and the reader
+
+    // A recording is the file magic, followed by chunks, followed by the chunk index and a trailer.
+    // Every chunk stores its rows column by column, so a reader can seek to any chunk through the index,
+    // and an interrupted recording without an index can still be read by walking the chunk headers.
+
+    constexpr std::array<char, 8> file_magic = { 'S', 'C', 'R', 'E', 'C', '0', '0', '1' };
+    constexpr std::array<char, 8> index_magic = { 'S', 'C', 'I', 'D', 'X', '0', '0', '1' };
+    constexpr uint32_t chunk_marker = 0x4B4E4843;  // "CHNK"
+
+    constexpr size_t rows_per_chunk = 4096;  // Upper bound of a chunk, which is also the writer's memory bound
+    constexpr int64_t chunk_duration_us = 5'000'000;  // Chunks are closed after this long so an interrupted recording loses little
+
+    constexpr size_t num_int_columns = 4;  // timestamp_us, source, tick, gear
+    constexpr size_t num_float_columns = 14;  // lap_percent, speed, rpm, throttle, brake, clutch, input[4], output[4]
+
+    struct chunk_header {
+
+        uint32_t marker = chunk_marker;
+        uint32_t num_rows = 0;
+        uint32_t payload_size = 0;
+        uint32_t _padding_1 = 0;
+        int64_t first_us = 0, last_us = 0;
+    };
+
+    struct index_entry {
+
+        uint64_t offset = 0;
+        uint32_t num_rows = 0;
+        uint32_t _padding_1 = 0;
+        int64_t first_us = 0, last_us = 0;
+    };
+
+    struct trailer {
+
+        uint64_t index_offset = 0;
+        uint32_t num_entries = 0;
+        uint32_t _padding_1 = 0;
+        std::array<char, 8> magic = index_magic;
+    };
+
+    std::vector<uint8_t> encode(const std::vector<sample> &rows);  // Encodes a chunk payload
+    bool decode(const uint8_t *data, const size_t &size, const uint32_t &num_rows, std::vector<sample> &rows);  // Decodes a chunk payload
+}
@@ -0,0 +1,122 @@
+#include "recorder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <spdlog/spdlog.h>
+
+#include "format.h"
+
+namespace sc::recorder {
+
+    static std::optional<std::string> load_chunk(reader &target, const size_t &chunk_i) {
+        const auto &info = target.chunks[chunk_i];
+        format::chunk_header header;
+        target.file.clear();
+        target.file.seekg(static_cast<std::streamoff>(info.offset));
+        if (!target.file.read(reinterpret_cast<char *>(&header), sizeof(header)) || header.marker != format::chunk_marker) return fmt::format("Chunk #{} has no valid header.", chunk_i);
+        std::vector<uint8_t> payload(header.payload_size);
+        if (!target.file.read(reinterpret_cast<char *>(payload.data()), static_cast<std::streamsize>(payload.size()))) return fmt::format("Chunk #{} is truncated.", chunk_i);
+        if (!format::decode(payload.data(), payload.size(), header.num_rows, target.rows)) return fmt::format("Chunk #{} is corrupted.", chunk_i);
+        target.row_i = 0;
+        return std::nullopt;
+    }
+
+    static std::thread player_worker;  // Plays samples to the callback
+    static std::atomic_bool player_working = false;  // Cleared to stop playback, and by the thread once done
+}
+
+tl::expected<std::shared_ptr<sc::recorder::reader>, std::string> sc::recorder::reader::open(const std::filesystem::path &path) {
+    auto target = std::make_shared<reader>();
+    target->file.open(path, std::ios::binary);
+    if (!target->file) return tl::make_unexpected(fmt::format("Unable to open recording \"{}\".", path.string()));
+    std::array<char, 8> magic;
+    if (!target->file.read(magic.data(), magic.size()) || magic != format::file_magic) return tl::make_unexpected(fmt::format("\"{}\" is not a recording.", path.string()));
+    target->file.seekg(0, std::ios::end);
+    const auto file_size = static_cast<uint64_t>(target->file.tellg());
+    format::trailer trailer;
+    if (file_size >= magic.size() + sizeof(trailer)) {
+        target->file.seekg(static_cast<std::streamoff>(file_size - sizeof(trailer)));
+        target->file.read(reinterpret_cast<char *>(&trailer), sizeof(trailer));
+    }
+    if (target->file && trailer.magic == format::index_magic && trailer.index_offset + trailer.num_entries * sizeof(format::index_entry) + sizeof(trailer) == file_size) {
+        std::vector<format::index_entry> index(trailer.num_entries);
+        target->file.seekg(static_cast<std::streamoff>(trailer.index_offset));
+        target->file.read(reinterpret_cast<char *>(index.data()), static_cast<std::streamsize>(index.size() * sizeof(format::index_entry)));
+        for (const auto &entry : index) target->chunks.push_back({ entry.offset, entry.num_rows, entry.first_us, entry.last_us });
+    } else {  // No index; the recording was interrupted, so walk the chunk headers instead
+        spdlog::warn("Recording \"{}\" has no index, scanning chunks.", path.string());
+        target->file.clear();
+        uint64_t offset = magic.size();
+        for (format::chunk_header header; offset + sizeof(header) <= file_size; offset += sizeof(header) + header.payload_size) {
+            target->file.seekg(static_cast<std::streamoff>(offset));
+            if (!target->file.read(reinterpret_cast<char *>(&header), sizeof(header)) || header.marker != format::chunk_marker) break;
+            if (offset + sizeof(header) + header.payload_size > file_size) break;
+            target->chunks.push_back({ offset, header.num_rows, header.first_us, header.last_us });
+        }
+    }
+    return target;
+}
+
+std::optional<std::string> sc::recorder::reader::seek(const int64_t &timestamp_us) {
+    const auto chunk = std::find_if(chunks.begin(), chunks.end(), [&](const chunk_info &info) { return info.last_us >= timestamp_us; });
+    rows.clear();
+    row_i = 0;
+    chunk_i = static_cast<size_t>(chunk - chunks.begin());
+    if (chunk == chunks.end()) return std::nullopt;
+    if (const auto err = load_chunk(*this, chunk_i); err) return err;
+    chunk_i++;
+    while (row_i < rows.size() && rows[row_i].timestamp_us < timestamp_us) row_i++;
+    return std::nullopt;
+}
+
+tl::expected<std::optional<sc::recorder::sample>, std::string> sc::recorder::reader::next() {
+    while (row_i >= rows.size()) {
+        if (chunk_i >= chunks.size()) return std::nullopt;
+        if (const auto err = load_chunk(*this, chunk_i); err) return tl::make_unexpected(*err);
+        chunk_i++;
+    }
+    return rows[row_i++];
+}
+
+std::optional<std::string> sc::recorder::player::start(const std::filesystem::path &path, std::function<void(const sample &)> on_sample, const float &speed, const int64_t &from_us, std::function<void()> on_end) {
+    stop();
+    auto opened = reader::open(path);
+    if (!opened.has_value()) return opened.error();
+    auto source = *opened;
+    if (const auto err = source->seek(from_us); err) return err;
+    player_working = true;
+    player_worker = std::thread([source, on_sample, speed, on_end]() {
+        std::optional<int64_t> first_us;
+        const auto started = std::chrono::steady_clock::now();
+        while (player_working) {
+            const auto next = source->next();
+            if (!next.has_value()) {
+                spdlog::error("Replay stopped: {}", next.error());
+                break;
+            }
+            if (!next->has_value()) break;
+            const auto &value = **next;
+            if (!first_us) first_us = value.timestamp_us;
+            if (speed > 0) {  // Sleep in short steps so "stop" stays responsive across long gaps
+                const auto due = started + std::chrono::microseconds(static_cast<int64_t>((value.timestamp_us - *first_us) / speed));
+                while (player_working && std::chrono::steady_clock::now() < due) std::this_thread::sleep_until(std::min(due, std::chrono::steady_clock::now() + std::chrono::milliseconds(50)));
+                if (!player_working) break;
+            }
+            on_sample(value);
+        }
+        if (player_working.exchange(false) && on_end) on_end();  // Ran out rather than being stopped
+    });
+    return std::nullopt;
+}
+
+void sc::recorder::player::stop() {
+    player_working = false;
+    if (player_worker.joinable()) player_worker.join();
+}
+
+bool sc::recorder::player::playing() {
+    return player_working;
+}
@@ -0,0 +1,209 @@
+#include "recorder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <spdlog/spdlog.h>
+
+#include "format.h"
+
+namespace sc::recorder {
+
+    // Bounded multi-producer queue (Vyukov). Producers claim a cell with one CAS and never wait;
+    // the writer thread is the only consumer.
+    template<size_t capacity> struct sample_queue {
+
+        static_assert((capacity & (capacity - 1)) == 0, "Queue capacity must be a power of two.");
+
+        struct alignas(64) cell {
+
+            std::atomic<size_t> sequence = 0;
+            sample value;
+        };
+
+        std::array<cell, capacity> cells;
+        alignas(64) std::atomic<size_t> enqueue_pos = 0;
+        alignas(64) std::atomic<size_t> dequeue_pos = 0;
+
+        sample_queue() {
+            for (size_t i = 0; i < capacity; i++) cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        bool try_push(const sample &value) {
+            auto pos = enqueue_pos.load(std::memory_order_relaxed);
+            for (;;) {
+                auto &target = cells[pos & (capacity - 1)];
+                const auto sequence = target.sequence.load(std::memory_order_acquire);
+                const auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+                if (!difference) {
+                    if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        target.value = value;
+                        target.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (difference < 0) return false;  // Full
+                else pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        bool try_pop(sample &value) {
+            const auto pos = dequeue_pos.load(std::memory_order_relaxed);
+            auto &target = cells[pos & (capacity - 1)];
+            if (target.sequence.load(std::memory_order_acquire) != pos + 1) return false;  // Empty, or the producer is still writing
+            value = target.value;
+            target.sequence.store(pos + capacity, std::memory_order_release);
+            dequeue_pos.store(pos + 1, std::memory_order_relaxed);
+            return true;
+        }
+    };
+
+    static sample_queue<8192> queue;  // Pending pedal samples
+    static std::thread worker;  // Writes chunks to disk
+    static std::atomic_bool working = false;  // Keeps the writer alive and gates "push"
+    static std::atomic<uint64_t> dropped_samples = 0;  // Samples rejected by a full queue
+
+    struct writer_state {
+
+        std::ofstream file;
+        const iracing::telemetry_bus *bus = nullptr;
+        iracing::telemetry_bus::cursor cursor;
+        sample last;  // Carries every column forward so rows are complete snapshots of the timeline
+        std::vector<sample> rows, batch;
+        std::vector<format::index_entry> index;
+        uint64_t num_rows = 0, num_bytes = 0;
+        bool failed = false;
+    };
+
+    static writer_state state;
+
+    static void write_chunk() {
+        if (state.rows.empty() || state.failed) return;
+        const auto payload = format::encode(state.rows);
+        format::chunk_header header;
+        header.num_rows = static_cast<uint32_t>(state.rows.size());
+        header.payload_size = static_cast<uint32_t>(payload.size());
+        header.first_us = state.rows.front().timestamp_us;
+        header.last_us = state.rows.back().timestamp_us;
+        format::index_entry entry;
+        entry.offset = static_cast<uint64_t>(state.file.tellp());
+        entry.num_rows = header.num_rows;
+        entry.first_us = header.first_us;
+        entry.last_us = header.last_us;
+        state.file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        state.file.write(reinterpret_cast<const char *>(payload.data()), static_cast<std::streamsize>(payload.size()));
+        state.file.flush();
+        if (!state.file) {
+            spdlog::error("Unable to write recording chunk, recording stopped.");
+            state.failed = true;
+            return;
+        }
+        state.index.push_back(entry);
+        state.num_rows += state.rows.size();
+        state.num_bytes += sizeof(header) + payload.size();
+        state.rows.clear();
+    }
+
+    static void collect() {  // Drains the bus and the queue into time ordered rows
+        state.batch.clear();
+        if (state.bus) {
+            while (const auto current = state.bus->read(state.cursor)) {
+                sample value;
+                value.timestamp_us = current->timestamp_us;
+                value.source = source::telemetry;
+                value.tick = current->tick;
+                value.gear = current->gear;
+                value.lap_percent = current->lap_percent;
+                value.speed = current->speed;
+                value.rpm = current->rpm;
+                value.throttle = current->throttle;
+                value.brake = current->brake;
+                value.clutch = current->clutch;
+                state.batch.push_back(value);
+            }
+        }
+        for (sample value; queue.try_pop(value);) state.batch.push_back(value);
+        std::stable_sort(state.batch.begin(), state.batch.end(), [](const sample &first, const sample &second) {
+            return first.timestamp_us < second.timestamp_us;
+        });
+        for (const auto &value : state.batch) {
+            if (value.source & source::telemetry) {
+                state.last.tick = value.tick;
+                state.last.gear = value.gear;
+                state.last.lap_percent = value.lap_percent;
+                state.last.speed = value.speed;
+                state.last.rpm = value.rpm;
+                state.last.throttle = value.throttle;
+                state.last.brake = value.brake;
+                state.last.clutch = value.clutch;
+            }
+            if (value.source & (source::pedals_legacy | source::pedals_mk4)) {
+                state.last.input = value.input;
+                state.last.output = value.output;
+            }
+            state.last.timestamp_us = value.timestamp_us;
+            state.last.source = value.source;
+            state.rows.push_back(state.last);
+            if (state.rows.size() >= format::rows_per_chunk || state.rows.back().timestamp_us - state.rows.front().timestamp_us >= format::chunk_duration_us) write_chunk();
+        }
+    }
+
+    static void work() {
+        while (working) {
+            collect();
+            if (state.batch.empty()) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        collect();
+        write_chunk();
+        format::trailer trailer;
+        trailer.index_offset = static_cast<uint64_t>(state.file.tellp());
+        trailer.num_entries = static_cast<uint32_t>(state.index.size());
+        state.file.write(reinterpret_cast<const char *>(state.index.data()), static_cast<std::streamsize>(state.index.size() * sizeof(format::index_entry)));
+        state.file.write(reinterpret_cast<const char *>(&trailer), sizeof(trailer));
+        state.file.close();
+        const auto telemetry_dropped = state.bus ? state.cursor.dropped : 0;
+        spdlog::info("Recorded {} samples in {} chunks ({} bytes), dropped {} pedal samples and {} telemetry frames.", state.num_rows, state.index.size(), state.num_bytes, dropped_samples.load(), telemetry_dropped);
+    }
+}
+
+int64_t sc::recorder::now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::optional<std::string> sc::recorder::start(const std::filesystem::path &path, const iracing::telemetry_bus *bus) {
+    stop();
+    for (sample stale; queue.try_pop(stale);) { }  // Discard samples pushed while stopping the previous recording
+    state = writer_state();
+    state.file.open(path, std::ios::binary | std::ios::trunc);
+    if (!state.file) return fmt::format("Unable to open \"{}\" for recording.", path.string());
+    state.file.write(format::file_magic.data(), format::file_magic.size());
+    state.rows.reserve(format::rows_per_chunk);
+    state.bus = bus;
+    if (bus) state.cursor = bus->subscribe();
+    dropped_samples = 0;
+    working = true;
+    worker = std::thread(work);
+    spdlog::info("Recording to {}", path.string());
+    return std::nullopt;
+}
+
+void sc::recorder::stop() {
+    working = false;
+    if (worker.joinable()) worker.join();
+}
+
+bool sc::recorder::recording() {
+    return working;
+}
+
+bool sc::recorder::push(const sample &value) {
+    if (!working) return false;
+    if (queue.try_push(value)) return true;
+    dropped_samples++;
+    return false;
+}
+
+uint64_t sc::recorder::dropped() {
+    return dropped_samples;
+}
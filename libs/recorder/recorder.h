@@ -0,0 +1,75 @@
+#pragma once  // Ensures this header file is included only once during compilation
+
+#include <array>  // Include the header file for using std::array
+#include <cstdint>  // Include the header file for using fixed width integers
+#include <filesystem>  // Include the header file for using std::filesystem::path
+#include <fstream>  // Include the header file for using std::ifstream
+#include <functional>  // Include the header file for using std::function
+#include <memory>  // Include the header file for using std::shared_ptr
+#include <optional>  // Include the header file for using std::optional
+#include <string>  // Include the header file for using std::string
+#include <vector>  // Include the header file for using std::vector
+
+#include <tl/expected.hpp>  // Include the header file for using tl::expected
+
+#include "../iracing/telemetry_bus.h"  // Include the header file for the iRacing frame bus
+
+namespace sc::recorder {  // Start of the sc::recorder namespace
+
+    enum source : int32_t {  // Bit flags describing which producer a sample's fresh values came from
+        telemetry = 1,  // An iRacing frame
+        pedals_legacy = 2,  // The legacy (ViGEm) pedal pipeline
+        pedals_mk4 = 4  // An MK4 device
+    };
+
+    struct sample {  // One row of the recording timeline; columns that were not refreshed carry their last value
+
+        int64_t timestamp_us = 0;  // Steady clock time, in microseconds, same clock as iracing::frame::timestamp_us
+        int64_t source = 0;  // Combination of "source" flags
+        int64_t tick = -1;  // iRacing tick of the latest telemetry
+        int64_t gear = 0;  // iRacing gear
+        float lap_percent = 0, speed = 0, rpm = 0;  // iRacing channels
+        float throttle = 0, brake = 0, clutch = 0;  // Pedals as seen by the sim
+        std::array<float, 4> input { }, output { };  // Pedal input and output fractions, 0 to 1, per axis
+    };
+
+    struct chunk_info {  // Index entry of a chunk within a recording
+
+        uint64_t offset = 0;  // Byte offset of the chunk header within the file
+        uint32_t num_rows = 0;  // Number of samples in the chunk
+        int64_t first_us = 0, last_us = 0;  // Timestamps of the first and last sample
+    };
+
+    int64_t now_us();  // Current steady clock time in microseconds
+
+    // Starts recording to "path". When "bus" is given, its frames are recorded too; it is read by the writer thread, never by the producer.
+    std::optional<std::string> start(const std::filesystem::path &path, const iracing::telemetry_bus *bus = nullptr);
+    void stop();  // Flushes the pending chunk, writes the index and closes the file
+    bool recording();  // Whether a recording is in progress
+
+    // Queues a pedal sample; never blocks. Returns false and counts a drop when the queue is full or nothing is being recorded.
+    bool push(const sample &value);
+    uint64_t dropped();  // Samples dropped by "push" during the current recording
+
+    struct reader {  // Random access reader for a finished (or interrupted) recording
+
+        std::ifstream file;  // The opened recording
+        std::vector<chunk_info> chunks;  // Every chunk, ordered by file offset
+        std::vector<sample> rows;  // Decoded samples of the current chunk
+        size_t chunk_i = 0, row_i = 0;  // Position of the next sample
+
+        static tl::expected<std::shared_ptr<reader>, std::string> open(const std::filesystem::path &path);
+
+        std::optional<std::string> seek(const int64_t &timestamp_us);  // Positions at the first sample at or after "timestamp_us"
+        tl::expected<std::optional<sample>, std::string> next();  // The next sample, or nothing at the end
+    };
+
+    namespace player {  // Feeds a recording to a callback as if it was live
+
+        // Speed 1 keeps the recorded pacing, higher values play faster, 0 plays as fast as possible.
+        // "on_end" is called on the playback thread once the recording runs out or fails, but not after "stop".
+        std::optional<std::string> start(const std::filesystem::path &path, std::function<void(const sample &)> on_sample, const float &speed = 1.f, const int64_t &from_us = 0, std::function<void()> on_end = nullptr);
+        void stop();  // Stops the playback thread
+        bool playing();  // Whether samples are still being played
+    }
+}  // End of the sc::recorder namespace
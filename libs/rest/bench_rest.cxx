@@ -0,0 +1,98 @@
+#include "rest.h"
+#include "stand_in_server.h"
+
+#include <curl/curl.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include "../defer.hpp"
+
+// The implementation eon::rest::client replaced: a curl easy handle, and so a new connection, per request.
+static eon::rest::response post_easy(const std::string &url, const nlohmann::json &post_data) {
+    std::string buffer;
+    auto curl = curl_easy_init();
+    if (!curl) return tl::make_unexpected("Unable to initialize.");
+    DEFER(curl_easy_cleanup(curl));
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_URL, url.data());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, +[](void *incoming, size_t size, size_t n, void *user) {
+        static_cast<std::string *>(user)->append(static_cast<const char *>(incoming), size * n);
+        return size * n;
+    });
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &buffer);
+    struct curl_slist *headers = nullptr;
+    DEFER(curl_slist_free_all(headers));
+    headers = curl_slist_append(headers, "Accept: application/json");
+    headers = curl_slist_append(headers, "Content-Type: application/json");
+    headers = curl_slist_append(headers, "charset: utf-8");
+    const auto post_data_str = post_data.dump();
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, post_data_str.data());
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(post_data_str.size()));
+    if (curl_easy_perform(curl) != CURLE_OK) return tl::make_unexpected("Unable to initiate request.");
+    if (long code; curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &code) != CURLE_OK || code != 200) return tl::make_unexpected("HTTP error.");
+    try {
+        return nlohmann::json::parse(buffer);
+    } catch (const nlohmann::json::exception &exc) {
+        return tl::make_unexpected("Unable to parse response.");
+    }
+}
+
+using poster = std::function<std::shared_future<eon::rest::response>(const std::string &, const nlohmann::json &)>;
+
+static void run(const char *name, const poster &post, eon::rest::stand_in_server &server) {
+    const auto url = server.url("/echo");
+    const nlohmann::json doc = { { "email", "driver@example.com" }, { "session_token", std::string(64, 'f') } };
+    const auto connections_before = server.num_connections();
+    int num_errors = 0;
+
+    // One request at a time, as the UI makes them
+    constexpr int num_sequential = 500;
+    std::vector<double> latencies_us;
+    for (int i = 0; i < num_sequential; i++) {
+        const auto start = std::chrono::high_resolution_clock::now();
+        if (!post(url, doc).get()) num_errors++;
+        latencies_us.push_back(std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count());
+    }
+    std::sort(latencies_us.begin(), latencies_us.end());
+    double mean_us = 0;
+    for (const auto &latency_us : latencies_us) mean_us += latency_us / num_sequential;
+
+    // Many in flight at once
+    constexpr int num_concurrent = 2000, in_flight = 32;
+    const auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < num_concurrent; i += in_flight) {
+        std::vector<std::shared_future<eon::rest::response>> batch;
+        for (int j = i; j < i + in_flight && j < num_concurrent; j++) batch.push_back(post(url, doc));
+        for (const auto &res : batch) if (!res.get()) num_errors++;
+    }
+    const auto elapsed_s = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    spdlog::info("{}:", name);
+    spdlog::info("  sequential: {:.1f} us mean, {:.1f} us median, {:.1f} us 99th percentile", mean_us, latencies_us[num_sequential / 2], latencies_us[(num_sequential * 99) / 100]);
+    spdlog::info("  {} in flight: {:.0f} requests per second", in_flight, num_concurrent / elapsed_s);
+    spdlog::info("  {} connections opened, {} errors", server.num_connections() - connections_before, num_errors);
+}
+
+int main() {
+    eon::rest::stand_in_server server;
+    if (!server.ok()) {
+        spdlog::error("Unable to start the stand-in server.");
+        return 1;
+    }
+
+    run("easy handle per request, std::async per call", [](const std::string &url, const nlohmann::json &doc) {
+        return std::async(std::launch::async, [url, doc]() { return post_easy(url, doc); }).share();
+    }, server);
+
+    eon::rest::client client;
+    run("eon::rest::client", [&](const std::string &url, const nlohmann::json &doc) {
+        return client.post(url, doc);
+    }, server);
+    return 0;
+}
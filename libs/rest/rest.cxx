@@ -2,25 +2,37 @@
 
 #include <curl/curl.h>
 #include <curl/easy.h>
+#include <curl/multi.h>
 #include <spdlog/spdlog.h>
 
 #include <mutex>
 #include <optional>
+#include <algorithm>
+#include <cctype>
 
 #include <sstream>
 
-#include "../defer.hpp"
-
 static size_t curl_write_cb(void *incoming_buffer, size_t element_size, size_t num_elements, void *user) {
     const auto num_bytes = element_size * num_elements;
-    auto buffer = reinterpret_cast<std::vector<std::byte> *>(user);
-    const auto length_before = buffer->size();
-    buffer->resize(buffer->size() + num_bytes);
-    memcpy(&(*buffer)[length_before], incoming_buffer, num_bytes);
+    reinterpret_cast<std::string *>(user)->append(reinterpret_cast<const char *>(incoming_buffer), num_bytes);
+    return num_bytes;
+}
+
+static size_t curl_header_cb(char *incoming_buffer, size_t element_size, size_t num_elements, void *user) {
+    const auto num_bytes = element_size * num_elements;
+    std::string_view line(incoming_buffer, num_bytes);
+    constexpr std::string_view name = "etag:";
+    if (line.size() > name.size() && std::equal(name.begin(), name.end(), line.begin(), [](const char &a, const char &b) { return a == std::tolower(static_cast<unsigned char>(b)); })) {
+        line.remove_prefix(name.size());
+        while (!line.empty() && (line.front() == ' ' || line.front() == '\t')) line.remove_prefix(1);
+        while (!line.empty() && (line.back() == '\r' || line.back() == '\n' || line.back() == ' ')) line.remove_suffix(1);
+        *reinterpret_cast<std::string *>(user) = line;
+    }
     return num_bytes;
 }
 
 static std::optional<std::string> initialize_winsock() {
+    #ifdef _WIN32
     static std::mutex mutex;
     std::lock_guard guard(mutex);
     static WSADATA wsa_data;
@@ -35,46 +47,209 @@ static std::optional<std::string> initialize_winsock() {
         }
     }
     return "Unable to initialize Windows sockets.";
+    #else
+    return std::nullopt;  // Sockets need no initialization elsewhere
+    #endif
 }
 
-tl::expected<nlohmann::json, std::string> eon::rest::post(const std::string_view &url, const nlohmann::json &post_data) {
-    if (const auto err = initialize_winsock(); err) return tl::make_unexpected(*err);
-    std::vector<std::byte> buffer;
-    auto curl = curl_easy_init();
-    if (!curl) return tl::make_unexpected("Unable to initialize.");
-    DEFER(curl_easy_cleanup(curl));
-    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1);
-    curl_easy_setopt(curl, CURLOPT_URL, url.data());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curl_write_cb);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &buffer);
-    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0);
-    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0);
+struct eon::rest::client::transfer {
+
+    CURL *curl = nullptr;
     struct curl_slist *headers = nullptr;
-    DEFER(curl_slist_free_all(headers));
-    headers = curl_slist_append(headers, "Accept: application/json");
-    headers = curl_slist_append(headers, "Content-Type: application/json");
-    headers = curl_slist_append(headers, "charset: utf-8");
-    const auto post_data_str = post_data.dump();
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, post_data_str.data());
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, post_data_str.size());
-    if (auto curl_res = curl_easy_perform(curl); curl_res != CURLE_OK) {
-        std::stringstream ss;
-        ss << "Unable to initiate request. (Error #";
-        ss << curl_res;
-        ss << ")";
-        return tl::make_unexpected(ss.str());
+    request req;
+    reply res;
+    std::function<void(raw_response)> deliver;  // Sets the caller's promise
+    std::function<void()> on_complete;
+
+    ~transfer() {
+        if (headers) curl_slist_free_all(headers);
+        if (curl) curl_easy_cleanup(curl);
+    }
+
+    void finish(raw_response result) {
+        deliver(std::move(result));
+        if (on_complete) on_complete();
+    }
+
+    raw_response result(const CURLcode &curl_res) {
+        if (curl_res != CURLE_OK) {
+            std::stringstream ss;
+            ss << "Unable to initiate request. (Error #";
+            ss << curl_res;
+            ss << ": ";
+            ss << curl_easy_strerror(curl_res);
+            ss << ")";
+            return tl::make_unexpected(ss.str());
+        }
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &res.status);
+        return std::move(res);
     }
-    if (long code; curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &code) != CURLE_OK || code != 200) {
-        std::stringstream ss;
-        ss << "HTTP error #";
-        ss << code;
-        ss << ".";
-        return tl::make_unexpected(ss.str());
+};
+
+eon::rest::client::client(const options &opts) : opts(opts) {
+    if (const auto err = initialize_winsock(); err) spdlog::error(*err);
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    multi = curl_multi_init();
+    if (!multi) {
+        spdlog::error("Unable to initialize the HTTP client.");
+        return;
     }
-    try {
-        return nlohmann::json::parse(std::string_view(reinterpret_cast<char *>(buffer.data()), buffer.size()));
-    } catch (const nlohmann::json::exception &exc) {
-        return tl::make_unexpected("Unable to parse response.");
+    curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, opts.max_host_connections);
+    curl_multi_setopt(multi, CURLMOPT_MAXCONNECTS, opts.max_cached_connections);
+    curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    thread = std::thread([this]() { run(); });
+}
+
+eon::rest::client::client() : client(options { }) { }
+
+eon::rest::client::~client() {
+    cancel();
+    if (thread.joinable()) thread.join();
+    if (multi) curl_multi_cleanup(multi);
+    curl_global_cleanup();
+}
+
+void eon::rest::client::cancel() {
+    {
+        std::lock_guard guard(mutex);
+        stopping = true;
     }
-}
\ No newline at end of file
+    if (multi) curl_multi_wakeup(multi);
+}
+
+std::shared_future<eon::rest::response> eon::rest::client::post(const std::string_view &url, const nlohmann::json &post_data, std::function<void()> on_complete) {
+    auto pending = std::make_unique<transfer>();
+    pending->req.method = "POST";
+    pending->req.url = url;
+    pending->req.headers = { "Accept: application/json", "Content-Type: application/json", "charset: utf-8" };
+    pending->req.body = post_data.dump();
+    pending->on_complete = std::move(on_complete);
+    const auto promise = std::make_shared<std::promise<response>>();
+    auto res = promise->get_future().share();
+    pending->deliver = [promise](raw_response raw) {  // Evaluated the way a blocking POST would be
+        if (!raw) {
+            promise->set_value(tl::make_unexpected(raw.error()));
+            return;
+        }
+        if (raw->status != 200) {
+            std::stringstream ss;
+            ss << "HTTP error #";
+            ss << raw->status;
+            ss << ".";
+            promise->set_value(tl::make_unexpected(ss.str()));
+            return;
+        }
+        try {
+            promise->set_value(nlohmann::json::parse(raw->body));
+        } catch (const nlohmann::json::exception &exc) {
+            promise->set_value(tl::make_unexpected("Unable to parse response."));
+        }
+    };
+    queue(std::move(pending));
+    return res;
+}
+
+std::shared_future<eon::rest::raw_response> eon::rest::client::send(request req, std::function<void()> on_complete) {
+    auto pending = std::make_unique<transfer>();
+    pending->req = std::move(req);
+    pending->on_complete = std::move(on_complete);
+    const auto promise = std::make_shared<std::promise<raw_response>>();
+    auto res = promise->get_future().share();
+    pending->deliver = [promise](raw_response raw) { promise->set_value(std::move(raw)); };
+    queue(std::move(pending));
+    return res;
+}
+
+void eon::rest::client::queue(std::unique_ptr<transfer> pending) {
+    if (multi) {
+        std::lock_guard guard(mutex);
+        if (!stopping) queued.push_back(std::move(pending));
+    }
+    if (pending) pending->finish(tl::make_unexpected(multi ? "Client shut down." : "Unable to initialize."));
+    else curl_multi_wakeup(multi);
+}
+
+void eon::rest::client::run() {
+    std::vector<std::unique_ptr<transfer>> incoming, active;
+    for (;;) {
+        bool stop;
+        {
+            std::lock_guard guard(mutex);
+            incoming.swap(queued);
+            stop = stopping;
+        }
+
+        if (stop) {
+            for (auto &pending : active) curl_multi_remove_handle(multi, pending->curl);
+            for (auto &pending : active) pending->finish(tl::make_unexpected("Client shut down."));
+            for (auto &pending : incoming) pending->finish(tl::make_unexpected("Client shut down."));
+            return;
+        }
+
+        for (auto &pending : incoming) {
+            pending->curl = curl_easy_init();
+            if (!pending->curl) {
+                pending->finish(tl::make_unexpected("Unable to initialize."));
+                continue;
+            }
+            const auto curl = pending->curl;
+            const auto &req = pending->req;
+            curl_easy_setopt(curl, CURLOPT_PRIVATE, pending.get());
+            curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+            curl_easy_setopt(curl, CURLOPT_URL, req.url.data());
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curl_write_cb);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &pending->res.body);
+            curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, curl_header_cb);
+            curl_easy_setopt(curl, CURLOPT_HEADERDATA, &pending->res.etag);
+            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
+            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+            curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, static_cast<long>(opts.timeout.count()));
+            curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, static_cast<long>(opts.connect_timeout.count()));
+            curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+            curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);  // Rather wait for a connection that can multiplex than open another
+            for (const auto &header : req.headers) pending->headers = curl_slist_append(pending->headers, header.data());
+            pending->headers = curl_slist_append(pending->headers, "Expect:");  // Send the body right away instead of waiting for 100 Continue
+            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, pending->headers);
+            if (req.method == "POST") curl_easy_setopt(curl, CURLOPT_POST, 1L);
+            else if (req.method != "GET") curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, req.method.data());
+            if (!req.body.empty() || req.method == "POST") {
+                curl_easy_setopt(curl, CURLOPT_POSTFIELDS, req.body.data());
+                curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(req.body.size()));
+            }
+            if (curl_multi_add_handle(multi, curl) != CURLM_OK) {
+                pending->finish(tl::make_unexpected("Unable to initiate request."));
+                continue;
+            }
+            active.push_back(std::move(pending));
+        }
+        incoming.clear();
+
+        int running = 0;
+        curl_multi_perform(multi, &running);
+        int num_messages = 0;
+        while (const auto message = curl_multi_info_read(multi, &num_messages)) {
+            if (message->msg != CURLMSG_DONE) continue;
+            const auto curl = message->easy_handle;
+            const auto curl_res = message->data.result;
+            transfer *done = nullptr;
+            curl_easy_getinfo(curl, CURLINFO_PRIVATE, &done);
+            curl_multi_remove_handle(multi, curl);  // Invalidates the message; the connection stays cached for the next request
+            const auto it = std::find_if(active.begin(), active.end(), [&](const auto &pending) { return pending.get() == done; });
+            if (it == active.end()) continue;
+            auto finished = std::move(*it);
+            active.erase(it);
+            finished->finish(finished->result(curl_res));
+        }
+
+        curl_multi_poll(multi, nullptr, 0, 1000, nullptr);  // Returns early on socket activity, a transfer timeout or curl_multi_wakeup()
+    }
+}
+
+eon::rest::client &eon::rest::client::shared() {
+    static client instance;
+    return instance;
+}
+
+tl::expected<nlohmann::json, std::string> eon::rest::post(const std::string_view &url, const nlohmann::json &post_data) {
+    return client::shared().post(url, post_data).get();
+}
@@ -4,6 +4,12 @@
 #include <string>
 #include <string_view>
 #include <future>
+#include <functional>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <memory>
+#include <vector>
 
 #include <nlohmann/json.hpp>
 #include <tl/expected.hpp>
@@ -12,5 +18,68 @@ namespace eon::rest {
 
     using response = tl::expected<nlohmann::json, std::string>;
 
-    response post(const std::string_view &url, const nlohmann::json &post_data);
-}
\ No newline at end of file
+    struct request {
+
+        std::string method = "GET";
+        std::string url;
+        std::vector<std::string> headers;  // "Name: value"
+        std::string body;  // Sent unless empty
+    };
+
+    struct reply {
+
+        long status = 0;
+        std::string etag;  // The ETag header as sent, quotes included; empty without one
+        std::string body;
+    };
+
+    using raw_response = tl::expected<reply, std::string>;  // Any status is a reply; errors are for transfers that failed
+
+    // Runs every request of its own on one curl multi handle and one thread, so connections to a host are kept alive and
+    // reused instead of opened per request. Requests to the same host share at most max_host_connections connections;
+    // over HTTP/2 they are multiplexed on one.
+    class client {
+    public:
+
+        struct options {
+
+            std::chrono::milliseconds timeout = std::chrono::seconds(30);  // Whole request, including the wait for a connection
+            std::chrono::milliseconds connect_timeout = std::chrono::seconds(10);
+            long max_host_connections = 4;
+            long max_cached_connections = 8;  // Idle connections kept open for reuse
+        };
+
+        explicit client(const options &opts);
+        client();
+        ~client();  // Fails the requests still pending
+
+        void cancel();  // Fails the requests still pending and every later one, without waiting for the thread
+
+        client(const client &) = delete;
+        client &operator=(const client &) = delete;
+
+        // Queues a JSON POST and returns right away. "on_complete" runs on the client's thread after the response is set.
+        std::shared_future<response> post(const std::string_view &url, const nlohmann::json &post_data, std::function<void()> on_complete = { });
+
+        // Queues any request, for callers that need the status and headers, e.g. for conditional requests.
+        std::shared_future<raw_response> send(request req, std::function<void()> on_complete = { });
+
+        static client &shared();  // Process-wide client with the default options
+
+    private:
+
+        struct transfer;
+
+        void queue(std::unique_ptr<transfer> pending);
+        void run();
+
+        options opts;
+        void *multi = nullptr;  // CURLM
+        std::mutex mutex;
+        std::vector<std::unique_ptr<transfer>> queued;
+        bool stopping = false;
+        std::thread thread;
+    };
+
+    response post(const std::string_view &url, const nlohmann::json &post_data);  // Blocks on client::shared()
+}
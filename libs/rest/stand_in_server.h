@@ -0,0 +1,226 @@
+#pragma once
+
+// A minimal HTTP/1.1 server on the loopback interface, standing in for the web API in tests and benchmarks.
+// Connections are kept alive until the client closes them. A test can pass its own routes; these are built in:
+//   /echo        200 with {"echo": <request body>}
+//   /slow        200 with {} after "slow_delay"
+//   /status/500  500 with an empty body
+//   /garbage     200 with a body that isn't JSON
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+#else
+    #include <arpa/inet.h>
+    #include <netinet/in.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <optional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace eon::rest {
+
+    class stand_in_server {
+    public:
+
+        #ifdef _WIN32
+        using socket_type = SOCKET;
+        static constexpr socket_type invalid_socket = INVALID_SOCKET;
+        static void close_socket(const socket_type &s) { closesocket(s); }
+        static constexpr int send_flags = 0;
+        #else
+        using socket_type = int;
+        static constexpr socket_type invalid_socket = -1;
+        static void close_socket(const socket_type &s) { close(s); }
+        static constexpr int send_flags = MSG_NOSIGNAL;  // A client that hung up is an error to return, not a signal
+        #endif
+
+        struct route_request {
+
+            std::string method, path;
+            std::vector<std::pair<std::string, std::string>> headers;  // Names in lower case
+            std::string body;
+
+            std::string header(const std::string_view &name) const {
+                for (const auto &[key, value] : headers) if (key == name) return value;
+                return { };
+            }
+        };
+
+        struct route_reply {
+
+            int status = 200;
+            std::vector<std::string> headers;  // "Name: value"
+            std::string body;
+        };
+
+        using routes = std::function<std::optional<route_reply>(const route_request &)>;  // Called from the connection threads; empty for the built-in routes
+
+        std::chrono::milliseconds slow_delay = std::chrono::seconds(2);
+
+        explicit stand_in_server(routes custom = { }) : custom(std::move(custom)) {
+            #ifdef _WIN32
+            WSADATA wsa_data;
+            WSAStartup(MAKEWORD(2, 2), &wsa_data);
+            #endif
+            listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+            if (listener == invalid_socket) return;
+            sockaddr_in address = { };
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            address.sin_port = 0;  // Any free port
+            socklen_t length = sizeof(address);
+            if (bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(listener, 64) != 0 || getsockname(listener, reinterpret_cast<sockaddr *>(&address), &length) != 0) {
+                close_socket(listener);
+                listener = invalid_socket;
+                return;
+            }
+            bound_port = ntohs(address.sin_port);
+            acceptor = std::thread([this]() { accept_loop(); });
+        }
+
+        ~stand_in_server() {
+            stopping = true;
+            if (listener != invalid_socket) {
+                #ifdef _WIN32
+                shutdown(listener, SD_BOTH);
+                #else
+                shutdown(listener, SHUT_RDWR);
+                #endif
+                close_socket(listener);
+            }
+            if (acceptor.joinable()) acceptor.join();
+            {
+                std::lock_guard guard(mutex);
+                for (const auto &s : connections) {
+                    #ifdef _WIN32
+                    shutdown(s, SD_BOTH);
+                    #else
+                    shutdown(s, SHUT_RDWR);
+                    #endif
+                }
+            }
+            for (auto &handler : handlers) handler.join();
+            for (const auto &s : connections) close_socket(s);  // Only now, so a shutdown above never hits a reused descriptor
+        }
+
+        bool ok() const { return bound_port != 0; }
+
+        std::string url(const std::string_view &path) const {
+            return "http://127.0.0.1:" + std::to_string(bound_port) + std::string(path);
+        }
+
+        uint64_t num_connections() const { return accepted; }  // Connections accepted so far
+        uint64_t num_requests() const { return served; }
+
+    private:
+
+        void accept_loop() {
+            while (!stopping) {
+                const auto s = accept(listener, nullptr, nullptr);
+                if (s == invalid_socket) return;
+                accepted++;
+                std::lock_guard guard(mutex);
+                connections.push_back(s);
+                handlers.emplace_back([this, s]() { serve(s); });
+            }
+        }
+
+        void serve(const socket_type &s) {
+            std::string pending;
+            char chunk[4096];
+            for (;;) {
+                const auto header_end = pending.find("\r\n\r\n");
+                if (header_end == std::string::npos) {
+                    const auto n = recv(s, chunk, sizeof(chunk), 0);
+                    if (n <= 0) break;
+                    pending.append(chunk, static_cast<size_t>(n));
+                    continue;
+                }
+                const std::string_view head(pending.data(), header_end);
+                size_t content_length = 0;
+                for (const std::string_view key : { "Content-Length:", "content-length:" }) {
+                    if (const auto at = head.find(key); at != std::string_view::npos) content_length = std::strtoul(pending.data() + at + key.size(), nullptr, 10);
+                }
+                const auto request_size = header_end + 4 + content_length;
+                while (pending.size() < request_size) {
+                    const auto n = recv(s, chunk, sizeof(chunk), 0);
+                    if (n <= 0) break;
+                    pending.append(chunk, static_cast<size_t>(n));
+                }
+                if (pending.size() < request_size) break;
+
+                route_request request;
+                const auto request_line = head.substr(0, head.find("\r\n"));
+                const auto path_begin = request_line.find(' ') + 1;
+                request.method = request_line.substr(0, path_begin - 1);
+                request.path = request_line.substr(path_begin, request_line.find(' ', path_begin) - path_begin);
+                for (size_t at = request_line.size() + 2; at < head.size();) {
+                    auto end = head.find("\r\n", at);
+                    if (end == std::string_view::npos) end = head.size();
+                    const auto line = head.substr(at, end - at);
+                    at = end + 2;
+                    const auto colon = line.find(':');
+                    if (colon == std::string_view::npos) continue;
+                    std::string name(line.substr(0, colon));
+                    std::transform(name.begin(), name.end(), name.begin(), [](const char &c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+                    auto value = line.substr(colon + 1);
+                    while (!value.empty() && value.front() == ' ') value.remove_prefix(1);
+                    request.headers.emplace_back(std::move(name), std::string(value));
+                }
+                request.body = pending.substr(header_end + 4, content_length);
+                pending.erase(0, request_size);
+                served++;
+
+                if (!respond(s, request)) break;
+            }
+        }
+
+        bool respond(const socket_type &s, const route_request &request) const {
+            std::optional<route_reply> reply;
+            if (custom) reply = custom(request);
+            if (!reply) {
+                reply.emplace();
+                reply->headers.push_back("Content-Type: application/json");
+                if (request.path == "/echo") reply->body = "{\"echo\":" + (request.body.empty() ? std::string("null") : request.body) + "}";
+                else if (request.path == "/slow") {
+                    for (const auto until = std::chrono::steady_clock::now() + slow_delay; !stopping && std::chrono::steady_clock::now() < until;) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    reply->body = "{}";
+                } else if (request.path == "/status/500") reply->status = 500;
+                else if (request.path == "/garbage") reply->body = "this is not json";
+                else reply->status = 404;
+            }
+            auto response = "HTTP/1.1 " + std::to_string(reply->status) + (reply->status < 400 ? " OK" : " Error") + "\r\n";
+            for (const auto &header : reply->headers) response += header + "\r\n";
+            response += "Content-Length: " + std::to_string(reply->body.size()) + "\r\n\r\n" + reply->body;
+            for (size_t sent = 0; sent < response.size();) {
+                const auto n = send(s, response.data() + sent, static_cast<int>(response.size() - sent), send_flags);
+                if (n <= 0) return false;
+                sent += static_cast<size_t>(n);
+            }
+            return true;
+        }
+
+        routes custom;
+        socket_type listener = invalid_socket;
+        uint16_t bound_port = 0;
+        std::atomic_bool stopping = false;
+        std::atomic<uint64_t> accepted = 0, served = 0;
+        std::thread acceptor;
+        std::mutex mutex;
+        std::vector<socket_type> connections;
+        std::vector<std::thread> handlers;
+    };
+}
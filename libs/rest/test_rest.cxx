@@ -1,10 +1,76 @@
 #include "rest.h"
+#include "stand_in_server.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
 
 #include <spdlog/spdlog.h>
 
 #include "../api/api.h"
+#include "../check.hpp"
+
+using sc::test::check;
+
+static void test_stand_in() {
+    eon::rest::stand_in_server server;
+    check(server.ok(), "stand-in server listens");
+    if (!server.ok()) return;
+
+    {
+        eon::rest::client::options opts;
+        opts.max_host_connections = 2;
+        eon::rest::client client(opts);
+        std::atomic<int> num_completed = 0;
+        std::vector<std::shared_future<eon::rest::response>> responses;
+        for (int i = 0; i < 64; i++) responses.push_back(client.post(server.url("/echo"), { { "i", i } }, [&]() { num_completed++; }));
+        bool all_echoed = true;
+        for (int i = 0; i < 64; i++) {
+            const auto &res = responses[i].get();
+            all_echoed = all_echoed && res.has_value() && (*res)["echo"]["i"] == i;
+        }
+        check(all_echoed, "every concurrent request gets its own echo back");
+        for (int i = 0; i < 100 && num_completed < 64; i++) std::this_thread::sleep_for(std::chrono::milliseconds(1));  // It runs right after the response is set
+        check(num_completed == 64, "every request calls on_complete");
+        check(server.num_connections() <= 2, "requests share at most max_host_connections connections");
+
+        const auto connections_before = server.num_connections();
+        for (int i = 0; i < 16; i++) check(client.post(server.url("/echo"), { { "again", i } }).get().has_value(), "sequential request succeeds");
+        check(server.num_connections() == connections_before, "sequential requests reuse the cached connections");
+
+        const auto status = client.post(server.url("/status/500"), { }).get();
+        check(!status && status.error() == "HTTP error #500.", "a non-200 status is an error");
+        const auto garbage = client.post(server.url("/garbage"), { }).get();
+        check(!garbage && garbage.error() == "Unable to parse response.", "a body that isn't JSON is an error");
+    }
+
+    {
+        eon::rest::client::options opts;
+        opts.timeout = std::chrono::milliseconds(200);
+        eon::rest::client client(opts);
+        const auto start = std::chrono::steady_clock::now();
+        const auto slow = client.post(server.url("/slow"), { }).get();
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        check(!slow.has_value(), "a request that takes too long times out");
+        check(elapsed < std::chrono::seconds(1), "the timeout is honoured");
+        check(client.post(server.url("/echo"), { { "after", "timeout" } }).get().has_value(), "the client still works after a timeout");
+    }
+
+    {
+        std::shared_future<eon::rest::response> pending;
+        {
+            eon::rest::client client;
+            pending = client.post(server.url("/slow"), { });
+        }
+        check(pending.wait_for(std::chrono::seconds(0)) == std::future_status::ready && !pending.get().has_value(), "destroying the client fails its pending requests");
+    }
+}
 
 int main() {
+    test_stand_in();
+    const auto res = sc::test::finish("stand-in server");
+
     for (int i = 0; i < 4; i++) {
         const auto res = eon::rest::post("http://dummy.restapiexample.com/api/v1/create", {
             { "name", "Brandon" },
@@ -16,5 +82,5 @@ int main() {
     if (const auto res = sc::api::customer::get_session_token("miranda@google.com", "abc123").get(); res) {
         spdlog::critical("Session key: {}", res->dump());
     } else spdlog::error(res.error());
-    return 0;
-}
\ No newline at end of file
+    return res;
+}
@@ -0,0 +1,160 @@
+#include "serial.h"
+#include "reader.h"
+#include "framing.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <spdlog/spdlog.h>
+
+using namespace sc::serial;
+using bench_clock = std::chrono::steady_clock;
+
+// 8N1 takes ten bits on the wire per byte
+static constexpr uint32_t baud_rate = 1000000;
+static constexpr double line_bytes_per_s = baud_rate / 10.0;
+static constexpr size_t payload_size = 64;
+
+struct result {
+
+    size_t num_frames = 0;
+    double seconds = 0;
+    std::vector<double> latencies_us;
+};
+
+static std::vector<std::byte> stamped_payload(const uint32_t &sequence) {
+    std::vector<std::byte> payload(payload_size, std::byte { 0xA5 });
+    const auto sent_ns = static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now().time_since_epoch()).count());
+    std::memcpy(payload.data(), &sequence, sizeof(sequence));
+    std::memcpy(payload.data() + sizeof(sequence), &sent_ns, sizeof(sent_ns));
+    return payload;
+}
+
+static double latency_us(const std::byte *payload) {
+    int64_t sent_ns;
+    std::memcpy(&sent_ns, payload + sizeof(uint32_t), sizeof(sent_ns));
+    return (std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now().time_since_epoch()).count() - sent_ns) / 1000.0;
+}
+
+// Writes frames into the master side; paced to the line rate, or as fast as the pseudo-terminal takes them
+static std::thread start_writer(const int &master, const size_t &num_frames, const bool &paced) {
+    return std::thread([=]() {
+        const auto frame_time = std::chrono::duration<double>(framing::encoded_size(payload_size) / line_bytes_per_s);
+        const auto start = bench_clock::now();
+        std::array<std::byte, framing::encoded_size(payload_size)> frame;
+        for (size_t i = 0; i < num_frames; i++) {
+            if (paced) std::this_thread::sleep_until(start + std::chrono::duration_cast<bench_clock::duration>(frame_time * static_cast<double>(i)));
+            const auto payload = stamped_payload(static_cast<uint32_t>(i));
+            const auto size = framing::encode(payload.data(), payload.size(), frame.data());
+            for (size_t at = 0; at < size; ) {
+                const auto res = ::write(master, frame.data() + at, size - at);
+                if (res <= 0) return;
+                at += static_cast<size_t>(res);
+            }
+        }
+    });
+}
+
+// The event-driven path: a reader thread fills the ring, frames are decoded where they lie
+static result run_ring(comm_instance &comm, const int &master, const size_t &num_frames, const bool &paced) {
+    result res;
+    byte_ring ring(64 * 1024);
+    framing::parser parser;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool pending = false;
+    reader port_reader(comm, ring, [&]() {
+        { std::lock_guard guard(mutex); pending = true; }
+        cv.notify_one();
+    });
+    const auto start = bench_clock::now();
+    auto writer = start_writer(master, num_frames, paced);
+    while (res.num_frames < num_frames && bench_clock::now() - start < std::chrono::seconds(30)) {
+        {
+            std::unique_lock lock(mutex);
+            cv.wait_for(lock, std::chrono::milliseconds(100), [&]() { return pending; });
+            pending = false;
+        }
+        parser.parse(ring, [&](const std::byte *payload, const size_t &) {
+            res.latencies_us.push_back(latency_us(payload));
+            res.num_frames++;
+        });
+    }
+    res.seconds = std::chrono::duration<double>(bench_clock::now() - start).count();
+    writer.join();
+    return res;
+}
+
+// The way the port was read before: poll read(), which allocates a vector per call, and gather frames in another vector
+static result run_polling(comm_instance &comm, const int &master, const size_t &num_frames, const bool &paced) {
+    result res;
+    std::vector<std::byte> pending;
+    const auto start = bench_clock::now();
+    auto writer = start_writer(master, num_frames, paced);
+    while (res.num_frames < num_frames && bench_clock::now() - start < std::chrono::seconds(30)) {
+        const auto chunk = comm.read();
+        if (!chunk.has_value()) break;
+        if (chunk->empty()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        pending.insert(pending.end(), chunk->begin(), chunk->end());
+        auto it = pending.begin();
+        while (true) {
+            const auto zero = std::find(it, pending.end(), std::byte { 0 });
+            if (zero == pending.end()) break;
+            std::vector<std::byte> frame(it, zero);
+            const auto decoded = framing::decode_in_place(frame.data(), frame.size());
+            if (decoded && *decoded >= 2) {
+                res.latencies_us.push_back(latency_us(frame.data()));
+                res.num_frames++;
+            }
+            it = zero + 1;
+        }
+        pending.erase(pending.begin(), it);
+    }
+    res.seconds = std::chrono::duration<double>(bench_clock::now() - start).count();
+    writer.join();
+    return res;
+}
+
+static void report(const std::string &name, result res) {
+    std::sort(res.latencies_us.begin(), res.latencies_us.end());
+    const auto at = [&](const double &q) { return res.latencies_us.empty() ? 0.0 : res.latencies_us[static_cast<size_t>(q * (res.latencies_us.size() - 1))]; };
+    const auto bytes_per_s = res.num_frames * framing::encoded_size(payload_size) / res.seconds;
+    spdlog::info("  {:<28} {:>7} frames, {:>8.2f} MB/s ({:>6.1f}x 1 Mbaud), latency p50 {:>8.1f} us, p99 {:>8.1f} us, max {:>8.1f} us",
+        name, res.num_frames, bytes_per_s / 1e6, bytes_per_s / line_bytes_per_s, at(0.5), at(0.99), at(1.0));
+}
+
+int main() {
+    const auto master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        spdlog::error("Unable to open a pseudo-terminal pair");
+        return 1;
+    }
+    comm_instance comm;
+    if (const auto err = comm.open(ptsname(master), baud_rate); err) {
+        spdlog::error("{}", *err);
+        return 1;
+    }
+    spdlog::info("{}-byte payloads, {}-byte frames, 1 Mbaud carries {:.0f} frames/s", payload_size, framing::encoded_size(payload_size), line_bytes_per_s / framing::encoded_size(payload_size));
+
+    // A pseudo-terminal doesn't pace bytes to the baud rate, so unpaced runs show how far past the line rate each path keeps up
+    spdlog::info("As fast as the pseudo-terminal takes them:");
+    report("reader + ring + parser", run_ring(comm, master, 200000, false));
+    report("polled read()", run_polling(comm, master, 200000, false));
+
+    spdlog::info("Paced at 1 Mbaud, 2 s:");
+    const auto num_paced = static_cast<size_t>(2 * line_bytes_per_s / framing::encoded_size(payload_size));
+    report("reader + ring + parser", run_ring(comm, master, num_paced, true));
+    report("polled read()", run_polling(comm, master, num_paced, true));
+
+    comm.close();
+    ::close(master);
+    return 0;
+}
@@ -0,0 +1,135 @@
+#include "framing.h"
+
+#include <cstring>
+
+namespace {
+
+    struct crc_table {
+
+        std::array<uint16_t, 256> entries;
+
+        constexpr crc_table() : entries() {
+            for (uint32_t i = 0; i < 256; i++) {
+                uint16_t crc = static_cast<uint16_t>(i << 8);
+                for (int bit = 0; bit < 8; bit++) crc = static_cast<uint16_t>(crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1);
+                entries[i] = crc;
+            }
+        }
+    };
+
+    constexpr crc_table table;
+}
+
+uint16_t sc::serial::framing::crc16(const std::byte *data, const size_t &size, uint16_t crc) {
+    for (size_t i = 0; i < size; i++) crc = static_cast<uint16_t>((crc << 8) ^ table.entries[((crc >> 8) ^ std::to_integer<uint8_t>(data[i])) & 0xFF]);
+    return crc;
+}
+
+size_t sc::serial::framing::encode(const std::byte *payload, const size_t &size, std::byte *output) {
+    const auto crc = crc16(payload, size);
+    const std::array<std::byte, 2> crc_bytes = { static_cast<std::byte>(crc & 0xFF), static_cast<std::byte>(crc >> 8) };
+    size_t code_at = 0, at = 1;
+    uint8_t code = 1;
+    const auto put = [&](const std::byte &value) {
+        if (value != std::byte { 0 }) {
+            output[at++] = value;
+            code++;
+        }
+        if (value == std::byte { 0 } || code == 0xFF) {
+            output[code_at] = static_cast<std::byte>(code);
+            code_at = at++;
+            code = 1;
+        }
+    };
+    for (size_t i = 0; i < size; i++) put(payload[i]);
+    for (const auto &value : crc_bytes) put(value);
+    output[code_at] = static_cast<std::byte>(code);
+    output[at++] = std::byte { 0 };
+    return at;
+}
+
+std::vector<std::byte> sc::serial::framing::encode(const std::byte *payload, const size_t &size) {
+    std::vector<std::byte> res(encoded_size(size));
+    res.resize(encode(payload, size, res.data()));
+    return res;
+}
+
+std::optional<size_t> sc::serial::framing::decode_in_place(std::byte *data, const size_t &size) {
+    // Each code byte is replaced by the zero it stands for, so the output never overtakes the input
+    size_t from = 0, to = 0;
+    while (from < size) {
+        const auto code = std::to_integer<uint8_t>(data[from++]);
+        if (code == 0 || from + code - 1 > size) return std::nullopt;
+        std::memmove(data + to, data + from, code - 1u);
+        if (std::memchr(data + to, 0, code - 1u)) return std::nullopt;
+        from += code - 1u;
+        to += code - 1u;
+        if (code != 0xFF && from < size) data[to++] = std::byte { 0 };
+    }
+    return to;
+}
+
+void sc::serial::framing::parser::finish(std::byte *data, const size_t &size, const handler &on_frame, size_t &num_handled) {
+    const auto decoded = decode_in_place(data, size);
+    if (!decoded || *decoded < 2) {
+        errors++;
+        return;
+    }
+    const auto payload_size = *decoded - 2;
+    const auto crc = static_cast<uint16_t>(std::to_integer<uint16_t>(data[payload_size]) | std::to_integer<uint16_t>(data[payload_size + 1]) << 8);
+    if (crc != crc16(data, payload_size)) {
+        errors++;
+        return;
+    }
+    frames++;
+    num_handled++;
+    on_frame(data, payload_size);
+}
+
+size_t sc::serial::framing::parser::parse(byte_ring &ring, const handler &on_frame) {
+    size_t num_handled = 0;
+    while (true) {
+        const auto span = ring.read_span();
+        if (!span.size) break;
+        const auto *zero = static_cast<const std::byte *>(std::memchr(span.data + scanned, 0, span.size - scanned));
+        const auto length = zero ? static_cast<size_t>(zero - span.data) : span.size;
+
+        if (scratch_size || overflowed) {
+            // Gathering a frame that the ring's end split
+            if (!overflowed && scratch_size + length <= scratch.size()) std::memcpy(scratch.data() + scratch_size, span.data, length);
+            else overflowed = true;
+            scratch_size += length;
+            if (!zero) {
+                ring.consume(length);
+                continue;
+            }
+            if (overflowed) errors++;
+            else finish(scratch.data(), scratch_size, on_frame, num_handled);
+            scratch_size = 0;
+            overflowed = false;
+            ring.consume(length + 1);
+            continue;
+        }
+
+        if (zero) {
+            if (length) finish(span.data, length, on_frame, num_handled); // Back-to-back delimiters are allowed, e.g. to resynchronize
+            ring.consume(length + 1);
+            scanned = 0;
+            continue;
+        }
+
+        // No delimiter yet. If more is queued past the ring's end, or the frame fills the ring, it has to be gathered;
+        // otherwise it is still arriving and stays where it is, remembered as scanned so it isn't searched again
+        scanned = 0;
+        if (ring.size() > span.size || span.size == ring.capacity() || span.size > scratch.size()) {
+            if (span.size <= scratch.size()) std::memcpy(scratch.data(), span.data, span.size);
+            else overflowed = true;
+            scratch_size = span.size;
+            ring.consume(span.size);
+            continue;
+        }
+        scanned = span.size;
+        break;
+    }
+    return num_handled;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include "ring.h"
+
+namespace sc::serial::framing {
+
+    // On the wire a frame is COBS(payload, CRC-16 of the payload, little endian) followed by a 0x00 delimiter. COBS leaves no
+    // zero inside a frame, so a receiver that joins mid-stream or loses bytes resynchronizes at the next delimiter.
+
+    constexpr size_t encoded_size(const size_t &payload_size) { return payload_size + 2 + (payload_size + 2) / 254 + 1 + 1; } // Payload, CRC, COBS overhead and delimiter, at most
+
+    constexpr size_t max_payload = 1024;
+    constexpr size_t max_encoded = encoded_size(max_payload);
+
+    uint16_t crc16(const std::byte *data, const size_t &size, uint16_t crc = 0xFFFF); // CRC-16/CCITT-FALSE
+
+    size_t encode(const std::byte *payload, const size_t &size, std::byte *output); // Output needs encoded_size(size) bytes; returns how many were used
+    std::vector<std::byte> encode(const std::byte *payload, const size_t &size);
+    std::optional<size_t> decode_in_place(std::byte *data, const size_t &size); // COBS only, without the delimiter; the decoded size, or nothing if malformed
+
+    class parser {
+    public:
+
+        using handler = std::function<void(const std::byte *payload, const size_t &size)>;
+
+        // Hands every complete frame in the ring to on_frame and consumes it, leaving a partial frame for later. A frame in
+        // one piece is decoded where it lies in the ring; only one split by the ring's end is gathered into scratch first.
+        // The payload is valid during the call only. Returns the number of frames handed over.
+        size_t parse(byte_ring &ring, const handler &on_frame);
+
+        uint64_t num_frames() const { return frames; }
+        uint64_t num_errors() const { return errors; } // Frames dropped for a bad CRC, bad COBS or being too long
+
+    private:
+
+        void finish(std::byte *data, const size_t &size, const handler &on_frame, size_t &num_handled);
+
+        std::array<std::byte, max_encoded> scratch;
+        size_t scratch_size = 0;
+        size_t scanned = 0; // Bytes at the front of the ring already searched for a delimiter
+        bool overflowed = false; // The frame being gathered is too long; drop it at its delimiter
+        uint64_t frames = 0, errors = 0;
+    };
+}
@@ -0,0 +1,44 @@
+#include "reader.h"
+
+#include <spdlog/spdlog.h>
+
+// How long a read waits in the driver before looking whether the reader is being stopped
+static constexpr auto wake_interval = std::chrono::milliseconds(20);
+
+sc::serial::reader::reader(comm_instance &comm, byte_ring &ring, std::function<void()> on_data) : comm(comm), ring(ring), on_data(std::move(on_data)) {
+    thread = std::thread(&reader::run, this);
+}
+
+sc::serial::reader::~reader() {
+    stopping.store(true, std::memory_order_release);
+    if (thread.joinable()) thread.join();
+}
+
+std::optional<std::string> sc::serial::reader::error() const {
+    std::lock_guard guard(error_mutex);
+    return last_error;
+}
+
+void sc::serial::reader::run() {
+    while (!stopping.load(std::memory_order_acquire)) {
+        const auto span = ring.write_span();
+        if (!span.size) {
+            // The driver keeps buffering meanwhile; dropping bytes here would only cost whole frames later
+            stalls.fetch_add(1, std::memory_order_relaxed);
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            continue;
+        }
+        const auto res = comm.read_some(span.data, span.size, wake_interval);
+        if (!res.has_value()) {
+            spdlog::warn("Stopped reading {}: {}", comm.port.value_or("serial port"), res.error());
+            std::lock_guard guard(error_mutex);
+            last_error = res.error();
+            break;
+        }
+        if (!*res) continue;
+        ring.commit(*res);
+        bytes_read.fetch_add(*res, std::memory_order_relaxed);
+        if (on_data) on_data();
+    }
+    stopped.store(true, std::memory_order_release);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "serial.h"
+#include "ring.h"
+
+namespace sc::serial {
+
+    // Moves bytes from a port into a ring on its own thread. The thread sleeps in the driver until bytes arrive, so nothing
+    // polls the port and nothing is allocated per read; the consumer is told through on_data and drains the ring at its pace.
+    class reader {
+    public:
+
+        reader(comm_instance &comm, byte_ring &ring, std::function<void()> on_data = { });
+        ~reader(); // Stops the thread; the port stays open
+
+        reader(const reader &) = delete;
+        reader &operator=(const reader &) = delete;
+
+        std::optional<std::string> error() const; // Why the thread stopped, if it did
+        bool running() const { return !stopped.load(std::memory_order_acquire); }
+        uint64_t num_bytes() const { return bytes_read.load(std::memory_order_relaxed); }
+        uint64_t num_stalls() const { return stalls.load(std::memory_order_relaxed); } // Times the ring was full and the port had to wait on the consumer
+
+    private:
+
+        void run();
+
+        comm_instance &comm;
+        byte_ring &ring;
+        std::function<void()> on_data;
+        std::atomic<bool> stopping = false, stopped = false;
+        std::atomic<uint64_t> bytes_read = 0, stalls = 0;
+        mutable std::mutex error_mutex;
+        std::optional<std::string> last_error;
+        std::thread thread;
+    };
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+
+namespace sc::serial {
+
+    struct byte_span {
+
+        std::byte *data = nullptr;
+        size_t size = 0;
+    };
+
+    // Lock-free byte queue for one producer thread and one consumer thread. Both sides work on spans of the ring itself,
+    // so the producer reads from the port straight into it and the consumer parses in place; nothing is copied in between.
+    class byte_ring {
+    public:
+
+        explicit byte_ring(const size_t &capacity) : buffer(new std::byte[round_up(capacity)]), mask(round_up(capacity) - 1) { }
+
+        size_t capacity() const { return mask + 1; }
+        size_t size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+
+        // Producer: the free space up to the end of the ring; fill some of it, then commit what was filled
+        byte_span write_span() {
+            const auto at = head.load(std::memory_order_relaxed);
+            const auto free = capacity() - (at - tail.load(std::memory_order_acquire));
+            const auto offset = at & mask;
+            return { buffer.get() + offset, std::min(free, capacity() - offset) };
+        }
+
+        void commit(const size_t &size) {
+            head.store(head.load(std::memory_order_relaxed) + size, std::memory_order_release);
+        }
+
+        size_t write(const std::byte *data, const size_t &size) {
+            size_t num_written = 0;
+            while (num_written < size) {
+                const auto span = write_span();
+                if (!span.size) break;
+                const auto n = std::min(span.size, size - num_written);
+                std::memcpy(span.data, data + num_written, n);
+                commit(n);
+                num_written += n;
+            }
+            return num_written;
+        }
+
+        // Consumer: the queued bytes up to the end of the ring, writable so they can be decoded in place; consume them when done
+        byte_span read_span() {
+            const auto at = tail.load(std::memory_order_relaxed);
+            const auto queued = head.load(std::memory_order_acquire) - at;
+            const auto offset = at & mask;
+            return { buffer.get() + offset, std::min(queued, capacity() - offset) };
+        }
+
+        void consume(const size_t &size) {
+            tail.store(tail.load(std::memory_order_relaxed) + size, std::memory_order_release);
+        }
+
+        size_t read(std::byte *data, const size_t &size) {
+            size_t num_read = 0;
+            while (num_read < size) {
+                const auto span = read_span();
+                if (!span.size) break;
+                const auto n = std::min(span.size, size - num_read);
+                std::memcpy(data + num_read, span.data, n);
+                consume(n);
+                num_read += n;
+            }
+            return num_read;
+        }
+
+    private:
+
+        static size_t round_up(const size_t &capacity) {
+            size_t res = 64;
+            while (res < capacity) res <<= 1;
+            return res;
+        }
+
+        std::unique_ptr<std::byte[]> buffer;
+        size_t mask;
+        alignas(64) std::atomic<size_t> head = 0; // Total bytes ever committed; only the producer writes it
+        alignas(64) std::atomic<size_t> tail = 0; // Total bytes ever consumed; only the consumer writes it
+    };
+}
@@ -1,11 +1,14 @@
 #include "serial.h"
 
-#include <locale>
-#include <codecvt>
-
 #include <spdlog/spdlog.h>
 #include <fmt/format.h>
 
+#ifdef _WIN32
+
+#include <locale>
+#include <codecvt>
+#include <cwchar>
+
 #include "../winreg.hpp"
 
 tl::expected<std::vector<std::string>, std::string> sc::serial::list_ports() {
@@ -23,10 +26,34 @@ tl::expected<std::vector<std::string>, std::string> sc::serial::list_ports() {
     return list;
 }
 
-std::optional<std::string> sc::serial::comm_instance::open(const std::string_view &port, std::optional<DWORD> baud_rate) {
+std::optional<sc::serial::usb_id> sc::serial::port_usb_id(const std::string_view &port) {
+    // Every USB device that ever had a port is listed as Enum\USB\VID_xxxx&PID_xxxx\<instance>, with the port's name in "Device Parameters"
+    const auto name = port.substr(port.rfind('\\') + 1);
+    winreg::RegKey devices;
+    if (const auto res = devices.TryOpen(HKEY_LOCAL_MACHINE, L"SYSTEM\\CurrentControlSet\\Enum\\USB", KEY_READ); !res) return std::nullopt;
+    try {
+        for (const auto &device : devices.EnumSubKeys()) {
+            unsigned int vendor, product;
+            if (swscanf(device.c_str(), L"VID_%4x&PID_%4x", &vendor, &product) != 2) continue;
+            winreg::RegKey instances;
+            if (const auto res = instances.TryOpen(devices.Get(), device, KEY_READ); !res) continue;
+            for (const auto &instance : instances.EnumSubKeys()) {
+                winreg::RegKey parameters;
+                if (const auto res = parameters.TryOpen(instances.Get(), instance + L"\\Device Parameters", KEY_READ); !res) continue;
+                const auto port_name = parameters.TryGetStringValue(L"PortName");
+                if (port_name && std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>().to_bytes(*port_name) == name) return usb_id { static_cast<uint16_t>(vendor), static_cast<uint16_t>(product) };
+            }
+        }
+    } catch (...) {
+        // ...
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> sc::serial::comm_instance::open(const std::string_view &port, std::optional<uint32_t> baud_rate) {
     if (const auto err = close(); err) return err;
     this->port = port;
-    io_handle = CreateFileA(port.data(), GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,  NULL);
+    io_handle = CreateFileA(this->port->c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,  NULL);
     if (io_handle != INVALID_HANDLE_VALUE) {
         DCB params = { 0 };
         if (GetCommState(io_handle, &params)) {
@@ -61,6 +88,7 @@ std::optional<std::string> sc::serial::comm_instance::close() {
     }
     port = std::nullopt;
     connected = false;
+    read_timeout_ms = std::nullopt;
     return std::nullopt;
 }
 
@@ -69,23 +97,216 @@ tl::expected<std::vector<std::byte>, std::string> sc::serial::comm_instance::rea
     if (!ClearCommError(io_handle, &error, &status)) return tl::make_unexpected("Unable to get current status of COMM port.");
     if (status.cbInQue == 0) return { };
     std::vector<std::byte> buffer(status.cbInQue);
-    DWORD num_bytes_read;
-    if (!ReadFile(io_handle, buffer.data(), buffer.size(), &num_bytes_read, NULL)) return tl::make_unexpected("Unable to read from COMM port.");
-    if (num_bytes_read != buffer.size()) buffer.resize(num_bytes_read);
+    const auto res = read_some(buffer.data(), buffer.size(), std::chrono::milliseconds(0));
+    if (!res.has_value()) return tl::make_unexpected(res.error());
+    if (*res != buffer.size()) buffer.resize(*res);
     return buffer;
 }
 
-std::optional<std::string> sc::serial::comm_instance::write(const std::vector<std::byte> &input) {
+tl::expected<size_t, std::string> sc::serial::comm_instance::read_some(std::byte *buffer, const size_t &capacity, const std::chrono::milliseconds &timeout) {
+    if (!connected) return tl::make_unexpected("Not connected.");
+    // ReadFile returns as soon as anything has arrived, or after the timeout with nothing; a timeout of 0 returns at once
+    const auto timeout_ms = static_cast<DWORD>(timeout.count());
+    if (read_timeout_ms != timeout_ms) {
+        COMMTIMEOUTS timeouts = { 0 };
+        timeouts.ReadIntervalTimeout = MAXDWORD;
+        timeouts.ReadTotalTimeoutMultiplier = timeout_ms ? MAXDWORD : 0;
+        timeouts.ReadTotalTimeoutConstant = timeout_ms;
+        if (!SetCommTimeouts(io_handle, &timeouts)) return tl::make_unexpected("Unable to set timeouts of COMM port.");
+        read_timeout_ms = timeout_ms;
+    }
+    DWORD num_bytes_read;
+    if (!ReadFile(io_handle, buffer, static_cast<DWORD>(capacity), &num_bytes_read, NULL)) {
+        ClearCommError(io_handle, &error, &status);
+        return tl::make_unexpected("Unable to read from COMM port.");
+    }
+    return num_bytes_read;
+}
+
+std::optional<std::string> sc::serial::comm_instance::write(const std::byte *data, const size_t &size) {
     if (!connected) return "Not connected.";
     DWORD num_bytes_written;
-    if (!WriteFile(io_handle, input.data(), input.size(), &num_bytes_written, NULL)) {
+    if (!WriteFile(io_handle, data, static_cast<DWORD>(size), &num_bytes_written, NULL)) {
         ClearCommError(io_handle, &error, &status);
         return "Unable to write data.";
     }
-    if (num_bytes_written != input.size()) return "Unable to write entire packet.";
+    if (num_bytes_written != size) return "Unable to write entire packet.";
+    return std::nullopt;
+}
+
+#else
+
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+tl::expected<std::vector<std::string>, std::string> sc::serial::list_ports() {
+    std::vector<std::string> list;
+    std::error_code ec;
+    for (const auto &entry : std::filesystem::directory_iterator("/dev", ec)) {
+        const auto name = entry.path().filename().string();
+        for (const std::string_view prefix : { "ttyUSB", "ttyACM", "cu.usbmodem", "cu.usbserial" }) {
+            if (name.compare(0, prefix.size(), prefix) == 0) list.push_back(entry.path().string());
+        }
+    }
+    if (ec) return tl::make_unexpected(fmt::format("Unable to list /dev: {}", ec.message()));
+    std::sort(list.begin(), list.end());
+    return list;
+}
+
+std::optional<sc::serial::usb_id> sc::serial::port_usb_id(const std::string_view &port) {
+#ifdef __linux__
+    // The tty's device is a USB interface, or a driver's node below one; the USB device above it has the IDs, as hex text
+    std::error_code ec;
+    auto dir = std::filesystem::canonical(std::filesystem::path("/sys/class/tty") / std::filesystem::path(port).filename() / "device", ec);
+    if (ec) return std::nullopt;
+    for (int depth = 0; depth < 4 && dir.has_relative_path(); depth++, dir = dir.parent_path()) {
+        std::ifstream vendor_file(dir / "idVendor"), product_file(dir / "idProduct");
+        unsigned int vendor, product;
+        if (vendor_file >> std::hex >> vendor && product_file >> std::hex >> product) return usb_id { static_cast<uint16_t>(vendor), static_cast<uint16_t>(product) };
+    }
+#endif
+    return std::nullopt;
+}
+
+static std::optional<speed_t> to_speed(const uint32_t &baud_rate) {
+    switch (baud_rate) {
+        case 1200: return B1200; // Opening and closing at 1200 baud is how Arduino-style boards are asked to reset into their bootloader
+        case 2400: return B2400;
+        case 4800: return B4800;
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+#ifdef B460800
+        case 460800: return B460800;
+#endif
+#ifdef B500000
+        case 500000: return B500000;
+#endif
+#ifdef B921600
+        case 921600: return B921600;
+#endif
+#ifdef B1000000
+        case 1000000: return B1000000;
+#endif
+#ifdef B2000000
+        case 2000000: return B2000000;
+#endif
+        default: return std::nullopt;
+    }
+}
+
+std::optional<std::string> sc::serial::comm_instance::open(const std::string_view &port, std::optional<uint32_t> baud_rate) {
+    if (const auto err = close(); err) return err;
+    const auto baud = baud_rate ? *baud_rate : 115200;
+    const auto speed = to_speed(baud);
+    if (!speed) return fmt::format("Unsupported baud rate for serial port: {}, {}", port, baud);
+    this->port = port;
+    io_handle = ::open(this->port->c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (io_handle == invalid_handle) {
+        const auto err = fmt::format("Unable to open serial port: {}, {}", port, std::strerror(errno));
+        this->port = std::nullopt;
+        return err;
+    }
+    termios params;
+    if (tcgetattr(io_handle, &params) != 0) {
+        close();
+        return fmt::format("Unable to get current serial parameters for serial port: {}", port);
+    }
+    // 8N1, no echo, no line editing and no translation: bytes go through as they are
+    cfmakeraw(&params);
+    params.c_cflag |= CLOCAL | CREAD | HUPCL; // HUPCL drops DTR on close, as closing the handle does on Windows
+    params.c_cflag &= ~(CSTOPB | PARENB | CRTSCTS);
+    params.c_cc[VMIN] = 0;
+    params.c_cc[VTIME] = 0;
+    cfsetispeed(&params, *speed);
+    cfsetospeed(&params, *speed);
+    if (tcsetattr(io_handle, TCSANOW, &params) != 0) {
+        close();
+        return fmt::format("Unable to get set serial parameters for serial port: {}, {}", port, baud);
+    }
+    tcflush(io_handle, TCIOFLUSH);
+    spdlog::debug("Opened serial port: {}, {}", port, baud);
+    connected = true;
     return std::nullopt;
 }
 
+std::optional<std::string> sc::serial::comm_instance::close() {
+    if (io_handle != invalid_handle) {
+        if (::close(io_handle) != 0) spdlog::warn("Unable to close serial port: {}", *port);
+        else spdlog::debug("Closed serial port: {}", *port);
+        io_handle = invalid_handle;
+    }
+    port = std::nullopt;
+    connected = false;
+    return std::nullopt;
+}
+
+tl::expected<std::vector<std::byte>, std::string> sc::serial::comm_instance::read() {
+    if (!connected) return tl::make_unexpected("Not connected.");
+    int num_queued = 0;
+    if (ioctl(io_handle, FIONREAD, &num_queued) != 0) return tl::make_unexpected("Unable to get current status of serial port.");
+    if (num_queued <= 0) return { };
+    std::vector<std::byte> buffer(static_cast<size_t>(num_queued));
+    const auto res = read_some(buffer.data(), buffer.size(), std::chrono::milliseconds(0));
+    if (!res.has_value()) return tl::make_unexpected(res.error());
+    if (*res != buffer.size()) buffer.resize(*res);
+    return buffer;
+}
+
+tl::expected<size_t, std::string> sc::serial::comm_instance::read_some(std::byte *buffer, const size_t &capacity, const std::chrono::milliseconds &timeout) {
+    if (!connected) return tl::make_unexpected("Not connected.");
+    pollfd fd = { io_handle, POLLIN, 0 };
+    int res;
+    do res = poll(&fd, 1, static_cast<int>(timeout.count()));
+    while (res < 0 && errno == EINTR);
+    if (res < 0) return tl::make_unexpected(fmt::format("Unable to wait on serial port: {}", std::strerror(errno)));
+    if (res == 0) return 0;
+    if (fd.revents & (POLLERR | POLLNVAL)) return tl::make_unexpected("Serial port failed.");
+    const auto num_bytes_read = ::read(io_handle, buffer, capacity);
+    if (num_bytes_read < 0) {
+        if (errno == EAGAIN || errno == EINTR) return 0;
+        return tl::make_unexpected(fmt::format("Unable to read from serial port: {}", std::strerror(errno)));
+    }
+    if (num_bytes_read == 0 && (fd.revents & POLLHUP)) return tl::make_unexpected("Serial port was disconnected.");
+    return static_cast<size_t>(num_bytes_read);
+}
+
+std::optional<std::string> sc::serial::comm_instance::write(const std::byte *data, const size_t &size) {
+    if (!connected) return "Not connected.";
+    size_t num_bytes_written = 0;
+    while (num_bytes_written < size) {
+        const auto res = ::write(io_handle, data + num_bytes_written, size - num_bytes_written);
+        if (res >= 0) {
+            num_bytes_written += static_cast<size_t>(res);
+            continue;
+        }
+        if (errno == EINTR) continue;
+        if (errno != EAGAIN) return fmt::format("Unable to write data: {}", std::strerror(errno));
+        // The driver's buffer is full; wait for it to drain rather than spin
+        pollfd fd = { io_handle, POLLOUT, 0 };
+        if (poll(&fd, 1, 1000) == 0) return "Unable to write entire packet.";
+    }
+    return std::nullopt;
+}
+
+#endif
+
+std::optional<std::string> sc::serial::comm_instance::write(const std::vector<std::byte> &input) {
+    return write(input.data(), input.size());
+}
+
 sc::serial::comm_instance::~comm_instance() {
-    close();    
-}
\ No newline at end of file
+    close();
+}
@@ -5,32 +5,60 @@
 #include <string>
 #include <string_view>
 #include <cstddef>
+#include <cstdint>
+#include <chrono>
 
 #include <tl/expected.hpp>
 
+#ifdef _WIN32
+
 #define WIN32_LEAN_AND_MEAN
 
 #include <windows.h>
 
+#endif
+
 namespace sc::serial {
 
     tl::expected<std::vector<std::string>, std::string> list_ports();
 
+    struct usb_id {
+
+        uint16_t vendor = 0, product = 0;
+
+        constexpr bool operator==(const usb_id &other) const { return vendor == other.vendor && product == other.product; }
+    };
+
+    std::optional<usb_id> port_usb_id(const std::string_view &port); // The USB device behind a port; nothing if it isn't one, or that can't be told
+
     struct comm_instance {
 
+#ifdef _WIN32
+        using native_handle = HANDLE;
+        static inline const native_handle invalid_handle = INVALID_HANDLE_VALUE;
+#else
+        using native_handle = int;
+        static constexpr native_handle invalid_handle = -1;
+#endif
+
         std::optional<std::string> port;
 
         bool connected = false;
 
-        HANDLE io_handle = INVALID_HANDLE_VALUE;
+        native_handle io_handle = invalid_handle;
+#ifdef _WIN32
         COMSTAT status;
         DWORD error;
+        std::optional<DWORD> read_timeout_ms; // What the port's read timeouts are set to, so read_some only changes them when asked for another
+#endif
 
-        std::optional<std::string> open(const std::string_view &port, std::optional<DWORD> baud_rate = std::nullopt);
+        std::optional<std::string> open(const std::string_view &port, std::optional<uint32_t> baud_rate = std::nullopt);
         std::optional<std::string> close();
-        tl::expected<std::vector<std::byte>, std::string> read();
+        tl::expected<std::vector<std::byte>, std::string> read(); // Whatever has arrived, without waiting
+        tl::expected<size_t, std::string> read_some(std::byte *buffer, const size_t &capacity, const std::chrono::milliseconds &timeout); // Waits up to timeout for at least one byte; 0 if none came
         std::optional<std::string> write(const std::vector<std::byte> &input);
+        std::optional<std::string> write(const std::byte *data, const size_t &size);
 
         ~comm_instance();
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,202 @@
+#include "serial.h"
+#include "reader.h"
+#include "framing.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../check.hpp"
+
+using namespace sc::serial;
+
+using sc::test::check;
+
+static std::vector<std::byte> random_payload(std::mt19937 &rng, const size_t &size) {
+    std::vector<std::byte> res(size);
+    for (auto &value : res) value = static_cast<std::byte>(rng() % 4 ? rng() : 0); // Plenty of zeros for COBS to escape
+    return res;
+}
+
+// A pseudo-terminal pair: the test drives the master, the port under test opens the slave
+struct pty_pair {
+
+    int master = -1;
+    std::string slave;
+
+    pty_pair() {
+        master = posix_openpt(O_RDWR | O_NOCTTY);
+        if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) return;
+        slave = ptsname(master);
+    }
+
+    void write_all(const std::vector<std::byte> &data) const {
+        size_t at = 0;
+        while (at < data.size()) {
+            const auto res = ::write(master, data.data() + at, data.size() - at);
+            if (res <= 0) return;
+            at += static_cast<size_t>(res);
+        }
+    }
+
+    void close() {
+        if (master >= 0) ::close(master);
+        master = -1;
+    }
+
+    ~pty_pair() { close(); }
+};
+
+static void test_ring() {
+    byte_ring ring(1000);
+    check(ring.capacity() == 1024, "a ring's capacity is rounded up to a power of two");
+    constexpr size_t total = 4 << 20;
+    std::thread producer([&]() {
+        std::mt19937 rng(1);
+        size_t at = 0;
+        while (at < total) {
+            const auto span = ring.write_span();
+            const auto n = std::min({ span.size, static_cast<size_t>(rng() % 300 + 1), total - at });
+            for (size_t i = 0; i < n; i++) span.data[i] = static_cast<std::byte>((at + i) * 31 >> 3);
+            ring.commit(n);
+            at += n;
+        }
+    });
+    std::vector<std::byte> chunk(257);
+    size_t at = 0, num_wrong = 0;
+    while (at < total) {
+        const auto n = ring.read(chunk.data(), chunk.size());
+        for (size_t i = 0; i < n; i++) if (chunk[i] != static_cast<std::byte>((at + i) * 31 >> 3)) num_wrong++;
+        at += n;
+    }
+    producer.join();
+    check(num_wrong == 0, "a ring hands over bytes in order across threads");
+    check(ring.size() == 0, "a drained ring is empty");
+}
+
+static void test_framing() {
+    std::mt19937 rng(2);
+    for (const size_t size : { 0, 1, 2, 252, 253, 254, 255, 508, 509, 1024 }) {
+        for (int zeros = 0; zeros < 2; zeros++) {
+            auto payload = random_payload(rng, size);
+            if (!zeros) for (auto &value : payload) value |= std::byte { 1 };
+            auto encoded = framing::encode(payload.data(), payload.size());
+            check(encoded.size() <= framing::encoded_size(size), "a frame fits its worst-case size");
+            check(std::count(encoded.begin(), encoded.end(), std::byte { 0 }) == 1 && encoded.back() == std::byte { 0 }, "a frame's only zero is its delimiter");
+            const auto decoded = framing::decode_in_place(encoded.data(), encoded.size() - 1);
+            check(decoded == size + 2 && std::equal(payload.begin(), payload.end(), encoded.begin()), "COBS decodes to what it encoded, size " + std::to_string(size));
+        }
+    }
+
+    // Frames trickle through a ring smaller than some of them, wrapping around its end
+    byte_ring ring(512);
+    framing::parser parser;
+    std::vector<std::vector<std::byte>> sent, received;
+    std::vector<std::byte> stream;
+    for (int i = 0; i < 500; i++) {
+        sent.push_back(random_payload(rng, rng() % 700));
+        const auto encoded = framing::encode(sent.back().data(), sent.back().size());
+        stream.insert(stream.end(), encoded.begin(), encoded.end());
+    }
+    const auto on_frame = [&](const std::byte *payload, const size_t &size) { received.emplace_back(payload, payload + size); };
+    for (size_t at = 0; at < stream.size(); ) {
+        at += ring.write(stream.data() + at, std::min<size_t>(rng() % 200 + 1, stream.size() - at));
+        parser.parse(ring, on_frame);
+    }
+    check(received == sent, "frames parse back whole, however the ring splits them");
+    check(parser.num_errors() == 0, "clean frames parse without errors");
+
+    // Joining mid-frame, a corrupted frame and a runaway frame each cost that frame only
+    received.clear();
+    stream.clear();
+    const auto good = random_payload(rng, 40);
+    const auto good_encoded = framing::encode(good.data(), good.size());
+    stream.insert(stream.end(), good_encoded.begin() + 10, good_encoded.end());
+    auto corrupted = good_encoded;
+    corrupted[5] ^= std::byte { 0x10 };
+    if (corrupted[5] == std::byte { 0 }) corrupted[5] = std::byte { 0x10 };
+    stream.insert(stream.end(), corrupted.begin(), corrupted.end());
+    stream.insert(stream.end(), good_encoded.begin(), good_encoded.end());
+    stream.insert(stream.end(), 3000, std::byte { 0x55 });
+    stream.push_back(std::byte { 0 });
+    stream.insert(stream.end(), good_encoded.begin(), good_encoded.end());
+    for (size_t at = 0; at < stream.size(); ) {
+        at += ring.write(stream.data() + at, stream.size() - at);
+        parser.parse(ring, on_frame);
+    }
+    check(received.size() == 2 && received[0] == good && received[1] == good, "the parser resynchronizes at the next delimiter");
+    check(parser.num_errors() == 3, "dropped frames are counted");
+}
+
+static void test_pty() {
+    pty_pair pty;
+    if (pty.slave.empty()) {
+        check(false, "a pseudo-terminal pair opens");
+        return;
+    }
+    comm_instance comm;
+    check(comm.open("/dev/no-such-port").has_value(), "a missing port fails to open");
+    check(comm.open(pty.slave, 12345).has_value(), "an unsupported baud rate fails to open");
+    if (const auto err = comm.open(pty.slave, 1000000); err) {
+        check(false, "a port opens at 1 Mbaud: " + *err);
+        return;
+    }
+
+    byte_ring ring(4096);
+    framing::parser parser;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<std::vector<std::byte>> sent, received;
+    std::mt19937 rng(3);
+    for (int i = 0; i < 2000; i++) sent.push_back(random_payload(rng, rng() % 200));
+    {
+        reader port_reader(comm, ring, [&]() { cv.notify_one(); });
+        std::thread writer([&]() {
+            for (const auto &payload : sent) pty.write_all(framing::encode(payload.data(), payload.size()));
+        });
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        std::unique_lock lock(mutex);
+        while (received.size() < sent.size() && std::chrono::steady_clock::now() < deadline) {
+            cv.wait_for(lock, std::chrono::milliseconds(50));
+            parser.parse(ring, [&](const std::byte *payload, const size_t &size) { received.emplace_back(payload, payload + size); });
+        }
+        lock.unlock();
+        writer.join();
+        check(received == sent, "frames written to the other end arrive whole and in order");
+        check(port_reader.num_bytes() > 0 && !port_reader.error(), "the reader counts what it read");
+
+        // The other direction goes through write
+        const auto reply = framing::encode(sent[7].data(), sent[7].size());
+        check(!comm.write(reply), "a frame is written to the port");
+        byte_ring reply_ring(1024);
+        framing::parser reply_parser;
+        std::vector<std::byte> reply_payload;
+        for (int i = 0; i < 100 && reply_payload.empty(); i++) {
+            std::array<std::byte, 256> chunk;
+            const auto n = ::read(pty.master, chunk.data(), chunk.size());
+            if (n > 0) reply_ring.write(chunk.data(), static_cast<size_t>(n));
+            reply_parser.parse(reply_ring, [&](const std::byte *payload, const size_t &size) { reply_payload.assign(payload, payload + size); });
+        }
+        check(reply_payload == sent[7], "a frame written to the port arrives at the other end");
+
+        // Unplugging the device
+        pty.close();
+        for (int i = 0; i < 100 && port_reader.running(); i++) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        check(!port_reader.running() && port_reader.error(), "the reader stops with an error when the other end goes away");
+    }
+    check(!comm.close() && !comm.connected, "a port closes");
+    check(comm.read_some(nullptr, 0, std::chrono::milliseconds(0)).has_value() == false, "a closed port can't be read");
+    check(list_ports().has_value(), "ports can be listed");
+}
+
+int main() {
+    test_ring();
+    test_framing();
+    test_pty();
+    return sc::test::finish("serial");
+}
@@ -0,0 +1,92 @@
+#include "baked_animation.h"
+
+#include <cstring>
+
+#include <fmt/format.h>
+#include <stb_image.h>
+#include <stb_image_write.h>
+
+static constexpr char baked_magic[4] = { 'S', 'C', 'B', 'A' };
+static constexpr size_t baked_header_size = sizeof(baked_magic) + sizeof(uint32_t) * 2 + sizeof(int32_t) * 2 + sizeof(double);
+
+template <typename T> static void write_value(std::vector<std::byte> &out, const T &value) {
+    const auto offset = out.size();
+    out.resize(offset + sizeof(T));
+    memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+template <typename T> static T read_value(const std::vector<std::byte> &in, size_t &offset) {
+    T value;
+    memcpy(&value, in.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return value;
+}
+
+tl::expected<std::vector<std::byte>, std::string> sc::texture::bake_animation(const frame_sequence &sequence) {
+    if (!sequence.num_frames) return tl::make_unexpected("The sequence has no frames.");
+    std::vector<std::vector<std::byte>> pngs(sequence.num_frames);
+    for (size_t i = 0; i < sequence.num_frames; i++) {
+        const auto append = [](void *context, void *data, int size) {
+            auto &png = *static_cast<std::vector<std::byte> *>(context);
+            png.insert(png.end(), static_cast<const std::byte *>(data), static_cast<const std::byte *>(data) + size);
+        };
+        if (!stbi_write_png_to_func(append, &pngs[i], sequence.size.x, sequence.size.y, 4, sequence.frame_pixels(i), sequence.size.x * 4)) {
+            return tl::make_unexpected(fmt::format("Unable to encode frame {}.", i));
+        }
+    }
+    std::vector<std::byte> res;
+    res.insert(res.end(), reinterpret_cast<const std::byte *>(baked_magic), reinterpret_cast<const std::byte *>(baked_magic) + sizeof(baked_magic));
+    write_value<uint32_t>(res, baked_animation::version);
+    write_value<int32_t>(res, sequence.size.x);
+    write_value<int32_t>(res, sequence.size.y);
+    write_value<uint32_t>(res, static_cast<uint32_t>(sequence.num_frames));
+    write_value<double>(res, sequence.frame_rate);
+    uint64_t offset = 0;
+    for (const auto &png : pngs) {
+        write_value<uint64_t>(res, offset);
+        write_value<uint64_t>(res, png.size());
+        offset += png.size();
+    }
+    for (const auto &png : pngs) res.insert(res.end(), png.begin(), png.end());
+    return res;
+}
+
+tl::expected<sc::texture::baked_animation, std::string> sc::texture::baked_animation::parse(std::vector<std::byte> data) {
+    if (data.size() < baked_header_size || memcmp(data.data(), baked_magic, sizeof(baked_magic)) != 0) return tl::make_unexpected("Not a baked animation.");
+    size_t offset = sizeof(baked_magic);
+    if (const auto file_version = read_value<uint32_t>(data, offset); file_version != version) return tl::make_unexpected(fmt::format("Unsupported baked animation version: {}", file_version));
+    baked_animation res;
+    res.size.x = read_value<int32_t>(data, offset);
+    res.size.y = read_value<int32_t>(data, offset);
+    res.num_frames = read_value<uint32_t>(data, offset);
+    res.frame_rate = read_value<double>(data, offset);
+    if (res.size.x <= 0 || res.size.y <= 0 || !res.num_frames) return tl::make_unexpected("The baked animation is empty.");
+    const auto index_size = res.num_frames * sizeof(uint64_t) * 2;
+    if (data.size() - offset < index_size) return tl::make_unexpected("The baked animation index is truncated.");
+    const auto frames_offset = offset + index_size;
+    res.frames.reserve(res.num_frames);
+    for (size_t i = 0; i < res.num_frames; i++) {
+        const auto frame_offset = read_value<uint64_t>(data, offset);
+        const auto frame_size = read_value<uint64_t>(data, offset);
+        if (frame_offset > data.size() - frames_offset || frame_size > data.size() - frames_offset - frame_offset) return tl::make_unexpected(fmt::format("Frame {} lies outside the baked animation.", i));
+        res.frames.emplace_back(frames_offset + frame_offset, frame_size);
+    }
+    res.data = std::move(data);
+    return std::move(res);
+}
+
+std::optional<std::string> sc::texture::baked_animation::decode(const size_t &frame_i, std::byte *rgba) const {
+    const auto rgba_size = static_cast<size_t>(size.x) * size.y * 4;
+    const auto fail = [&](std::string err) -> std::optional<std::string> {
+        memset(rgba, 0, rgba_size); // Transparent rather than whatever frame the buffer held before
+        return err;
+    };
+    if (frame_i >= frames.size()) return fail(fmt::format("Frame {} is out of range.", frame_i));
+    int width, height;
+    unsigned char *pixels = stbi_load_from_memory(reinterpret_cast<const stbi_uc *>(data.data() + frames[frame_i].first), static_cast<int>(frames[frame_i].second), &width, &height, 0, STBI_rgb_alpha);
+    if (!pixels) return fail(fmt::format("Unable to decode frame {}.", frame_i));
+    if (width == size.x && height == size.y) memcpy(rgba, pixels, rgba_size);
+    stbi_image_free(pixels);
+    if (width != size.x || height != size.y) return fail(fmt::format("Frame {} is {}x{}, expected {}x{}.", frame_i, width, height, size.x, size.y));
+    return std::nullopt;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "texture.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include <string>
+#include <utility>
+
+#include <tl/expected.hpp>
+#include <glm/vec2.hpp>
+
+namespace sc::texture {
+
+    // An animation rasterized at build time, so showing it needs neither JSON parsing nor rlottie.
+    // Every frame is stored as its own PNG, so one frame can be decoded without touching the others.
+    // Layout: "SCBA", u32 version, i32 width, i32 height, u32 frame count, f64 frame rate,
+    // then a u64 offset and u64 length per frame into the PNG data following the index.
+    struct baked_animation {
+
+        static constexpr uint32_t version = 1;
+
+        glm::ivec2 size;
+        double frame_rate;
+        size_t num_frames;
+        std::vector<std::byte> data; // The whole baked file
+        std::vector<std::pair<size_t, size_t>> frames; // Offset and length of each frame's PNG in data
+
+        static tl::expected<baked_animation, std::string> parse(std::vector<std::byte> data);
+
+        // Decodes a frame into size.x * size.y RGBA pixels; on failure they are cleared to transparent.
+        std::optional<std::string> decode(const size_t &frame_i, std::byte *rgba) const;
+    };
+
+    tl::expected<std::vector<std::byte>, std::string> bake_animation(const frame_sequence &sequence);
+}
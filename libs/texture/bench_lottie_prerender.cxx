@@ -0,0 +1,86 @@
+#include "texture.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+#include <nlohmann/json.hpp>
+#include <rlottie_capi.h>
+
+// The implementation load_lottie_from_memory replaced: serial rendering, one vector per frame, copied into the sequence.
+static std::vector<sc::texture::frame> load_lottie_serial(const std::string &cache_key, const std::vector<std::byte> &data, const glm::ivec2 &size) {
+    const auto data_str = std::string(reinterpret_cast<const char *>(data.data()), data.size());
+    if (!nlohmann::json::accept(data_str)) return {};
+    auto animation = lottie_animation_from_data(data_str.c_str(), cache_key.c_str(), "");
+    if (!animation) return {};
+    const auto num_frames = lottie_animation_get_totalframe(animation);
+    std::vector<sc::texture::frame> frames;
+    frames.reserve(num_frames);
+    for (int i = 0; i < num_frames; i++) {
+        std::vector<std::byte> rgba(size.x * size.y * 4);
+        lottie_animation_render(animation, i, reinterpret_cast<uint32_t *>(rgba.data()), size.x, size.y, size.x * 4);
+        frames.push_back({
+            size,
+            rgba
+        });
+    }
+    lottie_animation_destroy(animation);
+    return frames;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        spdlog::error("Usage: {} <lottie.json> [width] [height] [iterations]", argv[0]);
+        return 1;
+    }
+    const glm::ivec2 size = { argc > 2 ? std::stoi(argv[2]) : 256, argc > 3 ? std::stoi(argv[3]) : 256 };
+    const auto iterations = argc > 4 ? std::stoi(argv[4]) : 5;
+    std::ifstream file(argv[1], std::ios::binary);
+    if (!file) {
+        spdlog::error("Unable to open: {}", argv[1]);
+        return 1;
+    }
+    std::vector<std::byte> data;
+    std::transform(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>(), std::back_inserter(data), [](const char &c) { return static_cast<std::byte>(c); });
+
+    const auto measure = [&](const auto &fn) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) fn(i);
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+    };
+    size_t serial_frames = 0;
+    const auto serial_ms = measure([&](const int &i) {
+        serial_frames = load_lottie_serial(fmt::format("serial{}", i), data, size).size();
+    });
+    const auto bench_parallel = [&](const size_t &num_threads) {
+        size_t num_frames = 0;
+        const auto ms = measure([&](const int &i) {
+            auto sequence = sc::texture::load_lottie_from_memory(fmt::format("parallel{}-{}", num_threads, i), data, size, num_threads);
+            if (sequence.has_value()) num_frames = sequence->num_frames;
+        });
+        return std::make_pair(ms, num_frames);
+    };
+    const auto [single_ms, num_frames] = bench_parallel(1);
+    const auto [parallel_ms, _] = bench_parallel(0);
+    if (!num_frames || num_frames != serial_frames) {
+        spdlog::error("Unable to render the animation ({} vs {} frames).", serial_frames, num_frames);
+        return 1;
+    }
+
+    const auto frame_bytes = static_cast<size_t>(size.x) * size.y * 4;
+    spdlog::info("{}: {} frames at {}x{}, {} iterations", argv[1], num_frames, size.x, size.y, iterations);
+    spdlog::info("Serial, copied frames:      {:.2f} ms", serial_ms);
+    spdlog::info("Arena, 1 thread:            {:.2f} ms", single_ms);
+    spdlog::info("Arena, {} threads:           {:.2f} ms ({:.2f}x)", std::max(1u, std::thread::hardware_concurrency()), parallel_ms, serial_ms / parallel_ms);
+    spdlog::info("Pixels in memory: {:.2f} MiB", (num_frames * frame_bytes) / (1024.0 * 1024.0));
+
+    // Texture memory as allocated, RGBA8 without mipmaps; what the driver adds on top isn't visible without a context
+    constexpr size_t ring_textures = 3; // lottie_player::create's default
+    spdlog::info("Textures before, one per frame: {} ({:.2f} MiB)", num_frames, (num_frames * frame_bytes) / (1024.0 * 1024.0));
+    spdlog::info("Textures after, lottie_player's ring: {} ({:.2f} MiB)", ring_textures, (ring_textures * frame_bytes) / (1024.0 * 1024.0));
+    return 0;
+}
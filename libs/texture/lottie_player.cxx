@@ -0,0 +1,180 @@
+#include "lottie_player.h"
+
+#include <glbinding/glbinding.h>
+#include <glbinding/gl33core/gl.h>
+
+using namespace gl;
+
+#include <spdlog/spdlog.h>
+#include <nlohmann/json.hpp>
+#include <rlottie_capi.h>
+
+#include <algorithm>
+
+tl::expected<std::shared_ptr<sc::texture::lottie_player>, std::string> sc::texture::lottie_player::create(const std::string_view &cache_key, const std::vector<std::byte> &data, const glm::ivec2 &size, const size_t &max_cached_frames, const size_t &num_textures) {
+    const auto data_str = std::string(reinterpret_cast<const char *>(data.data()), data.size());
+    if (!nlohmann::json::accept(data_str)) return tl::make_unexpected("Unable to parse JSON data.");
+    auto animation = lottie_animation_from_data(data_str.c_str(), std::string(cache_key).c_str(), "");
+    if (!animation) return tl::make_unexpected("Unable to process file.");
+    const auto num_frames = lottie_animation_get_totalframe(animation);
+    if (!num_frames) {
+        lottie_animation_destroy(animation);
+        return tl::make_unexpected("The animation has no frames.");
+    }
+    const auto frame_rate = lottie_animation_get_framerate(animation);
+    const auto render = [animation = std::shared_ptr<Lottie_Animation>(animation, lottie_animation_destroy), size](const size_t &frame_i, std::byte *rgba) {
+        lottie_animation_render(animation.get(), frame_i, reinterpret_cast<uint32_t *>(rgba), size.x, size.y, size.x * 4);
+    };
+    return std::make_shared<lottie_player>(render, cache_key, size, frame_rate, num_frames, std::max<size_t>(max_cached_frames, 1), std::max<size_t>(num_textures, 1));
+}
+
+tl::expected<std::shared_ptr<sc::texture::lottie_player>, std::string> sc::texture::lottie_player::create(const std::string_view &cache_key, baked_animation baked, const size_t &max_cached_frames, const size_t &num_textures) {
+    auto shared = std::make_shared<const baked_animation>(std::move(baked));
+    const auto render = [shared, cache_key = std::string(cache_key)](const size_t &frame_i, std::byte *rgba) {
+        if (const auto err = shared->decode(frame_i, rgba); err) spdlog::warn("{}: {}", cache_key, *err);
+    };
+    return std::make_shared<lottie_player>(render, cache_key, shared->size, shared->frame_rate, shared->num_frames, std::max<size_t>(max_cached_frames, 1), std::max<size_t>(num_textures, 1));
+}
+
+sc::texture::lottie_player::lottie_player(render_function render, const std::string_view &cache_key, const glm::ivec2 &size, const double &frame_rate, const size_t &num_frames, const size_t &max_cached_frames, const size_t &num_textures) : cache_key(cache_key), size(size), frame_rate(frame_rate), num_frames(num_frames), max_cached_frames(max_cached_frames), num_textures(num_textures), render(std::move(render)) {
+    spdlog::debug("Prepared Lottie player: {} ({}x{}, {} frames)", this->cache_key, size.x, size.y, num_frames);
+}
+
+sc::texture::lottie_player::~lottie_player() {
+    release();
+}
+
+std::shared_ptr<sc::texture::gpu_handle> sc::texture::lottie_player::texture(const size_t &frame_i) {
+    if (frame_i >= num_frames) return shown ? ring[*shown] : nullptr;
+    if (shown && ring_frames[*shown] == frame_i) return ring[*shown];
+    for (size_t i = 0; i < ring_frames.size(); i++) {
+        if (ring_frames[i] != frame_i) continue;
+        shown = i;
+        request(frame_i);
+        return ring[i];
+    }
+
+    std::optional<std::vector<std::byte>> pixels;
+    {
+        std::lock_guard guard(mutex);
+        if (const auto found = cached_index.find(frame_i); found != cached_index.end()) {
+            pixels = std::move(found->second->second);
+            cached.erase(found->second);
+            cached_index.erase(found);
+        }
+    }
+    request(frame_i);
+    if (!pixels) return shown ? ring[*shown] : nullptr; // Keep showing the previous frame until the worker catches up
+
+    if (ring_next >= ring.size()) {
+        GLuint handle;
+        glGenTextures(1, &handle);
+        if (handle <= 0) {
+            spdlog::warn("Unable to allocate a texture ID on the GPU for: {}", cache_key);
+            return shown ? ring[*shown] : nullptr;
+        }
+        glBindTexture(GL_TEXTURE_2D, handle);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size.x, size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        ring.push_back(std::make_shared<gpu_handle>(handle, size, fmt::format("<lottie:{}:{}x{}#{}>", cache_key, size.x, size.y, ring.size())));
+        ring_frames.emplace_back();
+    }
+    glBindTexture(GL_TEXTURE_2D, ring[ring_next]->handle);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, pixels->data());
+    ring_frames[ring_next] = frame_i;
+    shown = ring_next;
+    ring_next = (ring_next + 1) % num_textures;
+
+    std::lock_guard guard(mutex);
+    spare.push_back(std::move(*pixels));
+    return ring[*shown];
+}
+
+void sc::texture::lottie_player::trim() {
+    stop_worker();
+    cached.clear();
+    cached_index.clear();
+    spare.clear();
+    if (shown) {
+        ring = { ring[*shown] };
+        ring_frames = { ring_frames[*shown] };
+        shown = 0;
+        ring_next = 1 % num_textures;
+    } else release();
+}
+
+void sc::texture::lottie_player::release() {
+    stop_worker();
+    cached.clear();
+    cached_index.clear();
+    spare.clear();
+    ring.clear();
+    ring_frames.clear();
+    ring_next = 0;
+    shown.reset();
+}
+
+void sc::texture::lottie_player::request(const size_t &frame_i) {
+    // The requested frame comes first, then as many following frames as the cache can hold without evicting them again.
+    const auto prefetch = max_cached_frames / 2;
+    {
+        std::lock_guard guard(mutex);
+        requests.clear();
+        for (size_t ahead = 0; ahead <= prefetch && ahead < num_frames; ahead++) {
+            const auto next_i = (frame_i + ahead) % num_frames;
+            if (cached_index.count(next_i)) continue;
+            if (std::find(ring_frames.begin(), ring_frames.end(), next_i) != ring_frames.end()) continue;
+            requests.push_back(next_i);
+        }
+        if (requests.empty()) return;
+        if (!working) {
+            working = true;
+            worker = std::thread(&lottie_player::work, this);
+        }
+    }
+    cv.notify_one();
+}
+
+void sc::texture::lottie_player::stop_worker() {
+    {
+        std::lock_guard guard(mutex);
+        working = false;
+        requests.clear();
+    }
+    cv.notify_all();
+    if (worker.joinable()) worker.join();
+}
+
+void sc::texture::lottie_player::work() {
+    for (;;) {
+        size_t frame_i;
+        std::vector<std::byte> pixels;
+        {
+            std::unique_lock lock(mutex);
+            cv.wait(lock, [this]() { return !working || !requests.empty(); });
+            if (!working) return;
+            frame_i = requests.front();
+            requests.pop_front();
+            if (cached_index.count(frame_i)) continue;
+            if (!spare.empty()) {
+                pixels = std::move(spare.back());
+                spare.pop_back();
+            }
+        }
+        pixels.resize(static_cast<size_t>(size.x) * size.y * 4);
+        render(frame_i, pixels.data());
+        std::lock_guard guard(mutex);
+        if (cached_index.count(frame_i)) {
+            spare.push_back(std::move(pixels));
+            continue;
+        }
+        cached.emplace_front(frame_i, std::move(pixels));
+        cached_index[frame_i] = cached.begin();
+        while (cached.size() > max_cached_frames) {
+            cached_index.erase(cached.back().first);
+            spare.push_back(std::move(cached.back().second));
+            cached.pop_back();
+        }
+    }
+}
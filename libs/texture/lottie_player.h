@@ -0,0 +1,81 @@
+#pragma once
+
+#include "texture.h"
+#include "baked_animation.h"
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+#include <list>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+#include <tl/expected.hpp>
+#include <glm/vec2.hpp>
+
+namespace sc::texture {
+
+    // Plays a Lottie animation without rasterizing it up front.
+    // Frames are rendered (or decoded, for a baked animation) on demand by a worker thread into a small LRU of pixel buffers,
+    // then copied into a ring of reusable textures with glTexSubImage2D when they are shown.
+    struct lottie_player {
+
+        const std::string cache_key;
+        const glm::ivec2 size;
+        const double frame_rate;
+        const size_t num_frames;
+        const size_t max_cached_frames; // Rendered frames kept in memory, including prefetched ones
+        const size_t num_textures; // Textures in the ring; more than one, so a texture isn't rewritten while the GPU may still read it
+
+        using render_function = std::function<void(const size_t &frame_i, std::byte *rgba)>; // Called from the worker thread
+
+        static tl::expected<std::shared_ptr<lottie_player>, std::string> create(const std::string_view &cache_key, const std::vector<std::byte> &data, const glm::ivec2 &size, const size_t &max_cached_frames = 8, const size_t &num_textures = 3);
+        static tl::expected<std::shared_ptr<lottie_player>, std::string> create(const std::string_view &cache_key, baked_animation baked, const size_t &max_cached_frames = 8, const size_t &num_textures = 3);
+
+        lottie_player(render_function render, const std::string_view &cache_key, const glm::ivec2 &size, const double &frame_rate, const size_t &num_frames, const size_t &max_cached_frames, const size_t &num_textures);
+        lottie_player(const lottie_player &) = delete;
+        lottie_player &operator=(const lottie_player &) = delete;
+
+        ~lottie_player();
+
+        // Returns a texture showing the given frame, or the most recently shown frame while it is still being rendered.
+        // Must be called from the thread that owns the GL context.
+        std::shared_ptr<gpu_handle> texture(const size_t &frame_i);
+
+        // Stops the worker and drops every rendered frame, keeping only the texture that is currently shown.
+        void trim();
+
+        // Stops the worker and drops every rendered frame and texture.
+        void release();
+
+    private:
+
+        void work();
+        void stop_worker();
+        void request(const size_t &frame_i);
+
+        const render_function render;
+
+        std::thread worker;
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool working = false;
+
+        std::deque<size_t> requests; // Frames the worker should render next, most urgent first
+        std::list<std::pair<size_t, std::vector<std::byte>>> cached; // Rendered frames, most recently used first
+        std::unordered_map<size_t, decltype(cached)::iterator> cached_index;
+        std::vector<std::vector<std::byte>> spare; // Pixel buffers ready for reuse
+
+        std::vector<std::shared_ptr<gpu_handle>> ring; // Only touched by the GL thread
+        std::vector<std::optional<size_t>> ring_frames;
+        size_t ring_next = 0;
+        std::optional<size_t> shown;
+    };
+}
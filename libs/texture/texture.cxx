@@ -14,6 +14,10 @@ using namespace gl;
 #include <stb_image_write.h>
 #include <rlottie_capi.h>
 
+#include <atomic>
+#include <thread>
+#include <algorithm>
+
 tl::expected<sc::texture::frame, std::string> sc::texture::load_from_memory(const std::vector<std::byte> &data) {
     int image_width, image_height;
     unsigned char *image_data = stbi_load_from_memory(reinterpret_cast<const stbi_uc *>(data.data()), data.size(), &image_width, &image_height, 0, STBI_rgb_alpha);
@@ -26,30 +30,44 @@ tl::expected<sc::texture::frame, std::string> sc::texture::load_from_memory(cons
     return std::move(res);
 }
 
-tl::expected<sc::texture::frame_sequence, std::string> sc::texture::load_lottie_from_memory(const std::string_view &cache_key, const std::vector<std::byte> &data, const glm::ivec2 &size) {
+tl::expected<sc::texture::frame_sequence, std::string> sc::texture::load_lottie_from_memory(const std::string_view &cache_key, const std::vector<std::byte> &data, const glm::ivec2 &size, const size_t &num_threads) {
     const auto data_str = std::string(reinterpret_cast<const char *>(data.data()), data.size());
     if (!nlohmann::json::accept(data_str)) return tl::make_unexpected("Unable to parse JSON data.");
-    auto animation = lottie_animation_from_data(data_str.c_str(), cache_key.data(), "");
+    const auto key = std::string(cache_key);
+    auto animation = lottie_animation_from_data(data_str.c_str(), key.c_str(), "");
     if (!animation) return tl::make_unexpected("Unable to process file.");
-    const auto frame_rate = lottie_animation_get_framerate(animation);
-    const auto num_frames = lottie_animation_get_totalframe(animation);
-    const auto duration = lottie_animation_get_duration(animation);
-    std::vector<frame> frames;
-    frames.reserve(num_frames);
-    for (int i = 0; i < num_frames; i++) {
-        std::vector<std::byte> rgba(size.x * size.y * 4);
-        lottie_animation_render(animation, i, reinterpret_cast<uint32_t *>(rgba.data()), size.x, size.y, size.x * 4);
-        frames.push_back({
-            size,
-            rgba
+    frame_sequence res;
+    res.frame_rate = lottie_animation_get_framerate(animation);
+    res.size = size;
+    res.num_frames = lottie_animation_get_totalframe(animation);
+    const size_t frame_bytes = static_cast<size_t>(size.x) * size.y * 4;
+    res.pixels.resize(frame_bytes * res.num_frames);
+
+    // Each worker renders with its own animation instance; rlottie shares the parsed model between instances with the same cache key.
+    std::atomic<size_t> next_frame_i = 0;
+    const auto render = [&](Lottie_Animation *instance) {
+        for (auto frame_i = next_frame_i++; frame_i < res.num_frames; frame_i = next_frame_i++) {
+            lottie_animation_render(instance, frame_i, reinterpret_cast<uint32_t *>(res.pixels.data() + (frame_i * frame_bytes)), size.x, size.y, size.x * 4);
+        }
+    };
+    const auto num_workers = std::min<size_t>(num_threads ? num_threads : std::max(1u, std::thread::hardware_concurrency()), res.num_frames);
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < num_workers; i++) {
+        workers.emplace_back([&]() {
+            if (auto instance = lottie_animation_from_data(data_str.c_str(), key.c_str(), ""); instance) {
+                render(instance);
+                lottie_animation_destroy(instance);
+            }
         });
     }
+    render(animation); // The calling thread takes part with the instance it already has
+    for (auto &worker : workers) worker.join();
     lottie_animation_destroy(animation);
-    const frame_sequence res {
-        frame_rate,
-        frames
-    };
-    return res;
+    return std::move(res);
+}
+
+const std::byte *sc::texture::frame_sequence::frame_pixels(const size_t &frame_i) const {
+    return pixels.data() + (frame_i * static_cast<size_t>(size.x) * size.y * 4);
 }
 
 tl::expected<sc::texture::frame, std::string> sc::texture::resize(const frame &reference, const glm::ivec2 &new_size) {
@@ -106,4 +124,4 @@ tl::expected<std::shared_ptr<sc::texture::gpu_handle>, std::string> sc::texture:
     }
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, reference.size.x, reference.size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, reference.content.data());
     return std::make_shared<gpu_handle>(texture, size, description);
-}
\ No newline at end of file
+}
@@ -23,7 +23,11 @@ namespace sc::texture {
     struct frame_sequence {
 
         double frame_rate;
-        std::vector<frame> frames;
+        glm::ivec2 size; // Every frame has this size
+        size_t num_frames;
+        std::vector<std::byte> pixels; // RGBA of every frame, back to back in one allocation
+
+        const std::byte *frame_pixels(const size_t &frame_i) const;
 
         static std::optional<size_t> plot_frame_index(const double &frame_rate, const size_t &num_frames, double &seconds, const bool &wrap = false);
     };
@@ -42,7 +46,7 @@ namespace sc::texture {
     };
 
     tl::expected<frame, std::string> load_from_memory(const std::vector<std::byte> &data);
-    tl::expected<frame_sequence, std::string> load_lottie_from_memory(const std::string_view &cache_key, const std::vector<std::byte> &data, const glm::ivec2 &size);
+    tl::expected<frame_sequence, std::string> load_lottie_from_memory(const std::string_view &cache_key, const std::vector<std::byte> &data, const glm::ivec2 &size, const size_t &num_threads = 0);
     tl::expected<frame, std::string> resize(const frame &reference, const glm::ivec2 &new_size);
     tl::expected<std::shared_ptr<gpu_handle>, std::string> upload_to_gpu(const frame &reference, const glm::ivec2 &size, const std::optional<std::string> &description = std::nullopt);
 }
\ No newline at end of file
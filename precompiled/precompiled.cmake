@@ -1,6 +1,14 @@
 include_directories("${PROJECT_SOURCE_DIR}/precompiled/rlottie/include")
-if(CMAKE_BUILD_TYPE MATCHES Debug)
-    link_libraries("${PROJECT_SOURCE_DIR}/precompiled/rlottie/lib/Debug/rlottie.lib")
+if(WIN32)
+    if(CMAKE_BUILD_TYPE MATCHES Debug)
+        link_libraries("${PROJECT_SOURCE_DIR}/precompiled/rlottie/lib/Debug/rlottie.lib")
+    else()
+        link_libraries("${PROJECT_SOURCE_DIR}/precompiled/rlottie/lib/RelWithDebInfo/rlottie.lib")
+    endif()
 else()
-    link_libraries("${PROJECT_SOURCE_DIR}/precompiled/rlottie/lib/RelWithDebInfo/rlottie.lib")
-endif()
\ No newline at end of file
+    # Only the headless tools build elsewhere (bench_gui); they use the system's rlottie.
+    find_library(RLOTTIE_LIBRARY rlottie)
+    if(RLOTTIE_LIBRARY)
+        link_libraries("${RLOTTIE_LIBRARY}")
+    endif()
+endif()